@@ -28,6 +28,9 @@
 #include <fstream>
 #include <utility>
 #include <iterator>
+#include <set>
+#include <vector>
+#include <atomic>
 
 #include <wx/datetime.h>
 #include <wx/filename.h>
@@ -41,18 +44,29 @@
 
 #include "common.h"
 #include "3d_cache.h"
+#include "3d_mesh_cache.h"
+#include "3d_mesh_lod.h"
 #include "3d_info.h"
 #include "common.h"
 #include "sg/scenegraph.h"
 #include "3d_filename_resolver.h"
 #include "3d_plugin_manager.h"
 #include "plugins/3dapi/ifsg_api.h"
+#include <reporter.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #define MASK_3D_CACHE "3D_CACHE"
 
 static wxCriticalSection lock3D_cache;
 
+// The plugins are not reentrant (they keep static tables, switch the numeric
+// locale and are opened on demand): only one thread at a time may call them
+static wxCriticalSection lock3D_plugins;
+
 static bool isSHA1Same( const unsigned char* shaA, const unsigned char* shaB )
 {
     for( int i = 0; i < 20; ++i )
@@ -69,9 +83,30 @@ static bool checkTag( const char* aTag, void* aPluginMgrPtr )
 
     S3D_PLUGIN_MANAGER *pp = (S3D_PLUGIN_MANAGER*) aPluginMgrPtr;
 
+    wxCriticalSectionLocker lock( lock3D_plugins );
+
     return pp->CheckTag( aTag );
 }
 
+// checks the plugin tag of a cache file, and keeps it if it is valid: the tag of
+// the model is needed to write its other cache files
+struct CACHE_TAG_CHECK
+{
+    S3D_PLUGIN_MANAGER* plugins;
+    std::string*        tag;
+};
+
+static bool checkCacheTag( const char* aTag, void* aCheckPtr )
+{
+    CACHE_TAG_CHECK* check = (CACHE_TAG_CHECK*) aCheckPtr;
+
+    if( !checkTag( aTag, check->plugins ) )
+        return false;
+
+    *check->tag = aTag;
+    return true;
+}
+
 static const wxString sha1ToWXString( const unsigned char* aSHA1Sum )
 {
     unsigned char uc;
@@ -121,12 +156,20 @@ public:
 
     void SetSHA1( const unsigned char* aSHA1Sum );
     const wxString GetCacheBaseName( void );
+    void FreeRenderData( void );
 
     wxDateTime    modTime;      // file modification time
     unsigned char sha1sum[20];
     std::string   pluginInfo;   // PluginName:Version string
     SCENEGRAPH*   sceneData;
     S3DMODEL*     renderData;
+    S3D_MESH_CACHE* meshData;   // owns renderData when it was read from a mesh cache file
+
+    // levels of detail of renderData, from 1 to S3D_LOD_LEVELS - 1; they are
+    // NULL once lodDone is set if the model is too small to be simplified
+    bool            lodDone;
+    S3DMODEL*       lodData[S3D_LOD_LEVELS];
+    S3D_MESH_CACHE* lodMesh[S3D_LOD_LEVELS];
 };
 
 
@@ -134,6 +177,15 @@ S3D_CACHE_ENTRY::S3D_CACHE_ENTRY()
 {
     sceneData = NULL;
     renderData = NULL;
+    meshData = NULL;
+    lodDone = false;
+
+    for( int i = 0; i < S3D_LOD_LEVELS; ++i )
+    {
+        lodData[i] = NULL;
+        lodMesh[i] = NULL;
+    }
+
     memset( sha1sum, 0, 20 );
 }
 
@@ -143,8 +195,36 @@ S3D_CACHE_ENTRY::~S3D_CACHE_ENTRY()
     if( NULL != sceneData )
         delete sceneData;
 
-    if( NULL != renderData )
+    FreeRenderData();
+}
+
+
+void S3D_CACHE_ENTRY::FreeRenderData( void )
+{
+    if( NULL != meshData )
+    {
+        delete meshData;
+        meshData = NULL;
+        renderData = NULL;
+    }
+    else if( NULL != renderData )
+    {
         S3D::Destroy3DModel( &renderData );
+    }
+
+    // the levels of detail are made from the render data
+    for( int i = 0; i < S3D_LOD_LEVELS; ++i )
+    {
+        if( NULL != lodMesh[i] )
+            delete lodMesh[i];
+        else if( NULL != lodData[i] )
+            S3D::Destroy3DModel( &lodData[i] );
+
+        lodData[i] = NULL;
+        lodMesh[i] = NULL;
+    }
+
+    lodDone = false;
 }
 
 
@@ -201,7 +281,8 @@ S3D_CACHE::~S3D_CACHE()
 }
 
 
-SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr,
+                             bool aNeedScene )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -251,13 +332,17 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
                     mi->second->sceneData = NULL;
                 }
 
-                if( NULL != mi->second->renderData )
-                    S3D::Destroy3DModel( &mi->second->renderData );
+                mi->second->FreeRenderData();
 
+                wxCriticalSectionLocker pluginLock( lock3D_plugins );
                 mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath, mi->second->pluginInfo );
             }
         }
 
+        // the entry was read from a mesh cache file, which holds no scene data
+        if( aNeedScene && NULL == mi->second->sceneData && NULL != mi->second->meshData )
+            loadScene( full3Dpath, mi->second );
+
         if( NULL != aCachePtr )
             *aCachePtr = mi->second;
 
@@ -265,7 +350,7 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
     }
 
     // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return checkCache( full3Dpath, aCachePtr, aNeedScene );
 }
 
 
@@ -275,49 +360,12 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile )
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr,
+                                   bool aNeedScene )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
 
-    unsigned char sha1sum[20];
-
-    if( !getSHA1( aFileName, sha1sum ) || m_CacheDir.empty() )
-    {
-        // just in case we can't get a hash digest (for example, on access issues)
-        // or we do not have a configured cache file directory, we create an
-        // entry to prevent further attempts at loading the file
-        S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
-        m_CacheList.push_back( ep );
-        wxFileName fname( aFileName );
-        ep->modTime = fname.GetModificationTime();
-
-        if( m_CacheMap.insert( std::pair< wxString, S3D_CACHE_ENTRY* >
-            ( aFileName, ep ) ).second == false )
-        {
-            #ifdef DEBUG
-            do {
-                std::ostringstream ostr;
-                ostr << __FILE__ << ": " << __FUNCTION__ << ": " << __LINE__ << "\n";
-                ostr << " * [BUG] duplicate entry in map file; key = '";
-                ostr << aFileName.ToUTF8() << "'";
-                wxLogTrace( MASK_3D_CACHE, "%s\n", ostr.str().c_str() );
-            } while( 0 );
-            #endif
-
-            m_CacheList.pop_back();
-            delete ep;
-        }
-        else
-        {
-            if( aCachePtr )
-                *aCachePtr = ep;
-
-        }
-
-        return NULL;
-    }
-
     S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
     m_CacheList.push_back( ep );
     wxFileName fname( aFileName );
@@ -344,20 +392,48 @@ SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY**
     if( aCachePtr )
         *aCachePtr = ep;
 
-    ep->SetSHA1( sha1sum );
+    return loadEntry( aFileName, ep, aNeedScene );
+}
+
+
+SCENEGRAPH* S3D_CACHE::loadEntry( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem,
+                                  bool aNeedScene )
+{
+    unsigned char sha1sum[20];
+
+    // just in case we can't get a hash digest (for example, on access issues)
+    // or we do not have a configured cache file directory, the entry is left
+    // empty to prevent further attempts at loading the file
+    if( !getSHA1( aFileName, sha1sum ) || m_CacheDir.empty() )
+        return NULL;
+
+    aCacheItem->SetSHA1( sha1sum );
+
+    if( !aNeedScene && loadMeshData( aCacheItem ) )
+        return NULL;
+
+    return loadScene( aFileName, aCacheItem );
+}
 
-    wxString bname = ep->GetCacheBaseName();
+
+SCENEGRAPH* S3D_CACHE::loadScene( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem )
+{
+    wxString bname = aCacheItem->GetCacheBaseName();
     wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
 
-    if( wxFileName::FileExists( cachename ) && loadCacheData( ep ) )
-        return ep->sceneData;
+    if( wxFileName::FileExists( cachename ) && loadCacheData( aCacheItem ) )
+        return aCacheItem->sceneData;
 
-    ep->sceneData = m_Plugins->Load3DModel( aFileName, ep->pluginInfo );
+    // the cache file is written under the same lock: two models with the same
+    // content share it
+    wxCriticalSectionLocker lock( lock3D_plugins );
 
-    if( NULL != ep->sceneData )
-        saveCacheData( ep );
+    aCacheItem->sceneData = m_Plugins->Load3DModel( aFileName, aCacheItem->pluginInfo );
+
+    if( NULL != aCacheItem->sceneData )
+        saveCacheData( aCacheItem );
 
-    return ep->sceneData;
+    return aCacheItem->sceneData;
 }
 
 
@@ -459,7 +535,9 @@ bool S3D_CACHE::loadCacheData( S3D_CACHE_ENTRY* aCacheItem )
     if( NULL != aCacheItem->sceneData )
         S3D::DestroyNode( (SGNODE*) aCacheItem->sceneData );
 
-    aCacheItem->sceneData = (SCENEGRAPH*)S3D::ReadCache( fname.ToUTF8(), m_Plugins, checkTag );
+    CACHE_TAG_CHECK check = { m_Plugins, &aCacheItem->pluginInfo };
+
+    aCacheItem->sceneData = (SCENEGRAPH*)S3D::ReadCache( fname.ToUTF8(), &check, checkCacheTag );
 
     if( NULL == aCacheItem->sceneData )
         return false;
@@ -536,6 +614,97 @@ bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
 }
 
 
+bool S3D_CACHE::loadMeshData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    wxString bname = aCacheItem->GetCacheBaseName();
+
+    if( bname.empty() || m_CacheDir.empty() )
+        return false;
+
+    CACHE_TAG_CHECK check = { m_Plugins, &aCacheItem->pluginInfo };
+
+    S3D_MESH_CACHE* mp = S3D_MESH_CACHE::Read( m_CacheDir + bname + wxT( ".3dm" ),
+                                               aCacheItem->sha1sum, checkCacheTag, &check );
+
+    if( NULL == mp )
+        return false;
+
+    aCacheItem->FreeRenderData();
+    aCacheItem->meshData = mp;
+    aCacheItem->renderData = mp->GetModel();
+
+    return true;
+}
+
+
+bool S3D_CACHE::saveMeshData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    // nothing to convert, or the render data comes from the mesh cache file already
+    if( NULL == aCacheItem->renderData || NULL != aCacheItem->meshData )
+        return false;
+
+    wxString bname = aCacheItem->GetCacheBaseName();
+
+    if( bname.empty() || m_CacheDir.empty() )
+        return false;
+
+    // models with the same content share the file
+    wxCriticalSectionLocker lock( lock3D_plugins );
+
+    return S3D_MESH_CACHE::Write( m_CacheDir + bname + wxT( ".3dm" ), aCacheItem->sha1sum,
+                                  aCacheItem->pluginInfo, *aCacheItem->renderData );
+}
+
+
+void S3D_CACHE::makeLODs( S3D_CACHE_ENTRY* aCacheItem )
+{
+    if( aCacheItem->lodDone || NULL == aCacheItem->renderData )
+        return;
+
+    aCacheItem->lodDone = true;
+
+    if( S3D::CountTriangles( *aCacheItem->renderData ) < S3D_LOD_MIN_TRIANGLES )
+        return;
+
+    wxString bname = aCacheItem->GetCacheBaseName();
+    CACHE_TAG_CHECK check = { m_Plugins, &aCacheItem->pluginInfo };
+
+    for( int i = 1; i < S3D_LOD_LEVELS; ++i )
+    {
+        wxString fname = m_CacheDir + bname + wxString::Format( ".lod%d.3dm", i );
+
+        if( !m_CacheDir.empty() && !bname.empty() )
+        {
+            S3D_MESH_CACHE* mp = S3D_MESH_CACHE::Read( fname, aCacheItem->sha1sum,
+                                                       checkCacheTag, &check );
+
+            if( NULL != mp )
+            {
+                aCacheItem->lodMesh[i] = mp;
+                aCacheItem->lodData[i] = mp->GetModel();
+                continue;
+            }
+        }
+
+        // each level is made from the previous one
+        const S3DMODEL* source = ( i == 1 ) ? aCacheItem->renderData : aCacheItem->lodData[i - 1];
+
+        aCacheItem->lodData[i] = S3D::SimplifyModel( *source, S3D_LOD_RATIO );
+
+        if( NULL == aCacheItem->lodData[i] )
+            return;
+
+        if( !m_CacheDir.empty() && !bname.empty() )
+        {
+            wxCriticalSectionLocker lock( lock3D_plugins );
+
+            S3D_MESH_CACHE::Write( fname, aCacheItem->sha1sum, aCacheItem->pluginInfo,
+                                   *aCacheItem->lodData[i] );
+        }
+    }
+}
+
+
 bool S3D_CACHE::Set3DConfigDir( const wxString& aConfigDir )
 {
     if( !m_ConfigDir.empty() )
@@ -776,11 +945,21 @@ void S3D_CACHE::ClosePlugins( void )
 
 
 S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
+{
+    return getModel( aModelFileName, NULL );
+}
+
+
+S3DMODEL* S3D_CACHE::getModel( const wxString& aModelFileName, S3D_CACHE_ENTRY** aCachePtr )
 {
     S3D_CACHE_ENTRY* cp = NULL;
-    SCENEGRAPH* sp = load( aModelFileName, &cp );
+    SCENEGRAPH* sp = load( aModelFileName, &cp, false );
+
+    if( aCachePtr )
+        *aCachePtr = cp;
 
-    if( !sp )
+    // with the render data read from a mesh cache file, the scene data is not loaded
+    if( !sp && ( !cp || !cp->renderData ) )
         return NULL;
 
     if( !cp )
@@ -802,11 +981,28 @@ S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
 
     S3DMODEL* mp = S3D::GetModel( sp );
     cp->renderData = mp;
+    saveMeshData( cp );
 
     return mp;
 }
 
 
+S3DMODEL* S3D_CACHE::GetModelLOD( const wxString& aModelFileName, int aLevel )
+{
+    if( aLevel <= 0 || aLevel >= S3D_LOD_LEVELS )
+        return NULL;
+
+    S3D_CACHE_ENTRY* cp = NULL;
+
+    if( NULL == getModel( aModelFileName, &cp ) || NULL == cp )
+        return NULL;
+
+    makeLODs( cp );
+
+    return cp->lodData[aLevel];
+}
+
+
 wxString S3D_CACHE::GetModelHash( const wxString& aModelFileName )
 {
     wxString full3Dpath = m_FNResolver->ResolvePath( aModelFileName );
@@ -823,10 +1019,103 @@ wxString S3D_CACHE::GetModelHash( const wxString& aModelFileName )
 
     // a cache item does not exist; search the Filename->Cachename map
     S3D_CACHE_ENTRY* cp = NULL;
-    checkCache( full3Dpath, &cp );
+    checkCache( full3Dpath, &cp, false );
 
     if( NULL != cp )
         return cp->GetCacheBaseName();
 
     return wxEmptyString;
 }
+
+
+void S3D_CACHE::PrefetchModels( const std::list< wxString >& aModelFiles,
+                                REPORTER* aStatusTextReporter, bool aLODs )
+{
+    // the resolver is not thread safe: resolve all the paths first
+    std::set< wxString > paths;
+
+    for( std::list< wxString >::const_iterator sL = aModelFiles.begin();
+         sL != aModelFiles.end(); ++sL )
+    {
+        wxString full3Dpath = m_FNResolver->ResolvePath( *sL );
+
+        if( !full3Dpath.empty() )
+            paths.insert( full3Dpath );
+    }
+
+    struct PREFETCH_JOB
+    {
+        wxString         fileName;
+        S3D_CACHE_ENTRY* cacheItem;
+        bool             load;
+    };
+
+    std::vector< PREFETCH_JOB > jobs;
+
+    // Create the entries of the new models. From now on each entry is used by one
+    // worker only, so the workers do not need the cache lock.
+    {
+        wxCriticalSectionLocker lock( lock3D_cache );
+
+        for( std::set< wxString >::const_iterator sP = paths.begin(); sP != paths.end(); ++sP )
+        {
+            std::map< wxString, S3D_CACHE_ENTRY*, S3D::rsort_wxString >::iterator mi;
+            mi = m_CacheMap.find( *sP );
+
+            if( mi != m_CacheMap.end() )
+            {
+                S3D_CACHE_ENTRY* ep = mi->second;
+
+                // loaded, but not yet converted for display or simplified
+                if( ( NULL != ep->sceneData && NULL == ep->renderData )
+                    || ( aLODs && NULL != ep->renderData && !ep->lodDone ) )
+                    jobs.push_back( { *sP, ep, false } );
+
+                continue;
+            }
+
+            S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
+            m_CacheList.push_back( ep );
+            m_CacheMap.insert( std::pair< wxString, S3D_CACHE_ENTRY* >( *sP, ep ) );
+
+            jobs.push_back( { *sP, ep, true } );
+        }
+    }
+
+    const int nJobs = jobs.size();
+    std::atomic<int> nDone( 0 );
+
+    #pragma omp parallel for schedule(dynamic)
+    for( int i = 0; i < nJobs; ++i )
+    {
+        PREFETCH_JOB& job = jobs[i];
+
+        if( job.load )
+        {
+            job.cacheItem->modTime = wxFileName( job.fileName ).GetModificationTime();
+            loadEntry( job.fileName, job.cacheItem, false );
+        }
+
+        if( NULL != job.cacheItem->sceneData && NULL == job.cacheItem->renderData )
+        {
+            job.cacheItem->renderData = S3D::GetModel( job.cacheItem->sceneData );
+            saveMeshData( job.cacheItem );
+        }
+
+        if( aLODs )
+            makeLODs( job.cacheItem );
+
+        ++nDone;
+
+        // Only the calling thread can update the user interface
+#ifdef _OPENMP
+        if( aStatusTextReporter && omp_get_thread_num() == 0 )
+#else
+        if( aStatusTextReporter )
+#endif
+        {
+            aStatusTextReporter->Report( wxString::Format( _( "Loading 3D models %d/%d" ),
+                                                           nDone.load(), nJobs ) );
+        }
+    }
+}
@@ -36,9 +36,11 @@
 #include "3d_filename_resolver.h"
 #include "3d_info.h"
 #include "plugins/3dapi/c3dmodel.h"
+#include "3d_mesh_lod.h"
 
 
 class  PGM_BASE;
+class  REPORTER;
 class  S3D_CACHE;
 class  S3D_CACHE_ENTRY;
 class  SCENEGRAPH;
@@ -82,9 +84,11 @@ private:
      *
      * @param aFileName [in] is a partial or full file path
      * @param [out] if not NULL will hold a pointer to the cache entry for the model
+     * @param aNeedScene [in] see loadEntry()
      * @return on success a pointer to a SCENEGRAPH, otherwise NULL
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                            bool aNeedScene = true );
 
     /**
      * Function getSHA1
@@ -102,8 +106,43 @@ private:
     // save scene data to a cache file
     bool saveCacheData( S3D_CACHE_ENTRY* aCacheItem );
 
+    // load render data from a mesh cache file
+    bool loadMeshData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // save render data to a mesh cache file
+    bool saveMeshData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // read or make the levels of detail of the render data
+    void makeLODs( S3D_CACHE_ENTRY* aCacheItem );
+
+    // GetModel(), also returning the cache entry of the model
+    S3DMODEL* getModel( const wxString& aModelFileName, S3D_CACHE_ENTRY** aCachePtr );
+
     // the real load function (can supply a cache entry pointer to member functions)
-    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                      bool aNeedScene = true );
+
+    /**
+     * Function loadEntry
+     * fills a new cache entry with the scene data of a model, read from the cache
+     * file if there is one, otherwise from the model file. Only one thread may
+     * use a given entry, but several entries can be loaded concurrently.
+     *
+     * @param aFileName [in] is the full path to the model file
+     * @param aCacheItem [in,out] is the cache entry of the model
+     * @param aNeedScene [in] if false and a mesh cache file exists, only the render
+     * data is loaded from it and the scene data is left NULL
+     * @return on success a pointer to a SCENEGRAPH, otherwise NULL
+     */
+    SCENEGRAPH* loadEntry( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem,
+                           bool aNeedScene = true );
+
+    /**
+     * Function loadScene
+     * loads the scene data of an entry whose SHA1 is set, from the cache file if
+     * there is one, otherwise from the model file, and writes the cache file.
+     */
+    SCENEGRAPH* loadScene( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem );
 
 public:
     S3D_CACHE();
@@ -192,13 +231,45 @@ public:
     /**
      * Function GetModel
      * attempts to load the scene data for a model and to translate it
-     * into an S3D_MODEL structure for display by a renderer
+     * into an S3D_MODEL structure for display by a renderer. The render
+     * data is read from the mesh cache file (.3dm) of the model if there is
+     * one; the scene data is then not loaded at all.
      *
      * @param aModelFileName is the full path to the model to be loaded
      * @return is a pointer to the render data or NULL if not available
      */
     S3DMODEL* GetModel( const wxString& aModelFileName );
 
+    /**
+     * Function GetModelLOD
+     * returns a simplified version of the render data of a model, for display at a
+     * small size. The levels of detail are made from the render data the first
+     * time they are needed and stored next to the cache files of the model.
+     *
+     * @param aModelFileName is the full path to the model to be loaded
+     * @param aLevel is the level of detail, from 1 (the most detailed simplified
+     * version) to S3D_LOD_LEVELS - 1
+     * @return the render data of the level, or NULL if the model is not available
+     * or has too few triangles to be simplified; GetModel() is then to be used
+     */
+    S3DMODEL* GetModelLOD( const wxString& aModelFileName, int aLevel );
+
+    /**
+     * Function PrefetchModels
+     * loads the scene and render data of the models not yet in the cache,
+     * several of them at the same time, so that the next calls to GetModel()
+     * for these models return at once. The models already in the cache are
+     * not checked for changes, GetModel() still does it.
+     *
+     * @param aModelFiles is the list of partial or full paths to the models;
+     * duplicates are loaded once
+     * @param aStatusTextReporter if not NULL, receives the loading progress
+     * @param aLODs if true, the levels of detail of the models (see GetModelLOD())
+     * are also made
+     */
+    void PrefetchModels( const std::list< wxString >& aModelFiles,
+                         REPORTER* aStatusTextReporter = NULL, bool aLODs = false );
+
     wxString GetModelHash( const wxString& aModelFileName );
 };
 
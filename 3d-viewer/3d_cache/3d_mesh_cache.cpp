@@ -0,0 +1,432 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.cpp
+ */
+
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "3d_mesh_cache.h"
+
+
+#define MASK_3D_CACHE "3D_CACHE"
+
+/*
+ * Layout of a mesh cache file (native byte order):
+ *
+ *  MESH_CACHE_HEADER
+ *  plugin tag (pluginInfoSize chars, not terminated)
+ *  SMATERIAL[nMaterials]                           aligned to MESH_CACHE_ALIGN
+ *  MESH_CACHE_RECORD[nMeshes]                      aligned to MESH_CACHE_ALIGN
+ *  for each mesh, the arrays it uses               each aligned to MESH_CACHE_ALIGN
+ *
+ * The offsets are from the start of the file; an offset of 0 is a NULL array.
+ */
+
+#define MESH_CACHE_MAGIC    "KICAD3DM"
+#define MESH_CACHE_VERSION  1
+#define MESH_CACHE_BOM      0x01020304
+#define MESH_CACHE_ALIGN    16
+
+struct MESH_CACHE_HEADER
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t sizeofMaterial;    ///< reject files written with another structure layout
+    uint32_t sizeofVec3;
+    uint32_t sizeofVec2;
+    uint32_t pluginInfoSize;
+    uint8_t  sha1[20];
+    uint32_t nMaterials;
+    uint32_t nMeshes;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+
+struct MESH_CACHE_RECORD
+{
+    uint32_t vertexSize;
+    uint32_t faceIdxSize;
+    uint32_t materialIdx;
+    uint32_t reserved;
+    uint64_t positions;
+    uint64_t normals;
+    uint64_t texcoords;
+    uint64_t colors;
+    uint64_t faceIdx;
+};
+
+
+static uint64_t alignOffset( uint64_t aOffset )
+{
+    return ( aOffset + MESH_CACHE_ALIGN - 1 ) & ~(uint64_t)( MESH_CACHE_ALIGN - 1 );
+}
+
+
+/**
+ * Function writeBlock
+ * pads the file up to the next aligned offset and writes aSize bytes of aData.
+ * @return the offset of the block, or 0 if aData is NULL or on error.
+ */
+static uint64_t writeBlock( FILE* aFile, uint64_t& aOffset, const void* aData, size_t aSize )
+{
+    static const char padding[MESH_CACHE_ALIGN] = { 0 };
+
+    if( NULL == aData || 0 == aSize )
+        return 0;
+
+    uint64_t start = alignOffset( aOffset );
+
+    if( start > aOffset && fwrite( padding, start - aOffset, 1, aFile ) != 1 )
+        return 0;
+
+    if( fwrite( aData, aSize, 1, aFile ) != 1 )
+        return 0;
+
+    aOffset = start + aSize;
+    return start;
+}
+
+
+S3D_MESH_CACHE::S3D_MESH_CACHE()
+{
+    m_data = NULL;
+    m_size = 0;
+
+#ifdef _WIN32
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+#endif
+
+    memset( &m_model, 0, sizeof( m_model ) );
+}
+
+
+S3D_MESH_CACHE::~S3D_MESH_CACHE()
+{
+#ifdef _WIN32
+    if( m_data )
+        UnmapViewOfFile( m_data );
+
+    if( m_mapping )
+        CloseHandle( m_mapping );
+
+    if( m_file != INVALID_HANDLE_VALUE )
+        CloseHandle( m_file );
+#else
+    if( m_data )
+        munmap( (void*) m_data, m_size );
+#endif
+}
+
+
+bool S3D_MESH_CACHE::map( const wxString& aFileName )
+{
+#ifdef _WIN32
+    m_file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                          NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if( m_file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+
+    if( !GetFileSizeEx( m_file, &size ) || size.QuadPart < (LONGLONG) sizeof( MESH_CACHE_HEADER ) )
+        return false;
+
+    m_mapping = CreateFileMapping( m_file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+    if( NULL == m_mapping )
+        return false;
+
+    m_data = (const char*) MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 );
+    m_size = size.QuadPart;
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        return false;
+
+    struct stat st;
+
+    if( fstat( fd, &st ) != 0 || st.st_size < (off_t) sizeof( MESH_CACHE_HEADER ) )
+    {
+        close( fd );
+        return false;
+    }
+
+    void* data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    // the mapping stays valid once the descriptor is closed
+    close( fd );
+
+    if( data == MAP_FAILED )
+        return false;
+
+    m_data = (const char*) data;
+    m_size = st.st_size;
+#endif
+
+    return NULL != m_data;
+}
+
+
+bool S3D_MESH_CACHE::buildModel( const unsigned char* aSHA1Sum,
+                                 bool (*aTagCheck)( const char*, void* ), void* aPluginMgr )
+{
+    const MESH_CACHE_HEADER* header = (const MESH_CACHE_HEADER*) m_data;
+
+    if( memcmp( header->magic, MESH_CACHE_MAGIC, 8 )
+        || header->version != MESH_CACHE_VERSION
+        || header->byteOrder != MESH_CACHE_BOM
+        || header->sizeofMaterial != sizeof( SMATERIAL )
+        || header->sizeofVec3 != sizeof( SFVEC3F )
+        || header->sizeofVec2 != sizeof( SFVEC2F )
+        || header->fileSize != m_size )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] mesh cache file has an unsupported format\n" );
+        return false;
+    }
+
+    if( aSHA1Sum && memcmp( header->sha1, aSHA1Sum, 20 ) )
+        return false;
+
+    uint64_t offset = sizeof( MESH_CACHE_HEADER );
+
+    if( header->pluginInfoSize > m_size - offset )
+        return false;
+
+    if( aTagCheck )
+    {
+        std::string tag( m_data + offset, header->pluginInfoSize );
+
+        if( !aTagCheck( tag.c_str(), aPluginMgr ) )
+            return false;
+    }
+
+    offset += header->pluginInfoSize;
+
+    // check that the block [aOffset, aOffset + aCount * aElementSize) lies in the file
+    auto inFile = [this]( uint64_t aOffset, uint64_t aCount, uint64_t aElementSize ) -> bool
+    {
+        if( aOffset % MESH_CACHE_ALIGN || aOffset > m_size )
+            return false;
+
+        return aCount <= ( m_size - aOffset ) / aElementSize;
+    };
+
+    uint64_t materials = alignOffset( offset );
+
+    if( header->nMaterials && !inFile( materials, header->nMaterials, sizeof( SMATERIAL ) ) )
+        return false;
+
+    uint64_t records = alignOffset( materials + (uint64_t) header->nMaterials * sizeof( SMATERIAL ) );
+
+    if( !inFile( records, header->nMeshes, sizeof( MESH_CACHE_RECORD ) ) )
+        return false;
+
+    const MESH_CACHE_RECORD* record = (const MESH_CACHE_RECORD*)( m_data + records );
+
+    m_meshes.resize( header->nMeshes );
+
+    for( unsigned int i = 0; i < header->nMeshes; ++i, ++record )
+    {
+        // a corrupted file must not make the renderers read out of the arrays
+        if( record->materialIdx >= header->nMaterials
+            || record->faceIdxSize % 3
+            || ( record->vertexSize && !record->positions )
+            || ( record->faceIdxSize && !record->faceIdx )
+            || !inFile( record->positions, record->vertexSize, sizeof( SFVEC3F ) )
+            || ( record->normals
+                 && !inFile( record->normals, record->vertexSize, sizeof( SFVEC3F ) ) )
+            || ( record->texcoords
+                 && !inFile( record->texcoords, record->vertexSize, sizeof( SFVEC2F ) ) )
+            || ( record->colors
+                 && !inFile( record->colors, record->vertexSize, sizeof( SFVEC3F ) ) )
+            || !inFile( record->faceIdx, record->faceIdxSize, sizeof( unsigned int ) ) )
+        {
+            wxLogTrace( MASK_3D_CACHE, " * [3D model] corrupted mesh cache file\n" );
+            return false;
+        }
+
+        const unsigned int* faceIdx = (const unsigned int*)( m_data + record->faceIdx );
+
+        for( unsigned int j = 0; j < record->faceIdxSize; ++j )
+        {
+            if( faceIdx[j] >= record->vertexSize )
+            {
+                wxLogTrace( MASK_3D_CACHE, " * [3D model] corrupted mesh cache file\n" );
+                return false;
+            }
+        }
+
+        // The mapping is read only: the renderers never modify the model arrays
+        SMESH& mesh = m_meshes[i];
+
+        mesh.m_VertexSize  = record->vertexSize;
+        mesh.m_Positions   = record->positions ? (SFVEC3F*)( m_data + record->positions ) : NULL;
+        mesh.m_Normals     = record->normals ? (SFVEC3F*)( m_data + record->normals ) : NULL;
+        mesh.m_Texcoords   = record->texcoords ? (SFVEC2F*)( m_data + record->texcoords ) : NULL;
+        mesh.m_Color       = record->colors ? (SFVEC3F*)( m_data + record->colors ) : NULL;
+        mesh.m_FaceIdxSize = record->faceIdxSize;
+        mesh.m_FaceIdx     = record->faceIdx ? (unsigned int*) faceIdx : NULL;
+        mesh.m_MaterialIdx = record->materialIdx;
+    }
+
+    m_model.m_MeshesSize    = header->nMeshes;
+    m_model.m_Meshes        = m_meshes.empty() ? NULL : &m_meshes[0];
+    m_model.m_MaterialsSize = header->nMaterials;
+    m_model.m_Materials     = header->nMaterials ? (SMATERIAL*)( m_data + materials ) : NULL;
+
+    return true;
+}
+
+
+S3D_MESH_CACHE* S3D_MESH_CACHE::Read( const wxString& aFileName, const unsigned char* aSHA1Sum,
+                                      bool (*aTagCheck)( const char*, void* ), void* aPluginMgr )
+{
+    if( !wxFileName::FileExists( aFileName ) )
+        return NULL;
+
+    S3D_MESH_CACHE* cache = new S3D_MESH_CACHE;
+
+    if( !cache->map( aFileName ) || !cache->buildModel( aSHA1Sum, aTagCheck, aPluginMgr ) )
+    {
+        delete cache;
+        return NULL;
+    }
+
+    return cache;
+}
+
+
+bool S3D_MESH_CACHE::Write( const wxString& aFileName, const unsigned char* aSHA1Sum,
+                            const std::string& aPluginInfo, const S3DMODEL& aModel )
+{
+    if( NULL == aModel.m_Meshes || 0 == aModel.m_MeshesSize )
+        return false;
+
+    // the header is rewritten at the end, with the records and the file size
+    MESH_CACHE_HEADER header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, MESH_CACHE_MAGIC, 8 );
+    header.version        = MESH_CACHE_VERSION;
+    header.byteOrder      = MESH_CACHE_BOM;
+    header.sizeofMaterial = sizeof( SMATERIAL );
+    header.sizeofVec3     = sizeof( SFVEC3F );
+    header.sizeofVec2     = sizeof( SFVEC2F );
+    header.pluginInfoSize = aPluginInfo.size();
+    header.nMaterials     = aModel.m_Materials ? aModel.m_MaterialsSize : 0;
+    header.nMeshes        = aModel.m_MeshesSize;
+    memcpy( header.sha1, aSHA1Sum, 20 );
+
+    wxString tmpName = aFileName + wxT( ".tmp" );
+    FILE* fp = wxFopen( tmpName, wxT( "wb" ) );
+
+    if( NULL == fp )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot write mesh cache file '%s'\n",
+                    tmpName.GetData() );
+        return false;
+    }
+
+    std::vector<MESH_CACHE_RECORD> records( header.nMeshes );
+    uint64_t offset = 0;
+    bool ok = fwrite( &header, sizeof( header ), 1, fp ) == 1;
+    offset += sizeof( header );
+
+    if( ok && !aPluginInfo.empty() )
+    {
+        ok = fwrite( aPluginInfo.data(), aPluginInfo.size(), 1, fp ) == 1;
+        offset += aPluginInfo.size();
+    }
+
+    if( ok && header.nMaterials )
+        ok = writeBlock( fp, offset, aModel.m_Materials,
+                         header.nMaterials * sizeof( SMATERIAL ) ) != 0;
+
+    // reserve the records; they are written once the array offsets are known
+    uint64_t recordsOffset = 0;
+
+    if( ok )
+        ok = ( recordsOffset = writeBlock( fp, offset, &records[0],
+                                           records.size() * sizeof( MESH_CACHE_RECORD ) ) ) != 0;
+
+    for( unsigned int i = 0; ok && i < header.nMeshes; ++i )
+    {
+        const SMESH& mesh = aModel.m_Meshes[i];
+        MESH_CACHE_RECORD& record = records[i];
+
+        record.vertexSize  = mesh.m_VertexSize;
+        record.faceIdxSize = mesh.m_FaceIdxSize;
+        record.materialIdx = mesh.m_MaterialIdx;
+        record.positions   = writeBlock( fp, offset, mesh.m_Positions,
+                                         mesh.m_VertexSize * sizeof( SFVEC3F ) );
+        record.normals     = writeBlock( fp, offset, mesh.m_Normals,
+                                         mesh.m_VertexSize * sizeof( SFVEC3F ) );
+        record.texcoords   = writeBlock( fp, offset, mesh.m_Texcoords,
+                                         mesh.m_VertexSize * sizeof( SFVEC2F ) );
+        record.colors      = writeBlock( fp, offset, mesh.m_Color,
+                                         mesh.m_VertexSize * sizeof( SFVEC3F ) );
+        record.faceIdx     = writeBlock( fp, offset, mesh.m_FaceIdx,
+                                         mesh.m_FaceIdxSize * sizeof( unsigned int ) );
+
+        ok = !ferror( fp );
+    }
+
+    header.fileSize = offset;
+
+    ok = ok && fseek( fp, recordsOffset, SEEK_SET ) == 0
+            && fwrite( &records[0], records.size() * sizeof( MESH_CACHE_RECORD ), 1, fp ) == 1
+            && fseek( fp, 0, SEEK_SET ) == 0
+            && fwrite( &header, sizeof( header ), 1, fp ) == 1;
+
+    ok = ( fclose( fp ) == 0 ) && ok;
+
+    if( !ok || !wxRenameFile( tmpName, aFileName, true ) )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot write mesh cache file '%s'\n",
+                    aFileName.GetData() );
+        wxRemoveFile( tmpName );
+        return false;
+    }
+
+    return true;
+}
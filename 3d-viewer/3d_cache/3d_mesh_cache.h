@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.h
+ * defines the cache file of the render data (S3DMODEL) of 3D models
+ */
+
+#ifndef MESH_CACHE_3D_H
+#define MESH_CACHE_3D_H
+
+#include <string>
+#include <vector>
+#include <wx/string.h>
+#include "plugins/3dapi/c3dmodel.h"
+
+
+/**
+ * Class S3D_MESH_CACHE
+ * is the render data of a model (S3DMODEL) read from a mesh cache file (.3dm).
+ *
+ * The scene graph cache files (.3dc) store the SGNODE tree of a model, which must be
+ * rebuilt node by node and then converted to meshes. The mesh cache files store instead
+ * the result of this conversion: the materials and, for each mesh, its arrays (positions,
+ * normals, texture coordinates, colors and face indices) contiguous and aligned. The file
+ * is memory mapped and the meshes point directly into it, so loading a model costs
+ * little more than the validation of its indices.
+ *
+ * The file is written in the native byte order and with the native layout of the
+ * structures; a file made by another platform or build is rejected, and the model is
+ * loaded again from the scene graph cache.
+ */
+class S3D_MESH_CACHE
+{
+public:
+    ~S3D_MESH_CACHE();
+
+    /**
+     * Function Read
+     * maps a mesh cache file and builds the model pointing into it.
+     *
+     * @param aFileName is the full path to the cache file
+     * @param aSHA1Sum is the 20 byte SHA1 hash of the model file
+     * @param aTagCheck if not NULL, checks the tag (PluginName:Version) of the
+     * plugin which loaded the model, as for the scene graph cache files
+     * @param aPluginMgr is passed to aTagCheck
+     * @return the mesh cache, or NULL if the file does not exist, is not valid or was
+     * made from another model file or by another plugin version
+     */
+    static S3D_MESH_CACHE* Read( const wxString& aFileName, const unsigned char* aSHA1Sum,
+                                 bool (*aTagCheck)( const char*, void* ), void* aPluginMgr );
+
+    /**
+     * Function Write
+     * writes the mesh cache file of a model. The file is written under a temporary name
+     * and then renamed, so a concurrent reader never sees a partial file.
+     *
+     * @param aFileName is the full path to the cache file
+     * @param aSHA1Sum is the 20 byte SHA1 hash of the model file
+     * @param aPluginInfo is the tag of the plugin which loaded the model
+     * @param aModel is the render data of the model
+     * @return true on success
+     */
+    static bool Write( const wxString& aFileName, const unsigned char* aSHA1Sum,
+                       const std::string& aPluginInfo, const S3DMODEL& aModel );
+
+    /**
+     * Function GetModel
+     * @return the model; it is owned by the mesh cache and valid as long as it exists.
+     */
+    S3DMODEL* GetModel() { return &m_model; }
+
+private:
+    S3D_MESH_CACHE();
+
+    // prohibit assignment and default copy constructor
+    S3D_MESH_CACHE( const S3D_MESH_CACHE& source );
+    S3D_MESH_CACHE& operator=( const S3D_MESH_CACHE& source );
+
+    bool map( const wxString& aFileName );
+    bool buildModel( const unsigned char* aSHA1Sum,
+                     bool (*aTagCheck)( const char*, void* ), void* aPluginMgr );
+
+    const char*        m_data;      ///< the mapped file
+    size_t             m_size;
+
+#ifdef _WIN32
+    void*              m_file;
+    void*              m_mapping;
+#endif
+
+    S3DMODEL           m_model;
+    std::vector<SMESH> m_meshes;
+};
+
+#endif  // MESH_CACHE_3D_H
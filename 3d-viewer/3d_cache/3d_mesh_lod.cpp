@@ -0,0 +1,580 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_lod.cpp
+ */
+
+#define GLM_FORCE_RADIANS
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include "3d_mesh_lod.h"
+#include "plugins/3dapi/ifsg_api.h"
+
+
+// weight of the planes keeping the open edges in place, relative to the
+// squared length of the edge
+#define BOUNDARY_WEIGHT 1000.0
+
+
+/**
+ * Struct QUADRIC
+ * is the symmetric 4x4 matrix of the sum of the squared distances to a set of planes.
+ */
+struct QUADRIC
+{
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+    QUADRIC()
+    {
+        memset( this, 0, sizeof( *this ) );
+    }
+
+    void AddPlane( const SFVEC3D& aNormal, double aD, double aWeight )
+    {
+        const double a = aNormal.x, b = aNormal.y, c = aNormal.z;
+
+        a2 += aWeight * a * a;  ab += aWeight * a * b;  ac += aWeight * a * c;
+        ad += aWeight * a * aD; b2 += aWeight * b * b;  bc += aWeight * b * c;
+        bd += aWeight * b * aD; c2 += aWeight * c * c;  cd += aWeight * c * aD;
+        d2 += aWeight * aD * aD;
+    }
+
+    QUADRIC& operator+=( const QUADRIC& aOther )
+    {
+        a2 += aOther.a2; ab += aOther.ab; ac += aOther.ac; ad += aOther.ad;
+        b2 += aOther.b2; bc += aOther.bc; bd += aOther.bd;
+        c2 += aOther.c2; cd += aOther.cd; d2 += aOther.d2;
+        return *this;
+    }
+
+    double Error( const SFVEC3D& aPoint ) const
+    {
+        const double x = aPoint.x, y = aPoint.y, z = aPoint.z;
+
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+               + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+               + c2 * z * z + 2 * cd * z + d2;
+    }
+};
+
+
+/// a candidate half edge collapse, moving the vertex 'from' onto 'to'
+struct COLLAPSE
+{
+    double       cost;
+    unsigned int from;
+    unsigned int to;
+    unsigned int fromStamp;
+    unsigned int toStamp;
+
+    bool operator<( const COLLAPSE& aOther ) const
+    {
+        // std::priority_queue pops the greatest element first
+        return cost > aOther.cost;
+    }
+};
+
+
+/**
+ * Class MESH_SIMPLIFIER
+ * simplifies one mesh. The vertices are welded by position: the quadrics, the
+ * adjacency and the collapses are those of the welded vertices, while the faces keep
+ * referencing the vertices of the mesh.
+ */
+class MESH_SIMPLIFIER
+{
+public:
+    MESH_SIMPLIFIER( const SMESH& aMesh ) : m_mesh( aMesh ) {}
+
+    void Simplify( unsigned int aTargetFaces, SMESH& aResult );
+
+private:
+    SFVEC3D position( unsigned int aPos ) const
+    {
+        return SFVEC3D( m_mesh.m_Positions[m_posVertex[aPos]] );
+    }
+
+    void weld();
+    void buildQuadrics();
+    void pushCollapse( unsigned int aPosA, unsigned int aPosB );
+    bool collapse( unsigned int aFrom, unsigned int aTo );
+    unsigned int matchVertex( unsigned int aPos, unsigned int aVertex ) const;
+    void output( SMESH& aResult ) const;
+
+    const SMESH&                m_mesh;
+
+    std::vector<unsigned int>   m_vertexPos;    ///< welded vertex of each mesh vertex
+    std::vector<unsigned int>   m_posVertex;    ///< a mesh vertex of each welded vertex
+    std::vector<unsigned int>   m_posFirst;     ///< mesh vertices of each welded vertex,
+    std::vector<unsigned int>   m_posVertices;  ///< in m_posVertices[m_posFirst[i]..]
+
+    std::vector<unsigned int>   m_faces;        ///< 3 mesh vertices per face
+    std::vector<bool>           m_faceAlive;
+    unsigned int                m_aliveFaces;
+
+    std::vector< std::vector<unsigned int> > m_posFaces;   ///< faces of each welded vertex
+    std::vector<QUADRIC>        m_quadrics;
+    std::vector<unsigned int>   m_stamps;       ///< changed each time a vertex changes
+    std::vector<bool>           m_posAlive;
+
+    std::priority_queue<COLLAPSE> m_queue;
+};
+
+
+void MESH_SIMPLIFIER::weld()
+{
+    struct POS_HASH
+    {
+        size_t operator()( const SFVEC3F& aPos ) const
+        {
+            uint32_t bits[3];
+            memcpy( bits, &aPos.x, sizeof( bits ) );
+
+            return ( bits[0] * 73856093u ) ^ ( bits[1] * 19349663u ) ^ ( bits[2] * 83492791u );
+        }
+    };
+
+    std::unordered_map<SFVEC3F, unsigned int, POS_HASH> positions;
+    positions.reserve( m_mesh.m_VertexSize );
+
+    m_vertexPos.resize( m_mesh.m_VertexSize );
+
+    for( unsigned int i = 0; i < m_mesh.m_VertexSize; ++i )
+    {
+        auto it = positions.insert( std::make_pair( m_mesh.m_Positions[i],
+                                                    (unsigned int) m_posVertex.size() ) );
+
+        if( it.second )
+            m_posVertex.push_back( i );
+
+        m_vertexPos[i] = it.first->second;
+    }
+
+    const unsigned int nPos = m_posVertex.size();
+
+    m_posFirst.assign( nPos + 1, 0 );
+
+    for( unsigned int i = 0; i < m_mesh.m_VertexSize; ++i )
+        m_posFirst[m_vertexPos[i] + 1]++;
+
+    for( unsigned int i = 0; i < nPos; ++i )
+        m_posFirst[i + 1] += m_posFirst[i];
+
+    std::vector<unsigned int> fill( m_posFirst.begin(), m_posFirst.end() - 1 );
+    m_posVertices.resize( m_mesh.m_VertexSize );
+
+    for( unsigned int i = 0; i < m_mesh.m_VertexSize; ++i )
+        m_posVertices[fill[m_vertexPos[i]]++] = i;
+}
+
+
+void MESH_SIMPLIFIER::buildQuadrics()
+{
+    const unsigned int nPos = m_posVertex.size();
+    const unsigned int nFaces = m_faces.size() / 3;
+
+    m_quadrics.assign( nPos, QUADRIC() );
+    m_posFaces.assign( nPos, std::vector<unsigned int>() );
+
+    // number of faces using each welded edge, to find the open ones
+    std::unordered_map<uint64_t, unsigned int> edges;
+    edges.reserve( nFaces * 2 );
+
+    for( unsigned int f = 0; f < nFaces; ++f )
+    {
+        unsigned int p[3];
+
+        for( int k = 0; k < 3; ++k )
+            p[k] = m_vertexPos[m_faces[3 * f + k]];
+
+        for( int k = 0; k < 3; ++k )
+        {
+            m_posFaces[p[k]].push_back( f );
+
+            unsigned int a = std::min( p[k], p[( k + 1 ) % 3] );
+            unsigned int b = std::max( p[k], p[( k + 1 ) % 3] );
+
+            edges[( (uint64_t) a << 32 ) | b]++;
+        }
+
+        SFVEC3D p0 = position( p[0] );
+        SFVEC3D n = glm::cross( position( p[1] ) - p0, position( p[2] ) - p0 );
+        double len = glm::length( n );
+
+        if( len <= 0.0 )
+            continue;
+
+        // the planes are weighted by the area of the faces
+        n /= len;
+        double d = -glm::dot( n, p0 );
+
+        for( int k = 0; k < 3; ++k )
+            m_quadrics[p[k]].AddPlane( n, d, len * 0.5 );
+    }
+
+    for( unsigned int f = 0; f < nFaces; ++f )
+    {
+        unsigned int p[3];
+
+        for( int k = 0; k < 3; ++k )
+            p[k] = m_vertexPos[m_faces[3 * f + k]];
+
+        SFVEC3D p0 = position( p[0] );
+        SFVEC3D n = glm::cross( position( p[1] ) - p0, position( p[2] ) - p0 );
+
+        if( glm::length( n ) <= 0.0 )
+            continue;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            unsigned int a = p[k];
+            unsigned int b = p[( k + 1 ) % 3];
+
+            if( edges[( (uint64_t) std::min( a, b ) << 32 ) | std::max( a, b )] != 1 )
+                continue;
+
+            // keep the open edges in place with a plane through the edge, orthogonal
+            // to the face
+            SFVEC3D edge = position( b ) - position( a );
+            SFVEC3D bn = glm::cross( edge, n );
+            double len = glm::length( bn );
+
+            if( len <= 0.0 )
+                continue;
+
+            bn /= len;
+            double d = -glm::dot( bn, position( a ) );
+            double w = BOUNDARY_WEIGHT * glm::dot( edge, edge );
+
+            m_quadrics[a].AddPlane( bn, d, w );
+            m_quadrics[b].AddPlane( bn, d, w );
+        }
+    }
+
+    for( auto it = edges.begin(); it != edges.end(); ++it )
+        pushCollapse( it->first >> 32, it->first & 0xFFFFFFFF );
+}
+
+
+void MESH_SIMPLIFIER::pushCollapse( unsigned int aPosA, unsigned int aPosB )
+{
+    if( aPosA == aPosB )
+        return;
+
+    QUADRIC q = m_quadrics[aPosA];
+    q += m_quadrics[aPosB];
+
+    double costA = q.Error( position( aPosA ) );
+    double costB = q.Error( position( aPosB ) );
+
+    COLLAPSE c;
+
+    if( costA < costB )
+        c = { costA, aPosB, aPosA, m_stamps[aPosB], m_stamps[aPosA] };
+    else
+        c = { costB, aPosA, aPosB, m_stamps[aPosA], m_stamps[aPosB] };
+
+    m_queue.push( c );
+}
+
+
+unsigned int MESH_SIMPLIFIER::matchVertex( unsigned int aPos, unsigned int aVertex ) const
+{
+    unsigned int best = m_posVertices[m_posFirst[aPos]];
+
+    if( !m_mesh.m_Normals )
+        return best;
+
+    // keep the vertex on the same side of a crease
+    const SFVEC3F& normal = m_mesh.m_Normals[aVertex];
+    float bestDot = -2.0f;
+
+    for( unsigned int i = m_posFirst[aPos]; i < m_posFirst[aPos + 1]; ++i )
+    {
+        float dot = glm::dot( normal, m_mesh.m_Normals[m_posVertices[i]] );
+
+        if( dot > bestDot )
+        {
+            bestDot = dot;
+            best = m_posVertices[i];
+        }
+    }
+
+    return best;
+}
+
+
+bool MESH_SIMPLIFIER::collapse( unsigned int aFrom, unsigned int aTo )
+{
+    const std::vector<unsigned int>& faces = m_posFaces[aFrom];
+    const SFVEC3D target = position( aTo );
+
+    // reject the collapses flipping a face
+    for( unsigned int f : faces )
+    {
+        if( !m_faceAlive[f] )
+            continue;
+
+        SFVEC3D p[3];
+        bool degenerate = false;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            unsigned int pos = m_vertexPos[m_faces[3 * f + k]];
+
+            degenerate |= ( pos == aTo );
+            p[k] = position( pos );
+        }
+
+        if( degenerate )
+            continue;
+
+        SFVEC3D before = glm::cross( p[1] - p[0], p[2] - p[0] );
+
+        for( int k = 0; k < 3; ++k )
+        {
+            if( m_vertexPos[m_faces[3 * f + k]] == aFrom )
+                p[k] = target;
+        }
+
+        SFVEC3D after = glm::cross( p[1] - p[0], p[2] - p[0] );
+
+        if( glm::dot( before, after ) <= 0.0 )
+            return false;
+    }
+
+    std::vector<unsigned int>& toFaces = m_posFaces[aTo];
+
+    for( unsigned int f : faces )
+    {
+        if( !m_faceAlive[f] )
+            continue;
+
+        bool degenerate = false;
+
+        for( int k = 0; k < 3; ++k )
+            degenerate |= ( m_vertexPos[m_faces[3 * f + k]] == aTo );
+
+        if( degenerate )
+        {
+            m_faceAlive[f] = false;
+            --m_aliveFaces;
+            continue;
+        }
+
+        for( int k = 0; k < 3; ++k )
+        {
+            unsigned int& vertex = m_faces[3 * f + k];
+
+            if( m_vertexPos[vertex] == aFrom )
+                vertex = matchVertex( aTo, vertex );
+        }
+
+        toFaces.push_back( f );
+    }
+
+    m_quadrics[aTo] += m_quadrics[aFrom];
+    m_posAlive[aFrom] = false;
+    m_posFaces[aFrom].clear();
+    m_stamps[aTo]++;
+
+    // drop the dead faces and queue the new edges of the remaining vertex
+    std::vector<unsigned int> neighbours;
+    size_t alive = 0;
+
+    for( unsigned int f : toFaces )
+    {
+        if( !m_faceAlive[f] )
+            continue;
+
+        toFaces[alive++] = f;
+
+        for( int k = 0; k < 3; ++k )
+            neighbours.push_back( m_vertexPos[m_faces[3 * f + k]] );
+    }
+
+    toFaces.resize( alive );
+
+    std::sort( neighbours.begin(), neighbours.end() );
+    neighbours.erase( std::unique( neighbours.begin(), neighbours.end() ), neighbours.end() );
+
+    for( unsigned int pos : neighbours )
+        pushCollapse( aTo, pos );
+
+    return true;
+}
+
+
+void MESH_SIMPLIFIER::output( SMESH& aResult ) const
+{
+    std::vector<unsigned int> remap( m_mesh.m_VertexSize, UINT_MAX );
+    std::vector<unsigned int> vertices;
+    std::vector<unsigned int> faceIdx;
+
+    faceIdx.reserve( m_aliveFaces * 3 );
+
+    for( size_t f = 0; f < m_faceAlive.size(); ++f )
+    {
+        if( !m_faceAlive[f] )
+            continue;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            unsigned int vertex = m_faces[3 * f + k];
+
+            if( remap[vertex] == UINT_MAX )
+            {
+                remap[vertex] = vertices.size();
+                vertices.push_back( vertex );
+            }
+
+            faceIdx.push_back( remap[vertex] );
+        }
+    }
+
+    const unsigned int nVertices = vertices.size();
+
+    S3D::Init3DMesh( aResult );
+    aResult.m_MaterialIdx = m_mesh.m_MaterialIdx;
+
+    if( faceIdx.empty() )
+        return;
+
+    aResult.m_VertexSize = nVertices;
+    aResult.m_Positions = new SFVEC3F[nVertices];
+
+    if( m_mesh.m_Normals )
+        aResult.m_Normals = new SFVEC3F[nVertices];
+
+    if( m_mesh.m_Texcoords )
+        aResult.m_Texcoords = new SFVEC2F[nVertices];
+
+    if( m_mesh.m_Color )
+        aResult.m_Color = new SFVEC3F[nVertices];
+
+    for( unsigned int i = 0; i < nVertices; ++i )
+    {
+        unsigned int v = vertices[i];
+
+        aResult.m_Positions[i] = m_mesh.m_Positions[v];
+
+        if( m_mesh.m_Normals )
+            aResult.m_Normals[i] = m_mesh.m_Normals[v];
+
+        if( m_mesh.m_Texcoords )
+            aResult.m_Texcoords[i] = m_mesh.m_Texcoords[v];
+
+        if( m_mesh.m_Color )
+            aResult.m_Color[i] = m_mesh.m_Color[v];
+    }
+
+    aResult.m_FaceIdxSize = faceIdx.size();
+    aResult.m_FaceIdx = new unsigned int[faceIdx.size()];
+    std::copy( faceIdx.begin(), faceIdx.end(), aResult.m_FaceIdx );
+}
+
+
+void MESH_SIMPLIFIER::Simplify( unsigned int aTargetFaces, SMESH& aResult )
+{
+    m_faces.assign( m_mesh.m_FaceIdx, m_mesh.m_FaceIdx + m_mesh.m_FaceIdxSize );
+    m_aliveFaces = m_faces.size() / 3;
+    m_faceAlive.assign( m_aliveFaces, true );
+
+    weld();
+
+    m_stamps.assign( m_posVertex.size(), 0 );
+    m_posAlive.assign( m_posVertex.size(), true );
+
+    buildQuadrics();
+
+    while( m_aliveFaces > aTargetFaces && !m_queue.empty() )
+    {
+        COLLAPSE c = m_queue.top();
+        m_queue.pop();
+
+        // skip the collapses queued before one of the vertices changed
+        if( !m_posAlive[c.from] || !m_posAlive[c.to]
+            || m_stamps[c.from] != c.fromStamp || m_stamps[c.to] != c.toStamp )
+            continue;
+
+        collapse( c.from, c.to );
+    }
+
+    output( aResult );
+}
+
+
+unsigned int S3D::CountTriangles( const S3DMODEL& aModel )
+{
+    unsigned int count = 0;
+
+    for( unsigned int i = 0; i < aModel.m_MeshesSize; ++i )
+        count += aModel.m_Meshes[i].m_FaceIdxSize / 3;
+
+    return count;
+}
+
+
+S3DMODEL* S3D::SimplifyModel( const S3DMODEL& aModel, float aRatio )
+{
+    if( NULL == aModel.m_Meshes || 0 == aModel.m_MeshesSize )
+        return NULL;
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    if( aModel.m_Materials && aModel.m_MaterialsSize )
+    {
+        model->m_MaterialsSize = aModel.m_MaterialsSize;
+        model->m_Materials = new SMATERIAL[aModel.m_MaterialsSize];
+        std::copy( aModel.m_Materials, aModel.m_Materials + aModel.m_MaterialsSize,
+                   model->m_Materials );
+    }
+
+    model->m_MeshesSize = aModel.m_MeshesSize;
+    model->m_Meshes = new SMESH[aModel.m_MeshesSize];
+
+    for( unsigned int i = 0; i < aModel.m_MeshesSize; ++i )
+    {
+        const SMESH& mesh = aModel.m_Meshes[i];
+        unsigned int faces = mesh.m_FaceIdxSize / 3;
+
+        // keep a few faces of each mesh: a small part may still be visible
+        unsigned int target = std::max( (unsigned int)( faces * aRatio ),
+                                        std::min( faces, 4u ) );
+
+        MESH_SIMPLIFIER simplifier( mesh );
+        simplifier.Simplify( target, model->m_Meshes[i] );
+    }
+
+    return model;
+}
@@ -0,0 +1,68 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_lod.h
+ * defines the simplification of the render data of 3D models, for the levels of detail
+ */
+
+#ifndef MESH_LOD_3D_H
+#define MESH_LOD_3D_H
+
+#include "plugins/3dapi/c3dmodel.h"
+
+/// number of levels of detail of a model, level 0 being the model itself
+#define S3D_LOD_LEVELS          3
+
+/// each level keeps this fraction of the triangles of the previous one
+#define S3D_LOD_RATIO           0.25f
+
+/// models with fewer triangles are not simplified
+#define S3D_LOD_MIN_TRIANGLES   2000
+
+
+namespace S3D
+{
+    /**
+     * Function CountTriangles
+     * @return the number of triangles of all the meshes of aModel
+     */
+    unsigned int CountTriangles( const S3DMODEL& aModel );
+
+    /**
+     * Function SimplifyModel
+     * makes a simplified copy of a model, reducing the triangle count of each mesh by
+     * quadric error edge collapses (Garland and Heckbert). The vertices with the same
+     * position are collapsed together, so the meshes do not crack along their creases;
+     * the collapses are half edge ones, so the normals, colors and texture coordinates
+     * of the remaining vertices are kept as they are. The materials are copied.
+     *
+     * @param aModel is the model to simplify
+     * @param aRatio is the fraction of the triangles to keep
+     * @return a new model, to be freed with S3D::Destroy3DModel(), or NULL if aModel
+     * has no meshes
+     */
+    S3DMODEL* SimplifyModel( const S3DMODEL& aModel, float aRatio );
+};
+
+#endif  // MESH_LOD_3D_H
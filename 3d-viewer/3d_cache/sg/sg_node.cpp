@@ -26,6 +26,7 @@
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <atomic>
 #include <wx/log.h>
 
 #include "3d_cache/sg/sg_node.h"
@@ -45,7 +46,9 @@ static const std::string node_names[S3D::SGTYPE_END + 1] = {
 };
 
 
-static unsigned int node_counts[S3D::SGTYPE_END] = { 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+// atomic: models may be read from the cache by several threads (see S3D_CACHE::PrefetchModels)
+static std::atomic<unsigned int> node_counts[S3D::SGTYPE_END] = { {1}, {1}, {1}, {1}, {1},
+                                                                  {1}, {1}, {1}, {1} };
 
 
 char const* S3D::GetNodeTypeName( S3D::SGTYPES aType )
@@ -62,8 +65,7 @@ static void getNodeName( S3D::SGTYPES nodeType, std::string& aName )
         return;
     }
 
-    unsigned int seqNum = node_counts[nodeType];
-    ++node_counts[nodeType];
+    unsigned int seqNum = node_counts[nodeType]++;
 
     std::ostringstream ostr;
     ostr << node_names[nodeType] << "_" << seqNum;
@@ -85,6 +85,7 @@ CINFO3D_VISU::CINFO3D_VISU() :
     m_stats_nr_holes = 0;
     m_stats_hole_med_diameter = 0.0f;
     m_stats_track_med_width = 0.0f;
+    m_stats_bvh2D_build_time = 0;
 
     m_calc_seg_min_factor3DU = 0.0f;
     m_calc_seg_max_factor3DU = 0.0f;
@@ -286,11 +287,8 @@ double CINFO3D_VISU::GetCircleCorrectionFactor( int aNrSides ) const
 }
 
 
-void CINFO3D_VISU::InitSettings( REPORTER *aStatusTextReporter )
+EDA_RECT CINFO3D_VISU::getBoardBoundingBox() const
 {
-    wxLogTrace( m_logTrace, wxT( "CINFO3D_VISU::InitSettings" ) );
-
-    // Calculates the board bounding box
     // First, use only the board outlines
     EDA_RECT bbbox = m_board->ComputeBoundingBox( true );
 
@@ -302,6 +300,45 @@ void CINFO3D_VISU::InitSettings( REPORTER *aStatusTextReporter )
     if( ( bbbox.GetWidth() == 0 ) && ( bbbox.GetHeight() == 0 ) )
         bbbox.Inflate( Millimeter2iu( 10 ) );
 
+    return bbbox;
+}
+
+
+bool CINFO3D_VISU::UpdateLayers( const LSET &aLayers, bool aHoles,
+                                 REPORTER *aStatusTextReporter )
+{
+    wxLogTrace( m_logTrace, wxT( "CINFO3D_VISU::UpdateLayers" ) );
+
+    // The board outline and size give the board body and the 3D units scale,
+    // and the copper layer count gives the Z positions: all must be converted again
+    // if they changed (or if the board was never converted)
+    const EDA_RECT bbbox = getBoardBoundingBox();
+    const unsigned int copperLayersCount = std::max( m_board->GetCopperLayerCount(), 2 );
+
+    if( aLayers[Edge_Cuts] ||
+        ( copperLayersCount != m_copperLayersCount ) ||
+        ( bbbox.GetSize() != m_boardSize ) ||
+        ( bbbox.Centre().x != m_boardPos.x ) ||
+        ( bbbox.Centre().y != -m_boardPos.y ) )
+    {
+        InitSettings( aStatusTextReporter );
+
+        return false;
+    }
+
+    createLayers( aLayers, aHoles, aStatusTextReporter );
+
+    return true;
+}
+
+
+void CINFO3D_VISU::InitSettings( REPORTER *aStatusTextReporter )
+{
+    wxLogTrace( m_logTrace, wxT( "CINFO3D_VISU::InitSettings" ) );
+
+    // Calculates the board bounding box
+    EDA_RECT bbbox = getBoardBoundingBox();
+
     m_boardSize = bbbox.GetSize();
     m_boardPos  = bbbox.Centre();
 
@@ -456,7 +493,7 @@ void CINFO3D_VISU::InitSettings( REPORTER *aStatusTextReporter )
     if( aStatusTextReporter )
         aStatusTextReporter->Report( _( "Create layers" ) );
 
-    createLayers( aStatusTextReporter );
+    createLayers( LSET::AllLayersMask(), true, aStatusTextReporter );
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_stopCreateLayersTime = GetRunningMicroSecs();
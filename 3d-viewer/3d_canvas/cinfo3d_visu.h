@@ -133,6 +133,18 @@ class CINFO3D_VISU
      */
     void InitSettings( REPORTER *aStatusTextReporter );
 
+    /**
+     * @brief UpdateLayers - Function to be called by the render after a board change, to
+     * convert again only the items of the changed layers.
+     * If the change needs it (board outline, board size or layer count changed), all the
+     * board is converted again, as by InitSettings.
+     * @param aLayers: the layers to convert again
+     * @param aHoles: true to convert again the holes of the vias and pads
+     * @param aStatusTextReporter: the pointer for the status reporter
+     * @return true if only the given layers were converted, false if all the board was
+     */
+    bool UpdateLayers( const LSET &aLayers, bool aHoles, REPORTER *aStatusTextReporter );
+
     /**
      * @brief BiuTo3Dunits - Board integer units To 3D units
      * @return the conversion factor to transform a position from the board to 3d units
@@ -384,6 +396,12 @@ class CINFO3D_VISU
      */
     float GetStats_Med_Track_Width() const { return m_stats_track_med_width; }
 
+    /**
+     * @brief GetStats_BVH2D_Build_Time - Time spent building the BVHs of the 2D containers
+     * @return time in microseconds
+     */
+    unsigned int GetStats_BVH2D_Build_Time() const { return m_stats_bvh2D_build_time; }
+
     /**
      * @brief GetNrSegmentsCircle
      * @param aDiameter: diameter in 3DU
@@ -418,8 +436,9 @@ class CINFO3D_VISU
 
  private:
     void createBoardPolygon();
-    void createLayers( REPORTER *aStatusTextReporter );
-    void destroyLayers();
+    EDA_RECT getBoardBoundingBox() const;
+    void createLayers( const LSET &aLayers, bool aHoles, REPORTER *aStatusTextReporter );
+    void destroyLayers( const LSET &aLayers = LSET::AllLayersMask(), bool aHoles = true );
 
     // Helper functions to create the board
     COBJECT2D *createNewTrack( const TRACK* aTrack , int aClearanceValue ) const;
@@ -658,6 +677,9 @@ class CINFO3D_VISU
     /// Computed medium diameter of the holes in 3D units
     float        m_stats_hole_med_diameter;
 
+    /// Time to build the BVHs of the holes and solder mask containers, in microseconds
+    unsigned int m_stats_bvh2D_build_time;
+
     /**
      *  Trace mask used to enable or disable the trace output of this class.
      *  The debug output can be turned on by setting the WXTRACE environment variable to
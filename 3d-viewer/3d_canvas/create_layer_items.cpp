@@ -1024,72 +1024,36 @@ void CINFO3D_VISU::buildPadShapeThickOutlineAsSegments( const D_PAD*  aPad,
 }
 
 
-void CINFO3D_VISU::destroyLayers()
+// Deletes the items of aMap on the layers of aLayers, or all of them
+template <class MAP>
+static void destroyLayersOfMap( MAP &aMap, const LSET &aLayers )
 {
-    if( !m_layers_poly.empty() )
+    for( typename MAP::iterator ii = aMap.begin(); ii != aMap.end(); )
     {
-        for( MAP_POLY::iterator ii = m_layers_poly.begin();
-             ii != m_layers_poly.end();
-             ++ii )
-        {
-            delete ii->second;
-            ii->second = NULL;
-        }
-
-        m_layers_poly.clear();
-    }
-
-    if( !m_layers_inner_holes_poly.empty() )
-    {
-        for( MAP_POLY::iterator ii = m_layers_inner_holes_poly.begin();
-             ii != m_layers_inner_holes_poly.end();
-             ++ii )
+        if( aLayers[ii->first] )
         {
             delete ii->second;
-            ii->second = NULL;
+            ii = aMap.erase( ii );
         }
-
-        m_layers_inner_holes_poly.clear();
+        else
+            ++ii;
     }
+}
 
-    if( !m_layers_outer_holes_poly.empty() )
-    {
-        for( MAP_POLY::iterator ii = m_layers_outer_holes_poly.begin();
-             ii != m_layers_outer_holes_poly.end();
-             ++ii )
-        {
-            delete ii->second;
-            ii->second = NULL;
-        }
-
-        m_layers_outer_holes_poly.clear();
-    }
 
-    if( !m_layers_container2D.empty() )
-    {
-        for( MAP_CONTAINER_2D::iterator ii = m_layers_container2D.begin();
-             ii != m_layers_container2D.end();
-             ++ii )
-        {
-            delete ii->second;
-            ii->second = NULL;
-        }
+void CINFO3D_VISU::destroyLayers( const LSET &aLayers, bool aHoles )
+{
+    destroyLayersOfMap( m_layers_poly, aLayers );
+    destroyLayersOfMap( m_layers_container2D, aLayers );
 
-        m_layers_container2D.clear();
-    }
+    if( !aHoles )
+        return;
 
-    if( !m_layers_holes2D.empty() )
-    {
-        for( MAP_CONTAINER_2D::iterator ii = m_layers_holes2D.begin();
-             ii != m_layers_holes2D.end();
-             ++ii )
-        {
-            delete ii->second;
-            ii->second = NULL;
-        }
+    const LSET allLayers = LSET::AllLayersMask();
 
-        m_layers_holes2D.clear();
-    }
+    destroyLayersOfMap( m_layers_inner_holes_poly, allLayers );
+    destroyLayersOfMap( m_layers_outer_holes_poly, allLayers );
+    destroyLayersOfMap( m_layers_holes2D, allLayers );
 
     m_through_holes_inner.Clear();
     m_through_holes_outer.Clear();
@@ -1104,7 +1068,8 @@ void CINFO3D_VISU::destroyLayers()
 }
 
 
-void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
+void CINFO3D_VISU::createLayers( const LSET &aLayers, bool aHoles,
+                                 REPORTER *aStatusTextReporter )
 {
     // Number of segments to draw a circle using segments (used on countour zones
     // and text copper elements )
@@ -1117,7 +1082,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     const int segcountInStrokeFont  = 12;
     const double correctionFactorStroke = GetCircleCorrectionFactor( segcountInStrokeFont );
 
-    destroyLayers();
+    destroyLayers( aLayers, aHoles );
 
     // Build Copper layers
     // Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L692
@@ -1136,8 +1101,12 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     m_stats_track_med_width         = 0;
     m_stats_nr_vias                 = 0;
     m_stats_via_med_hole_diameter   = 0;
-    m_stats_nr_holes                = 0;
-    m_stats_hole_med_diameter       = 0;
+
+    if( aHoles )
+    {
+        m_stats_nr_holes            = 0;
+        m_stats_hole_med_diameter   = 0;
+    }
 
     // Prepare track list, convert in a vector. Calc statistic for the holes
     // /////////////////////////////////////////////////////////////////////////
@@ -1180,11 +1149,16 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 #endif
 
     // Prepare copper layers index and containers
+    // layer_id holds the copper layers to build, holes_layer_id the copper layers
+    // to build the holes of (all of them, or none if the holes are not rebuilt)
     // /////////////////////////////////////////////////////////////////////////
     std::vector< LAYER_ID > layer_id;
     layer_id.clear();
     layer_id.reserve( m_copperLayersCount );
 
+    std::vector< LAYER_ID > holes_layer_id;
+    holes_layer_id.reserve( m_copperLayersCount );
+
     for( unsigned i = 0; i < DIM( cu_seq ); ++i )
         cu_seq[i] = ToLAYER_ID( B_Cu - i );
 
@@ -1195,6 +1169,12 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         if( !Is3DLayerEnabled( curr_layer_id ) ) // Skip non enabled layers
             continue;
 
+        if( aHoles )
+            holes_layer_id.push_back( curr_layer_id );
+
+        if( !aLayers[curr_layer_id] )
+            continue;
+
         layer_id.push_back( curr_layer_id );
 
         CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
@@ -1249,9 +1229,9 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
     // Create VIAS and THTs objects and add it to holes containers
     // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( unsigned int lIdx = 0; lIdx < holes_layer_id.size(); ++lIdx )
     {
-        const LAYER_ID curr_layer_id = layer_id[lIdx];
+        const LAYER_ID curr_layer_id = holes_layer_id[lIdx];
 
         // ADD TRACKS
         unsigned int nTracks = trackList.size();
@@ -1333,9 +1313,9 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
     // Create VIAS and THTs objects and add it to holes containers
     // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( unsigned int lIdx = 0; lIdx < holes_layer_id.size(); ++lIdx )
     {
-        const LAYER_ID curr_layer_id = layer_id[lIdx];
+        const LAYER_ID curr_layer_id = holes_layer_id[lIdx];
 
         // ADD TRACKS
         const unsigned int nTracks = trackList.size();
@@ -1481,32 +1461,35 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
     // Add holes of modules
     // /////////////////////////////////////////////////////////////////////////
-    for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    if( aHoles )
     {
-        const D_PAD* pad = module->Pads();
-
-        for( ; pad; pad = pad->Next() )
+        for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
         {
-            const wxSize padHole = pad->GetDrillSize();
+            const D_PAD* pad = module->Pads();
 
-            if( !padHole.x )    // Not drilled pad like SMD pad
-                continue;
+            for( ; pad; pad = pad->Next() )
+            {
+                const wxSize padHole = pad->GetDrillSize();
 
-            // The hole in the body is inflated by copper thickness,
-            // if not plated, no copper
-            const int inflate = (pad->GetAttribute () != PAD_ATTRIB_HOLE_NOT_PLATED) ?
-                                GetCopperThicknessBIU() : 0;
+                if( !padHole.x )    // Not drilled pad like SMD pad
+                    continue;
+
+                // The hole in the body is inflated by copper thickness,
+                // if not plated, no copper
+                const int inflate = (pad->GetAttribute () != PAD_ATTRIB_HOLE_NOT_PLATED) ?
+                                    GetCopperThicknessBIU() : 0;
 
-            m_stats_nr_holes++;
-            m_stats_hole_med_diameter += ( ( pad->GetDrillSize().x +
-                                             pad->GetDrillSize().y ) / 2.0f ) * m_biuTo3Dunits;
+                m_stats_nr_holes++;
+                m_stats_hole_med_diameter += ( ( pad->GetDrillSize().x +
+                                                 pad->GetDrillSize().y ) / 2.0f ) * m_biuTo3Dunits;
 
-            m_through_holes_outer.Add( createNewPadDrill( pad, inflate ) );
-            m_through_holes_inner.Add( createNewPadDrill( pad,       0 ) );
+                m_through_holes_outer.Add( createNewPadDrill( pad, inflate ) );
+                m_through_holes_inner.Add( createNewPadDrill( pad,       0 ) );
+            }
         }
+        if( m_stats_nr_holes )
+            m_stats_hole_med_diameter /= (float)m_stats_nr_holes;
     }
-    if( m_stats_nr_holes )
-        m_stats_hole_med_diameter /= (float)m_stats_nr_holes;
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     printf( "T07: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
@@ -1515,42 +1498,45 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
     // Add contours of the pad holes (pads can be Circle or Segment holes)
     // /////////////////////////////////////////////////////////////////////////
-    for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    if( aHoles )
     {
-        const D_PAD* pad = module->Pads();
-
-        for( ; pad; pad = pad->Next() )
+        for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
         {
-            const wxSize padHole = pad->GetDrillSize();
+            const D_PAD* pad = module->Pads();
 
-            if( !padHole.x ) // Not drilled pad like SMD pad
-                continue;
+            for( ; pad; pad = pad->Next() )
+            {
+                const wxSize padHole = pad->GetDrillSize();
 
-            // The hole in the body is inflated by copper thickness.
-            const int inflate = GetCopperThicknessBIU();
+                if( !padHole.x ) // Not drilled pad like SMD pad
+                    continue;
 
-            // we use the hole diameter to calculate the seg count.
-            // for round holes, padHole.x == padHole.y
-            // for oblong holes, the diameter is the smaller of (padHole.x, padHole.y)
-            const int diam = std::min( padHole.x, padHole.y );
+                // The hole in the body is inflated by copper thickness.
+                const int inflate = GetCopperThicknessBIU();
 
+                // we use the hole diameter to calculate the seg count.
+                // for round holes, padHole.x == padHole.y
+                // for oblong holes, the diameter is the smaller of (padHole.x, padHole.y)
+                const int diam = std::min( padHole.x, padHole.y );
 
-            if( pad->GetAttribute () != PAD_ATTRIB_HOLE_NOT_PLATED )
-            {
-                pad->BuildPadDrillShapePolygon( m_through_outer_holes_poly,
-                                                inflate,
-                                                GetNrSegmentsCircle( diam ) );
 
-                pad->BuildPadDrillShapePolygon( m_through_inner_holes_poly,
-                                                0,
-                                                GetNrSegmentsCircle( diam ) );
-            }
-            else
-            {
-                // If not plated, no copper.
-                pad->BuildPadDrillShapePolygon( m_through_outer_holes_poly_NPTH,
-                                                inflate,
-                                                GetNrSegmentsCircle( diam ) );
+                if( pad->GetAttribute () != PAD_ATTRIB_HOLE_NOT_PLATED )
+                {
+                    pad->BuildPadDrillShapePolygon( m_through_outer_holes_poly,
+                                                    inflate,
+                                                    GetNrSegmentsCircle( diam ) );
+
+                    pad->BuildPadDrillShapePolygon( m_through_inner_holes_poly,
+                                                    0,
+                                                    GetNrSegmentsCircle( diam ) );
+                }
+                else
+                {
+                    // If not plated, no copper.
+                    pad->BuildPadDrillShapePolygon( m_through_outer_holes_poly_NPTH,
+                                                    inflate,
+                                                    GetNrSegmentsCircle( diam ) );
+                }
             }
         }
     }
@@ -1861,9 +1847,9 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     if( aStatusTextReporter )
         aStatusTextReporter->Report( _( "Simplify holes contours" ) );
 
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( unsigned int lIdx = 0; lIdx < holes_layer_id.size(); ++lIdx )
     {
-        const LAYER_ID curr_layer_id = layer_id[lIdx];
+        const LAYER_ID curr_layer_id = holes_layer_id[lIdx];
 
         if( m_layers_outer_holes_poly.find( curr_layer_id ) !=
             m_layers_outer_holes_poly.end() )
@@ -1887,11 +1873,14 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
 
     // This will make a union of all added contourns
-    m_through_inner_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    //m_through_inner_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST ); // Not in use
+    if( aHoles )
+    {
+        m_through_inner_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+        m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+        m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
+        m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+        //m_through_inner_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST ); // Not in use
+    }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endCopperLayersTime = GetRunningMicroSecs();
@@ -1934,9 +1923,10 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
          ++seq )
     {
         const LAYER_ID curr_layer_id = *seq;
+        const bool isMaskLayer = ( curr_layer_id == F_Mask ) || ( curr_layer_id == B_Mask );
 
-        if( !Is3DLayerEnabled( curr_layer_id ) )
-                    continue;
+        if( !Is3DLayerEnabled( curr_layer_id ) || !aLayers[curr_layer_id] )
+            continue;
 
         CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
         m_layers_container2D[curr_layer_id] = layerContainer;
@@ -2026,7 +2016,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
                                                          linewidth );
                 }
             }
-            else
+            else if( !isMaskLayer )     // mask openings are added below, merged
             {
                 AddPadsShapesWithClearanceToContainer( module,
                                                        layerContainer,
@@ -2059,7 +2049,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
                     buildPadShapeThickOutlineAsPolygon( pad, *layerPoly, linewidth );
                 }
             }
-            else
+            else if( !isMaskLayer )
             {
                 transformPadsShapesWithClearanceToPolygon( module->Pads(),
                                                            curr_layer_id,
@@ -2081,6 +2071,36 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         }
 
 
+        // Add solder mask openings: the pads (and vias) with their mask margin, merged
+        // like in the plots, from the board cache shared with them.
+        // The zones are not included: they are drawn below, when FL_ZONE is set
+        // /////////////////////////////////////////////////////////////////////
+        if( isMaskLayer )
+        {
+            SHAPE_POLY_SET openings;
+
+            m_board->GetMergedMaskLayer( curr_layer_id,
+                                         m_board->GetDesignSettings().m_SolderMaskMinWidth,
+                                         m_board->GetPlotOptions().GetPlotViaOnMaskLayer(),
+                                         false, openings );
+
+            // Note: This two sequencial calls are need in order to get
+            // the triangulation function to work properly.
+            openings.Simplify( SHAPE_POLY_SET::PM_FAST );
+            openings.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+            if( !openings.IsEmpty() )
+            {
+                Convert_shape_line_polygon_to_triangles( openings,
+                                                         *layerContainer,
+                                                         m_biuTo3Dunits,
+                                                         *m_board );
+
+                layerPoly->Append( openings );
+            }
+        }
+
+
         // Draw non copper zones
         // /////////////////////////////////////////////////////////////////////
         if( GetFlag( FL_ZONE ) )
@@ -2128,26 +2148,39 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     unsigned stats_startHolesBVHTime = GetRunningMicroSecs();
 #endif
 
-    m_through_holes_inner.BuildBVH();
-    m_through_holes_outer.BuildBVH();
+    unsigned startBVHTime = GetRunningMicroSecs();
 
-    if( !m_layers_holes2D.empty() )
+    // The containers are independent, build their BVHs in parallel
+    std::vector<CBVHCONTAINER2D *> containersBVH;
+
+    if( aHoles )
     {
+        containersBVH.push_back( &m_through_holes_inner );
+        containersBVH.push_back( &m_through_holes_outer );
+
         for( MAP_CONTAINER_2D::iterator ii = m_layers_holes2D.begin();
              ii != m_layers_holes2D.end();
              ++ii )
         {
-            ((CBVHCONTAINER2D *)(ii->second))->BuildBVH();
+            containersBVH.push_back( (CBVHCONTAINER2D *)(ii->second) );
         }
     }
 
     // We only need the Solder mask to initialize the BVH
     // because..?
-    if( (CBVHCONTAINER2D *)m_layers_container2D[B_Mask] )
-        ((CBVHCONTAINER2D *)m_layers_container2D[B_Mask])->BuildBVH();
+    if( aLayers[B_Mask] && (CBVHCONTAINER2D *)m_layers_container2D[B_Mask] )
+        containersBVH.push_back( (CBVHCONTAINER2D *)m_layers_container2D[B_Mask] );
+
+    if( aLayers[F_Mask] && (CBVHCONTAINER2D *)m_layers_container2D[F_Mask] )
+        containersBVH.push_back( (CBVHCONTAINER2D *)m_layers_container2D[F_Mask] );
+
+    const int nContainers = containersBVH.size();
+
+    #pragma omp parallel for schedule(dynamic)
+    for( signed int i = 0; i < nContainers; ++i )
+        containersBVH[i]->BuildBVH();
 
-    if( (CBVHCONTAINER2D *)m_layers_container2D[F_Mask] )
-        ((CBVHCONTAINER2D *)m_layers_container2D[F_Mask])->BuildBVH();
+    m_stats_bvh2D_build_time = GetRunningMicroSecs() - startBVHTime;
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endHolesBVHTime = GetRunningMicroSecs();
@@ -228,6 +228,19 @@ void EDA_3D_CANVAS::ReloadRequest( BOARD *aBoard , S3D_CACHE *aCachePointer )
 }
 
 
+void EDA_3D_CANVAS::UpdateRequest( BOARD *aBoard, const LSET &aLayers, bool aHoles )
+{
+    if( aBoard != m_settings.GetBoard() )
+    {
+        ReloadRequest( aBoard );
+        return;
+    }
+
+    if( m_3d_render )
+        m_3d_render->UpdateRequest( aLayers, aHoles );
+}
+
+
 void EDA_3D_CANVAS::RenderRaytracingRequest()
 {
     m_3d_render = m_3d_render_raytracing;
@@ -75,6 +75,15 @@ class EDA_3D_CANVAS : public wxGLCanvas
 
     void ReloadRequest( BOARD *aBoard = NULL, S3D_CACHE *aCachePointer = NULL );
 
+    /**
+     * @brief UpdateRequest - Schedule a reload of only the layers changed by a board edit
+     * @param aBoard: the edited board. If it is not the board of the canvas,
+     * a full reload is scheduled
+     * @param aLayers: the layers changed by the edit
+     * @param aHoles: true if the edit changed vias or pad holes
+     */
+    void UpdateRequest( BOARD *aBoard, const LSET &aLayers, bool aHoles );
+
     /**
      * @brief IsReloadRequestPending - Query if there is a pending reload request
      * @return true if it wants to reload, false if there is no reload pending
@@ -336,10 +336,6 @@ CLAYERS_OGL_DISP_LISTS *C3D_RENDER_OGL_LEGACY::generate_holes_display_list(
 
 void C3D_RENDER_OGL_LEGACY::reload( REPORTER *aStatusTextReporter )
 {
-    m_reloadRequested = false;
-
-    ogl_free_all_display_lists();
-
     COBJECT2D_STATS::Instance().ResetStats();
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -348,186 +344,214 @@ void C3D_RENDER_OGL_LEGACY::reload( REPORTER *aStatusTextReporter )
 
     unsigned stats_startReloadTime = GetRunningMicroSecs();
 
-    m_settings.InitSettings( aStatusTextReporter );
+    // On a partial reload, only the display lists of the changed layers
+    // (and the holes, if they changed) are generated again
+    LSET updatedLayers;
+    bool updatedHoles;
+    const bool fullReload = reloadSettings( aStatusTextReporter, updatedLayers, updatedHoles );
+
+    if( fullReload )
+    {
+        ogl_free_all_display_lists();
+
+        updatedLayers = LSET::AllLayersMask();
+        updatedHoles  = true;
+    }
+    else
+    {
+        ogl_free_layers_display_lists( updatedLayers );
+
+        if( updatedHoles )
+            ogl_free_holes_display_lists();
+    }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endReloadTime = GetRunningMicroSecs();
 #endif
 
-    SFVEC3F camera_pos = m_settings.GetBoardCenter3DU();
-    m_settings.CameraGet().SetBoardLookAtPos( camera_pos );
+    if( fullReload )
+    {
+        SFVEC3F camera_pos = m_settings.GetBoardCenter3DU();
+        m_settings.CameraGet().SetBoardLookAtPos( camera_pos );
+    }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_start_OpenGL_Load_Time = GetRunningMicroSecs();
 #endif
 
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Load OpenGL: board" ) );
+    if( fullReload )
+    {
+        if( aStatusTextReporter )
+            aStatusTextReporter->Report( _( "Load OpenGL: board" ) );
 
-    // Create Board
-    // /////////////////////////////////////////////////////////////////////////
+        // Create Board
+        // /////////////////////////////////////////////////////////////////////
 
-    CCONTAINER2D boardContainer;
-    Convert_shape_line_polygon_to_triangles( m_settings.GetBoardPoly(),
-                                             boardContainer,
-                                             m_settings.BiuTo3Dunits(),
-                                             (const BOARD_ITEM &)*m_settings.GetBoard() );
+        CCONTAINER2D boardContainer;
+        Convert_shape_line_polygon_to_triangles( m_settings.GetBoardPoly(),
+                                                 boardContainer,
+                                                 m_settings.BiuTo3Dunits(),
+                                                 (const BOARD_ITEM &)*m_settings.GetBoard() );
 
-    const LIST_OBJECT2D &listBoardObject2d = boardContainer.GetList();
+        const LIST_OBJECT2D &listBoardObject2d = boardContainer.GetList();
 
-    if( listBoardObject2d.size() > 0 )
-    {
-        // We will set a unitary Z so it will in future used with transformations
-        // since the board poly will be used not only to draw itself but also the
-        // solder mask layers.
-        const float layer_z_top = 1.0f;
-        const float layer_z_bot = 0.0f;
+        if( listBoardObject2d.size() > 0 )
+        {
+            // We will set a unitary Z so it will in future used with transformations
+            // since the board poly will be used not only to draw itself but also the
+            // solder mask layers.
+            const float layer_z_top = 1.0f;
+            const float layer_z_bot = 0.0f;
 
-        CLAYER_TRIANGLES *layerTriangles = new CLAYER_TRIANGLES( listBoardObject2d.size() );
+            CLAYER_TRIANGLES *layerTriangles = new CLAYER_TRIANGLES( listBoardObject2d.size() );
 
-        // Convert the list of objects(triangles) to triangle layer structure
-        for( LIST_OBJECT2D::const_iterator itemOnLayer = listBoardObject2d.begin();
-             itemOnLayer != listBoardObject2d.end();
-             ++itemOnLayer )
-        {
-            const COBJECT2D *object2d_A = static_cast<const COBJECT2D *>(*itemOnLayer);
+            // Convert the list of objects(triangles) to triangle layer structure
+            for( LIST_OBJECT2D::const_iterator itemOnLayer = listBoardObject2d.begin();
+                 itemOnLayer != listBoardObject2d.end();
+                 ++itemOnLayer )
+            {
+                const COBJECT2D *object2d_A = static_cast<const COBJECT2D *>(*itemOnLayer);
 
-            wxASSERT( object2d_A->GetObjectType() == OBJ2D_TRIANGLE );
+                wxASSERT( object2d_A->GetObjectType() == OBJ2D_TRIANGLE );
 
-            const CTRIANGLE2D *tri = (const CTRIANGLE2D *)object2d_A;
+                const CTRIANGLE2D *tri = (const CTRIANGLE2D *)object2d_A;
 
-            const SFVEC2F &v1 = tri->GetP1();
-            const SFVEC2F &v2 = tri->GetP2();
-            const SFVEC2F &v3 = tri->GetP3();
+                const SFVEC2F &v1 = tri->GetP1();
+                const SFVEC2F &v2 = tri->GetP2();
+                const SFVEC2F &v3 = tri->GetP3();
 
-            add_triangle_top_bot( layerTriangles,
-                                  v1,
-                                  v2,
-                                  v3,
-                                  layer_z_top,
-                                  layer_z_bot );
-        }
+                add_triangle_top_bot( layerTriangles,
+                                      v1,
+                                      v2,
+                                      v3,
+                                      layer_z_top,
+                                      layer_z_bot );
+            }
 
-        const SHAPE_POLY_SET &boardPoly = m_settings.GetBoardPoly();
+            const SHAPE_POLY_SET &boardPoly = m_settings.GetBoardPoly();
 
-        wxASSERT( boardPoly.OutlineCount() > 0 );
+            wxASSERT( boardPoly.OutlineCount() > 0 );
 
-        if( boardPoly.OutlineCount() > 0 )
-        {
-            layerTriangles->AddToMiddleContourns( boardPoly,
-                                                  layer_z_bot,
-                                                  layer_z_top,
-                                                  m_settings.BiuTo3Dunits(),
-                                                  false );
+            if( boardPoly.OutlineCount() > 0 )
+            {
+                layerTriangles->AddToMiddleContourns( boardPoly,
+                                                      layer_z_bot,
+                                                      layer_z_top,
+                                                      m_settings.BiuTo3Dunits(),
+                                                      false );
 
-            m_ogl_disp_list_board = new CLAYERS_OGL_DISP_LISTS( *layerTriangles,
-                                                                m_ogl_circle_texture,
-                                                                layer_z_top,
-                                                                layer_z_top );
-        }
+                m_ogl_disp_list_board = new CLAYERS_OGL_DISP_LISTS( *layerTriangles,
+                                                                    m_ogl_circle_texture,
+                                                                    layer_z_top,
+                                                                    layer_z_top );
+            }
 
-        delete layerTriangles;
+            delete layerTriangles;
+        }
     }
 
     // Create Through Holes and vias
     // /////////////////////////////////////////////////////////////////////////
 
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Load OpenGL: holes and vias" ) );
-
-    m_ogl_disp_list_through_holes_outer = generate_holes_display_list(
-                m_settings.GetThroughHole_Outer().GetList(),
-                m_settings.GetThroughHole_Outer_poly(),
-                1.0f,
-                0.0f,
-                false );
-
-    SHAPE_POLY_SET bodyHoles = m_settings.GetThroughHole_Outer_poly();
-
-    bodyHoles.BooleanAdd( m_settings.GetThroughHole_Outer_poly_NPTH(),
-                          SHAPE_POLY_SET::PM_FAST );
-
-    m_ogl_disp_list_through_holes_outer_with_npth = generate_holes_display_list(
-                m_settings.GetThroughHole_Outer().GetList(),
-                bodyHoles,
-                1.0f,
-                0.0f,
-                false );
-
-    m_ogl_disp_list_through_holes_inner = generate_holes_display_list(
-                m_settings.GetThroughHole_Inner().GetList(),
-                m_settings.GetThroughHole_Inner_poly(),
-                1.0f,
-                0.0f,
-                true );
-
-
-    m_ogl_disp_list_through_holes_vias_outer = generate_holes_display_list(
-                m_settings.GetThroughHole_Vias_Outer().GetList(),
-                m_settings.GetThroughHole_Vias_Outer_poly(),
-                1.0f,
-                0.0f,
-                false );
+    if( updatedHoles )
+    {
+        if( aStatusTextReporter )
+            aStatusTextReporter->Report( _( "Load OpenGL: holes and vias" ) );
+
+        m_ogl_disp_list_through_holes_outer = generate_holes_display_list(
+                    m_settings.GetThroughHole_Outer().GetList(),
+                    m_settings.GetThroughHole_Outer_poly(),
+                    1.0f,
+                    0.0f,
+                    false );
+
+        SHAPE_POLY_SET bodyHoles = m_settings.GetThroughHole_Outer_poly();
+
+        bodyHoles.BooleanAdd( m_settings.GetThroughHole_Outer_poly_NPTH(),
+                              SHAPE_POLY_SET::PM_FAST );
+
+        m_ogl_disp_list_through_holes_outer_with_npth = generate_holes_display_list(
+                    m_settings.GetThroughHole_Outer().GetList(),
+                    bodyHoles,
+                    1.0f,
+                    0.0f,
+                    false );
+
+        m_ogl_disp_list_through_holes_inner = generate_holes_display_list(
+                    m_settings.GetThroughHole_Inner().GetList(),
+                    m_settings.GetThroughHole_Inner_poly(),
+                    1.0f,
+                    0.0f,
+                    true );
+
+
+        m_ogl_disp_list_through_holes_vias_outer = generate_holes_display_list(
+                    m_settings.GetThroughHole_Vias_Outer().GetList(),
+                    m_settings.GetThroughHole_Vias_Outer_poly(),
+                    1.0f,
+                    0.0f,
+                    false );
+
+        // Not in use
+        //m_ogl_disp_list_through_holes_vias_inner = generate_holes_display_list(
+        //      m_settings.GetThroughHole_Vias_Inner().GetList(),
+        //      m_settings.GetThroughHole_Vias_Inner_poly(),
+        //      1.0f, 0.0f,
+        //      false );
+
+        const MAP_POLY & innerMapHoles = m_settings.GetPolyMapHoles_Inner();
+        const MAP_POLY & outerMapHoles = m_settings.GetPolyMapHoles_Outer();
+
+        wxASSERT( innerMapHoles.size() == outerMapHoles.size() );
+
+        const MAP_CONTAINER_2D &map_holes = m_settings.GetMapLayersHoles();
+
+        if( outerMapHoles.size() > 0 )
+        {
+            float layer_z_bot = 0.0f;
+            float layer_z_top = 0.0f;
 
-    // Not in use
-    //m_ogl_disp_list_through_holes_vias_inner = generate_holes_display_list(
-    //      m_settings.GetThroughHole_Vias_Inner().GetList(),
-    //      m_settings.GetThroughHole_Vias_Inner_poly(),
-    //      1.0f, 0.0f,
-    //      false );
+            for( MAP_POLY::const_iterator ii = outerMapHoles.begin();
+                 ii != outerMapHoles.end();
+                 ++ii )
+            {
+                LAYER_ID layer_id = static_cast<LAYER_ID>(ii->first);
+                const SHAPE_POLY_SET *poly = static_cast<const SHAPE_POLY_SET *>(ii->second);
+                const CBVHCONTAINER2D *container = map_holes.at( layer_id );
 
-    const MAP_POLY & innerMapHoles = m_settings.GetPolyMapHoles_Inner();
-    const MAP_POLY & outerMapHoles = m_settings.GetPolyMapHoles_Outer();
+                get_layer_z_pos( layer_id, layer_z_top, layer_z_bot );
 
-    wxASSERT( innerMapHoles.size() == outerMapHoles.size() );
+                m_ogl_disp_lists_layers_holes_outer[layer_id] = generate_holes_display_list(
+                            container->GetList(),
+                            *poly,
+                            layer_z_top,
+                            layer_z_bot,
+                            false );
+            }
 
-    const MAP_CONTAINER_2D &map_holes = m_settings.GetMapLayersHoles();
+            for( MAP_POLY::const_iterator ii = innerMapHoles.begin();
+                 ii != innerMapHoles.end();
+                 ++ii )
+            {
+                LAYER_ID layer_id = static_cast<LAYER_ID>(ii->first);
+                const SHAPE_POLY_SET *poly = static_cast<const SHAPE_POLY_SET *>(ii->second);
+                const CBVHCONTAINER2D *container = map_holes.at( layer_id );
 
-    if( outerMapHoles.size() > 0 )
-    {
-        float layer_z_bot = 0.0f;
-        float layer_z_top = 0.0f;
+                get_layer_z_pos( layer_id, layer_z_top, layer_z_bot );
 
-        for( MAP_POLY::const_iterator ii = outerMapHoles.begin();
-             ii != outerMapHoles.end();
-             ++ii )
-        {
-            LAYER_ID layer_id = static_cast<LAYER_ID>(ii->first);
-            const SHAPE_POLY_SET *poly = static_cast<const SHAPE_POLY_SET *>(ii->second);
-            const CBVHCONTAINER2D *container = map_holes.at( layer_id );
-
-            get_layer_z_pos( layer_id, layer_z_top, layer_z_bot );
-
-            m_ogl_disp_lists_layers_holes_outer[layer_id] = generate_holes_display_list(
-                        container->GetList(),
-                        *poly,
-                        layer_z_top,
-                        layer_z_bot,
-                        false );
+                m_ogl_disp_lists_layers_holes_inner[layer_id] = generate_holes_display_list(
+                            container->GetList(),
+                            *poly,
+                            layer_z_top,
+                            layer_z_bot,
+                            false );
+            }
         }
 
-        for( MAP_POLY::const_iterator ii = innerMapHoles.begin();
-             ii != innerMapHoles.end();
-             ++ii )
-        {
-            LAYER_ID layer_id = static_cast<LAYER_ID>(ii->first);
-            const SHAPE_POLY_SET *poly = static_cast<const SHAPE_POLY_SET *>(ii->second);
-            const CBVHCONTAINER2D *container = map_holes.at( layer_id );
-
-            get_layer_z_pos( layer_id, layer_z_top, layer_z_bot );
-
-            m_ogl_disp_lists_layers_holes_inner[layer_id] = generate_holes_display_list(
-                        container->GetList(),
-                        *poly,
-                        layer_z_top,
-                        layer_z_bot,
-                        false );
-        }
+        // Generate vertical cylinders of vias and pads (copper)
+        generate_3D_Vias_and_Pads();
     }
 
-    // Generate vertical cylinders of vias and pads (copper)
-    generate_3D_Vias_and_Pads();
-
     // Add layers maps
     // /////////////////////////////////////////////////////////////////////////
 
@@ -540,7 +564,7 @@ void C3D_RENDER_OGL_LEGACY::reload( REPORTER *aStatusTextReporter )
     {
         LAYER_ID layer_id = static_cast<LAYER_ID>(ii->first);
 
-        if( !m_settings.Is3DLayerEnabled( layer_id ) )
+        if( !m_settings.Is3DLayerEnabled( layer_id ) || !updatedLayers[layer_id] )
             continue;
 
         const CBVHCONTAINER2D *container2d = static_cast<const CBVHCONTAINER2D *>(ii->second);
@@ -639,7 +663,7 @@ void C3D_RENDER_OGL_LEGACY::reload( REPORTER *aStatusTextReporter )
     if( aStatusTextReporter )
         aStatusTextReporter->Report( _( "Loading 3D models" ) );
 
-    load_3D_models();
+    load_3D_models( aStatusTextReporter );
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_end_models_Load_Time = GetRunningMicroSecs();
@@ -754,7 +778,7 @@ void C3D_RENDER_OGL_LEGACY::generate_3D_Vias_and_Pads()
         CLAYER_TRIANGLES *layerTriangleVIA = new CLAYER_TRIANGLES( reserve_nr_triangles_estimation );
 
         // Insert plated vertical holes inside the board
-        // /////////////////////////////////////////////////////////////////////////
+        // /////////////////////////////////////////////////////////////////////
 
         // Insert vias holes (vertical cylinders)
         for( const TRACK* track = m_settings.GetBoard()->m_Track;
@@ -918,13 +942,17 @@ void C3D_RENDER_OGL_LEGACY::generate_3D_Vias_and_Pads()
  * cache for this render. (cache based on C_OGL_3DMODEL with associated
  * openGL lists in GPU memory)
  */
-void C3D_RENDER_OGL_LEGACY::load_3D_models()
+void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER *aStatusTextReporter )
 {
     if( (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_NORMAL )) &&
         (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_NORMAL_INSERT )) &&
         (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL )) )
         return;
 
+    // Load and convert the models in parallel; the OpenGL lists are then built
+    // here, in the OpenGL thread
+    prefetch3DModels( aStatusTextReporter, true );
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
@@ -944,18 +972,29 @@ void C3D_RENDER_OGL_LEGACY::load_3D_models()
                     if( m_3dmodel_map.find( sM->m_Filename ) == m_3dmodel_map.end() )
                     {
                         // It is not present, try get it from cache
-                        const S3DMODEL *modelPtr =
-                                m_settings.Get3DCacheManager()->GetModel( sM->m_Filename );
+                        S3D_CACHE *cacheMgr = m_settings.Get3DCacheManager();
+                        const S3DMODEL *modelPtr = cacheMgr->GetModel( sM->m_Filename );
 
                         // only add it if the return is not NULL
                         if( modelPtr )
                         {
-                            C_OGL_3DMODEL* ogl_model =
-                                    new C_OGL_3DMODEL( *modelPtr,
-                                                       m_settings.MaterialModeGet() );
+                            std::vector< C_OGL_3DMODEL * > &levels =
+                                    m_3dmodel_map[ sM->m_Filename ];
+
+                            levels.push_back( new C_OGL_3DMODEL( *modelPtr,
+                                                                 m_settings.MaterialModeGet() ) );
+
+                            // and its levels of detail, if it has some
+                            for( int level = 1; level < S3D_LOD_LEVELS; ++level )
+                            {
+                                modelPtr = cacheMgr->GetModelLOD( sM->m_Filename, level );
+
+                                if( !modelPtr )
+                                    break;
 
-                            if( ogl_model )
-                                m_3dmodel_map[ sM->m_Filename ] = ogl_model;
+                                levels.push_back( new C_OGL_3DMODEL( *modelPtr,
+                                                                     m_settings.MaterialModeGet() ) );
+                            }
                         }
                     }
                 }
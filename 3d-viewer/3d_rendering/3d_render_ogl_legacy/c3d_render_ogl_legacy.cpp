@@ -838,17 +838,55 @@ void C3D_RENDER_OGL_LEGACY::ogl_free_all_display_lists()
 
     m_ogl_disp_list_grid = 0;
 
-    for( MAP_OGL_DISP_LISTS::const_iterator ii = m_ogl_disp_lists_layers.begin();
-         ii != m_ogl_disp_lists_layers.end();
+    ogl_free_layers_display_lists( LSET::AllLayersMask() );
+    ogl_free_holes_display_lists();
+
+    for( MAP_3DMODEL::const_iterator ii = m_3dmodel_map.begin();
+         ii != m_3dmodel_map.end();
          ++ii )
     {
-        CLAYERS_OGL_DISP_LISTS *pLayerDispList = static_cast<CLAYERS_OGL_DISP_LISTS*>(ii->second);
-        delete pLayerDispList;
+        for( unsigned int level = 0; level < ii->second.size(); ++level )
+            delete ii->second[level];
     }
 
-    m_ogl_disp_lists_layers.clear();
+    m_3dmodel_map.clear();
+
+
+    delete m_ogl_disp_list_board;
+    m_ogl_disp_list_board = 0;
+}
+
+
+void C3D_RENDER_OGL_LEGACY::ogl_free_layers_display_lists( const LSET &aLayers )
+{
+    for( MAP_OGL_DISP_LISTS::iterator ii = m_ogl_disp_lists_layers.begin();
+         ii != m_ogl_disp_lists_layers.end(); )
+    {
+        if( aLayers[ii->first] )
+        {
+            delete ii->second;
+            ii = m_ogl_disp_lists_layers.erase( ii );
+        }
+        else
+            ++ii;
+    }
+
+    for( MAP_TRIANGLES::iterator ii = m_triangles.begin();
+         ii != m_triangles.end(); )
+    {
+        if( aLayers[ii->first] )
+        {
+            delete ii->second;
+            ii = m_triangles.erase( ii );
+        }
+        else
+            ++ii;
+    }
+}
 
 
+void C3D_RENDER_OGL_LEGACY::ogl_free_holes_display_lists()
+{
     for( MAP_OGL_DISP_LISTS::const_iterator ii = m_ogl_disp_lists_layers_holes_outer.begin();
          ii != m_ogl_disp_lists_layers_holes_outer.end();
          ++ii )
@@ -870,31 +908,6 @@ void C3D_RENDER_OGL_LEGACY::ogl_free_all_display_lists()
 
     m_ogl_disp_lists_layers_holes_inner.clear();
 
-    for( MAP_TRIANGLES::const_iterator ii = m_triangles.begin();
-         ii != m_triangles.end();
-         ++ii )
-    {
-        CLAYER_TRIANGLES *pointer = static_cast<CLAYER_TRIANGLES*>(ii->second);
-        delete pointer;
-    }
-
-    m_triangles.clear();
-
-
-    for( MAP_3DMODEL::const_iterator ii = m_3dmodel_map.begin();
-         ii != m_3dmodel_map.end();
-         ++ii )
-    {
-        C_OGL_3DMODEL *pointer = static_cast<C_OGL_3DMODEL*>(ii->second);
-        delete pointer;
-    }
-
-    m_3dmodel_map.clear();
-
-
-    delete m_ogl_disp_list_board;
-    m_ogl_disp_list_board = 0;
-
     delete m_ogl_disp_list_through_holes_outer_with_npth;
     m_ogl_disp_list_through_holes_outer_with_npth = 0;
 
@@ -1034,10 +1047,11 @@ void C3D_RENDER_OGL_LEGACY::render_3D_module( const MODULE* module,
             if( !sM->m_Filename.empty() )
             {
                 // Check if the model is present in our cache map
-                if( m_3dmodel_map.find( sM->m_Filename ) != m_3dmodel_map.end() )
+                MAP_3DMODEL::const_iterator ii = m_3dmodel_map.find( sM->m_Filename );
+
+                if( ii != m_3dmodel_map.end() )
                 {
-                    // It is not present, try get it from cache
-                    const C_OGL_3DMODEL *modelPtr = m_3dmodel_map[ sM->m_Filename ];
+                    const C_OGL_3DMODEL *modelPtr = ii->second[0];
 
                     if( modelPtr )
                     {
@@ -1056,6 +1070,11 @@ void C3D_RENDER_OGL_LEGACY::render_3D_module( const MODULE* module,
 
                             glScalef( sM->m_Scale.x, sM->m_Scale.y, sM->m_Scale.z );
 
+                            // the levels of detail have the materials and meshes of the model
+                            if( ii->second.size() > 1 )
+                                modelPtr = ii->second[ get_model_lod( modelPtr->GetBBox(),
+                                                                      ii->second.size() ) ];
+
                             if( aRenderTransparentOnly )
                                 modelPtr->Draw_transparent();
                             else
@@ -1093,6 +1112,56 @@ void C3D_RENDER_OGL_LEGACY::render_3D_module( const MODULE* module,
 }
 
 
+// Projected size, in pixels, under which a model is rendered with its first level
+// of detail. Each level has about 1/4 of the triangles of the previous one, so the
+// size halves from one level to the next.
+#define LOD_FULL_DETAIL_SIZE 300.0f
+
+unsigned int C3D_RENDER_OGL_LEGACY::get_model_lod( const CBBOX &aBBox,
+                                                   unsigned int aLevels ) const
+{
+    GLfloat modelview[16];
+
+    glGetFloatv( GL_MODELVIEW_MATRIX, modelview );
+
+    const glm::mat4 modelMatrix = glm::make_mat4( modelview );
+    const glm::mat4 &projection = m_settings.CameraGet().GetProjectionMatrix();
+
+    const glm::vec4 center = modelMatrix * glm::vec4( aBBox.GetCenter(), 1.0f );
+
+    // the model transform may scale, the bounding sphere is scaled by the largest axis
+    const float scale = glm::max( glm::length( glm::vec3( modelMatrix[0] ) ),
+                                  glm::max( glm::length( glm::vec3( modelMatrix[1] ) ),
+                                            glm::length( glm::vec3( modelMatrix[2] ) ) ) );
+
+    const float radius = 0.5f * glm::length( aBBox.GetExtent() ) * scale;
+
+    // diameter in pixels; with a perspective projection it shrinks with the distance
+    float size = radius * projection[1][1] * m_windowSize.y;
+
+    if( projection[2][3] != 0.0f )
+    {
+        const float distance = -center.z;
+
+        if( distance <= radius )
+            return 0;
+
+        size /= distance;
+    }
+
+    unsigned int level = 0;
+    float threshold = LOD_FULL_DETAIL_SIZE;
+
+    while( size < threshold && level + 1 < aLevels )
+    {
+        threshold *= 0.5f;
+        ++level;
+    }
+
+    return level;
+}
+
+
 // create a 3D grid to an openGL display list: an horizontal grid (XY plane and Z = 0,
 // and a vertical grid (XZ plane and Y = 0)
 void C3D_RENDER_OGL_LEGACY::generate_new_3DGrid( GRID3D_TYPE aGridType )
@@ -45,11 +45,13 @@
 #include "3d_cache/3d_info.h"
 
 #include <map>
+#include <vector>
 
 
 typedef std::map< LAYER_ID, CLAYERS_OGL_DISP_LISTS* > MAP_OGL_DISP_LISTS;
 typedef std::map< LAYER_ID, CLAYER_TRIANGLES * > MAP_TRIANGLES;
-typedef std::map< wxString, C_OGL_3DMODEL * > MAP_3DMODEL;
+/// the OpenGL model of each model file, followed by its levels of detail if it has some
+typedef std::map< wxString, std::vector< C_OGL_3DMODEL * > > MAP_3DMODEL;
 
 #define SIZE_OF_CIRCLE_TEXTURE 1024
 
@@ -76,6 +78,8 @@ private:
     void ogl_set_arrow_material();
 
     void ogl_free_all_display_lists();
+    void ogl_free_layers_display_lists( const LSET &aLayers );
+    void ogl_free_holes_display_lists();
     MAP_OGL_DISP_LISTS      m_ogl_disp_lists_layers;
     MAP_OGL_DISP_LISTS      m_ogl_disp_lists_layers_holes_outer;
     MAP_OGL_DISP_LISTS      m_ogl_disp_lists_layers_holes_inner;
@@ -174,7 +178,7 @@ private:
 
     void generate_3D_Vias_and_Pads();
 
-    void load_3D_models();
+    void load_3D_models( REPORTER *aStatusTextReporter );
 
     /**
      * @brief render_3D_models
@@ -186,6 +190,15 @@ private:
 
     void render_3D_module( const MODULE* module, bool aRenderTransparentOnly );
 
+    /**
+     * @brief get_model_lod - Select the level of detail to render a model with, from
+     * its size projected on the screen with the current modelview matrix
+     * @param aBBox: the bounding box of the model
+     * @param aLevels: the number of levels of the model
+     * @return the level, from 0 (full detail) to aLevels - 1
+     */
+    unsigned int get_model_lod( const CBBOX &aBBox, unsigned int aLevels ) const;
+
     void setLight_Front( bool enabled );
     void setLight_Top( bool enabled );
     void setLight_Bottom( bool enabled );
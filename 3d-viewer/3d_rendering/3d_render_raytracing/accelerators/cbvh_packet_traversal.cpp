@@ -28,6 +28,7 @@
  */
 
 #include "cbvh_pbrt.h"
+#include "../raypacket_simd.h"
 #include <wx/debug.h>
 
 
@@ -48,52 +49,33 @@ struct StackNode
 static inline unsigned int getFirstHit( const RAYPACKET &aRayPacket,
                                         const CBBOX &aBBox,
                                         unsigned int ia,
-                                        HITINFO_PACKET *aHitInfoPacket )
+                                        const float *aTHit )
 {
     float hitT;
 
     if( aBBox.Intersect( aRayPacket.m_ray[ia], &hitT ) )
-        if( hitT < aHitInfoPacket[ia].m_HitInfo.m_tHit )
+        if( hitT < aTHit[ia] )
             return ia;
 
     if( !aRayPacket.m_Frustum.Intersect( aBBox ) )
         return RAYPACKET_RAYS_PER_PACKET;
 
-    for( unsigned int i = ia + 1; i < RAYPACKET_RAYS_PER_PACKET; ++i )
-    {
-        if( aBBox.Intersect( aRayPacket.m_ray[i], &hitT ) )
-            if( hitT < aHitInfoPacket[i].m_HitInfo.m_tHit )
-                return i;
-    }
+    const RAYPACKET_MASK hits = RAYPACKET_IntersectBBox( aRayPacket, aBBox,
+                                                         RAYPACKET_MASK_FROM( ia + 1 ),
+                                                         aTHit );
 
-    return RAYPACKET_RAYS_PER_PACKET;
+    return hits ? RAYPACKET_FirstRay( hits ) : RAYPACKET_RAYS_PER_PACKET;
 }
 
 
 #ifdef BVH_RANGED_TRAVERSAL
 
-static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
-                                       const CBBOX &aBBox,
-                                       unsigned int ia,
-                                       HITINFO_PACKET *aHitInfoPacket )
-{
-    for( unsigned int ie = (RAYPACKET_RAYS_PER_PACKET - 1); ie > ia; --ie )
-    {
-        float hitT;
-
-        if( aBBox.Intersect( aRayPacket.m_ray[ie], &hitT ) )
-            if( hitT < aHitInfoPacket[ie].m_HitInfo.m_tHit )
-                return ie + 1;
-    }
-
-    return ia + 1;
-}
-
-
 // "Large Ray Packets for Real-time Whitted Ray Tracing"
 // http://cseweb.ucsd.edu/~ravir/whitted.pdf
 
 // Ranged Traversal
+// The boxes and the primitives are tested against several rays at a time by the
+// SIMD kernels of raypacket_simd.h
 bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
                            HITINFO_PACKET *aHitInfoPacket ) const
 {
@@ -107,13 +89,19 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     int todoOffset = 0, nodeNum = 0;
     StackNode todo[MAX_TODOS];
 
+    // Current hit distances, contiguous for the kernels
+    float tHit[RAYPACKET_RAYS_PER_PACKET];
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
+
     unsigned int ia = 0;
 
     while( true )
     {
         const LinearBVHNode *curCell = &m_nodes[nodeNum];
 
-        ia = getFirstHit( aRayPacket, curCell->bounds, ia, aHitInfoPacket );
+        ia = getFirstHit( aRayPacket, curCell->bounds, ia, tHit );
 
         if( ia < RAYPACKET_RAYS_PER_PACKET )
         {
@@ -127,10 +115,12 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
             }
             else
             {
-                const unsigned int ie = getLastHit( aRayPacket,
-                                                    curCell->bounds,
-                                                    ia,
-                                                    aHitInfoPacket );
+                // The rays that reach this leaf
+                RAYPACKET_MASK rays = RAYPACKET_IntersectBBox( aRayPacket,
+                                                               curCell->bounds,
+                                                               RAYPACKET_MASK_FROM( ia ),
+                                                               tHit );
+                rays |= (RAYPACKET_MASK) 1 << ia;
 
                 for( int j = 0; j < curCell->nPrimitives; ++j )
                 {
@@ -138,17 +128,19 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
 
                     if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
                     {
-                        for( unsigned int i = ia; i < ie; ++i )
+                        RAYPACKET_MASK hits = obj->IntersectPacket( aRayPacket, rays, tHit,
+                                                                    aHitInfoPacket );
+
+                        while( hits )
                         {
-                            const bool hitted = obj->Intersect( aRayPacket.m_ray[i],
-                                                                aHitInfoPacket[i].m_HitInfo );
+                            const unsigned int i = RAYPACKET_FirstRay( hits );
 
-                            if( hitted )
-                            {
-                                anyHitted |= hitted;
-                                aHitInfoPacket[i].m_hitresult |= hitted;
-                                aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
-                            }
+                            hits &= hits - 1;
+
+                            anyHitted = true;
+                            aHitInfoPacket[i].m_hitresult = true;
+                            aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
+                            tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
                         }
                     }
                 }
@@ -68,6 +68,7 @@
 
 #include "cbvh_pbrt.h"
 #include "../../../3d_fastmath.h"
+#include <algorithm>
 #include <vector>
 #include <boost/range/algorithm/partition.hpp>
 #include <boost/range/algorithm/nth_element.hpp>
@@ -81,6 +82,21 @@
 #include <stdio.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// OpenMP tasks (OpenMP 3.0) are used to build the subtrees in parallel
+#if defined( _OPENMP ) && ( _OPENMP >= 200805 )
+#define BVH_PARALLEL_BUILD
+#endif
+
+// Below this number of primitives, a subtree is built by the thread of its parent
+#define BVH_TASK_MIN_PRIMITIVES 4096
+
+// Minimum number of primitives sorted by each thread in the radix sort
+#define RADIX_SORT_MIN_CHUNK 16384
+
 // BVHAccel Local Declarations
 struct BVHPrimitiveInfo
 {
@@ -184,6 +200,21 @@ static void RadixSort( std::vector<MortonPrimitive> *v )
     wxASSERT( (nBits % bitsPerPass) == 0 );
 
     const int nPasses = nBits / bitsPerPass;
+    const int nBuckets = 1 << bitsPerPass;
+    const int bitMask = (1 << bitsPerPass) - 1;
+
+    // The array is split in chunks, one per thread. Each thread counts the keys of its
+    // chunk, then stores them after the ones of the previous chunks: the sort stays stable.
+    const int size = v->size();
+    int nChunks = 1;
+
+#ifdef _OPENMP
+    nChunks = std::max( 1, std::min( omp_get_max_threads(), size / RADIX_SORT_MIN_CHUNK ) );
+#endif
+
+    const int chunkSize = ( size + nChunks - 1 ) / nChunks;
+
+    std::vector<int> bucketCount( nChunks * nBuckets );
 
     for( int pass = 0; pass < nPasses; ++pass )
     {
@@ -195,33 +226,52 @@ static void RadixSort( std::vector<MortonPrimitive> *v )
         std::vector<MortonPrimitive> &out = (pass & 1) ? *v : tempVector;
 
         // Count number of zero bits in array for current radix sort bit
-        const int nBuckets = 1 << bitsPerPass;
-        int bucketCount[nBuckets] = {0};
-        const int bitMask = (1 << bitsPerPass) - 1;
+        std::fill( bucketCount.begin(), bucketCount.end(), 0 );
 
-        for( uint32_t i = 0; i < in.size(); ++i )
+        #pragma omp parallel for
+        for( int chunk = 0; chunk < nChunks; ++chunk )
         {
-            const MortonPrimitive &mp = in[i];
-            int bucket = (mp.mortonCode >> lowBit) & bitMask;
+            int *count = &bucketCount[chunk * nBuckets];
+            const int chunkEnd = std::min( size, (chunk + 1) * chunkSize );
+
+            for( int i = chunk * chunkSize; i < chunkEnd; ++i )
+            {
+                const MortonPrimitive &mp = in[i];
+                int bucket = (mp.mortonCode >> lowBit) & bitMask;
 
-            wxASSERT( (bucket >= 0) && (bucket < nBuckets) );
+                wxASSERT( (bucket >= 0) && (bucket < nBuckets) );
 
-            ++bucketCount[bucket];
+                ++count[bucket];
+            }
         }
 
-        // Compute starting index in output array for each bucket
-        int startIndex[nBuckets];
-        startIndex[0] = 0;
+        // Compute starting index in output array for each bucket and chunk
+        int startIndex = 0;
+
+        for( int bucket = 0; bucket < nBuckets; ++bucket )
+        {
+            for( int chunk = 0; chunk < nChunks; ++chunk )
+            {
+                const int count = bucketCount[chunk * nBuckets + bucket];
 
-        for( int i = 1; i < nBuckets; ++i )
-            startIndex[i] = startIndex[i - 1] + bucketCount[i - 1];
+                bucketCount[chunk * nBuckets + bucket] = startIndex;
+                startIndex += count;
+            }
+        }
 
         // Store sorted values in output array
-        for( uint32_t i = 0; i < in.size(); ++i )
+        #pragma omp parallel for
+        for( int chunk = 0; chunk < nChunks; ++chunk )
         {
-            const MortonPrimitive &mp = in[i];
-            int bucket = (mp.mortonCode >> lowBit) & bitMask;
-            out[startIndex[bucket]++] = mp;
+            int *outIndex = &bucketCount[chunk * nBuckets];
+            const int chunkEnd = std::min( size, (chunk + 1) * chunkSize );
+
+            for( int i = chunk * chunkSize; i < chunkEnd; ++i )
+            {
+                const MortonPrimitive &mp = in[i];
+                int bucket = (mp.mortonCode >> lowBit) & bitMask;
+                out[outIndex[bucket]++] = mp;
+            }
         }
     }
 
@@ -258,9 +308,12 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
 
     // Initialize _primitiveInfo_ array for primitives
     // /////////////////////////////////////////////////////////////////////////
-    std::vector<BVHPrimitiveInfo> primitiveInfo( m_primitives.size() );
+    const int nPrimitives = m_primitives.size();
+
+    std::vector<BVHPrimitiveInfo> primitiveInfo( nPrimitives );
 
-    for( size_t i = 0; i < m_primitives.size(); ++i )
+    #pragma omp parallel for
+    for( int i = 0; i < nPrimitives; ++i )
     {
         wxASSERT( m_primitives[i]->GetBBox().IsInitialized() );
 
@@ -274,13 +327,39 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
     orderedPrims.clear();
     orderedPrims.reserve( m_primitives.size() );
 
-    BVHBuildNode *root;
+    BVHBuildNode *root = NULL;
 
     if( m_splitMethod == SPLIT_HLBVH )
         root = HLBVHBuild( primitiveInfo, &totalNodes, orderedPrims);
     else
-        root = recursiveBuild( primitiveInfo, 0, m_primitives.size(),
-                               &totalNodes, orderedPrims);
+    {
+        // A binary tree with at most one leaf per primitive
+        const int maxNodes = 2 * nPrimitives - 1;
+
+        BVHBuildNode *nodes = static_cast<BVHBuildNode *>( _mm_malloc( sizeof( BVHBuildNode ) *
+                                                                       maxNodes,
+                                                                       L1_CACHE_LINE_SIZE ) );
+        m_addresses_pointer_to_mm_free.push_back( nodes );
+
+        std::atomic<int> nodesCreated( 0 );
+
+        #pragma omp parallel
+        {
+            #pragma omp single
+            root = recursiveBuild( &primitiveInfo, 0, nPrimitives, &nodesCreated, nodes );
+        }
+
+        totalNodes = nodesCreated;
+
+        wxASSERT( totalNodes <= maxNodes );
+
+        // The leaves refer to ranges of the reordered _primitiveInfo_
+        orderedPrims.resize( nPrimitives );
+
+        #pragma omp parallel for
+        for( int i = 0; i < nPrimitives; ++i )
+            orderedPrims[i] = m_primitives[ primitiveInfo[i].primitiveNumber ];
+    }
 
     wxASSERT( m_primitives.size() == orderedPrims.size() );
 
@@ -444,12 +523,14 @@ struct BucketInfo
 };
 
 
-BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primitiveInfo,
+BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> *aPrimitiveInfo,
                                           int start,
                                           int end,
-                                          int *totalNodes,
-                                          CONST_VECTOR_OBJECT &orderedPrims )
+                                          std::atomic<int> *totalNodes,
+                                          BVHBuildNode *aNodes )
 {
+    std::vector<BVHPrimitiveInfo> &primitiveInfo = *aPrimitiveInfo;
+
     wxASSERT( totalNodes != NULL );
     wxASSERT( start >= 0 );
     wxASSERT( end   >= 0 );
@@ -458,12 +539,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
     wxASSERT( start <= (int)primitiveInfo.size() );
     wxASSERT( end   <= (int)primitiveInfo.size() );
 
-    (*totalNodes)++;
-
-    // !TODO: implement an memory Arena
-    BVHBuildNode *node = static_cast<BVHBuildNode *>( _mm_malloc( sizeof( BVHBuildNode ),
-                                                                  L1_CACHE_LINE_SIZE ) );
-    m_addresses_pointer_to_mm_free.push_back( node );
+    BVHBuildNode *node = &aNodes[ (*totalNodes)++ ];
 
     node->bounds.Reset();
     node->firstPrimOffset = 0;
@@ -484,16 +560,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
     if( nPrimitives == 1 )
     {
         // Create leaf _BVHBuildNode_
-        int firstPrimOffset = orderedPrims.size();
-
-        for( int i = start; i < end; ++i )
-        {
-            int primitiveNr = primitiveInfo[i].primitiveNumber;
-            wxASSERT( primitiveNr < (int)m_primitives.size() );
-            orderedPrims.push_back( m_primitives[ primitiveNr ] );
-        }
-
-        node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+        node->InitLeaf( start, nPrimitives, bounds );
     }
     else
     {
@@ -513,23 +580,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
                   centroidBounds.Min()[dim] ) < (FLT_EPSILON + FLT_EPSILON) )
         {
             // Create leaf _BVHBuildNode_
-            const int firstPrimOffset = orderedPrims.size();
-
-            for( int i = start; i < end; ++i )
-            {
-                int primitiveNr = primitiveInfo[i].primitiveNumber;
-
-                wxASSERT( (primitiveNr >= 0) &&
-                          (primitiveNr < (int)m_primitives.size()) );
-
-                const COBJECT *obj = static_cast<const COBJECT *>( m_primitives[ primitiveNr ] );
-
-                wxASSERT( obj != NULL );
-
-                orderedPrims.push_back( obj );
-            }
-
-            node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+            node->InitLeaf( start, nPrimitives, bounds );
         }
         else
         {
@@ -681,18 +732,7 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
                     else
                     {
                         // Create leaf _BVHBuildNode_
-                        const int firstPrimOffset = orderedPrims.size();
-
-                        for( int i = start; i < end; ++i )
-                        {
-                            const int primitiveNr = primitiveInfo[i].primitiveNumber;
-
-                            wxASSERT( primitiveNr < (int)m_primitives.size() );
-
-                            orderedPrims.push_back( m_primitives[ primitiveNr ] );
-                        }
-
-                        node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
+                        node->InitLeaf( start, nPrimitives, bounds );
 
                         return node;
                     }
@@ -701,17 +741,26 @@ BVHBuildNode *CBVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo> &primiti
             }
             }
 
-            node->InitInterior( dim,
-                                recursiveBuild( primitiveInfo,
-                                                start,
-                                                mid,
-                                                totalNodes,
-                                                orderedPrims ),
-                                recursiveBuild( primitiveInfo,
-                                                mid,
-                                                end,
-                                                totalNodes,
-                                                orderedPrims) );
+            BVHBuildNode *children[2];
+
+#ifdef BVH_PARALLEL_BUILD
+            if( nPrimitives > BVH_TASK_MIN_PRIMITIVES )
+            {
+                #pragma omp task shared( children )
+                children[0] = recursiveBuild( aPrimitiveInfo, start, mid, totalNodes, aNodes );
+
+                children[1] = recursiveBuild( aPrimitiveInfo, mid, end, totalNodes, aNodes );
+
+                #pragma omp taskwait
+            }
+            else
+#endif
+            {
+                children[0] = recursiveBuild( aPrimitiveInfo, start, mid, totalNodes, aNodes );
+                children[1] = recursiveBuild( aPrimitiveInfo, mid, end, totalNodes, aNodes );
+            }
+
+            node->InitInterior( dim, children[0], children[1] );
         }
     }
 
@@ -733,6 +782,7 @@ BVHBuildNode *CBVH_PBRT::HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primit
     // Compute Morton indices of primitives
     std::vector<MortonPrimitive> mortonPrims( primitiveInfo.size() );
 
+    #pragma omp parallel for
     for( int i = 0; i < (int)primitiveInfo.size(); ++i )
     {
         // Initialize _mortonPrims[i]_ for _i_th primitive
@@ -758,6 +808,13 @@ BVHBuildNode *CBVH_PBRT::HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primit
 
     // Create LBVH treelets at bottom of BVH
 
+    // Nodes of all the treelets, at most 2 per primitive
+    BVHBuildNode *treeletNodes = static_cast<BVHBuildNode *>( _mm_malloc( 2 * mortonPrims.size() *
+                                                                          sizeof( BVHBuildNode ),
+                                                                          L1_CACHE_LINE_SIZE ) );
+
+    m_addresses_pointer_to_mm_free.push_back( treeletNodes );
+
     // Find intervals of primitives for each treelet
     std::vector<LBVHTreelet> treeletsToBuild;
 
@@ -771,30 +828,12 @@ BVHBuildNode *CBVH_PBRT::HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primit
         {
             // Add entry to _treeletsToBuild_ for this treelet
             const int numPrimitives = end - start;
-            const int maxBVHNodes = 2 * numPrimitives;
-
-            // !TODO: implement a memory arena
-            BVHBuildNode *nodes = static_cast<BVHBuildNode *>( _mm_malloc( maxBVHNodes *
-                                                                           sizeof( BVHBuildNode ),
-                                                                           L1_CACHE_LINE_SIZE ) );
-
-            m_addresses_pointer_to_mm_free.push_back( nodes );
-
-            for( int i = 0; i < maxBVHNodes; ++i )
-            {
-                nodes[i].bounds.Reset();
-                nodes[i].firstPrimOffset = 0;
-                nodes[i].nPrimitives = 0;
-                nodes[i].splitAxis = 0;
-                nodes[i].children[0] = NULL;
-                nodes[i].children[1] = NULL;
-            }
 
             LBVHTreelet tmpTreelet;
 
             tmpTreelet.startIndex = start;
             tmpTreelet.numPrimitives = numPrimitives;
-            tmpTreelet.buildNodes = nodes;
+            tmpTreelet.buildNodes = &treeletNodes[2 * start];
 
             treeletsToBuild.push_back( tmpTreelet );
 
@@ -804,11 +843,12 @@ BVHBuildNode *CBVH_PBRT::HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primit
 
     // Create LBVHs for treelets in parallel
     int atomicTotal = 0;
-    int orderedPrimsOffset = 0;
+    const int nTreelets = treeletsToBuild.size();
 
     orderedPrims.resize( m_primitives.size() );
 
-    for( int index = 0; index < (int)treeletsToBuild.size(); ++index )
+    #pragma omp parallel for schedule(dynamic) reduction(+:atomicTotal)
+    for( int index = 0; index < nTreelets; ++index )
     {
         // Generate _index_th LBVH treelet
         int nodesCreated = 0;
@@ -816,6 +856,9 @@ BVHBuildNode *CBVH_PBRT::HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primit
 
         LBVHTreelet &tr = treeletsToBuild[index];
 
+        // The treelets are in Morton order, as their primitives
+        int orderedPrimsOffset = tr.startIndex;
+
         wxASSERT( tr.startIndex < (int)mortonPrims.size() );
 
         tr.buildNodes = emitLBVH( tr.buildNodes,
@@ -71,6 +71,7 @@
 #define _CBVH_PBRT_H_
 
 #include "caccelerator.h"
+#include <atomic>
 #include <list>
 #include <stdint.h>
 
@@ -125,11 +126,17 @@ public:
 
 private:
 
-    BVHBuildNode *recursiveBuild( std::vector<BVHPrimitiveInfo> &primitiveInfo,
+    /**
+     * @brief recursiveBuild - builds the tree of primitiveInfo[start, end). The primitive
+     * infos are reordered in place and the leaves refer to their ranges, so the
+     * subtrees are built in parallel (OpenMP tasks) when large enough.
+     * @param aNodes - storage for the nodes, *totalNodes is the next free one
+     */
+    BVHBuildNode *recursiveBuild( std::vector<BVHPrimitiveInfo> *aPrimitiveInfo,
                                   int start,
                                   int end,
-                                  int *totalNodes,
-                                  CONST_VECTOR_OBJECT &orderedPrims );
+                                  std::atomic<int> *totalNodes,
+                                  BVHBuildNode *aNodes );
 
     BVHBuildNode *HLBVHBuild( const std::vector<BVHPrimitiveInfo> &primitiveInfo,
                               int *totalNodes,
@@ -305,12 +305,7 @@ static bool sortByCentroid_X( const COBJECT2D *a, const COBJECT2D *b )
 
 static bool sortByCentroid_Y( const COBJECT2D *a, const COBJECT2D *b )
 {
-    return a->GetCentroid()[0] < b->GetCentroid()[0];
-}
-
-static bool sortByCentroid_Z( const COBJECT2D *a, const COBJECT2D *b )
-{
-    return a->GetCentroid()[0] < b->GetCentroid()[0];
+    return a->GetCentroid()[1] < b->GetCentroid()[1];
 }
 
 void CBVHCONTAINER2D::recursiveBuild_MIDDLE_SPLIT( BVH_CONTAINER_NODE_2D *aNodeParent )
@@ -336,12 +331,10 @@ void CBVHCONTAINER2D::recursiveBuild_MIDDLE_SPLIT( BVH_CONTAINER_NODE_2D *aNodeP
         const unsigned int axis_to_split = aNodeParent->m_BBox.MaxDimension();
 
         // Divide the objects
-        switch( axis_to_split )
-        {
-            case 0: aNodeParent->m_LeafList.sort( sortByCentroid_X );
-            case 1: aNodeParent->m_LeafList.sort( sortByCentroid_Y );
-            case 2: aNodeParent->m_LeafList.sort( sortByCentroid_Z );
-        }
+        if( axis_to_split == 0 )
+            aNodeParent->m_LeafList.sort( sortByCentroid_X );
+        else
+            aNodeParent->m_LeafList.sort( sortByCentroid_Y );
 
         unsigned int i = 0;
 
@@ -217,8 +217,6 @@ void C3D_RENDER_RAYTRACING::create_3d_object_from(  CCONTAINER &aDstContainer,
 
 void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
 {
-    m_reloadRequested = false;
-
     m_model_materials.clear();
 
     COBJECT2D_STATS::Instance().ResetStats();
@@ -230,15 +228,22 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
 
     unsigned stats_startReloadTime = GetRunningMicroSecs();
 
-    m_settings.InitSettings( aStatusTextReporter );
+    // The 2D layers are updated only where the board changed, but the 3D scene
+    // and its BVH are always built again from all of them
+    LSET updatedLayers;
+    bool updatedHoles;
+    const bool fullReload = reloadSettings( aStatusTextReporter, updatedLayers, updatedHoles );
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endReloadTime = GetRunningMicroSecs();
     unsigned stats_startConvertTime = GetRunningMicroSecs();
  #endif
 
-    SFVEC3F camera_pos = m_settings.GetBoardCenter3DU();
-    m_settings.CameraGet().SetBoardLookAtPos( camera_pos );
+    if( fullReload )
+    {
+        SFVEC3F camera_pos = m_settings.GetBoardCenter3DU();
+        m_settings.CameraGet().SetBoardLookAtPos( camera_pos );
+    }
 
     // Init initial lights
     m_lights.Clear();
@@ -798,7 +803,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
 #endif
 
 
-    load_3D_models();
+    load_3D_models( aStatusTextReporter );
 
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -862,9 +867,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
     // Create an accelerator
     // /////////////////////////////////////////////////////////////////////////
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_startAcceleratorTime = GetRunningMicroSecs();
-#endif
 
     if( m_accelerator )
     {
@@ -875,9 +878,10 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
     //m_accelerator = new CGRID( m_object_container );
     m_accelerator = new CBVH_PBRT( m_object_container );
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endAcceleratorTime = GetRunningMicroSecs();
-#endif
+
+    m_stats.m_sceneBuild = stats_startAcceleratorTime - stats_startReloadTime;
+    m_stats.m_acceleratorBuild = stats_endAcceleratorTime - stats_startAcceleratorTime;
 
     setupMaterials();
 
@@ -914,8 +918,12 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
         const double calculation_time = (double)( GetRunningMicroSecs() -
                                                   stats_startReloadTime ) / 1e6;
 
-        aStatusTextReporter->Report( wxString::Format( _( "Reload time %.3f s" ),
-                                                       calculation_time ) );
+        // BVH construction time of the 2D layers and of the 3D scene
+        const double bvh_time = (double)( m_settings.GetStats_BVH2D_Build_Time() +
+                                          m_stats.m_acceleratorBuild ) / 1e6;
+
+        aStatusTextReporter->Report( wxString::Format( _( "Reload time %.3f s (BVH build %.3f s)" ),
+                                                       calculation_time, bvh_time ) );
     }
 }
 
@@ -1151,8 +1159,14 @@ void C3D_RENDER_RAYTRACING::add_3D_vias_and_pads_to_container()
 }
 
 
-void C3D_RENDER_RAYTRACING::load_3D_models()
+void C3D_RENDER_RAYTRACING::load_3D_models( REPORTER *aStatusTextReporter )
 {
+    // No cache manager when rendering outside of a project (e.g. from scripts)
+    if( !m_settings.Get3DCacheManager() )
+        return;
+
+    prefetch3DModels( aStatusTextReporter );
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
@@ -28,7 +28,9 @@
  */
 
 #include <GL/glew.h>
+#include <algorithm>
 #include <climits>
+#include <cstring>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -41,6 +43,24 @@
 #include <omp.h>
 #endif
 
+// Luminance variance of the first pass over which a block is traced again with
+// anti-aliasing by the progressive render
+#define REFINE_MIN_VARIANCE 0.0005f
+
+// Number of rows shaded at once by the post processing
+#define POST_PROCESS_ROWS 16
+
+
+struct BLOCK_VARIANCE_GREATER
+{
+    explicit BLOCK_VARIANCE_GREATER( const std::vector< float > &aVariance ) :
+        m_variance( aVariance ) {}
+
+    bool operator()( long a, long b ) const { return m_variance[a] > m_variance[b]; }
+
+    const std::vector< float > &m_variance;
+};
+
 C3D_RENDER_RAYTRACING::C3D_RENDER_RAYTRACING( CINFO3D_VISU &aSettings ) :
                        C3D_RENDER_BASE( aSettings ),
                        m_postshader_ssao( aSettings.CameraGet() )
@@ -63,6 +83,16 @@ C3D_RENDER_RAYTRACING::C3D_RENDER_RAYTRACING( CINFO3D_VISU &aSettings ) :
     m_xoffset = 0;
     m_yoffset = 0;
 
+    m_antiAliasingPasses = 3;
+    memset( &m_stats, 0, sizeof( m_stats ) );
+
+    m_progressive = true;
+    m_timeSlice = 150000;
+    m_qualityBudget = 0;
+    m_nrBlocksRenderProgress = 0;
+    m_postProcessShadeRow = 0;
+    m_postProcessBlurRow = 0;
+
     m_isPreview = false;
     m_rt_render_state = RT_RENDER_STATE_MAX; // Set to an initial invalid state
 }
@@ -91,6 +121,14 @@ int C3D_RENDER_RAYTRACING::GetWaitForEditingTimeOut()
 }
 
 
+void C3D_RENDER_RAYTRACING::SetRenderBudget( unsigned int aTimeSliceMs,
+                                             unsigned int aQualityBudgetMs )
+{
+    m_timeSlice = aTimeSliceMs * 1000;
+    m_qualityBudget = aQualityBudgetMs * 1000;
+}
+
+
 void C3D_RENDER_RAYTRACING::opengl_delete_pbo()
 {
     // Delete PBO if it was created
@@ -122,6 +160,11 @@ void C3D_RENDER_RAYTRACING::restart_render_state()
 
     m_rt_render_state = RT_RENDER_STATE_TRACING;
     m_nrBlocksRenderProgress = 0;
+    m_postProcessShadeRow = 0;
+    m_postProcessBlurRow = 0;
+
+    m_blockVariance.assign( m_blockPositions.size(), 0.0f );
+    m_blockRefineOrder.clear();
 
     m_postshader_ssao.InitFrame();
 
@@ -158,6 +201,7 @@ bool C3D_RENDER_RAYTRACING::Redraw( bool aIsMoving, REPORTER *aStatusTextReporte
         // revert to preview mode the first time the Redraw is called
         m_oldWindowsSize = m_windowSize;
         initialize_block_positions();
+        opengl_init_pbo();
     }
 
 
@@ -183,6 +227,7 @@ bool C3D_RENDER_RAYTRACING::Redraw( bool aIsMoving, REPORTER *aStatusTextReporte
         requestRedraw = true;
 
         initialize_block_positions();
+        opengl_init_pbo();
     }
 
 
@@ -290,6 +335,82 @@ bool C3D_RENDER_RAYTRACING::Redraw( bool aIsMoving, REPORTER *aStatusTextReporte
 }
 
 
+void C3D_RENDER_RAYTRACING::RenderToBuffer( const wxSize &aSize,
+                                            std::vector<GLubyte> &aRGBABuffer,
+                                            REPORTER *aStatusTextReporter )
+{
+    m_stats.m_tracing = 0;
+    m_stats.m_postProcessing = 0;
+
+    if( m_reloadRequested )
+        reload( aStatusTextReporter );
+
+    m_settings.CameraGet().SetCurWindowSize( aSize );
+
+    if( ( m_windowSize != aSize ) || m_blockPositions.empty() )
+    {
+        m_windowSize = aSize;
+        initialize_block_positions();
+    }
+
+    std::vector<GLubyte> traced( m_realBufferSize.x * m_realBufferSize.y * 4 );
+
+    // Force a restart, as the camera may have changed
+    m_rt_render_state = RT_RENDER_STATE_MAX;
+
+    // Render at full quality, in a single pass
+    const bool progressive = m_progressive;
+    m_progressive = false;
+
+    const unsigned startTracingTime = GetRunningMicroSecs();
+
+    render( &traced[0], aStatusTextReporter );
+
+    while( m_rt_render_state == RT_RENDER_STATE_TRACING )
+        render( &traced[0], aStatusTextReporter );
+
+    const unsigned startPostProcessTime = GetRunningMicroSecs();
+
+    while( m_rt_render_state != RT_RENDER_STATE_FINISH )
+        render( &traced[0], aStatusTextReporter );
+
+    const unsigned endTime = GetRunningMicroSecs();
+
+    m_progressive = progressive;
+
+    m_stats.m_tracing = startPostProcessTime - startTracingTime;
+    m_stats.m_postProcessing = endTime - startPostProcessTime;
+
+    // Place the traced buffer at its display offset, over the background
+    aRGBABuffer.resize( aSize.x * aSize.y * 4 );
+
+    for( int y = 0; y < aSize.y; ++y )
+    {
+        const float posYfactor = (float)y / (float)aSize.y;
+        const SFVEC3F bgColor = (SFVEC3F)m_settings.m_BgColorTop * SFVEC3F( posYfactor ) +
+                                (SFVEC3F)m_settings.m_BgColorBot *
+                                ( SFVEC3F( 1.0f ) - SFVEC3F( posYfactor ) );
+
+        GLubyte *ptr = &aRGBABuffer[y * aSize.x * 4];
+
+        for( int x = 0; x < aSize.x; ++x, ptr += 4 )
+        {
+            ptr[0] = (unsigned int)glm::clamp( (int)(bgColor.r * 255), 0, 255 );
+            ptr[1] = (unsigned int)glm::clamp( (int)(bgColor.g * 255), 0, 255 );
+            ptr[2] = (unsigned int)glm::clamp( (int)(bgColor.b * 255), 0, 255 );
+            ptr[3] = 255;
+        }
+    }
+
+    for( unsigned int y = 0; y < m_realBufferSize.y; ++y )
+    {
+        memcpy( &aRGBABuffer[( ( y + m_yoffset ) * aSize.x + m_xoffset ) * 4],
+                &traced[y * m_realBufferSize.x * 4],
+                m_realBufferSize.x * 4 );
+    }
+}
+
+
 void C3D_RENDER_RAYTRACING::render( GLubyte *ptrPBO , REPORTER *aStatusTextReporter )
 {
     if( (m_rt_render_state == RT_RENDER_STATE_FINISH) ||
@@ -320,6 +441,7 @@ void C3D_RENDER_RAYTRACING::render( GLubyte *ptrPBO , REPORTER *aStatusTextRepor
     switch( m_rt_render_state )
     {
     case RT_RENDER_STATE_TRACING:
+    case RT_RENDER_STATE_REFINE:
             rt_render_tracing( ptrPBO, aStatusTextReporter );
         break;
 
@@ -355,13 +477,23 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
     m_isPreview = false;
     wxASSERT( m_blockPositions.size() <= LONG_MAX );
 
-    const long nrBlocks = (long) m_blockPositions.size();
+    // On the progressive render, the first pass traces the blocks without anti-aliasing
+    // and the refine pass traces the blocks of m_blockRefineOrder again with it
+    const bool refine = ( m_rt_render_state == RT_RENDER_STATE_REFINE );
+    const bool antiAliasing = refine || !m_progressive;
+    const bool postProcess = refine &&
+                             m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING );
+
+    const long nrBlocks = refine ? (long) m_blockRefineOrder.size() :
+                                   (long) m_blockPositions.size();
     const unsigned startTime = GetRunningMicroSecs();
+    const unsigned timeSlice = m_timeSlice;
     bool breakLoop = false;
     int numBlocksRendered = 0;
 
     #pragma omp parallel for schedule(dynamic) shared(breakLoop) \
-        firstprivate(ptrPBO, nrBlocks, startTime) reduction(+:numBlocksRendered) default(none)
+        firstprivate(ptrPBO, nrBlocks, startTime, timeSlice, refine, antiAliasing, postProcess) \
+        reduction(+:numBlocksRendered) default(none)
     for( long iBlock = 0; iBlock < nrBlocks; iBlock++ )
     {
 
@@ -380,7 +512,21 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 
             if( process_block )
             {
-                rt_render_trace_block( ptrPBO, iBlock );
+                const long block = refine ? m_blockRefineOrder[iBlock] : iBlock;
+
+                rt_render_trace_block( ptrPBO, block, antiAliasing );
+
+                // The post processing was already done on the first pass; only the
+                // colors changed, so the block is blurred and finished again
+                if( postProcess )
+                {
+                    const SFVEC2UI &blockPos = m_blockPositions[block];
+
+                    rt_post_process_blur( ptrPBO, blockPos.x, blockPos.y,
+                                          blockPos.x + RAYPACKET_DIM,
+                                          blockPos.y + RAYPACKET_DIM );
+                }
+
                 numBlocksRendered++;
 
 
@@ -389,7 +535,7 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
                 #ifdef _OPENMP
                 if( omp_get_thread_num() == 0 )
                 #endif
-                    if( (GetRunningMicroSecs() - startTime) > 150000 )
+                    if( (GetRunningMicroSecs() - startTime) > timeSlice )
                     {
                         breakLoop = true;
                         #pragma omp flush(breakLoop)
@@ -401,27 +547,75 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
     m_nrBlocksRenderProgress += numBlocksRendered;
 
     if( aStatusTextReporter )
-        aStatusTextReporter->Report( wxString::Format( _( "Rendering: %.0f %%" ),
+        aStatusTextReporter->Report( wxString::Format( refine ? _( "Refining: %.0f %%" ) :
+                                                                _( "Rendering: %.0f %%" ),
                                                        (float)(m_nrBlocksRenderProgress * 100) /
-                                                       (float)nrBlocks ) );
+                                                       (float)std::max( nrBlocks, 1L ) ) );
+
+    if( refine )
+    {
+        // Leave the image as it is when the quality budget is spent
+        const bool budgetSpent = m_qualityBudget &&
+                                 ( GetRunningMicroSecs() - m_stats_start_rendering_time ) >
+                                 m_qualityBudget;
+
+        if( ( m_nrBlocksRenderProgress >= nrBlocks ) || budgetSpent )
+            m_rt_render_state = RT_RENDER_STATE_FINISH;
+
+        return;
+    }
 
     // Check if it finish the rendering and if should continue to a post processing
     // or mark it as finished
     if( m_nrBlocksRenderProgress >= nrBlocks )
     {
+        // The blocks to refine, the most detailed first
+        if( m_progressive && m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
+        {
+            for( long i = 0; i < nrBlocks; ++i )
+            {
+                if( m_blockVariance[i] > REFINE_MIN_VARIANCE )
+                    m_blockRefineOrder.push_back( i );
+            }
+
+            std::stable_sort( m_blockRefineOrder.begin(), m_blockRefineOrder.end(),
+                              BLOCK_VARIANCE_GREATER( m_blockVariance ) );
+        }
+
         if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
             m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_SHADE;
         else
-        {
-            m_rt_render_state = RT_RENDER_STATE_FINISH;
-        }
+            rt_start_refine();
     }
 }
 
 
+void C3D_RENDER_RAYTRACING::rt_start_refine()
+{
+    if( m_blockRefineOrder.empty() )
+    {
+        m_rt_render_state = RT_RENDER_STATE_FINISH;
+        return;
+    }
+
+    m_rt_render_state = RT_RENDER_STATE_REFINE;
+    m_nrBlocksRenderProgress = 0;
+
+    m_blockPositionsWasProcessed.resize( m_blockRefineOrder.size() );
+
+    std::fill( m_blockPositionsWasProcessed.begin(),
+               m_blockPositionsWasProcessed.end(),
+               false );
+}
+
+
 void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
-                                                   signed int iBlock )
+                                                   signed int iBlock,
+                                                   bool aAntiAliasing )
 {
+    const bool antiAliasing = aAntiAliasing &&
+                              m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING );
+
     // Initialize ray packets
     // /////////////////////////////////////////////////////////////////////////
     const SFVEC2UI &blockPos = m_blockPositions[iBlock];
@@ -534,6 +728,27 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
     }
 
 
+    // Luminance variance of the block, used by the progressive render to select the
+    // blocks to refine
+    // /////////////////////////////////////////////////////////////////////////
+    float lumSum = 0.0f;
+    float lumSqSum = 0.0f;
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        const float lum = hitColor[i].r * 0.2126f +
+                          hitColor[i].g * 0.7152f +
+                          hitColor[i].b * 0.0722f;
+
+        lumSum += lum;
+        lumSqSum += lum * lum;
+    }
+
+    const float lumMean = lumSum / (float)RAYPACKET_RAYS_PER_PACKET;
+
+    m_blockVariance[iBlock] = lumSqSum / (float)RAYPACKET_RAYS_PER_PACKET - lumMean * lumMean;
+
+
     // This code was a tentative to retrace the block but using small changes
     // on ray direction (to work as a random anti-aliasing)
     // but it was not producing good results with low passes,
@@ -604,7 +819,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
     // so it will reuse the nodes found on that hits
     // /////////////////////////////////////////////////////////////////////
 
-    if( m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
+    if( antiAliasing )
     {
 
         SFVEC3F hitColorAA[RAYPACKET_RAYS_PER_PACKET];
@@ -624,7 +839,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
         absDirDiff.z = glm::abs( blockPacket.m_ray[RAYPACKET_DIM + 0].m_Dir.z -
                                  blockPacket.m_ray[0].m_Dir.z ) * 0.55f;
 
-        const unsigned int number_of_passes = 3;
+        const unsigned int number_of_passes = glm::max( m_antiAliasingPasses, 1u );
 
         for( unsigned int aaPasses = 0; aaPasses < number_of_passes; ++aaPasses )
         {
@@ -768,7 +983,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
     SFVEC3F        hitColorAA[ (RAYPACKET_DIM-1) * (RAYPACKET_DIM-1) ];
     bool           hittedAA[ (RAYPACKET_DIM-1) * (RAYPACKET_DIM-1) ];
 
-    if( m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
+    if( antiAliasing )
     {
         for( unsigned int y = 0, i = 0; y < (RAYPACKET_DIM - 1); ++y )
         {
@@ -939,7 +1154,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
         {
             SFVEC3F hColor = hitColor[i];
 
-            if( m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
+            if( antiAliasing )
             {
                 SFVEC3F aaColor = bgColor[y];
 
@@ -1120,31 +1335,53 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
 void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
                                                           REPORTER *aStatusTextReporter )
 {
-    (void)ptrPBO; // unused
-
     if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
     {
-        if( aStatusTextReporter )
-            aStatusTextReporter->Report( _("Rendering: Post processing shader") );
+        const unsigned startTime = GetRunningMicroSecs();
 
-        // Compute the shader value
-        #pragma omp parallel for schedule(dynamic)
-        for( signed int y = 0; y < (int)m_realBufferSize.y; ++y )
+        // Compute the shader value, some rows at a time; the rows whose neighbors are
+        // already shaded are blurred and finished, so the result shows progressively
+        while( m_postProcessShadeRow < m_realBufferSize.y )
         {
-            SFVEC3F *ptr = &m_shaderBuffer[ y * m_realBufferSize.x ];
+            const unsigned int yEnd = std::min( m_postProcessShadeRow + POST_PROCESS_ROWS,
+                                                m_realBufferSize.y );
 
-            for( signed int x = 0; x < (int)m_realBufferSize.x; ++x )
+            #pragma omp parallel for schedule(dynamic)
+            for( signed int y = m_postProcessShadeRow; y < (int)yEnd; ++y )
             {
-                *ptr = m_postshader_ssao.Shade( SFVEC2I( x, y ) );
-                ptr++;
+                SFVEC3F *ptr = &m_shaderBuffer[ y * m_realBufferSize.x ];
+
+                for( signed int x = 0; x < (int)m_realBufferSize.x; ++x )
+                {
+                    *ptr = m_postshader_ssao.Shade( SFVEC2I( x, y ) );
+                    ptr++;
+                }
             }
+
+            m_postProcessShadeRow = yEnd;
+
+            // The blur uses the shade of the two next rows
+            if( yEnd < m_realBufferSize.y && yEnd > m_postProcessBlurRow + 2 )
+            {
+                rt_post_process_blur( ptrPBO, 0, m_postProcessBlurRow,
+                                      m_realBufferSize.x, yEnd - 2 );
+
+                m_postProcessBlurRow = yEnd - 2;
+            }
+
+            if( ( GetRunningMicroSecs() - startTime ) > m_timeSlice )
+                break;
         }
 
-        // Wait for all threads to finish
-        #pragma omp barrier
+        if( aStatusTextReporter )
+            aStatusTextReporter->Report( wxString::Format(
+                                             _( "Rendering: Post processing shader %.0f %%" ),
+                                             (float)(m_postProcessShadeRow * 100) /
+                                             (float)std::max( m_realBufferSize.y, 1u ) ) );
 
         // Set next state
-        m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
+        if( m_postProcessShadeRow >= m_realBufferSize.y )
+            m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
     }
     else
     {
@@ -1161,139 +1398,94 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
 
     if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
     {
-        // Now blurs the shader result and compute the final color
-        #pragma omp parallel for schedule(dynamic)
-        for( signed int y = 0; y < (int)m_realBufferSize.y; ++y )
-        {
-            GLubyte *ptr = &ptrPBO[ y * m_realBufferSize.x * 4 ];
-
-            SFVEC3F *ptrShaderY0 =
-                    &m_shaderBuffer[ glm::max((int)y - 2, 0) * m_realBufferSize.x ];
-            SFVEC3F *ptrShaderY1 =
-                    &m_shaderBuffer[ glm::max((int)y - 1, 0) * m_realBufferSize.x ];
-            SFVEC3F *ptrShaderY2 =
-                    &m_shaderBuffer[ y * m_realBufferSize.x ];
-            SFVEC3F *ptrShaderY3 =
-                    &m_shaderBuffer[ glm::min((int)y + 1, (int)(m_realBufferSize.y - 1)) *
-                                     m_realBufferSize.x ];
-            SFVEC3F *ptrShaderY4 =
-                    &m_shaderBuffer[ glm::min((int)y + 2, (int)(m_realBufferSize.y - 1)) *
-                                     m_realBufferSize.x ];
-
-            for( signed int x = 0; x < (int)m_realBufferSize.x; ++x )
-            {
-// This #if should be 1, it is here that can be used for debug proposes during development
-#if 1
+        // Now blurs the shader result of the remaining rows and compute the final color
+        rt_post_process_blur( ptrPBO, 0, m_postProcessBlurRow,
+                              m_realBufferSize.x, m_realBufferSize.y );
 
-                SFVEC3F bluredShadeColor = (*ptrShaderY0) * 1.0f / 273.0f +
-                                           (*ptrShaderY1) * 4.0f / 273.0f +
-                                           (*ptrShaderY2) * 7.0f / 273.0f +
-                                           (*ptrShaderY3) * 4.0f / 273.0f +
-                                           (*ptrShaderY4) * 1.0f / 273.0f;
-                if( x > 1 )
-                {
-                    ptrShaderY0++;
-                    ptrShaderY1++;
-                    ptrShaderY2++;
-                    ptrShaderY3++;
-                    ptrShaderY4++;
-                }
+        m_postProcessBlurRow = m_realBufferSize.y;
 
-                bluredShadeColor += (*ptrShaderY0) * 4.0f / 273.0f +
-                                    (*ptrShaderY1) *16.0f / 273.0f +
-                                    (*ptrShaderY2) *26.0f / 273.0f +
-                                    (*ptrShaderY3) *16.0f / 273.0f +
-                                    (*ptrShaderY4) * 4.0f / 273.0f;
+        // Debug code
+        //m_postshader_ssao.DebugBuffersOutputAsImages();
+    }
 
-                if( x > 0 )
-                {
-                    ptrShaderY0++;
-                    ptrShaderY1++;
-                    ptrShaderY2++;
-                    ptrShaderY3++;
-                    ptrShaderY4++;
-                }
+    // End rendering, or refine it
+    rt_start_refine();
+}
 
-                bluredShadeColor += (*ptrShaderY0) * 7.0f / 273.0f +
-                                    (*ptrShaderY1) *26.0f / 273.0f +
-                                    (*ptrShaderY2) *41.0f / 273.0f +
-                                    (*ptrShaderY3) *26.0f / 273.0f +
-                                    (*ptrShaderY4) * 7.0f / 273.0f;
 
-                if( x < ((int)m_realBufferSize.x - 1) )
-                {
-                    ptrShaderY0++;
-                    ptrShaderY1++;
-                    ptrShaderY2++;
-                    ptrShaderY3++;
-                    ptrShaderY4++;
-                }
+void C3D_RENDER_RAYTRACING::rt_post_process_blur( GLubyte *ptrPBO,
+                                                  unsigned int aX0, unsigned int aY0,
+                                                  unsigned int aX1, unsigned int aY1 )
+{
+    // Gaussian 5x5 kernel (/ 273), the borders of the image are extended
+    static const float kernel[5][5] = { {  1.0f,  4.0f,  7.0f,  4.0f,  1.0f },
+                                        {  4.0f, 16.0f, 26.0f, 16.0f,  4.0f },
+                                        {  7.0f, 26.0f, 41.0f, 26.0f,  7.0f },
+                                        {  4.0f, 16.0f, 26.0f, 16.0f,  4.0f },
+                                        {  1.0f,  4.0f,  7.0f,  4.0f,  1.0f } };
 
-                bluredShadeColor += (*ptrShaderY0) * 4.0f / 273.0f +
-                                    (*ptrShaderY1) *16.0f / 273.0f +
-                                    (*ptrShaderY2) *26.0f / 273.0f +
-                                    (*ptrShaderY3) *16.0f / 273.0f +
-                                    (*ptrShaderY4) * 4.0f / 273.0f;
+    const int lastX = (int)m_realBufferSize.x - 1;
+    const int lastY = (int)m_realBufferSize.y - 1;
 
-                if( x < ((int)m_realBufferSize.x - 2) )
-                {
-                    ptrShaderY0++;
-                    ptrShaderY1++;
-                    ptrShaderY2++;
-                    ptrShaderY3++;
-                    ptrShaderY4++;
-                }
+    aX1 = std::min( aX1, m_realBufferSize.x );
+    aY1 = std::min( aY1, m_realBufferSize.y );
+
+    #pragma omp parallel for schedule(dynamic) if( (aY1 - aY0) > RAYPACKET_DIM )
+    for( signed int y = aY0; y < (int)aY1; ++y )
+    {
+        GLubyte *ptr = &ptrPBO[ ( y * m_realBufferSize.x + aX0 ) * 4 ];
+
+        const SFVEC3F *ptrShaderY[5];
+
+        for( int k = 0; k < 5; ++k )
+            ptrShaderY[k] = &m_shaderBuffer[ glm::clamp( y + k - 2, 0, lastY ) *
+                                             m_realBufferSize.x ];
 
-                bluredShadeColor += (*ptrShaderY0) * 1.0f / 273.0f +
-                                    (*ptrShaderY1) * 4.0f / 273.0f +
-                                    (*ptrShaderY2) * 7.0f / 273.0f +
-                                    (*ptrShaderY3) * 4.0f / 273.0f +
-                                    (*ptrShaderY4) * 1.0f / 273.0f;
-
-                ptrShaderY0-= 3;
-                ptrShaderY1-= 3;
-                ptrShaderY2-= 3;
-                ptrShaderY3-= 3;
-                ptrShaderY4-= 3;
-
-                const float grayBluredColor = ( bluredShadeColor.r +
-                                                bluredShadeColor.g +
-                                                bluredShadeColor.b ) / 3.0f;
-
-                const SFVEC3F shadedColor = m_postshader_ssao.GetColorAtNotProtected(
-                                            SFVEC2I( x, y ) ) * ( SFVEC3F(1.0f) -
-                                                                  bluredShadeColor ) -
-                                            ( bluredShadeColor - grayBluredColor * 0.5f );
-
-                // Debug code
-                //const SFVEC3F shadedColor =  ( bluredShadeColor - grayBluredColor * 0.5f);
-                //const SFVEC3F shadedColor =  - glm::min( bluredShadeColor, SFVEC3F(0.0f) );
-                //const SFVEC3F shadedColor =  0.5f * (SFVEC3F(1.0f) - bluredShadeColor) -
-                //                             glm::min( bluredShadeColor, SFVEC3F(0.0f) );
-                //const SFVEC3F shadedColor =  bluredShadeColor;
+        for( signed int x = aX0; x < (int)aX1; ++x )
+        {
+// This #if should be 1, it is here that can be used for debug proposes during development
+#if 1
+            SFVEC3F bluredShadeColor( 0.0f );
+
+            for( int j = 0; j < 5; ++j )
+            {
+                const int xs = glm::clamp( x + j - 2, 0, lastX );
+
+                bluredShadeColor += ptrShaderY[0][xs] * kernel[j][0] / 273.0f +
+                                    ptrShaderY[1][xs] * kernel[j][1] / 273.0f +
+                                    ptrShaderY[2][xs] * kernel[j][2] / 273.0f +
+                                    ptrShaderY[3][xs] * kernel[j][3] / 273.0f +
+                                    ptrShaderY[4][xs] * kernel[j][4] / 273.0f;
+            }
+
+            const float grayBluredColor = ( bluredShadeColor.r +
+                                            bluredShadeColor.g +
+                                            bluredShadeColor.b ) / 3.0f;
+
+            const SFVEC3F shadedColor = m_postshader_ssao.GetColorAtNotProtected(
+                                        SFVEC2I( x, y ) ) * ( SFVEC3F(1.0f) -
+                                                              bluredShadeColor ) -
+                                        ( bluredShadeColor - grayBluredColor * 0.5f );
+
+            // Debug code
+            //const SFVEC3F shadedColor =  ( bluredShadeColor - grayBluredColor * 0.5f);
+            //const SFVEC3F shadedColor =  - glm::min( bluredShadeColor, SFVEC3F(0.0f) );
+            //const SFVEC3F shadedColor =  0.5f * (SFVEC3F(1.0f) - bluredShadeColor) -
+            //                             glm::min( bluredShadeColor, SFVEC3F(0.0f) );
+            //const SFVEC3F shadedColor =  bluredShadeColor;
 #else
-                // Debug code
-                //const SFVEC3F shadedColor =  SFVEC3F( 1.0f ) -
-                //                             m_shaderBuffer[ y * m_realBufferSize.x + x];
-                const SFVEC3F shadedColor =  m_shaderBuffer[ y * m_realBufferSize.x + x ];
+            // Debug code
+            //const SFVEC3F shadedColor =  SFVEC3F( 1.0f ) -
+            //                             m_shaderBuffer[ y * m_realBufferSize.x + x];
+            const SFVEC3F shadedColor =  m_shaderBuffer[ y * m_realBufferSize.x + x ];
 #endif
-                ptr[0] = (unsigned int)glm::clamp( (int)(shadedColor.r * 255), 0, 255 );
-                ptr[1] = (unsigned int)glm::clamp( (int)(shadedColor.g * 255), 0, 255 );
-                ptr[2] = (unsigned int)glm::clamp( (int)(shadedColor.b * 255), 0, 255 );
-                ptr[3] = 255;
-                ptr += 4;
-            }
+            ptr[0] = (unsigned int)glm::clamp( (int)(shadedColor.r * 255), 0, 255 );
+            ptr[1] = (unsigned int)glm::clamp( (int)(shadedColor.g * 255), 0, 255 );
+            ptr[2] = (unsigned int)glm::clamp( (int)(shadedColor.b * 255), 0, 255 );
+            ptr[3] = 255;
+            ptr += 4;
         }
-
-        // Wait for all threads to finish
-        #pragma omp barrier
-
-        // Debug code
-        //m_postshader_ssao.DebugBuffersOutputAsImages();
     }
-
-    // End rendering
-    m_rt_render_state = RT_RENDER_STATE_FINISH;
 }
 
 
@@ -2332,6 +2524,4 @@ void C3D_RENDER_RAYTRACING::initialize_block_positions()
     // Create m_shader buffer
     delete m_shaderBuffer;
     m_shaderBuffer = new SFVEC3F[m_realBufferSize.x * m_realBufferSize.y];
-
-    opengl_init_pbo();
 }
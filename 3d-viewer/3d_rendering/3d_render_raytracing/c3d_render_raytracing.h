@@ -40,6 +40,7 @@
 #include <plugins/3dapi/c3dmodel.h>
 
 #include <map>
+#include <vector>
 
 /// Vector of materials
 typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
@@ -52,10 +53,20 @@ typedef enum
     RT_RENDER_STATE_TRACING = 0,
     RT_RENDER_STATE_POST_PROCESS_SHADE,
     RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH,
+    RT_RENDER_STATE_REFINE,
     RT_RENDER_STATE_FINISH,
     RT_RENDER_STATE_MAX
 }RT_RENDER_STATE;
 
+/// Time spent in each stage of the last reload and render, in microseconds
+struct RT_RENDER_STATS
+{
+    unsigned int m_sceneBuild;          ///< board layers and 3D models to objects
+    unsigned int m_acceleratorBuild;    ///< BVH construction
+    unsigned int m_tracing;
+    unsigned int m_postProcessing;
+};
+
 class C3D_RENDER_RAYTRACING : public C3D_RENDER_BASE
 {
 public:
@@ -69,6 +80,50 @@ public:
 
     int GetWaitForEditingTimeOut();
 
+    /**
+     * @brief RenderToBuffer - render the board at full quality into a CPU frame
+     * buffer, without any OpenGL call, so it can run on machines without display
+     * or GPU. The scene is (re)built first if a reload was requested.
+     * @param aSize: size of the image, in pixels
+     * @param aRGBABuffer: receives aSize.x * aSize.y RGBA pixels, bottom row first
+     * (as the OpenGL buffers). The margins that are not traced (the ray packets
+     * cover a multiple of the packet size) are filled with the background.
+     * @param aStatusTextReporter: optional, to report the render progress
+     */
+    void RenderToBuffer( const wxSize &aSize,
+                         std::vector<GLubyte> &aRGBABuffer,
+                         REPORTER *aStatusTextReporter );
+
+    /**
+     * @brief SetAntiAliasingPasses - set the number of extra random rays traced per
+     * pixel when FL_RENDER_RAYTRACING_ANTI_ALIASING is enabled (default 3)
+     */
+    void SetAntiAliasingPasses( unsigned int aPasses ) { m_antiAliasingPasses = aPasses; }
+
+    /**
+     * @brief SetProgressiveRender - enable or disable the progressive render (enabled by
+     * default). The whole image is first traced with one ray per pixel and post
+     * processed, then the blocks with the most variance are traced again with
+     * anti-aliasing, the most detailed ones first; the flat blocks are kept as they are.
+     * RenderToBuffer always renders in a single pass.
+     */
+    void SetProgressiveRender( bool aProgressive ) { m_progressive = aProgressive; }
+
+    /**
+     * @brief SetRenderBudget - set the time budget of the render
+     * @param aTimeSliceMs: time spent rendering on each redraw before the progress is
+     * shown (default 150 ms)
+     * @param aQualityBudgetMs: time after which the refinement of the progressive render
+     * stops and the image is left as it is; 0 (default) for no limit
+     */
+    void SetRenderBudget( unsigned int aTimeSliceMs, unsigned int aQualityBudgetMs );
+
+    /**
+     * @brief GetStats - get the time spent in each stage of the last reload and
+     * RenderToBuffer
+     */
+    const RT_RENDER_STATS &GetStats() const { return m_stats; }
+
 private:
     bool initializeOpenGL();
     void initializeNewWindowSize();
@@ -80,7 +135,10 @@ private:
     void rt_render_tracing( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_post_process_shade( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_post_process_blur_finish( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
-    void rt_render_trace_block( GLubyte *ptrPBO , signed int iBlock );
+    void rt_render_trace_block( GLubyte *ptrPBO , signed int iBlock, bool aAntiAliasing );
+    void rt_post_process_blur( GLubyte *ptrPBO, unsigned int aX0, unsigned int aY0,
+                               unsigned int aX1, unsigned int aY1 );
+    void rt_start_refine();
 
     // Materials
     void setupMaterials();
@@ -112,6 +170,22 @@ private:
     /// Save the number of blocks progress of the render
     long m_nrBlocksRenderProgress;
 
+    /// Rows of the post processing already shaded and blurred
+    unsigned int m_postProcessShadeRow;
+    unsigned int m_postProcessBlurRow;
+
+    /// Progressive render: the luminance variance of each block in the first pass
+    std::vector< float > m_blockVariance;
+
+    /// Progressive render: the blocks to trace again with anti-aliasing, in order
+    std::vector< long > m_blockRefineOrder;
+
+    bool m_progressive;
+
+    /// Time budget, in microseconds
+    unsigned int m_timeSlice;
+    unsigned int m_qualityBudget;
+
     CPOSTSHADER_SSAO m_postshader_ssao;
 
     CLIGHTCONTAINER m_lights;
@@ -158,7 +232,10 @@ private:
     unsigned int m_xoffset;
     unsigned int m_yoffset;
 
+    unsigned int m_antiAliasingPasses;
+
     // Statistics
+    RT_RENDER_STATS m_stats;
     unsigned int m_stats_converted_dummy_to_plane;
     unsigned int m_stats_converted_roundsegment2d_to_roundsegment;
 
@@ -171,7 +248,7 @@ private:
     void add_3D_vias_and_pads_to_container();
     void insert3DViaHole( const VIA* aVia );
     void insert3DPadHole( const D_PAD* aPad );
-    void load_3D_models();
+    void load_3D_models( REPORTER *aStatusTextReporter );
     void add_3D_models( const S3DMODEL *a3DModel,
                         const glm::mat4 &aModelMatrix );
 
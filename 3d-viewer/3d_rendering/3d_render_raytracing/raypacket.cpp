@@ -61,6 +61,7 @@ RAYPACKET::RAYPACKET( const CCAMERA &aCamera, const SFVEC2I &aWindowsPosition )
                 m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM +                   0 ],
                 m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM + (RAYPACKET_DIM - 1) ] );
 
+    init_soa();
 }
 
 
@@ -96,6 +97,7 @@ RAYPACKET::RAYPACKET( const CCAMERA &aCamera,
                                m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM +                   0 ],
                                m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM + (RAYPACKET_DIM - 1) ] );
 
+    init_soa();
 }
 
 
@@ -128,4 +130,20 @@ RAYPACKET::RAYPACKET( const CCAMERA &aCamera,
                                m_ray[                   0 * RAYPACKET_DIM + (RAYPACKET_DIM - 1) ],
                                m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM +                   0 ],
                                m_ray[ (RAYPACKET_DIM - 1) * RAYPACKET_DIM + (RAYPACKET_DIM - 1) ] );
+
+    init_soa();
+}
+
+
+void RAYPACKET::init_soa()
+{
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            m_soa.m_Origin[axis][i] = m_ray[i].m_Origin[axis];
+            m_soa.m_Dir[axis][i]    = m_ray[i].m_Dir[axis];
+            m_soa.m_InvDir[axis][i] = m_ray[i].m_InvDir[axis];
+        }
+    }
 }
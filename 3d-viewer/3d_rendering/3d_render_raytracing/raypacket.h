@@ -40,10 +40,21 @@
 #define RAYPACKET_RAYS_PER_PACKET (RAYPACKET_DIM * RAYPACKET_DIM)
 
 
+/// Origins and directions of the rays of a packet, in structure of arrays layout
+/// (one array per axis), as read by the SIMD kernels of raypacket_simd.h
+struct RAYPACKET_SOA
+{
+    float m_Origin[3][RAYPACKET_RAYS_PER_PACKET];
+    float m_Dir[3][RAYPACKET_RAYS_PER_PACKET];
+    float m_InvDir[3][RAYPACKET_RAYS_PER_PACKET];
+};
+
+
 struct RAYPACKET
 {
     CFRUSTUM    m_Frustum;
     RAY         m_ray[RAYPACKET_RAYS_PER_PACKET];
+    RAYPACKET_SOA m_soa;
 
     RAYPACKET( const CCAMERA &aCamera,
                const SFVEC2I &aWindowsPosition );
@@ -55,6 +66,9 @@ struct RAYPACKET
     RAYPACKET( const CCAMERA &aCamera,
                const SFVEC2I &aWindowsPosition,
                unsigned int aPixelMultiple );
+
+private:
+    void init_soa();
 };
 
 
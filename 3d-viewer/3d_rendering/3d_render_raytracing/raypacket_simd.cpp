@@ -0,0 +1,465 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  raypacket_simd.cpp
+ * @brief SIMD intersection kernels for ray packets
+ */
+
+#include "raypacket_simd.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is part of all x86-64 processors, so it is used without run time check.
+// AVX is compiled for the functions that need it only (gcc target attribute), and
+// used if the processor supports it.
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define RAYPACKET_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( RAYPACKET_HAVE_SSE2 ) && defined( __GNUC__ ) && !defined( __clang__ ) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#define RAYPACKET_HAVE_AVX
+#include <immintrin.h>
+#define AVX_FUNCTION __attribute__(( target( "avx" ) ))
+#endif
+
+
+static_assert( RAYPACKET_RAYS_PER_PACKET <= 64, "RAYPACKET_MASK holds 64 rays" );
+static_assert( RAYPACKET_RAYS_PER_PACKET % 8 == 0, "kernels process 8 rays at a time" );
+
+
+// Relative tolerances of the conservative tests
+#define BBOX_EPSILON        1e-5f
+#define TRIANGLE_EPSILON    1e-4f
+
+
+// Box enlarged by BBOX_EPSILON of its size
+static void enlargedBox( const CBBOX &aBBox, float aMin[3], float aMax[3] )
+{
+    for( unsigned int axis = 0; axis < 3; ++axis )
+    {
+        const float pad = ( aBBox.Max()[axis] - aBBox.Min()[axis] ) * BBOX_EPSILON +
+                          FLT_EPSILON * std::max( std::abs( aBBox.Min()[axis] ),
+                                                  std::abs( aBBox.Max()[axis] ) );
+
+        aMin[axis] = aBBox.Min()[axis] - pad;
+        aMax[axis] = aBBox.Max()[axis] + pad;
+    }
+}
+
+
+// Scalar kernels
+// /////////////////////////////////////////////////////////////////////////////
+
+static RAYPACKET_MASK intersectBBoxScalar( const RAYPACKET_SOA &aRays,
+                                           const float aMin[3], const float aMax[3],
+                                           RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        if( !( aMask & ( (RAYPACKET_MASK) 1 << i ) ) )
+            continue;
+
+        float tNear = -FLT_MAX;
+        float tFar = FLT_MAX;
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            const float t1 = ( aMin[axis] - aRays.m_Origin[axis][i] ) * aRays.m_InvDir[axis][i];
+            const float t2 = ( aMax[axis] - aRays.m_Origin[axis][i] ) * aRays.m_InvDir[axis][i];
+
+            tNear = std::max( tNear, std::min( t1, t2 ) );
+            tFar = std::min( tFar, std::max( t1, t2 ) );
+        }
+
+        if( ( tFar >= std::max( tNear, 0.0f ) ) && ( tNear < aTHit[i] ) )
+            result |= (RAYPACKET_MASK) 1 << i;
+    }
+
+    return result;
+}
+
+
+static RAYPACKET_MASK intersectTriangleScalar( const RAYPACKET_SOA &aRays,
+                                               const RAYPACKET_TRIANGLE &aTri,
+                                               RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        if( !( aMask & ( (RAYPACKET_MASK) 1 << i ) ) )
+            continue;
+
+        const float Dk = aRays.m_Dir[aTri.k][i];
+        const float Du = aRays.m_Dir[aTri.ku][i];
+        const float Dv = aRays.m_Dir[aTri.kv][i];
+        const float Ok = aRays.m_Origin[aTri.k][i];
+        const float Ou = aRays.m_Origin[aTri.ku][i];
+        const float Ov = aRays.m_Origin[aTri.kv][i];
+
+        const float t = ( aTri.nd - Ok - aTri.nu * Ou - aTri.nv * Ov ) /
+                        ( Dk + aTri.nu * Du + aTri.nv * Dv );
+
+        if( !( ( t > 0.0f ) && ( t < aTHit[i] * ( 1.0f + TRIANGLE_EPSILON ) ) ) )
+            continue;
+
+        const float hu = Ou + t * Du - aTri.au;
+        const float hv = Ov + t * Dv - aTri.av;
+        const float beta = hv * aTri.bnu + hu * aTri.bnv;
+        const float gamma = hu * aTri.cnu + hv * aTri.cnv;
+
+        if( ( beta >= -TRIANGLE_EPSILON ) && ( gamma >= -TRIANGLE_EPSILON ) &&
+            ( ( beta + gamma ) <= ( 1.0f + TRIANGLE_EPSILON ) ) )
+            result |= (RAYPACKET_MASK) 1 << i;
+    }
+
+    return result;
+}
+
+
+// SSE2 kernels, 4 rays at a time
+// /////////////////////////////////////////////////////////////////////////////
+
+#ifdef RAYPACKET_HAVE_SSE2
+
+static RAYPACKET_MASK intersectBBoxSSE2( const RAYPACKET_SOA &aRays,
+                                         const float aMin[3], const float aMax[3],
+                                         RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    const __m128 zero = _mm_setzero_ps();
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; i += 4 )
+    {
+        if( !( ( aMask >> i ) & 0xF ) )
+            continue;
+
+        __m128 tNear = _mm_set1_ps( -FLT_MAX );
+        __m128 tFar = _mm_set1_ps( FLT_MAX );
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            const __m128 org = _mm_loadu_ps( &aRays.m_Origin[axis][i] );
+            const __m128 invDir = _mm_loadu_ps( &aRays.m_InvDir[axis][i] );
+
+            const __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aMin[axis] ), org ), invDir );
+            const __m128 t2 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aMax[axis] ), org ), invDir );
+
+            tNear = _mm_max_ps( tNear, _mm_min_ps( t1, t2 ) );
+            tFar = _mm_min_ps( tFar, _mm_max_ps( t1, t2 ) );
+        }
+
+        const __m128 hit = _mm_and_ps( _mm_cmpge_ps( tFar, _mm_max_ps( tNear, zero ) ),
+                                       _mm_cmplt_ps( tNear, _mm_loadu_ps( &aTHit[i] ) ) );
+
+        result |= (RAYPACKET_MASK) _mm_movemask_ps( hit ) << i;
+    }
+
+    return result & aMask;
+}
+
+
+static RAYPACKET_MASK intersectTriangleSSE2( const RAYPACKET_SOA &aRays,
+                                             const RAYPACKET_TRIANGLE &aTri,
+                                             RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    const __m128 nu = _mm_set1_ps( aTri.nu );
+    const __m128 nv = _mm_set1_ps( aTri.nv );
+    const __m128 nd = _mm_set1_ps( aTri.nd );
+    const __m128 au = _mm_set1_ps( aTri.au );
+    const __m128 av = _mm_set1_ps( aTri.av );
+    const __m128 bnu = _mm_set1_ps( aTri.bnu );
+    const __m128 bnv = _mm_set1_ps( aTri.bnv );
+    const __m128 cnu = _mm_set1_ps( aTri.cnu );
+    const __m128 cnv = _mm_set1_ps( aTri.cnv );
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minBarycentric = _mm_set1_ps( -TRIANGLE_EPSILON );
+    const __m128 maxBarycentric = _mm_set1_ps( 1.0f + TRIANGLE_EPSILON );
+    const __m128 tHitFactor = _mm_set1_ps( 1.0f + TRIANGLE_EPSILON );
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; i += 4 )
+    {
+        if( !( ( aMask >> i ) & 0xF ) )
+            continue;
+
+        const __m128 Dk = _mm_loadu_ps( &aRays.m_Dir[aTri.k][i] );
+        const __m128 Du = _mm_loadu_ps( &aRays.m_Dir[aTri.ku][i] );
+        const __m128 Dv = _mm_loadu_ps( &aRays.m_Dir[aTri.kv][i] );
+        const __m128 Ok = _mm_loadu_ps( &aRays.m_Origin[aTri.k][i] );
+        const __m128 Ou = _mm_loadu_ps( &aRays.m_Origin[aTri.ku][i] );
+        const __m128 Ov = _mm_loadu_ps( &aRays.m_Origin[aTri.kv][i] );
+
+        const __m128 den = _mm_add_ps( Dk, _mm_add_ps( _mm_mul_ps( nu, Du ),
+                                                       _mm_mul_ps( nv, Dv ) ) );
+        const __m128 num = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( nd, Ok ), _mm_mul_ps( nu, Ou ) ),
+                                       _mm_mul_ps( nv, Ov ) );
+        const __m128 t = _mm_div_ps( num, den );
+
+        __m128 valid = _mm_and_ps( _mm_cmpgt_ps( t, zero ),
+                                   _mm_cmplt_ps( t, _mm_mul_ps( _mm_loadu_ps( &aTHit[i] ),
+                                                                tHitFactor ) ) );
+
+        if( !_mm_movemask_ps( valid ) )
+            continue;
+
+        const __m128 hu = _mm_sub_ps( _mm_add_ps( Ou, _mm_mul_ps( t, Du ) ), au );
+        const __m128 hv = _mm_sub_ps( _mm_add_ps( Ov, _mm_mul_ps( t, Dv ) ), av );
+        const __m128 beta = _mm_add_ps( _mm_mul_ps( hv, bnu ), _mm_mul_ps( hu, bnv ) );
+        const __m128 gamma = _mm_add_ps( _mm_mul_ps( hu, cnu ), _mm_mul_ps( hv, cnv ) );
+
+        valid = _mm_and_ps( valid, _mm_cmpge_ps( beta, minBarycentric ) );
+        valid = _mm_and_ps( valid, _mm_cmpge_ps( gamma, minBarycentric ) );
+        valid = _mm_and_ps( valid, _mm_cmple_ps( _mm_add_ps( beta, gamma ), maxBarycentric ) );
+
+        result |= (RAYPACKET_MASK) _mm_movemask_ps( valid ) << i;
+    }
+
+    return result & aMask;
+}
+
+#endif // RAYPACKET_HAVE_SSE2
+
+
+// AVX kernels, 8 rays at a time
+// /////////////////////////////////////////////////////////////////////////////
+
+#ifdef RAYPACKET_HAVE_AVX
+
+AVX_FUNCTION
+static RAYPACKET_MASK intersectBBoxAVX( const RAYPACKET_SOA &aRays,
+                                        const float aMin[3], const float aMax[3],
+                                        RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    const __m256 zero = _mm256_setzero_ps();
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; i += 8 )
+    {
+        if( !( ( aMask >> i ) & 0xFF ) )
+            continue;
+
+        __m256 tNear = _mm256_set1_ps( -FLT_MAX );
+        __m256 tFar = _mm256_set1_ps( FLT_MAX );
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            const __m256 org = _mm256_loadu_ps( &aRays.m_Origin[axis][i] );
+            const __m256 invDir = _mm256_loadu_ps( &aRays.m_InvDir[axis][i] );
+
+            const __m256 t1 = _mm256_mul_ps( _mm256_sub_ps( _mm256_set1_ps( aMin[axis] ), org ),
+                                             invDir );
+            const __m256 t2 = _mm256_mul_ps( _mm256_sub_ps( _mm256_set1_ps( aMax[axis] ), org ),
+                                             invDir );
+
+            tNear = _mm256_max_ps( tNear, _mm256_min_ps( t1, t2 ) );
+            tFar = _mm256_min_ps( tFar, _mm256_max_ps( t1, t2 ) );
+        }
+
+        const __m256 hit = _mm256_and_ps(
+                _mm256_cmp_ps( tFar, _mm256_max_ps( tNear, zero ), _CMP_GE_OQ ),
+                _mm256_cmp_ps( tNear, _mm256_loadu_ps( &aTHit[i] ), _CMP_LT_OQ ) );
+
+        result |= (RAYPACKET_MASK) _mm256_movemask_ps( hit ) << i;
+    }
+
+    return result & aMask;
+}
+
+
+AVX_FUNCTION
+static RAYPACKET_MASK intersectTriangleAVX( const RAYPACKET_SOA &aRays,
+                                            const RAYPACKET_TRIANGLE &aTri,
+                                            RAYPACKET_MASK aMask, const float *aTHit )
+{
+    RAYPACKET_MASK result = 0;
+
+    const __m256 nu = _mm256_set1_ps( aTri.nu );
+    const __m256 nv = _mm256_set1_ps( aTri.nv );
+    const __m256 nd = _mm256_set1_ps( aTri.nd );
+    const __m256 au = _mm256_set1_ps( aTri.au );
+    const __m256 av = _mm256_set1_ps( aTri.av );
+    const __m256 bnu = _mm256_set1_ps( aTri.bnu );
+    const __m256 bnv = _mm256_set1_ps( aTri.bnv );
+    const __m256 cnu = _mm256_set1_ps( aTri.cnu );
+    const __m256 cnv = _mm256_set1_ps( aTri.cnv );
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 minBarycentric = _mm256_set1_ps( -TRIANGLE_EPSILON );
+    const __m256 maxBarycentric = _mm256_set1_ps( 1.0f + TRIANGLE_EPSILON );
+    const __m256 tHitFactor = _mm256_set1_ps( 1.0f + TRIANGLE_EPSILON );
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; i += 8 )
+    {
+        if( !( ( aMask >> i ) & 0xFF ) )
+            continue;
+
+        const __m256 Dk = _mm256_loadu_ps( &aRays.m_Dir[aTri.k][i] );
+        const __m256 Du = _mm256_loadu_ps( &aRays.m_Dir[aTri.ku][i] );
+        const __m256 Dv = _mm256_loadu_ps( &aRays.m_Dir[aTri.kv][i] );
+        const __m256 Ok = _mm256_loadu_ps( &aRays.m_Origin[aTri.k][i] );
+        const __m256 Ou = _mm256_loadu_ps( &aRays.m_Origin[aTri.ku][i] );
+        const __m256 Ov = _mm256_loadu_ps( &aRays.m_Origin[aTri.kv][i] );
+
+        const __m256 den = _mm256_add_ps( Dk, _mm256_add_ps( _mm256_mul_ps( nu, Du ),
+                                                             _mm256_mul_ps( nv, Dv ) ) );
+        const __m256 num = _mm256_sub_ps( _mm256_sub_ps( _mm256_sub_ps( nd, Ok ),
+                                                         _mm256_mul_ps( nu, Ou ) ),
+                                          _mm256_mul_ps( nv, Ov ) );
+        const __m256 t = _mm256_div_ps( num, den );
+
+        __m256 valid = _mm256_and_ps(
+                _mm256_cmp_ps( t, zero, _CMP_GT_OQ ),
+                _mm256_cmp_ps( t, _mm256_mul_ps( _mm256_loadu_ps( &aTHit[i] ), tHitFactor ),
+                               _CMP_LT_OQ ) );
+
+        if( !_mm256_movemask_ps( valid ) )
+            continue;
+
+        const __m256 hu = _mm256_sub_ps( _mm256_add_ps( Ou, _mm256_mul_ps( t, Du ) ), au );
+        const __m256 hv = _mm256_sub_ps( _mm256_add_ps( Ov, _mm256_mul_ps( t, Dv ) ), av );
+        const __m256 beta = _mm256_add_ps( _mm256_mul_ps( hv, bnu ), _mm256_mul_ps( hu, bnv ) );
+        const __m256 gamma = _mm256_add_ps( _mm256_mul_ps( hu, cnu ), _mm256_mul_ps( hv, cnv ) );
+
+        valid = _mm256_and_ps( valid, _mm256_cmp_ps( beta, minBarycentric, _CMP_GE_OQ ) );
+        valid = _mm256_and_ps( valid, _mm256_cmp_ps( gamma, minBarycentric, _CMP_GE_OQ ) );
+        valid = _mm256_and_ps( valid, _mm256_cmp_ps( _mm256_add_ps( beta, gamma ),
+                                                     maxBarycentric, _CMP_LE_OQ ) );
+
+        result |= (RAYPACKET_MASK) _mm256_movemask_ps( valid ) << i;
+    }
+
+    return result & aMask;
+}
+
+#endif // RAYPACKET_HAVE_AVX
+
+
+// Run time dispatch
+// /////////////////////////////////////////////////////////////////////////////
+
+static RAYPACKET_SIMD bestSimdLevel()
+{
+#ifdef RAYPACKET_HAVE_AVX
+    __builtin_cpu_init();
+
+    // also checks that the OS saves the AVX registers
+    if( __builtin_cpu_supports( "avx" ) )
+        return RAYPACKET_SIMD_AVX;
+#endif
+
+#ifdef RAYPACKET_HAVE_SSE2
+    return RAYPACKET_SIMD_SSE2;
+#else
+    return RAYPACKET_SIMD_SCALAR;
+#endif
+}
+
+
+static const RAYPACKET_SIMD s_bestSimdLevel = bestSimdLevel();
+static RAYPACKET_SIMD       s_simdLevel = s_bestSimdLevel;
+
+
+RAYPACKET_SIMD RAYPACKET_SimdLevel()
+{
+    return s_simdLevel;
+}
+
+
+RAYPACKET_SIMD RAYPACKET_SetSimdLevel( RAYPACKET_SIMD aLevel )
+{
+    s_simdLevel = std::min( aLevel, s_bestSimdLevel );
+
+    return s_simdLevel;
+}
+
+
+const char* RAYPACKET_SimdName( RAYPACKET_SIMD aLevel )
+{
+    switch( aLevel )
+    {
+    case RAYPACKET_SIMD_SSE2:   return "SSE2";
+    case RAYPACKET_SIMD_AVX:    return "AVX";
+    default:                    return "scalar";
+    }
+}
+
+
+RAYPACKET_MASK RAYPACKET_IntersectBBox( const RAYPACKET &aPacket,
+                                        const CBBOX &aBBox,
+                                        RAYPACKET_MASK aRays,
+                                        const float *aTHit )
+{
+    float bmin[3];
+    float bmax[3];
+
+    enlargedBox( aBBox, bmin, bmax );
+
+    switch( s_simdLevel )
+    {
+#ifdef RAYPACKET_HAVE_AVX
+    case RAYPACKET_SIMD_AVX:
+        return intersectBBoxAVX( aPacket.m_soa, bmin, bmax, aRays, aTHit );
+#endif
+
+#ifdef RAYPACKET_HAVE_SSE2
+    case RAYPACKET_SIMD_SSE2:
+        return intersectBBoxSSE2( aPacket.m_soa, bmin, bmax, aRays, aTHit );
+#endif
+
+    default:
+        return intersectBBoxScalar( aPacket.m_soa, bmin, bmax, aRays, aTHit );
+    }
+}
+
+
+RAYPACKET_MASK RAYPACKET_IntersectTriangle( const RAYPACKET &aPacket,
+                                            const RAYPACKET_TRIANGLE &aTriangle,
+                                            RAYPACKET_MASK aRays,
+                                            const float *aTHit )
+{
+    switch( s_simdLevel )
+    {
+#ifdef RAYPACKET_HAVE_AVX
+    case RAYPACKET_SIMD_AVX:
+        return intersectTriangleAVX( aPacket.m_soa, aTriangle, aRays, aTHit );
+#endif
+
+#ifdef RAYPACKET_HAVE_SSE2
+    case RAYPACKET_SIMD_SSE2:
+        return intersectTriangleSSE2( aPacket.m_soa, aTriangle, aRays, aTHit );
+#endif
+
+    default:
+        return intersectTriangleScalar( aPacket.m_soa, aTriangle, aRays, aTHit );
+    }
+}
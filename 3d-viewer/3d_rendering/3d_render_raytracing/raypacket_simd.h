@@ -0,0 +1,136 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  raypacket_simd.h
+ * @brief SIMD intersection kernels testing the rays of a RAYPACKET 4 (SSE2) or
+ * 8 (AVX) at a time. The instruction set is chosen at run time, with a scalar
+ * fallback.
+ */
+
+#ifndef _RAYPACKET_SIMD_H_
+#define _RAYPACKET_SIMD_H_
+
+#include <stdint.h>
+#include "raypacket.h"
+#include "shapes3D/cbbox.h"
+
+
+/// A set of rays of a RAYPACKET, bit i standing for the ray i
+typedef uint64_t RAYPACKET_MASK;
+
+#define RAYPACKET_MASK_ALL  ( ~(RAYPACKET_MASK) 0 )
+
+/// Mask of the rays aFirst ... RAYPACKET_RAYS_PER_PACKET - 1
+#define RAYPACKET_MASK_FROM( aFirst ) \
+    ( ( aFirst ) < RAYPACKET_RAYS_PER_PACKET ? RAYPACKET_MASK_ALL << ( aFirst ) : 0 )
+
+
+enum RAYPACKET_SIMD
+{
+    RAYPACKET_SIMD_SCALAR = 0,
+    RAYPACKET_SIMD_SSE2,
+    RAYPACKET_SIMD_AVX
+};
+
+
+/// Triangle constants used by the packet kernel, as precomputed by CTRIANGLE
+struct RAYPACKET_TRIANGLE
+{
+    unsigned int    k, ku, kv;      ///< projection axis, and the two other axis
+    float           nu, nv, nd;
+    float           au, av;         ///< first vertex, on the ku and kv axis
+    float           bnu, bnv;
+    float           cnu, cnv;
+};
+
+
+/**
+ * Function RAYPACKET_SimdLevel
+ * @return the instruction set used by the kernels: the best one supported by the
+ * processor, unless changed by RAYPACKET_SetSimdLevel()
+ */
+RAYPACKET_SIMD RAYPACKET_SimdLevel();
+
+/**
+ * Function RAYPACKET_SetSimdLevel
+ * selects the instruction set used by the kernels (for benchmarks and tests).
+ * It is lowered to the best one supported if needed. Not thread safe.
+ * @return the instruction set now in use
+ */
+RAYPACKET_SIMD RAYPACKET_SetSimdLevel( RAYPACKET_SIMD aLevel );
+
+/**
+ * Function RAYPACKET_SimdName
+ * @return the name of an instruction set, for reports
+ */
+const char* RAYPACKET_SimdName( RAYPACKET_SIMD aLevel );
+
+/**
+ * Function RAYPACKET_IntersectBBox
+ * tests the rays aRays of the packet against a box (slab test).
+ * The box is slightly enlarged, so the test never misses a hit of CBBOX::Intersect().
+ * @param aTHit - the current hit distance of each ray of the packet
+ * @return the rays of aRays entering the box closer than their current hit
+ */
+RAYPACKET_MASK RAYPACKET_IntersectBBox( const RAYPACKET &aPacket,
+                                        const CBBOX &aBBox,
+                                        RAYPACKET_MASK aRays,
+                                        const float *aTHit );
+
+/**
+ * Function RAYPACKET_IntersectTriangle
+ * tests the rays aRays of the packet against a triangle, the same way
+ * CTRIANGLE::Intersect() does. The test is conservative (small tolerance on the
+ * barycentric coordinates and the distance, no back face culling): the hits must
+ * be confirmed by CTRIANGLE::Intersect().
+ * @param aTHit - the current hit distance of each ray of the packet
+ * @return the rays of aRays that may hit the triangle closer than their current hit
+ */
+RAYPACKET_MASK RAYPACKET_IntersectTriangle( const RAYPACKET &aPacket,
+                                            const RAYPACKET_TRIANGLE &aTriangle,
+                                            RAYPACKET_MASK aRays,
+                                            const float *aTHit );
+
+/**
+ * Function RAYPACKET_FirstRay
+ * @return the index of the first ray of a non empty mask
+ */
+inline unsigned int RAYPACKET_FirstRay( RAYPACKET_MASK aRays )
+{
+#if defined( __GNUC__ )
+    return __builtin_ctzll( aRays );
+#else
+    unsigned int i = 0;
+
+    while( !( aRays & 1 ) )
+    {
+        aRays >>= 1;
+        ++i;
+    }
+
+    return i;
+#endif
+}
+
+#endif // _RAYPACKET_SIMD_H_
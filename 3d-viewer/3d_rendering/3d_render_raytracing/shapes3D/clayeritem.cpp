@@ -443,6 +443,18 @@ bool CLAYERITEM::IntersectP(const RAY &aRay , float aMaxDistance ) const
 }
 
 
+RAYPACKET_MASK CLAYERITEM::IntersectPacket( const RAYPACKET &aPacket,
+                                            RAYPACKET_MASK aRays,
+                                            const float *aTHit,
+                                            HITINFO_PACKET *aHitInfoPacket ) const
+{
+    // Most of the rays reaching a layer item miss its box, skip them in one pass
+    const RAYPACKET_MASK candidates = RAYPACKET_IntersectBBox( aPacket, m_bbox, aRays, aTHit );
+
+    return COBJECT::IntersectPacket( aPacket, candidates, aTHit, aHitInfoPacket );
+}
+
+
 bool CLAYERITEM::Intersects( const CBBOX &aBBox ) const
 {
     if( !m_bbox.Intersects( aBBox ) )
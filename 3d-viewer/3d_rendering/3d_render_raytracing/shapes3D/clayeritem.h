@@ -48,6 +48,10 @@ public:
     // Imported from COBJECT
     bool Intersect( const RAY &aRay, HITINFO &aHitInfo ) const;
     bool IntersectP(const RAY &aRay , float aMaxDistance ) const;
+    RAYPACKET_MASK IntersectPacket( const RAYPACKET &aPacket,
+                                    RAYPACKET_MASK aRays,
+                                    const float *aTHit,
+                                    HITINFO_PACKET *aHitInfoPacket ) const;
     bool Intersects( const CBBOX &aBBox ) const;
     SFVEC3F GetDiffuseColor( const HITINFO &aHitInfo ) const;
 
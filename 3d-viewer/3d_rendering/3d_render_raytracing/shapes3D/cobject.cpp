@@ -43,6 +43,29 @@ COBJECT::COBJECT( OBJECT3D_TYPE aObjType )
 }
 
 
+RAYPACKET_MASK COBJECT::IntersectPacket( const RAYPACKET &aPacket,
+                                         RAYPACKET_MASK aRays,
+                                         const float *aTHit,
+                                         HITINFO_PACKET *aHitInfoPacket ) const
+{
+    (void)aTHit; // Intersect() reads it from the hit information
+
+    RAYPACKET_MASK hits = 0;
+
+    while( aRays )
+    {
+        const unsigned int i = RAYPACKET_FirstRay( aRays );
+
+        aRays &= aRays - 1;
+
+        if( Intersect( aPacket.m_ray[i], aHitInfoPacket[i].m_HitInfo ) )
+            hits |= (RAYPACKET_MASK) 1 << i;
+    }
+
+    return hits;
+}
+
+
 static const char *OBJECT3D_STR[OBJ3D_MAX] =
 {
     "OBJ3D_CYLINDER",
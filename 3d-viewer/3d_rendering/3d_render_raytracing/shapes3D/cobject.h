@@ -33,6 +33,7 @@
 #include "cbbox.h"
 #include "../hitinfo.h"
 #include "../cmaterial.h"
+#include "../raypacket_simd.h"
 
 
 enum OBJECT3D_TYPE
@@ -90,6 +91,21 @@ public:
      */
     virtual bool IntersectP( const RAY &aRay, float aMaxDistance ) const = 0;
 
+    /** Function IntersectPacket
+     * @brief IntersectPacket - intersects the rays aRays of a packet, as Intersect()
+     * does for each of them. The default implementation tests the rays one at a time,
+     * objects having a SIMD kernel override it.
+     * @param aPacket
+     * @param aRays - the rays to test
+     * @param aTHit - the current hit distance of each ray of the packet
+     * @param aHitInfoPacket - the hit information of each ray, updated for the rays that hit
+     * @return the rays that intersect the object
+     */
+    virtual RAYPACKET_MASK IntersectPacket( const RAYPACKET &aPacket,
+                                            RAYPACKET_MASK aRays,
+                                            const float *aTHit,
+                                            HITINFO_PACKET *aHitInfoPacket ) const;
+
     const CBBOX &GetBBox() const { return m_bbox; }
 
     const SFVEC3F &GetCentroid() const { return m_centroid; }
@@ -311,6 +311,34 @@ bool CTRIANGLE::IntersectP( const RAY &aRay,
 }
 
 
+RAYPACKET_MASK CTRIANGLE::IntersectPacket( const RAYPACKET &aPacket,
+                                           RAYPACKET_MASK aRays,
+                                           const float *aTHit,
+                                           HITINFO_PACKET *aHitInfoPacket ) const
+{
+    RAYPACKET_TRIANGLE triangle;
+
+    triangle.k   = m_k;
+    triangle.ku  = s_modulo[m_k + 1];
+    triangle.kv  = s_modulo[m_k + 2];
+    triangle.nu  = m_nu;
+    triangle.nv  = m_nv;
+    triangle.nd  = m_nd;
+    triangle.au  = m_vertex[0][triangle.ku];
+    triangle.av  = m_vertex[0][triangle.kv];
+    triangle.bnu = m_bnu;
+    triangle.bnv = m_bnv;
+    triangle.cnu = m_cnu;
+    triangle.cnv = m_cnv;
+
+    // The kernel only selects the candidates, the hits are computed by Intersect()
+    const RAYPACKET_MASK candidates = RAYPACKET_IntersectTriangle( aPacket, triangle,
+                                                                   aRays, aTHit );
+
+    return COBJECT::IntersectPacket( aPacket, candidates, aTHit, aHitInfoPacket );
+}
+
+
 bool CTRIANGLE::Intersects( const CBBOX &aBBox ) const
 {
     //!TODO: improove
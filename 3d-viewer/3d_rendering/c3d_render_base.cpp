@@ -29,6 +29,8 @@
 
 
 #include "c3d_render_base.h"
+#include <class_board.h>
+#include <class_module.h>
 
 
 /**
@@ -47,6 +49,8 @@ C3D_RENDER_BASE::C3D_RENDER_BASE(CINFO3D_VISU &aSettings) :
     m_is_opengl_initialized = false;
     m_windowSize            = wxSize( -1, -1 );
     m_reloadRequested       = true;
+    m_reloadFull            = true;
+    m_updatedHoles          = false;
 }
 
 
@@ -54,3 +58,65 @@ C3D_RENDER_BASE::~C3D_RENDER_BASE()
 {
 }
 
+
+void C3D_RENDER_BASE::UpdateRequest( const LSET &aLayers, bool aHoles )
+{
+    m_reloadRequested = true;
+
+    if( m_reloadFull )
+        return;
+
+    m_updatedLayers |= aLayers;
+    m_updatedHoles  |= aHoles;
+}
+
+
+bool C3D_RENDER_BASE::reloadSettings( REPORTER *aStatusTextReporter, LSET &aUpdatedLayers,
+                                      bool &aUpdatedHoles )
+{
+    bool full = m_reloadFull;
+
+    if( full )
+        m_settings.InitSettings( aStatusTextReporter );
+    else
+        full = !m_settings.UpdateLayers( m_updatedLayers, m_updatedHoles, aStatusTextReporter );
+
+    aUpdatedLayers = m_updatedLayers;
+    aUpdatedHoles  = m_updatedHoles;
+
+    m_reloadRequested = false;
+    m_reloadFull      = false;
+    m_updatedLayers.reset();
+    m_updatedHoles    = false;
+
+    return full;
+}
+
+
+void C3D_RENDER_BASE::prefetch3DModels( REPORTER *aStatusTextReporter, bool aLODs )
+{
+    S3D_CACHE *cacheMgr = m_settings.Get3DCacheManager();
+
+    if( !cacheMgr )
+        return;
+
+    std::list<wxString> modelFiles;
+
+    for( const MODULE* module = m_settings.GetBoard()->m_Modules;
+         module;
+         module = module->Next() )
+    {
+        if( !m_settings.ShouldModuleBeDisplayed( (MODULE_ATTR_T)module->GetAttributes() ) )
+            continue;
+
+        for( std::list<S3D_INFO>::const_iterator sM = module->Models().begin();
+             sM != module->Models().end();
+             ++sM )
+        {
+            if( !sM->m_Filename.empty() )
+                modelFiles.push_back( sM->m_Filename );
+        }
+    }
+
+    cacheMgr->PrefetchModels( modelFiles, aStatusTextReporter, aLODs );
+}
@@ -70,7 +70,15 @@ public:
      * @brief ReloadRequest - !TODO: this must be reviewed to add flags to
      * improve specific render
      */
-    void ReloadRequest() { m_reloadRequested = true; }
+    void ReloadRequest() { m_reloadRequested = true; m_reloadFull = true; }
+
+    /**
+     * @brief UpdateRequest - Ask to reload only the given layers on the next
+     * redraw, after a board edit. It has no effect if a full reload is already pending.
+     * @param aLayers: the layers changed by the edit
+     * @param aHoles: true if the edit changed vias or pad holes
+     */
+    void UpdateRequest( const LSET &aLayers, bool aHoles );
 
     /**
      * @brief IsReloadRequestPending - Query if there is a pending reload request
@@ -86,6 +94,28 @@ public:
      */
     virtual int GetWaitForEditingTimeOut() = 0;
 
+protected:
+
+    /**
+     * @brief reloadSettings - Convert again the board in the settings, all of it
+     * or only the layers given by UpdateRequest, and clear the reload request.
+     * @param aStatusTextReporter: a pointer to the status progress reporter
+     * @param aUpdatedLayers: returns the layers converted again, on a partial reload
+     * @param aUpdatedHoles: returns true if the holes were converted again, on a
+     * partial reload
+     * @return true if the whole board was converted again
+     */
+    bool reloadSettings( REPORTER *aStatusTextReporter, LSET &aUpdatedLayers,
+                         bool &aUpdatedHoles );
+
+    /**
+     * @brief prefetch3DModels - Load in the 3D cache, in parallel, the models of
+     * the modules to be displayed, before the render builds its own data from them.
+     * @param aStatusTextReporter: a pointer to the status progress reporter
+     * @param aLODs: true to also make the levels of detail of the models
+     */
+    void prefetch3DModels( REPORTER *aStatusTextReporter, bool aLODs = false );
+
     // Attributes
 
 protected:
@@ -99,6 +129,13 @@ protected:
     /// !TODO: this must be reviewed in order to flag change types
     bool m_reloadRequested;
 
+    /// true if the pending reload must convert again the whole board
+    bool m_reloadFull;
+
+    /// layers and holes to convert again on a partial reload
+    LSET m_updatedLayers;
+    bool m_updatedHoles;
+
     /// The window size that this camera is working.
     wxSize m_windowSize;
 
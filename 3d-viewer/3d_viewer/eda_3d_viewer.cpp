@@ -234,6 +234,13 @@ void EDA_3D_VIEWER::ReloadRequest()
 }
 
 
+void EDA_3D_VIEWER::UpdateRequest( const LSET &aLayers, bool aHoles )
+{
+    if( m_canvas )
+        m_canvas->UpdateRequest( GetBoard(), aLayers, aHoles );
+}
+
+
 void EDA_3D_VIEWER::Exit3DFrame( wxCommandEvent &event )
 {
     wxLogTrace( m_logTrace, wxT( "EDA_3D_VIEWER::Exit3DFrame" ) );
@@ -65,6 +65,14 @@ class EDA_3D_VIEWER : public KIWAY_PLAYER
 
     void ReloadRequest();
 
+    /**
+     * @brief UpdateRequest - Schedule a reload of only the given layers, after
+     * a board edit that did not change the board outline.
+     * @param aLayers: the layers changed by the edit
+     * @param aHoles: true if the edit changed vias or pad holes
+     */
+    void UpdateRequest( const LSET &aLayers, bool aHoles );
+
     // !TODO: review this function
     // !TODO: this need a way to tell what changed to the reload will only
     // change the things on a need base
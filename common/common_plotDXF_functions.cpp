@@ -41,6 +41,29 @@
  */
 static const double DXF_OBLIQUE_ANGLE = 15;
 
+/// Number of digits after the point of the coordinates and sizes (in mm)
+static const int DXF_DECIMALS = 6;
+
+
+/**
+ * Helper function writeGroup
+ * writes the group code aCode and its value aValue
+ */
+static void writeGroup( PLOT_OUTPUT_BUFFER& aOut, const char* aCode, double aValue )
+{
+    aOut.Write( aCode );
+    aOut.WriteChar( '\n' );
+    aOut.WriteDouble( aValue, DXF_DECIMALS );
+    aOut.WriteChar( '\n' );
+}
+
+
+void DXF_PLOTTER::setCurrentColor( EDA_COLOR_T aColor )
+{
+    m_currentColor = aColor;
+    m_currentLayerName = TO_UTF8( wxString( ColorGetName( aColor ) ) );
+}
+
 /**
  * Set the scale/position for the DXF plot
  * The DXF engine doesn't support line widths and mirroring. The output
@@ -68,7 +91,7 @@ void DXF_PLOTTER::SetViewport( const wxPoint& aOffset, double aIusPerDecimil,
 
     SetDefaultLineWidth( 0 );               // No line width on DXF
     m_plotMirror = false;                     // No mirroring on DXF
-    m_currentColor = BLACK;
+    setCurrentColor( BLACK );
 }
 
 /**
@@ -78,68 +101,69 @@ bool DXF_PLOTTER::StartPlot()
 {
     wxASSERT( outputFile );
 
+    m_out.SetFile( outputFile );
+
     // DXF HEADER - Boilerplate
     // Defines the minimum for drawing i.e. the angle system and the
     // continuous linetype
-    fputs( "  0\n"
-           "SECTION\n"
-           "  2\n"
-           "HEADER\n"
-           "  9\n"
-           "$ANGBASE\n"
-           "  50\n"
-           "0.0\n"
-           "  9\n"
-           "$ANGDIR\n"
-           "  70\n"
-           "  1\n"
-           "  9\n"
-           "$MEASUREMENT\n"
-           "  70\n"
-           "0\n"
-           "  0\n"              // This means 'metric units'
-           "ENDSEC\n"
-           "  0\n"
-           "SECTION\n"
-           "  2\n"
-           "TABLES\n"
-           "  0\n"
-           "TABLE\n"
-           "  2\n"
-           "LTYPE\n"
-           "  70\n"
-           "1\n"
-           "  0\n"
-           "LTYPE\n"
-           "  2\n"
-           "CONTINUOUS\n"
-           "  70\n"
-           "0\n"
-           "  3\n"
-           "Solid line\n"
-           "  72\n"
-           "65\n"
-           "  73\n"
-           "0\n"
-           "  40\n"
-           "0.0\n"
-           "  0\n"
-           "ENDTAB\n",
-            outputFile );
+    m_out.Write( "  0\n"
+                 "SECTION\n"
+                 "  2\n"
+                 "HEADER\n"
+                 "  9\n"
+                 "$ANGBASE\n"
+                 "  50\n"
+                 "0.0\n"
+                 "  9\n"
+                 "$ANGDIR\n"
+                 "  70\n"
+                 "  1\n"
+                 "  9\n"
+                 "$MEASUREMENT\n"
+                 "  70\n"
+                 "0\n"
+                 "  0\n"              // This means 'metric units'
+                 "ENDSEC\n"
+                 "  0\n"
+                 "SECTION\n"
+                 "  2\n"
+                 "TABLES\n"
+                 "  0\n"
+                 "TABLE\n"
+                 "  2\n"
+                 "LTYPE\n"
+                 "  70\n"
+                 "1\n"
+                 "  0\n"
+                 "LTYPE\n"
+                 "  2\n"
+                 "CONTINUOUS\n"
+                 "  70\n"
+                 "0\n"
+                 "  3\n"
+                 "Solid line\n"
+                 "  72\n"
+                 "65\n"
+                 "  73\n"
+                 "0\n"
+                 "  40\n"
+                 "0.0\n"
+                 "  0\n"
+                 "ENDTAB\n" );
 
     // Text styles table
     // Defines 4 text styles, one for each bold/italic combination
-    fputs( "  0\n"
-           "TABLE\n"
-           "  2\n"
-           "STYLE\n"
-           "  70\n"
-           "4\n", outputFile );
+    m_out.Write( "  0\n"
+                 "TABLE\n"
+                 "  2\n"
+                 "STYLE\n"
+                 "  70\n"
+                 "4\n" );
 
     static const char *style_name[4] = {"KICAD", "KICADB", "KICADI", "KICADBI"};
     for(int i = 0; i < 4; i++ )
     {
-        fprintf( outputFile,
+        m_out.Printf(
                  "  0\n"
                  "STYLE\n"
                  "  2\n"
@@ -166,7 +190,7 @@ bool DXF_PLOTTER::StartPlot()
 
 
     // Layer table - one layer per color
-    fprintf( outputFile,
+    m_out.Printf(
              "  0\n"
              "ENDTAB\n"
              "  0\n"
@@ -228,7 +252,7 @@ bool DXF_PLOTTER::StartPlot()
 
     for( EDA_COLOR_T i = BLACK; i < NBCOLORS; i = NextColor(i) )
     {
-        fprintf( outputFile,
+        m_out.Printf(
                  "  0\n"
                  "LAYER\n"
                  "  2\n"
@@ -243,14 +267,14 @@ bool DXF_PLOTTER::StartPlot()
     }
 
     // End of layer table, begin entities
-    fputs( "  0\n"
-           "ENDTAB\n"
-           "  0\n"
-           "ENDSEC\n"
-           "  0\n"
-           "SECTION\n"
-           "  2\n"
-           "ENTITIES\n", outputFile );
+    m_out.Write( "  0\n"
+                 "ENDTAB\n"
+                 "  0\n"
+                 "ENDSEC\n"
+                 "  0\n"
+                 "SECTION\n"
+                 "  2\n"
+                 "ENTITIES\n" );
 
     return true;
 }
@@ -261,10 +285,11 @@ bool DXF_PLOTTER::EndPlot()
     wxASSERT( outputFile );
 
     // DXF FOOTER
-    fputs( "  0\n"
-           "ENDSEC\n"
-           "  0\n"
-           "EOF\n", outputFile );
+    m_out.Write( "  0\n"
+                 "ENDSEC\n"
+                 "  0\n"
+                 "EOF\n" );
+    m_out.SetFile( NULL );      // flush the buffer
     fclose( outputFile );
     outputFile = NULL;
 
@@ -282,10 +307,10 @@ void DXF_PLOTTER::SetColor( EDA_COLOR_T color )
        || ( color == BLACK )
        || ( color == WHITE ) )
     {
-        m_currentColor = color;
+        setCurrentColor( color );
     }
     else
-        m_currentColor = BLACK;
+        setCurrentColor( BLACK );
 }
 
 /**
@@ -315,26 +340,36 @@ void DXF_PLOTTER::Circle( const wxPoint& centre, int diameter, FILL_T fill, int
     DPOINT centre_dev = userToDeviceCoordinates( centre );
     if( radius > 0 )
     {
-        wxString cname( ColorGetName( m_currentColor ) );
         if (!fill)
         {
-            fprintf( outputFile, "0\nCIRCLE\n8\n%s\n10\n%g\n20\n%g\n40\n%g\n",
-                    TO_UTF8( cname ),
-                    centre_dev.x, centre_dev.y, radius );
+            m_out.Write( "0\nCIRCLE\n8\n" );
+            m_out.Write( m_currentLayerName );
+            m_out.WriteChar( '\n' );
+            writeGroup( m_out, "10", centre_dev.x );
+            writeGroup( m_out, "20", centre_dev.y );
+            writeGroup( m_out, "40", radius );
         }
         if (fill == FILLED_SHAPE)
         {
             double r = radius*0.5;
-            fprintf( outputFile, "0\nPOLYLINE\n");
-            fprintf( outputFile, "8\n%s\n66\n1\n70\n1\n", TO_UTF8( cname ));
-            fprintf( outputFile, "40\n%g\n41\n%g\n", radius, radius);
-            fprintf( outputFile, "0\nVERTEX\n8\n%s\n", TO_UTF8( cname ));
-            fprintf( outputFile, "10\n%g\n 20\n%g\n42\n1.0\n",
-                    centre_dev.x-r, centre_dev.y );
-            fprintf( outputFile, "0\nVERTEX\n8\n%s\n", TO_UTF8( cname ));
-            fprintf( outputFile, "10\n%g\n 20\n%g\n42\n1.0\n",
-                    centre_dev.x+r, centre_dev.y );
-            fprintf( outputFile, "0\nSEQEND\n");
+            m_out.Write( "0\nPOLYLINE\n8\n" );
+            m_out.Write( m_currentLayerName );
+            m_out.Write( "\n66\n1\n70\n1\n" );
+            writeGroup( m_out, "40", radius );
+            writeGroup( m_out, "41", radius );
+            m_out.Write( "0\nVERTEX\n8\n" );
+            m_out.Write( m_currentLayerName );
+            m_out.WriteChar( '\n' );
+            writeGroup( m_out, "10", centre_dev.x-r );
+            writeGroup( m_out, " 20", centre_dev.y );
+            m_out.Write( "42\n1.0\n" );
+            m_out.Write( "0\nVERTEX\n8\n" );
+            m_out.Write( m_currentLayerName );
+            m_out.WriteChar( '\n' );
+            writeGroup( m_out, "10", centre_dev.x+r );
+            writeGroup( m_out, " 20", centre_dev.y );
+            m_out.Write( "42\n1.0\n" );
+            m_out.Write( "0\nSEQEND\n" );
         }
     }
 }
@@ -462,10 +497,13 @@ void DXF_PLOTTER::PenTo( const wxPoint& pos, char plume )
     if( penLastpos != pos && plume == 'D' )
     {
         // DXF LINE
-        wxString cname( ColorGetName( m_currentColor ) );
-        fprintf( outputFile, "0\nLINE\n8\n%s\n10\n%g\n20\n%g\n11\n%g\n21\n%g\n",
-                 TO_UTF8( cname ),
-                 pen_lastpos_dev.x, pen_lastpos_dev.y, pos_dev.x, pos_dev.y );
+        m_out.Write( "0\nLINE\n8\n" );
+        m_out.Write( m_currentLayerName );
+        m_out.WriteChar( '\n' );
+        writeGroup( m_out, "10", pen_lastpos_dev.x );
+        writeGroup( m_out, "20", pen_lastpos_dev.y );
+        writeGroup( m_out, "11", pos_dev.x );
+        writeGroup( m_out, "21", pos_dev.y );
     }
     penLastpos = pos;
 }
@@ -509,12 +547,14 @@ void DXF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
     double radius_dev = userToDeviceSize( radius );
 
     // Emit a DXF ARC entity
-    wxString cname( ColorGetName( m_currentColor ) );
-    fprintf( outputFile,
-             "0\nARC\n8\n%s\n10\n%g\n20\n%g\n40\n%g\n50\n%g\n51\n%g\n",
-             TO_UTF8( cname ),
-             centre_dev.x, centre_dev.y, radius_dev,
-             StAngle / 10.0, EndAngle / 10.0 );
+    m_out.Write( "0\nARC\n8\n" );
+    m_out.Write( m_currentLayerName );
+    m_out.WriteChar( '\n' );
+    writeGroup( m_out, "10", centre_dev.x );
+    writeGroup( m_out, "20", centre_dev.y );
+    writeGroup( m_out, "40", radius_dev );
+    writeGroup( m_out, "50", StAngle / 10.0 );
+    writeGroup( m_out, "51", EndAngle / 10.0 );
 }
 
 /**
@@ -728,7 +768,6 @@ void DXF_PLOTTER::Text( const wxPoint&              aPos,
            more useful as a CAD object */
         DPOINT origin_dev = userToDeviceCoordinates( aPos );
         SetColor( aColor );
-        wxString cname( ColorGetName( m_currentColor ) );
         DPOINT size_dev = userToDeviceSize( aSize );
         int h_code = 0, v_code = 0;
         switch( aH_justify )
@@ -759,7 +798,7 @@ void DXF_PLOTTER::Text( const wxPoint&              aPos,
         // Position, size, rotation and alignment
         // The two alignment point usages is somewhat idiot (see the DXF ref)
         // Anyway since we don't use the fit/aligned options, they're the same
-        fprintf( outputFile,
+        m_out.Printf(
                 "  0\n"
                 "TEXT\n"
                 "  7\n"
@@ -790,7 +829,7 @@ void DXF_PLOTTER::Text( const wxPoint&              aPos,
                 "%d\n",         // V alignment
                 aBold ? (aItalic ? "KICADBI" : "KICADB")
                       : (aItalic ? "KICADI" : "KICAD"),
-                TO_UTF8( cname ),
+                m_currentLayerName.c_str(),
                 origin_dev.x, origin_dev.x,
                 origin_dev.y, origin_dev.y,
                 size_dev.y, fabs( size_dev.x / size_dev.y ),
@@ -822,36 +861,36 @@ void DXF_PLOTTER::Text( const wxPoint&              aPos,
          */
 
         bool overlining = false;
-        fputs( "  1\n", outputFile );
+        m_out.Write( "  1\n" );
         for( unsigned i = 0; i < aText.length(); i++ )
         {
             /* Here I do a bad thing: writing the output one byte at a time!
                but today I'm lazy and I have no idea on how to coerce a Unicode
                wxString to spit out latin1 encoded text ...
 
-               Atleast stdio is *supposed* to do output buffering, so there is
-               hope is not too slow */
+               Atleast the output is buffered, so there is hope is not
+               too slow */
             wchar_t ch = aText[i];
             if( ch > 255 )
             {
                 // I can't encode this...
-                putc( '?', outputFile );
+                m_out.WriteChar( '?' );
             }
             else
             {
                 if( ch == '~' )
                 {
                     // Handle the overline toggle
-                    fputs( overlining ? "%%o" : "%%O", outputFile );
+                    m_out.Write( overlining ? "%%o" : "%%O" );
                     overlining = !overlining;
                 }
                 else
                 {
-                    putc( ch, outputFile );
+                    m_out.WriteChar( ch );
                 }
             }
         }
-        putc( '\n', outputFile );
+        m_out.WriteChar( '\n' );
     }
 }
 
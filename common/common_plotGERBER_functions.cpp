@@ -41,10 +41,14 @@
 #include <build_version.h>
 
 
+// The body of the file is kept in memory up to this size, and then moved to a work file
+#define GERBER_BODY_BUFFER_SIZE ( 32 * 1024 * 1024 )
+
+
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
     workFile  = 0;
-    finalFile = 0;
+    m_bodyLimit = GERBER_BODY_BUFFER_SIZE;
     currentAperture = apertures.end();
 
     // number of digits after the point (number of digits of the mantissa
@@ -96,28 +100,72 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 
 void GERBER_PLOTTER::emitDcode( const DPOINT& pt, int dcode )
 {
+    // "X%dY%dD%02d*\n"
+    char  line[48];
+    char* text = line;
+
+    *text++ = 'X';
+    text = PLOT_OUTPUT_BUFFER::FormatInt( text, KiROUND( pt.x ) );
+    *text++ = 'Y';
+    text = PLOT_OUTPUT_BUFFER::FormatInt( text, KiROUND( pt.y ) );
+    *text++ = 'D';
+
+    if( dcode < 10 )
+        *text++ = '0';
+
+    text = PLOT_OUTPUT_BUFFER::FormatInt( text, dcode );
+    *text++ = '*';
+    *text++ = '\n';
 
-    fprintf( outputFile, "X%dY%dD%02d*\n",
-	    KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    writeBody( line, text - line );
 }
 
 
-bool GERBER_PLOTTER::StartPlot()
+void GERBER_PLOTTER::writeBody( const char* aText, size_t aLength )
 {
-    wxASSERT( outputFile );
+    m_body.append( aText, aLength );
 
-    finalFile = outputFile;     // the actual gerber file will be created later
+    // if the work file cannot be written, keep the body in memory
+    if( m_body.size() >= m_bodyLimit && !spillBody() )
+        m_bodyLimit *= 2;
+}
 
-    // Create a temporary filename to store gerber file
-    // note tmpfile() does not work under Vista and W7 in user mode
-    m_workFilename = filename + wxT(".tmp");
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
-    outputFile = workFile;
-    wxASSERT( outputFile );
 
-    if( outputFile == NULL )
+bool GERBER_PLOTTER::spillBody()
+{
+    if( !workFile )
+    {
+        // note tmpfile() does not work under Vista and W7 in user mode
+        m_workFilename = filename + wxT( ".tmp" );
+        workFile = wxFopen( m_workFilename, wxT( "w+b" ) );
+
+        if( !workFile )
+            return false;
+    }
+
+    if( fwrite( m_body.data(), 1, m_body.size(), workFile ) != m_body.size() )
         return false;
 
+    m_body.clear();
+
+    return true;
+}
+
+
+bool GERBER_PLOTTER::StartPlot()
+{
+    wxASSERT( outputFile );
+
+    // The header is written to the file now, the aperture list is known only at the end
+    // of the plot: the body is kept in m_body (and in a work file if it is too large)
+    // until EndPlot().
+    m_body.clear();
+    m_body.reserve( 1024 * 1024 );
+    m_bodyLimit = GERBER_BODY_BUFFER_SIZE;
+    apertures.clear();
+    m_apertureIndex.clear();
+    currentAperture = apertures.end();
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -164,38 +212,47 @@ bool GERBER_PLOTTER::StartPlot()
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
-
     wxASSERT( outputFile );
 
-    /* Outfile is actually a temporary file i.e. workFile */
-    fputs( "M02*\n", outputFile );
-    fflush( outputFile );
+    bool success = true;
 
-    fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
-    wxASSERT( workFile );
-    outputFile = finalFile;
+    writeBody( "M02*\n" );
 
     // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
+
+    // Then the body: the part moved to the work file, and the remaining one
+    if( workFile )
     {
-        fputs( line, outputFile );
+        char   buffer[64 * 1024];
+        size_t count;
 
-        if( strcmp( strtok( line, "\n\r" ), "G04 APERTURE LIST*" ) == 0 )
-        {
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
+        fflush( workFile );
+        fseek( workFile, 0, SEEK_SET );
+
+        while( ( count = fread( buffer, 1, sizeof( buffer ), workFile ) ) > 0 )
+            fwrite( buffer, 1, count, outputFile );
+
+        success = !ferror( workFile );
+
+        fclose( workFile );
+        workFile = 0;
+        ::wxRemoveFile( m_workFilename );
     }
 
-    fclose( workFile );
-    fclose( finalFile );
-    ::wxRemoveFile( m_workFilename );
+    if( fwrite( m_body.data(), 1, m_body.size(), outputFile ) != m_body.size() )
+        success = false;
+
+    // release the buffer
+    std::string().swap( m_body );
+
+    if( fclose( outputFile ) != 0 )
+        success = false;
+
     outputFile = 0;
 
-    return true;
+    return success;
 }
 
 
@@ -223,26 +280,22 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int width )
 std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize&           size,
                                                              APERTURE::APERTURE_TYPE type )
 {
-    int last_D_code = 9;
-
     // Search an existing aperture
-    std::vector<APERTURE>::iterator tool = apertures.begin();
+    APERTURE_KEY key = { type, size.x, size.y };
 
-    while( tool != apertures.end() )
-    {
-        last_D_code = tool->DCode;
+    std::unordered_map<APERTURE_KEY, int, APERTURE_KEY_HASH>::const_iterator it =
+            m_apertureIndex.find( key );
 
-        if( (tool->Type == type) && (tool->Size == size) )
-            return tool;
+    if( it != m_apertureIndex.end() )
+        return apertures.begin() + it->second;
 
-        tool++;
-    }
-
-    // Allocate a new aperture
+    // Allocate a new aperture; the D codes are allocated in sequence from 10
     APERTURE new_tool;
     new_tool.Size  = size;
     new_tool.Type  = type;
-    new_tool.DCode = last_D_code + 1;
+    new_tool.DCode = apertures.empty() ? 10 : apertures.back().DCode + 1;
+
+    m_apertureIndex[key] = apertures.size();
     apertures.push_back( new_tool );
     return apertures.end() - 1;
 }
@@ -259,7 +312,16 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           size,
     {
         // Pick an existing aperture or create a new one
         currentAperture = getAperture( size, type );
-        fprintf( outputFile, "D%d*\n", currentAperture->DCode );
+
+        char  line[16];
+        char* text = line;
+
+        *text++ = 'D';
+        text = PLOT_OUTPUT_BUFFER::FormatInt( text, currentAperture->DCode );
+        *text++ = '*';
+        *text++ = '\n';
+
+        writeBody( line, text - line );
     }
 }
 
@@ -377,17 +439,20 @@ void GERBER_PLOTTER::Arc( const wxPoint& aCenter, double aStAngle, double aEndAn
     DPOINT devEnd = userToDeviceCoordinates( end );
     DPOINT devCenter = userToDeviceCoordinates( aCenter ) - userToDeviceCoordinates( start );
 
-    fprintf( outputFile, "G75*\n" ); // Multiquadrant mode
+    char line[128];
+
+    writeBody( "G75*\n" ); // Multiquadrant mode
 
     if( aStAngle < aEndAngle )
-        fprintf( outputFile, "G03" );
+        writeBody( "G03" );
     else
-        fprintf( outputFile, "G02" );
+        writeBody( "G02" );
 
-    fprintf( outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
-    fprintf( outputFile, "G01*\n" ); // Back to linear interp.
+    int len = snprintf( line, sizeof( line ), "X%dY%dI%dJ%dD01*\n",
+                        KiROUND( devEnd.x ), KiROUND( devEnd.y ),
+                        KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
+    writeBody( line, len );
+    writeBody( "G01*\n" ); // Back to linear interp.
 }
 
 
@@ -405,7 +470,7 @@ void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
 
     if( aFill )
     {
-        fputs( "G36*\n", outputFile );
+        writeBody( "G36*\n" );
 
         MoveTo( aCornerList[0] );
 
@@ -413,7 +478,7 @@ void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
             LineTo( aCornerList[ii] );
 
         FinishTo( aCornerList[0] );
-        fputs( "G37*\n", outputFile );
+        writeBody( "G37*\n" );
     }
 
     if( aWidth > 0 )
@@ -433,6 +498,50 @@ void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
 }
 
 
+void GERBER_PLOTTER::PlotRegions( const SHAPE_POLY_SET& aPolygons )
+{
+    wxASSERT( outputFile );
+
+    for( int ii = 0; ii < aPolygons.OutlineCount(); ii++ )
+    {
+        if( aPolygons.HoleCount( ii ) > 0 )
+        {
+            // A region is a simple contour: join the holes to the outlines
+            SHAPE_POLY_SET fractured = aPolygons;
+            fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+            PlotRegions( fractured );
+            return;
+        }
+    }
+
+    for( int ii = 0; ii < aPolygons.OutlineCount(); ii++ )
+    {
+        const SHAPE_LINE_CHAIN& outline = aPolygons.COutline( ii );
+
+        if( outline.PointCount() < 3 )
+            continue;
+
+        writeBody( "G36*\n" );
+
+        const VECTOR2I& start = outline.CPoint( 0 );
+        emitDcode( userToDeviceCoordinates( wxPoint( start.x, start.y ) ), 2 );
+
+        for( int jj = 1; jj < outline.PointCount(); jj++ )
+        {
+            const VECTOR2I& corner = outline.CPoint( jj );
+            emitDcode( userToDeviceCoordinates( wxPoint( corner.x, corner.y ) ), 1 );
+        }
+
+        // Close the contour
+        emitDcode( userToDeviceCoordinates( wxPoint( start.x, start.y ) ), 1 );
+
+        writeBody( "G37*\n" );
+    }
+
+    penState = 'Z';
+}
+
+
 void GERBER_PLOTTER::FlashPadCircle( const wxPoint& pos, int diametre, EDA_DRAW_MODE_T trace_mode )
 {
     wxASSERT( outputFile );
@@ -654,7 +763,7 @@ void GERBER_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos,  const wxPoint* aCo
 void GERBER_PLOTTER::SetLayerPolarity( bool aPositive )
 {
     if( aPositive )
-        fprintf( outputFile, "%%LPD*%%\n" );
+        writeBody( "%LPD*%\n" );
     else
-        fprintf( outputFile, "%%LPC*%%\n" );
+        writeBody( "%LPC*%\n" );
 }
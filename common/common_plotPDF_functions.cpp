@@ -27,6 +27,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <fctsys.h>
 #include <pgm_base.h>
 #include <trigo.h>
@@ -40,6 +44,11 @@
 #include <wx/mstream.h>
 
 
+// In parallel stream mode, the raw page streams waiting to be compressed are flushed
+// when they use more memory than this
+#define PDF_PENDING_STREAMS_MAX_SIZE ( 64 * 1024 * 1024 )
+
+
 /*
  * Open or create the plot file aFullFilename
  * return true if success, false if the file cannot be created/opened
@@ -430,19 +439,20 @@ void PDF_PLOTTER::closePdfObject()
  * Pass -1 (default) for a fresh object. Especially from PDF 1.5 streams
  * can contain a lot of things, but for the moment we only handle page
  * content.
+ * The object itself is written by closePdfStream(), once compressed.
  */
 int PDF_PLOTTER::startPdfStream(int handle)
 {
     wxASSERT( outputFile );
     wxASSERT( !workFile );
-    handle = startPdfObject( handle );
 
-    // This is guaranteed to be handle+1 but needs to be allocated since
-    // you could allocate more object during stream preparation
+    if( handle < 0 )
+        handle = allocPdfObject();
+
+    streamHandle = handle;
+
+    // The length is deferred: it's the next object
     streamLengthHandle = allocPdfObject();
-    fprintf( outputFile,
-             "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
-             "stream\n", handle + 1 );
 
     // Open a temporary file to accumulate the stream
     workFilename = filename + wxT(".tmp");
@@ -453,7 +463,8 @@ int PDF_PLOTTER::startPdfStream(int handle)
 
 
 /**
- * Finish the current PDF stream (writes the deferred length, too)
+ * Finish the current PDF stream: compress it and write it with its deferred length,
+ * or keep it for flushPendingStreams() in parallel mode
  */
 void PDF_PLOTTER::closePdfStream()
 {
@@ -467,21 +478,51 @@ void PDF_PLOTTER::closePdfStream()
         return;
     }
 
-    // Rewind the file, read in the page stream and DEFLATE it
+    PDF_STREAM stream;
+    stream.handle = streamHandle;
+    stream.lengthHandle = streamLengthHandle;
+
+    // Rewind the file and read in the page stream
     fseek( workFile, 0, SEEK_SET );
-    unsigned char *inbuf = new unsigned char[stream_len];
+    stream.data.resize( stream_len );
 
-    int rc = fread( inbuf, 1, stream_len, workFile );
-    wxASSERT( rc == stream_len );
-    (void) rc;
+    if( stream_len > 0 )
+    {
+        int rc = fread( &stream.data[0], 1, stream_len, workFile );
+        wxASSERT( rc == stream_len );
+        (void) rc;
+    }
 
     // We are done with the temporary file, junk it
     fclose( workFile );
     workFile = 0;
     ::wxRemoveFile( workFilename );
 
+    if( !parallelStreams )
+    {
+        deflateStream( stream.data, compressionLevel );
+        writePdfStream( stream );
+        return;
+    }
+
+#ifdef USE_OPENMP
+    unsigned batchSize = omp_get_max_threads();
+#else
+    unsigned batchSize = 1;
+#endif /* USE_OPENMP */
+
+    pendingStreamsSize += stream.data.size();
+    pendingStreams.push_back( std::move( stream ) );
+
+    if( pendingStreams.size() >= batchSize || pendingStreamsSize > PDF_PENDING_STREAMS_MAX_SIZE )
+        flushPendingStreams();
+}
+
+
+void PDF_PLOTTER::deflateStream( std::string& aData, int aLevel )
+{
     // NULL means memos owns the memory, but provide a hint on optimum size needed.
-    wxMemoryOutputStream    memos( NULL, std::max( 2000l, stream_len ) ) ;
+    wxMemoryOutputStream    memos( NULL, std::max( (size_t) 2000, aData.size() ) ) ;
 
     {
         /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
@@ -491,29 +532,57 @@ void PDF_PLOTTER::closePdfStream()
          *                    8, Z_DEFAULT_STRATEGY );
          */
 
-        wxZlibOutputStream      zos( memos, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB );
-
-        zos.Write( inbuf, stream_len );
+        wxZlibOutputStream      zos( memos, aLevel, wxZLIB_ZLIB );
 
-        delete[] inbuf;
+        zos.Write( aData.data(), aData.size() );
 
     }   // flush the zip stream using zos destructor
 
     wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
 
-    unsigned out_count = sb->Tell();
+    aData.assign( (const char*) sb->GetBufferStart(), sb->Tell() );
+}
+
+
+void PDF_PLOTTER::writePdfStream( const PDF_STREAM& aStream )
+{
+    startPdfObject( aStream.handle );
+    fprintf( outputFile,
+             "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
+             "stream\n", aStream.lengthHandle );
 
-    fwrite( sb->GetBufferStart(), 1, out_count, outputFile );
+    fwrite( aStream.data.data(), 1, aStream.data.size(), outputFile );
 
     fputs( "endstream\n", outputFile );
     closePdfObject();
 
     // Writing the deferred length as an indirect object
-    startPdfObject( streamLengthHandle );
-    fprintf( outputFile, "%u\n", out_count );
+    startPdfObject( aStream.lengthHandle );
+    fprintf( outputFile, "%u\n", (unsigned) aStream.data.size() );
     closePdfObject();
 }
 
+
+void PDF_PLOTTER::flushPendingStreams()
+{
+    int count = pendingStreams.size();
+    int ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 ) private( ii )
+#endif /* USE_OPENMP */
+    for( ii = 0; ii < count; ii++ )
+        deflateStream( pendingStreams[ii].data, compressionLevel );
+
+    // The objects are written in order, so the xref table stays right
+    for( ii = 0; ii < count; ii++ )
+        writePdfStream( pendingStreams[ii] );
+
+    pendingStreams.clear();
+    pendingStreamsSize = 0;
+}
+
+
 /**
  * Starts a new page in the PDF document
  */
@@ -624,6 +693,9 @@ bool PDF_PLOTTER::EndPlot()
     // Close the current page (often the only one)
     ClosePage();
 
+    // and write the page streams still waiting for compression
+    flushPendingStreams();
+
     /* We need to declare the resources we're using (fonts in particular)
        The useful standard one is the Helvetica family. Adding external fonts
        is *very* involved! */
@@ -100,6 +100,24 @@
 #include <kicad_string.h>
 
 
+// Number of digits after the point of the sizes and coordinates in device units (decimils)
+static const int SVG_DECIMALS = 4;
+
+
+/**
+ * Helper function writeAttr
+ * writes the attribute ' aName="aValue"', the value being in device units
+ */
+static void writeAttr( PLOT_OUTPUT_BUFFER& aOut, const char* aName, double aValue )
+{
+    aOut.WriteChar( ' ' );
+    aOut.Write( aName );
+    aOut.Write( "=\"", 2 );
+    aOut.WriteDouble( aValue, SVG_DECIMALS );
+    aOut.WriteChar( '"' );
+}
+
+
 
 /**
  * Function XmlEsc
@@ -166,6 +184,7 @@ SVG_PLOTTER::SVG_PLOTTER()
     m_pen_rgb_color = 0;                // current color value (black)
     m_brush_rgb_color = 0;              // current color value (black)
     m_dashed = false;
+    m_pathOpen = false;
 }
 
 
@@ -206,38 +225,59 @@ void SVG_PLOTTER::setFillMode( FILL_T fill )
 }
 
 
+void SVG_PLOTTER::closePath()
+{
+    if( m_pathOpen )
+    {
+        m_out.Write( "\" />\n" );
+        m_pathOpen = false;
+    }
+}
+
+
 void SVG_PLOTTER::setSVGPlotStyle()
 {
-    fputs( "</g>\n<g style=\"", outputFile );
-    fputs( "fill:#", outputFile );
+    closePath();
+
+    m_out.Write( "</g>\n<g style=\"" );
+    m_out.Write( "fill:#" );
     // output the background fill color
-    fprintf( outputFile, "%6.6lX; ", m_brush_rgb_color );
+    m_out.WriteHex( m_brush_rgb_color, 6 );
+    m_out.Write( "; " );
 
     switch( m_fillMode )
     {
     case NO_FILL:
-        fputs( "fill-opacity:0.0; ", outputFile );
+        m_out.Write( "fill-opacity:0.0; " );
         break;
 
     case FILLED_SHAPE:
-        fputs( "fill-opacity:1.0; ", outputFile );
+        m_out.Write( "fill-opacity:1.0; " );
         break;
 
     case FILLED_WITH_BG_BODYCOLOR:
-        fputs( "fill-opacity:0.6; ", outputFile );
+        m_out.Write( "fill-opacity:0.6; " );
         break;
     }
 
     double pen_w = userToDeviceSize( GetCurrentLineWidth() );
-    fprintf( outputFile, "\nstroke:#%6.6lX; stroke-width:%g; stroke-opacity:1; \n",
-             m_pen_rgb_color, pen_w  );
-    fputs( "stroke-linecap:round; stroke-linejoin:round;", outputFile );
+    m_out.Write( "\nstroke:#" );
+    m_out.WriteHex( m_pen_rgb_color, 6 );
+    m_out.Write( "; stroke-width:" );
+    m_out.WriteDouble( pen_w, SVG_DECIMALS );
+    m_out.Write( "; stroke-opacity:1; \n" );
+    m_out.Write( "stroke-linecap:round; stroke-linejoin:round;" );
 
     if( m_dashed )
-        fprintf( outputFile, "stroke-dasharray:%g,%g;",
-                 GetDashMarkLenIU(), GetDashGapLenIU() );
+    {
+        m_out.Write( "stroke-dasharray:" );
+        m_out.WriteDouble( GetDashMarkLenIU(), SVG_DECIMALS );
+        m_out.WriteChar( ',' );
+        m_out.WriteDouble( GetDashGapLenIU(), SVG_DECIMALS );
+        m_out.WriteChar( ';' );
+    }
 
-    fputs( "\">\n", outputFile );
+    m_out.Write( "\">\n" );
 
     m_graphics_changed = false;
 }
@@ -318,22 +358,29 @@ void SVG_PLOTTER::Rect( const wxPoint& p1, const wxPoint& p2, FILL_T fill, int w
     setFillMode( fill );
     SetCurrentLineWidth( width );
 
+    closePath();
+
     // Rectangles having a 0 size value for height or width are just not drawn on Inscape,
     // so use a line when happens.
     if( rect_dev.GetSize().x == 0.0 || rect_dev.GetSize().y == 0.0 )    // Draw a line
-        fprintf( outputFile,
-                 "<line x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\" />\n",
-                 rect_dev.GetPosition().x, rect_dev.GetPosition().y,
-                 rect_dev.GetEnd().x, rect_dev.GetEnd().y
-                 );
-
+    {
+        m_out.Write( "<line" );
+        writeAttr( m_out, "x1", rect_dev.GetPosition().x );
+        writeAttr( m_out, "y1", rect_dev.GetPosition().y );
+        writeAttr( m_out, "x2", rect_dev.GetEnd().x );
+        writeAttr( m_out, "y2", rect_dev.GetEnd().y );
+        m_out.Write( " />\n" );
+    }
     else
-        fprintf( outputFile,
-                 "<rect x=\"%g\" y=\"%g\" width=\"%g\" height=\"%g\" rx=\"%g\" />\n",
-                 rect_dev.GetPosition().x, rect_dev.GetPosition().y,
-                 rect_dev.GetSize().x, rect_dev.GetSize().y,
-                 0.0   // radius of rounded corners
-                 );
+    {
+        m_out.Write( "<rect" );
+        writeAttr( m_out, "x", rect_dev.GetPosition().x );
+        writeAttr( m_out, "y", rect_dev.GetPosition().y );
+        writeAttr( m_out, "width", rect_dev.GetSize().x );
+        writeAttr( m_out, "height", rect_dev.GetSize().y );
+        writeAttr( m_out, "rx", 0.0 );     // radius of rounded corners
+        m_out.Write( " />\n" );
+    }
 }
 
 
@@ -345,9 +392,13 @@ void SVG_PLOTTER::Circle( const wxPoint& pos, int diametre, FILL_T fill, int wid
     setFillMode( fill );
     SetCurrentLineWidth( width );
 
-    fprintf( outputFile,
-             "<circle cx=\"%g\" cy=\"%g\" r=\"%g\" /> \n",
-             pos_dev.x, pos_dev.y, radius );
+    closePath();
+
+    m_out.Write( "<circle" );
+    writeAttr( m_out, "cx", pos_dev.x );
+    writeAttr( m_out, "cy", pos_dev.y );
+    writeAttr( m_out, "r", radius );
+    m_out.Write( " /> \n" );
 }
 
 
@@ -431,10 +482,25 @@ void SVG_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
     // flag arc size (0 = small arc > 180 deg, 1 = large arc > 180 deg),
     // sweep arc ( 0 = CCW, 1 = CW),
     // end point
-    fprintf( outputFile, "<path d=\"M%g %g A%g %g 0.0 %d %d %g %g \" />\n",
-             start.x, start.y, radius_dev, radius_dev,
-             flg_arc, flg_sweep,
-             end.x, end.y  );
+    closePath();
+
+    m_out.Write( "<path d=\"M" );
+    m_out.WriteDouble( start.x, SVG_DECIMALS );
+    m_out.WriteChar( ' ' );
+    m_out.WriteDouble( start.y, SVG_DECIMALS );
+    m_out.Write( " A" );
+    m_out.WriteDouble( radius_dev, SVG_DECIMALS );
+    m_out.WriteChar( ' ' );
+    m_out.WriteDouble( radius_dev, SVG_DECIMALS );
+    m_out.Write( " 0.0 " );
+    m_out.WriteInt( flg_arc );
+    m_out.WriteChar( ' ' );
+    m_out.WriteInt( flg_sweep );
+    m_out.WriteChar( ' ' );
+    m_out.WriteDouble( end.x, SVG_DECIMALS );
+    m_out.WriteChar( ' ' );
+    m_out.WriteDouble( end.y, SVG_DECIMALS );
+    m_out.Write( " \" />\n" );
 }
 
 
@@ -447,29 +513,33 @@ void SVG_PLOTTER::PlotPoly( const std::vector<wxPoint>& aCornerList,
     setFillMode( aFill );
     SetCurrentLineWidth( aWidth );
 
+    closePath();
+
     switch( aFill )
     {
     case NO_FILL:
-        fprintf( outputFile, "<polyline fill=\"none;\"\n" );
+        m_out.Write( "<polyline fill=\"none;\"\n" );
         break;
 
     case FILLED_WITH_BG_BODYCOLOR:
     case FILLED_SHAPE:
-        fprintf( outputFile, "<polyline style=\"fill-rule:evenodd;\"\n" );
+        m_out.Write( "<polyline style=\"fill-rule:evenodd;\"\n" );
         break;
     }
 
-    DPOINT pos = userToDeviceCoordinates( aCornerList[0] );
-    fprintf( outputFile, "points=\"%d,%d\n", (int) pos.x, (int) pos.y );
+    m_out.Write( "points=\"" );
 
-    for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
+    for( unsigned ii = 0; ii < aCornerList.size(); ii++ )
     {
-        pos = userToDeviceCoordinates( aCornerList[ii] );
-        fprintf( outputFile, "%d,%d\n", (int) pos.x, (int) pos.y );
+        DPOINT pos = userToDeviceCoordinates( aCornerList[ii] );
+        m_out.WriteInt( (int) pos.x );
+        m_out.WriteChar( ',' );
+        m_out.WriteInt( (int) pos.y );
+        m_out.WriteChar( '\n' );
     }
 
     // Close/(fill) the path
-    fprintf( outputFile, "\" /> \n" );
+    m_out.Write( "\" /> \n" );
 }
 
 
@@ -495,7 +565,8 @@ void SVG_PLOTTER::PenTo( const wxPoint& pos, char plume )
     {
         if( penState != 'Z' )
         {
-            fputs( "\" />\n", outputFile );
+            // The <path> element is left open: if the next strokes are drawn
+            // with the same style, they are added to it (see closePath())
             penState        = 'Z';
             penLastpos.x    = -1;
             penLastpos.y    = -1;
@@ -516,14 +587,29 @@ void SVG_PLOTTER::PenTo( const wxPoint& pos, char plume )
             setSVGPlotStyle();
         }
 
-        fprintf( outputFile, "<path d=\"M%d %d\n",
-                 (int) pos_dev.x, (int) pos_dev.y );
+        if( m_pathOpen )
+        {
+            m_out.WriteChar( 'M' );
+        }
+        else
+        {
+            m_out.Write( "<path d=\"M" );
+            m_pathOpen = true;
+        }
+
+        m_out.WriteInt( (int) pos_dev.x );
+        m_out.WriteChar( ' ' );
+        m_out.WriteInt( (int) pos_dev.y );
+        m_out.WriteChar( '\n' );
     }
     else if( penState != plume || pos != penLastpos )
     {
         DPOINT pos_dev = userToDeviceCoordinates( pos );
-        fprintf( outputFile, "L%d %d\n",
-                 (int) pos_dev.x, (int) pos_dev.y );
+        m_out.WriteChar( 'L' );
+        m_out.WriteInt( (int) pos_dev.x );
+        m_out.WriteChar( ' ' );
+        m_out.WriteInt( (int) pos_dev.y );
+        m_out.WriteChar( '\n' );
     }
 
     penState    = plume;
@@ -540,6 +626,9 @@ bool SVG_PLOTTER::StartPlot()
     wxASSERT( outputFile );
     wxString            msg;
 
+    m_out.SetFile( outputFile );
+    m_pathOpen = false;
+
     static const char*  header[] =
     {
         "<?xml version=\"1.0\" standalone=\"no\"?>\n",
@@ -552,18 +641,17 @@ bool SVG_PLOTTER::StartPlot()
     // Write header.
     for( int ii = 0; header[ii] != NULL; ii++ )
     {
-        fputs( header[ii], outputFile );
+        m_out.Write( header[ii] );
     }
 
     // Write viewport pos and size
     wxPoint origin;    // TODO set to actual value
-    fprintf( outputFile,
-             "    width=\"%gcm\" height=\"%gcm\" viewBox=\"%d %d %d %d \">\n",
-             (double) paperSize.x / m_IUsPerDecimil * 2.54 / 10000,
-             (double) paperSize.y / m_IUsPerDecimil * 2.54 / 10000,
-             origin.x, origin.y,
-             (int) ( paperSize.x / m_IUsPerDecimil ),
-             (int) ( paperSize.y / m_IUsPerDecimil) );
+    m_out.Printf( "    width=\"%gcm\" height=\"%gcm\" viewBox=\"%d %d %d %d \">\n",
+                  (double) paperSize.x / m_IUsPerDecimil * 2.54 / 10000,
+                  (double) paperSize.y / m_IUsPerDecimil * 2.54 / 10000,
+                  origin.x, origin.y,
+                  (int) ( paperSize.x / m_IUsPerDecimil ),
+                  (int) ( paperSize.y / m_IUsPerDecimil) );
 
     // Write title
     char    date_buf[250];
@@ -571,29 +659,30 @@ bool SVG_PLOTTER::StartPlot()
     strftime( date_buf, 250, "%Y/%m/%d %H:%M:%S",
               localtime( &ltime ) );
 
-    fprintf( outputFile,
-             "<title>SVG Picture created as %s date %s </title>\n",
-             TO_UTF8( XmlEsc( wxFileName( filename ).GetFullName() ) ), date_buf );
+    m_out.Printf( "<title>SVG Picture created as %s date %s </title>\n",
+                  TO_UTF8( XmlEsc( wxFileName( filename ).GetFullName() ) ), date_buf );
     // End of header
-    fprintf( outputFile, "  <desc>Picture generated by %s </desc>\n",
-             TO_UTF8( XmlEsc( creator ) ) );
+    m_out.Printf( "  <desc>Picture generated by %s </desc>\n",
+                  TO_UTF8( XmlEsc( creator ) ) );
 
     // output the pen and brush color (RVB values in hex) and opacity
     double opacity = 1.0;      // 0.0 (transparent to 1.0 (solid)
-    fprintf( outputFile,
-             "<g style=\"fill:#%6.6lX; fill-opacity:%g;stroke:#%6.6lX; stroke-opacity:%g;\n",
-             m_brush_rgb_color, opacity, m_pen_rgb_color, opacity );
+    m_out.Printf( "<g style=\"fill:#%6.6lX; fill-opacity:%g;stroke:#%6.6lX; stroke-opacity:%g;\n",
+                  m_brush_rgb_color, opacity, m_pen_rgb_color, opacity );
 
     // output the pen cap and line joint
-    fputs( "stroke-linecap:round; stroke-linejoin:round; \"\n", outputFile );
-    fputs( " transform=\"translate(0 0) scale(1 1)\">\n", outputFile );
+    m_out.Write( "stroke-linecap:round; stroke-linejoin:round; \"\n" );
+    m_out.Write( " transform=\"translate(0 0) scale(1 1)\">\n" );
     return true;
 }
 
 
 bool SVG_PLOTTER::EndPlot()
 {
-    fputs( "</g> \n</svg>\n", outputFile );
+    closePath();
+
+    m_out.Write( "</g> \n</svg>\n" );
+    m_out.SetFile( NULL );      // flush the buffer
     fclose( outputFile );
     outputFile = NULL;
 
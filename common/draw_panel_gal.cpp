@@ -30,7 +30,7 @@
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <view/wx_view_controls.h>
-#include <pcb_painter.h>
+#include <painter.h>
 
 #include <gal/graphics_abstraction_layer.h>
 #include <gal/opengl/opengl_gal.h>
@@ -72,10 +72,8 @@ EDA_DRAW_PANEL_GAL::EDA_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWin
 #endif
     EnableScrolling( false, false );    // otherwise Zoom Auto disables GAL canvas
 
-    m_painter = new KIGFX::PCB_PAINTER( m_gal );
-
+    // The painter depends on the kind of items to draw: it is created by the derived panels
     m_view = new KIGFX::VIEW( true );
-    m_view->SetPainter( m_painter );
     m_view->SetGAL( m_gal );
 
     Connect( wxEVT_SIZE, wxSizeEventHandler( EDA_DRAW_PANEL_GAL::onSize ), NULL, this );
@@ -169,7 +167,7 @@ void EDA_DRAW_PANEL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
 #endif /* PROFILE */
 
     m_drawing = true;
-    KIGFX::PCB_RENDER_SETTINGS* settings = static_cast<KIGFX::PCB_RENDER_SETTINGS*>( m_painter->GetSettings() );
+    KIGFX::RENDER_SETTINGS* settings = m_painter->GetSettings();
 
 // Scrollbars broken in GAL on OSX
 #ifndef __WXMAC__
@@ -181,8 +179,7 @@ void EDA_DRAW_PANEL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
     m_gal->BeginDrawing();
     m_gal->ClearScreen( settings->GetBackgroundColor() );
 
-    KIGFX::COLOR4D gridColor = settings->GetLayerColor( ITEM_GAL_LAYER( GRID_VISIBLE ) );
-    m_gal->SetGridColor( gridColor );
+    m_gal->SetGridColor( settings->GetGridColor() );
 
     if( m_view->IsDirty() )
     {
@@ -41,6 +41,7 @@ RENDER_SETTINGS::RENDER_SETTINGS()
     m_highlightNetcode      = -1;
     m_outlineWidth          = 1;
     m_worksheetLineWidth    = 100000;
+    m_gridColor             = COLOR4D( 0.5, 0.5, 0.5, 1.0 );
 
     // Store the predefined colors used in KiCad in format used by GAL
     for( int i = 0; i < NBCOLORS; i++ )
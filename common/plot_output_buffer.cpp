@@ -0,0 +1,242 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file plot_output_buffer.cpp
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <plot_output_buffer.h>
+
+
+PLOT_OUTPUT_BUFFER::PLOT_OUTPUT_BUFFER( size_t aSize ) :
+    m_file( NULL ),
+    m_size( aSize )
+{
+}
+
+
+PLOT_OUTPUT_BUFFER::~PLOT_OUTPUT_BUFFER()
+{
+    Flush();
+}
+
+
+void PLOT_OUTPUT_BUFFER::SetFile( FILE* aFile )
+{
+    Flush();
+    m_file = aFile;
+
+    // Allocated once, when the plot starts
+    if( m_file )
+        m_buffer.reserve( m_size );
+}
+
+
+bool PLOT_OUTPUT_BUFFER::Flush()
+{
+    bool success = true;
+
+    if( m_file && !m_buffer.empty() )
+        success = fwrite( m_buffer.data(), 1, m_buffer.size(), m_file ) == m_buffer.size();
+
+    m_buffer.clear();
+
+    return success;
+}
+
+
+void PLOT_OUTPUT_BUFFER::Write( const char* aText, size_t aLength )
+{
+    if( m_buffer.size() + aLength > m_size )
+    {
+        Flush();
+
+        // No need to copy big blocks
+        if( aLength > m_size )
+        {
+            if( m_file )
+                fwrite( aText, 1, aLength, m_file );
+
+            return;
+        }
+    }
+
+    m_buffer.append( aText, aLength );
+}
+
+
+void PLOT_OUTPUT_BUFFER::Write( const char* aText )
+{
+    Write( aText, strlen( aText ) );
+}
+
+
+void PLOT_OUTPUT_BUFFER::WriteInt( int aValue )
+{
+    char text[16];
+
+    Write( text, FormatInt( text, aValue ) - text );
+}
+
+
+void PLOT_OUTPUT_BUFFER::WriteDouble( double aValue, int aDecimals )
+{
+    char text[32];
+
+    Write( text, FormatDouble( text, aValue, aDecimals ) - text );
+}
+
+
+void PLOT_OUTPUT_BUFFER::WriteHex( unsigned long aValue, int aDigits )
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char     digits[2 * sizeof( unsigned long )];
+    int      count = 0;
+
+    do
+    {
+        digits[count++] = hexDigits[aValue & 0xF];
+        aValue >>= 4;
+    } while( aValue );
+
+    for( int ii = count; ii < aDigits; ii++ )
+        WriteChar( '0' );
+
+    while( count )
+        WriteChar( digits[--count] );
+}
+
+
+void PLOT_OUTPUT_BUFFER::Printf( const char* aFormat, ... )
+{
+    char    text[1024];
+    va_list args;
+
+    va_start( args, aFormat );
+    int len = vsnprintf( text, sizeof( text ), aFormat, args );
+    va_end( args );
+
+    if( len < 0 )
+        return;
+
+    if( len < (int) sizeof( text ) )
+    {
+        Write( text, len );
+        return;
+    }
+
+    // Too long for the local buffer: format it again, in a big enough one
+    std::string longText( len + 1, '\0' );
+
+    va_start( args, aFormat );
+    vsnprintf( &longText[0], len + 1, aFormat, args );
+    va_end( args );
+
+    Write( longText.data(), len );
+}
+
+
+char* PLOT_OUTPUT_BUFFER::FormatInt( char* aBuffer, int aValue )
+{
+    unsigned value = aValue < 0 ? 0u - (unsigned) aValue : (unsigned) aValue;
+    char     digits[12];
+    int      count = 0;
+
+    if( aValue < 0 )
+        *aBuffer++ = '-';
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while( value );
+
+    while( count )
+        *aBuffer++ = digits[--count];
+
+    return aBuffer;
+}
+
+
+char* PLOT_OUTPUT_BUFFER::FormatDouble( char* aBuffer, double aValue, int aDecimals )
+{
+    static const double scales[] =
+        { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+    if( aDecimals < 0 )
+        aDecimals = 0;
+    else if( aDecimals > 9 )
+        aDecimals = 9;
+
+    double scaled = aValue * scales[aDecimals];
+
+    // Out of the range of the fixed point conversion (or not a number)
+    if( !( fabs( scaled ) < 1e18 ) )
+        return aBuffer + sprintf( aBuffer, "%g", aValue );
+
+    int64_t  rounded = (int64_t) floor( fabs( scaled ) + 0.5 );
+    uint64_t divisor = (uint64_t) scales[aDecimals];
+    uint64_t intPart = rounded / divisor;
+    uint64_t decPart = rounded % divisor;
+    char     digits[20];
+    int      count = 0;
+
+    if( aValue < 0 && rounded != 0 )
+        *aBuffer++ = '-';
+
+    do
+    {
+        digits[count++] = '0' + intPart % 10;
+        intPart /= 10;
+    } while( intPart );
+
+    while( count )
+        *aBuffer++ = digits[--count];
+
+    if( decPart )
+    {
+        // Drop the trailing zeros
+        while( decPart % 10 == 0 )
+        {
+            decPart /= 10;
+            aDecimals--;
+        }
+
+        *aBuffer++ = '.';
+
+        for( int ii = aDecimals - 1; ii >= 0; ii-- )
+        {
+            aBuffer[ii] = '0' + decPart % 10;
+            decPart /= 10;
+        }
+
+        aBuffer += aDecimals;
+    }
+
+    return aBuffer;
+}
@@ -38,6 +38,10 @@
 #include <dialog_plot_schematic.h>
 #include <wx_html_report_panel.h>
 
+// Hidden setting: the compression level (0 to 9) of the PDF page streams.
+// Lower levels make a larger file faster.
+#define PLOT_PDF_COMPRESSION_KEY wxT( "PlotPDFCompression" )
+
 void DIALOG_PLOT_SCHEMATIC::createPDFFile( bool aPlotAll, bool aPlotFrameRef )
 {
     SCH_SCREEN*     screen = m_parent->GetScreen();
@@ -63,6 +67,14 @@ void DIALOG_PLOT_SCHEMATIC::createPDFFile( bool aPlotAll, bool aPlotFrameRef )
     plotter->SetColorMode( getModeColor() );
     plotter->SetCreator( wxT( "Eeschema-PDF" ) );
 
+    int compression;
+    m_config->Read( PLOT_PDF_COMPRESSION_KEY, &compression, 9 );
+    plotter->SetCompressionLevel( std::min( std::max( compression, 0 ), 9 ) );
+
+    // The pages are plotted one after the other (the sheets can share their screens),
+    // but their streams are compressed in parallel
+    plotter->SetParallelStreams( sheetList.size() > 1 );
+
     wxString msg;
     wxFileName plotFileName;
     REPORTER& reporter = m_MessagesBox->Reporter();
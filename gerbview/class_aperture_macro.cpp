@@ -103,7 +103,9 @@ void AM_PRIMITIVE::DrawBasicShape( GERBER_DRAW_ITEM* aParent,
 
     const int seg_per_circle = 64;   // Number of segments to approximate a circle
     // Draw the primitive shape for flashed items.
-    static std::vector<wxPoint> polybuffer;     // create a static buffer to avoid a lot of memory reallocation
+    // a static buffer to avoid a lot of memory reallocation (one per thread: the
+    // files can be read in parallel)
+    static thread_local std::vector<wxPoint> polybuffer;
     polybuffer.clear();
 
     wxPoint curPos = aShapePos;
@@ -696,44 +698,55 @@ int AM_PRIMITIVE::GetShapeDim( GERBER_DRAW_ITEM* aParent )
 
 
 /*
- * Function DrawApertureMacroShape
- * Draw the primitive shape for flashed items.
- * When an item is flashed, this is the shape of the item
+ * Function GetApertureMacroShape
+ * Calculate the primitive shape for flashed items.
  */
-void APERTURE_MACRO::DrawApertureMacroShape( GERBER_DRAW_ITEM* aParent,
-                                             EDA_RECT* aClipBox, wxDC* aDC,
-                                             EDA_COLOR_T aColor,
-                                             wxPoint aShapePos, bool aFilledShape )
+void APERTURE_MACRO::GetApertureMacroShape( GERBER_DRAW_ITEM* aParent, wxPoint aShapePos,
+                                            SHAPE_POLY_SET& aShapeBuffer )
 {
-    SHAPE_POLY_SET shapeBuffer;
     SHAPE_POLY_SET holeBuffer;
     bool hasHole = false;
 
+    aShapeBuffer.RemoveAllContours();
+
     for( AM_PRIMITIVES::iterator prim_macro = primitives.begin();
          prim_macro != primitives.end(); ++prim_macro )
     {
         if( prim_macro->IsAMPrimitiveExposureOn( aParent ) )
-            prim_macro->DrawBasicShape( aParent, shapeBuffer, aShapePos );
+            prim_macro->DrawBasicShape( aParent, aShapeBuffer, aShapePos );
         else
         {
             prim_macro->DrawBasicShape( aParent, holeBuffer, aShapePos );
 
             if( holeBuffer.OutlineCount() )     // we have a new hole in shape: remove the hole
             {
-                shapeBuffer.BooleanSubtract( holeBuffer, SHAPE_POLY_SET::PM_FAST );
+                aShapeBuffer.BooleanSubtract( holeBuffer, SHAPE_POLY_SET::PM_FAST );
                 holeBuffer.RemoveAllContours();
                 hasHole = true;
             }
         }
     }
 
-    if( shapeBuffer.OutlineCount() == 0 )
-        return;
-
     // If a hole is defined inside a polygon, we must fracture the polygon
     // to be able to drawn it (i.e link holes by overlapping edges)
-    if( hasHole )
-        shapeBuffer.Fracture( SHAPE_POLY_SET::PM_FAST );
+    if( hasHole && aShapeBuffer.OutlineCount() )
+        aShapeBuffer.Fracture( SHAPE_POLY_SET::PM_FAST );
+}
+
+
+/*
+ * Function DrawApertureMacroShape
+ * Draw the primitive shape for flashed items.
+ * When an item is flashed, this is the shape of the item
+ */
+void APERTURE_MACRO::DrawApertureMacroShape( GERBER_DRAW_ITEM* aParent,
+                                             EDA_RECT* aClipBox, wxDC* aDC,
+                                             EDA_COLOR_T aColor,
+                                             wxPoint aShapePos, bool aFilledShape )
+{
+    SHAPE_POLY_SET shapeBuffer;
+
+    GetApertureMacroShape( aParent, aShapePos, shapeBuffer );
 
     for( int ii = 0; ii < shapeBuffer.OutlineCount(); ii++ )
     {
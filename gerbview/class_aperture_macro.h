@@ -183,7 +183,19 @@ struct APERTURE_MACRO
      */
     double GetLocalParam( const D_CODE* aDcode, unsigned aParamId ) const;
 
-   /**
+    /**
+     * Function GetApertureMacroShape
+     * Calculates the primitive shape for flashed items, in A,B plotter axis.
+     * When an item is flashed, this is the shape of the item
+     * @param aParent = the parent GERBER_DRAW_ITEM which is actually drawn
+     * @param aShapePos = the actual shape position
+     * @param aShapeBuffer = a SHAPE_POLY_SET to put the shape converted to polygons
+     *  (fractured when the shape has holes)
+     */
+    void GetApertureMacroShape( GERBER_DRAW_ITEM* aParent, wxPoint aShapePos,
+                                SHAPE_POLY_SET& aShapeBuffer );
+
+    /**
      * Function DrawApertureMacroShape
      * Draw the primitive shape for flashed items.
      * When an item is flashed, this is the shape of the item
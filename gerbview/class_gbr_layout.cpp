@@ -398,8 +398,6 @@ void GBR_LAYOUT::DrawItemsDCodeID( EDA_DRAW_PANEL* aPanel, wxDC* aDC,
                 pos.y = (item->m_Start.y + item->m_End.y) / 2;
             }
 
-            pos = item->GetABPosition( pos );
-
             Line.Printf( wxT( "D%d" ), item->m_DCode );
 
             if( item->GetDcodeDescr() )
@@ -426,10 +424,16 @@ void GBR_LAYOUT::DrawItemsDCodeID( EDA_DRAW_PANEL* aPanel, wxDC* aDC,
                 width /= 2;
             }
 
-            DrawGraphicText( aPanel->GetClipBox(), aDC, pos, aDrawColor, Line,
-                             orient, wxSize( width, width ),
-                             GR_TEXT_HJUSTIFY_CENTER, GR_TEXT_VJUSTIFY_CENTER,
-                             0, false, false );
+            // Step and repeat: each instance has its D code
+            for( int ii = 0; ii < item->GetInstanceCount(); ii++ )
+            {
+                wxPoint textPos = item->GetABPosition( pos + item->GetInstanceOffset( ii ) );
+
+                DrawGraphicText( aPanel->GetClipBox(), aDC, textPos, aDrawColor, Line,
+                                 orient, wxSize( width, width ),
+                                 GR_TEXT_HJUSTIFY_CENTER, GR_TEXT_VJUSTIFY_CENTER,
+                                 0, false, false );
+            }
         }
     }
 }
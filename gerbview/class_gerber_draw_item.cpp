@@ -37,6 +37,8 @@
 #include <class_gerber_draw_item.h>
 #include <class_gerber_file_image.h>
 #include <class_gerber_file_image_list.h>
+#include <class_aperture_macro.h>
+#include <geometry/shape_poly_set.h>
 
 
 GERBER_DRAW_ITEM::GERBER_DRAW_ITEM( GERBER_FILE_IMAGE* aGerberImageFile ) :
@@ -53,6 +55,8 @@ GERBER_DRAW_ITEM::GERBER_DRAW_ITEM( GERBER_FILE_IMAGE* aGerberImageFile ) :
     m_mirrorB       = false;
     m_drawScale.x   = m_drawScale.y = 1.0;
     m_lyrRotation   = 0;
+    m_repeatCount   = wxSize( 1, 1 );
+    m_polarityRun   = 0;
 
     if( m_GerberImageFile )
         SetLayerParameters();
@@ -141,6 +145,23 @@ wxPoint GERBER_DRAW_ITEM::GetXYPosition( const wxPoint& aABPosition ) const
 }
 
 
+void GERBER_DRAW_ITEM::SetStepAndRepeat( int aCountX, int aCountY, const wxPoint& aStep )
+{
+    m_repeatCount = wxSize( std::max( aCountX, 1 ), std::max( aCountY, 1 ) );
+    m_repeatStep  = aStep;
+}
+
+
+wxPoint GERBER_DRAW_ITEM::GetInstanceOffset( int aInstance ) const
+{
+    // The instances are stored column by column, as the SR command creates them
+    int ii = aInstance / m_repeatCount.y;
+    int jj = aInstance % m_repeatCount.y;
+
+    return wxPoint( ii * m_repeatStep.x, jj * m_repeatStep.y );
+}
+
+
 void GERBER_DRAW_ITEM::SetLayerParameters()
 {
     m_UnitsMetric = m_GerberImageFile->m_GerbMetric;
@@ -217,24 +238,122 @@ D_CODE* GERBER_DRAW_ITEM::GetDcodeDescr()
 
 const EDA_RECT GERBER_DRAW_ITEM::GetBoundingBox() const
 {
-    // return a rectangle which is (pos,dim) in nature.  therefore the +1
-    EDA_RECT bbox( m_Start, wxSize( 1, 1 ) );
+    EDA_RECT bbox = instanceBoundingBox( wxPoint( 0, 0 ) );
 
-    bbox.Inflate( m_Size.x / 2, m_Size.y / 2 );
+    if( GetInstanceCount() == 1 )
+        return bbox;
 
-    // calculate the corners coordinates in current gerber axis orientations
-    wxPoint org = GetABPosition( bbox.GetOrigin() );
-    wxPoint end = GetABPosition( bbox.GetEnd() );
+    // The instances are on a grid: the 4 corner instances give the bounding box
+    // of all of them, whatever the rotation of the image
+    int nx = m_repeatCount.x - 1;
+    int ny = m_repeatCount.y - 1;
 
-    // Set the corners position:
-    bbox.SetOrigin( org );
-    bbox.SetEnd( end );
-    bbox.Normalize();
+    bbox.Merge( instanceBoundingBox( wxPoint( nx * m_repeatStep.x, 0 ) ) );
+    bbox.Merge( instanceBoundingBox( wxPoint( 0, ny * m_repeatStep.y ) ) );
+    bbox.Merge( instanceBoundingBox( wxPoint( nx * m_repeatStep.x, ny * m_repeatStep.y ) ) );
 
     return bbox;
 }
 
 
+const EDA_RECT GERBER_DRAW_ITEM::instanceBoundingBox( const wxPoint& aInstanceOffset ) const
+{
+    // calculate the extent of the shape in XY gerber axis
+    EDA_RECT bbox( m_Start + aInstanceOffset, wxSize( 1, 1 ) );
+
+    switch( m_Shape )
+    {
+    case GBR_SEGMENT:
+        bbox.Merge( m_End + aInstanceOffset );
+        bbox.Inflate( std::max( m_Size.x, m_Size.y ) / 2 );
+        break;
+
+    case GBR_ARC:
+    {
+        int radius = KiROUND( GetLineLength( m_Start, m_ArcCentre ) );
+
+        bbox = EDA_RECT( m_ArcCentre + aInstanceOffset, wxSize( 1, 1 ) );
+        bbox.Inflate( radius + m_Size.x / 2 );
+        break;
+    }
+
+    case GBR_CIRCLE:
+        bbox.Inflate( KiROUND( GetLineLength( m_Start, m_End ) ) + m_Size.x / 2 );
+        break;
+
+    case GBR_POLYGON:
+        for( unsigned ii = 0; ii < m_PolyCorners.size(); ii++ )
+            bbox.Merge( m_PolyCorners[ii] + aInstanceOffset );
+
+        break;
+
+    default:        // Flashed shapes
+        bbox.Inflate( m_Size.x / 2, m_Size.y / 2 );
+        break;
+    }
+
+    // calculate the corners coordinates in current gerber axis orientations
+    // (the image can be rotated by any angle: the 4 corners are needed)
+    wxPoint corners[4] =
+    {
+        bbox.GetOrigin(), bbox.GetEnd(),
+        wxPoint( bbox.GetX(), bbox.GetBottom() ), wxPoint( bbox.GetRight(), bbox.GetY() )
+    };
+
+    EDA_RECT abBox( GetABPosition( corners[0] ), wxSize( 0, 0 ) );
+
+    for( int ii = 1; ii < 4; ii++ )
+        abBox.Merge( GetABPosition( corners[ii] ) );
+
+    return abBox;
+}
+
+
+const BOX2I GERBER_DRAW_ITEM::ViewBBox() const
+{
+    EDA_RECT bbox = GetBoundingBox();
+
+    // An aperture macro shape is not limited to the aperture size
+    D_CODE* dcode = const_cast<GERBER_DRAW_ITEM*>( this )->GetDcodeDescr();
+
+    if( m_Shape == GBR_SPOT_MACRO && dcode && dcode->GetMacro() )
+    {
+        SHAPE_POLY_SET shape;
+
+        dcode->GetMacro()->GetApertureMacroShape( const_cast<GERBER_DRAW_ITEM*>( this ),
+                                                  m_Start, shape );
+
+        if( shape.OutlineCount() )
+        {
+            BOX2I   shapeBox = shape.BBox();
+            wxPoint pos = GetABPosition( m_Start );
+            int     margin = std::max( std::max( std::abs( shapeBox.GetX() - pos.x ),
+                                                 std::abs( shapeBox.GetRight() - pos.x ) ),
+                                       std::max( std::abs( shapeBox.GetY() - pos.y ),
+                                                 std::abs( shapeBox.GetBottom() - pos.y ) ) );
+
+            bbox.Inflate( margin );
+        }
+    }
+
+    return BOX2I( VECTOR2I( bbox.GetOrigin() ), VECTOR2I( bbox.GetSize() ) );
+}
+
+
+void GERBER_DRAW_ITEM::ViewGetLayers( int aLayers[], int& aCount ) const
+{
+    // Each polarity run has its own layer, drawn above the previous runs. The runs which
+    // do not fit share the last two layers, dark and clear items staying apart.
+    int run = m_polarityRun;
+
+    if( run >= GERBER_GAL_RUN_COUNT )
+        run = GERBER_GAL_RUN_COUNT - 2 + ( run - GERBER_GAL_RUN_COUNT ) % 2;
+
+    aCount = 1;
+    aLayers[0] = GERBER_GAL_LAYER( GetLayer(), run );
+}
+
+
 void GERBER_DRAW_ITEM::MoveAB( const wxPoint& aMoveVector )
 {
     wxPoint xymove = GetXYPosition( aMoveVector );
@@ -259,7 +378,7 @@ void GERBER_DRAW_ITEM::MoveXY( const wxPoint& aMoveVector )
 }
 
 
-bool GERBER_DRAW_ITEM::HasNegativeItems()
+bool GERBER_DRAW_ITEM::HasNegativeItems() const
 {
     bool isClear = m_LayerNegative ^ m_GerberImageFile->m_ImageNegative;
 
@@ -270,6 +389,49 @@ bool GERBER_DRAW_ITEM::HasNegativeItems()
 
 void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
                              const wxPoint& aOffset, GBR_DISPLAY_OPTIONS* aDrawOptions )
+{
+    int count = GetInstanceCount();
+
+    if( count == 1 )
+    {
+        drawInstance( aPanel, aDC, aDrawMode, aOffset, aDrawOptions, wxPoint( 0, 0 ) );
+        return;
+    }
+
+    // Step and repeat: draw the instances which are visible
+    EDA_RECT* clipBox = aPanel->GetClipBox();
+
+    // Nothing to test when the whole block is visible
+    if( clipBox && clipBox->Contains( GetBoundingBox() ) )
+        clipBox = NULL;
+
+    // GetABPosition() is an affine transform: the bounding box of an instance is the one
+    // of the first instance, moved by the AB position of the instance offset
+    EDA_RECT firstBox = instanceBoundingBox( wxPoint( 0, 0 ) );
+    wxPoint  abOrigin = GetABPosition( wxPoint( 0, 0 ) );
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        wxPoint instanceOffset = GetInstanceOffset( ii );
+
+        if( clipBox )
+        {
+            EDA_RECT instanceBox = firstBox;
+
+            instanceBox.Move( GetABPosition( instanceOffset ) - abOrigin );
+
+            if( !clipBox->Intersects( instanceBox ) )
+                continue;
+        }
+
+        drawInstance( aPanel, aDC, aDrawMode, aOffset, aDrawOptions, instanceOffset );
+    }
+}
+
+
+void GERBER_DRAW_ITEM::drawInstance( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
+                                     const wxPoint& aOffset, GBR_DISPLAY_OPTIONS* aDrawOptions,
+                                     const wxPoint& aInstanceOffset )
 {
     // used when a D_CODE is not found. default D_CODE to draw a flashed item
     static D_CODE dummyD_CODE( 0 );
@@ -305,6 +467,10 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
 
     isFilled = aDrawOptions->m_DisplayLinesFill;
 
+    wxPoint start  = m_Start + aInstanceOffset;
+    wxPoint end    = m_End + aInstanceOffset;
+    wxPoint centre = m_ArcCentre + aInstanceOffset;
+
     switch( m_Shape )
     {
     case GBR_POLYGON:
@@ -313,7 +479,7 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
         if( !isDark )
             isFilled = true;
 
-        DrawGbrPoly( aPanel->GetClipBox(), aDC, color, aOffset, isFilled );
+        DrawGbrPoly( aPanel->GetClipBox(), aDC, color, aOffset + aInstanceOffset, isFilled );
         break;
 
     case GBR_CIRCLE:
@@ -324,14 +490,14 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
         if( !isFilled )
         {
             // draw the border of the pen's path using two circles, each as narrow as possible
-            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
+            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( start ),
                       radius - halfPenWidth, 0, color );
-            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
+            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( start ),
                       radius + halfPenWidth, 0, color );
         }
         else    // Filled mode
         {
-            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
+            GRCircle( aPanel->GetClipBox(), aDC, GetABPosition( start ),
                       radius, m_Size.x, color );
         }
         break;
@@ -341,22 +507,22 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
         // a round pen only is expected.
 
 #if 0   // for arc debug only
-        GRLine( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
-                GetABPosition( m_ArcCentre ), 0, color );
-        GRLine( aPanel->GetClipBox(), aDC, GetABPosition( m_End ),
-                GetABPosition( m_ArcCentre ), 0, color );
+        GRLine( aPanel->GetClipBox(), aDC, GetABPosition( start ),
+                GetABPosition( centre ), 0, color );
+        GRLine( aPanel->GetClipBox(), aDC, GetABPosition( end ),
+                GetABPosition( centre ), 0, color );
 #endif
 
         if( !isFilled )
         {
-            GRArc1( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
-                    GetABPosition( m_End ), GetABPosition( m_ArcCentre ),
+            GRArc1( aPanel->GetClipBox(), aDC, GetABPosition( start ),
+                    GetABPosition( end ), GetABPosition( centre ),
                     0, color );
         }
         else
         {
-            GRArc1( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
-                    GetABPosition( m_End ), GetABPosition( m_ArcCentre ),
+            GRArc1( aPanel->GetClipBox(), aDC, GetABPosition( start ),
+                    GetABPosition( end ), GetABPosition( centre ),
                     m_Size.x, color );
         }
 
@@ -369,7 +535,7 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
     case GBR_SPOT_MACRO:
         isFilled = aDrawOptions->m_DisplayFlashedItemsFill;
         d_codeDescr->DrawFlashedShape( this, aPanel->GetClipBox(), aDC, color,
-                                       m_Start, isFilled );
+                                       start, isFilled );
         break;
 
     case GBR_SEGMENT:
@@ -383,19 +549,19 @@ void GERBER_DRAW_ITEM::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDra
             if( m_PolyCorners.size() == 0 )
                 ConvertSegmentToPolygon( );
 
-            DrawGbrPoly( aPanel->GetClipBox(), aDC, color, aOffset, isFilled );
+            DrawGbrPoly( aPanel->GetClipBox(), aDC, color, aOffset + aInstanceOffset, isFilled );
         }
         else
         {
             if( !isFilled )
             {
-                    GRCSegm( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
-                             GetABPosition( m_End ), m_Size.x, color );
+                    GRCSegm( aPanel->GetClipBox(), aDC, GetABPosition( start ),
+                             GetABPosition( end ), m_Size.x, color );
             }
             else
             {
-                GRFilledSegment( aPanel->GetClipBox(), aDC, GetABPosition( m_Start ),
-                                 GetABPosition( m_End ), m_Size.x, color );
+                GRFilledSegment( aPanel->GetClipBox(), aDC, GetABPosition( start ),
+                                 GetABPosition( end ), m_Size.x, color );
             }
         }
 
@@ -580,24 +746,39 @@ bool GERBER_DRAW_ITEM::HitTest( const wxPoint& aRefPos ) const
     // TODO: a better analyze of the shape (perhaps create a D_CODE::HitTest for flashed items)
     int     radius = std::min( m_Size.x, m_Size.y ) >> 1;
 
-    if( m_Flashed )
-        return HitTestPoints( m_Start, ref_pos, radius );
-    else
-        return TestSegmentHit( ref_pos, m_Start, m_End, radius );
+    for( int ii = 0; ii < GetInstanceCount(); ii++ )
+    {
+        // the reference position, relative to the instance ii
+        wxPoint pos = ref_pos - GetInstanceOffset( ii );
+
+        if( m_Flashed )
+        {
+            if( HitTestPoints( m_Start, pos, radius ) )
+                return true;
+        }
+        else if( TestSegmentHit( pos, m_Start, m_End, radius ) )
+            return true;
+    }
+
+    return false;
 }
 
 
 bool GERBER_DRAW_ITEM::HitTest( const EDA_RECT& aRefArea ) const
 {
-    wxPoint pos = GetABPosition( m_Start );
+    for( int ii = 0; ii < GetInstanceCount(); ii++ )
+    {
+        wxPoint offset = GetInstanceOffset( ii );
+        wxPoint pos = GetABPosition( m_Start + offset );
 
-    if( aRefArea.Contains( pos ) )
-        return true;
+        if( aRefArea.Contains( pos ) )
+            return true;
 
-    pos = GetABPosition( m_End );
+        pos = GetABPosition( m_End + offset );
 
-    if( aRefArea.Contains( pos ) )
-        return true;
+        if( aRefArea.Contains( pos ) )
+            return true;
+    }
 
     return false;
 }
@@ -108,6 +108,14 @@ private:
                                             ///< (dcode). Stored in each item, because %TO is
                                             ///< a dynamic object attribute
 
+    // Step and repeat (SR command): the item is drawn m_repeatCount.x * m_repeatCount.y
+    // times, instead of being duplicated
+    wxSize      m_repeatCount;              // Number of instances on X and Y axis
+    wxPoint     m_repeatStep;               // Offset between two instances, in XY gerber axis
+
+    int         m_polarityRun;              // Index of the polarity run of the item in its
+                                            // image (number of polarity changes before it)
+
 public:
     GERBER_DRAW_ITEM( GERBER_FILE_IMAGE* aGerberparams );
     ~GERBER_DRAW_ITEM();
@@ -136,7 +144,7 @@ public:
      * used to optimize screen refresh (when no items are in background color
      * refresh can be faster)
      */
-    bool HasNegativeItems();
+    bool HasNegativeItems() const;
 
     /**
      * Function SetLayerParameters
@@ -153,6 +161,14 @@ public:
         m_LayerNegative = aNegative;
     }
 
+    /**
+     * Function SetPolarityRun
+     * sets the index of the polarity run of the item, i.e. the number of polarity changes
+     * before it in its image. The GAL view draws each run above the previous ones.
+     */
+    void SetPolarityRun( int aRun ) { m_polarityRun = aRun; }
+    int GetPolarityRun() const { return m_polarityRun; }
+
     /**
      * Function MoveAB
      * move this object.
@@ -176,6 +192,29 @@ public:
     const wxPoint& GetPosition() const          { return m_Start; }
     void SetPosition( const wxPoint& aPos )     {  m_Start = aPos; }
 
+    /**
+     * Function SetStepAndRepeat
+     * makes this item the first instance of a step and repeat block.
+     * @param aCountX = the number of instances on X axis
+     * @param aCountY = the number of instances on Y axis
+     * @param aStep = the offset between two instances, in XY gerber axis
+     */
+    void SetStepAndRepeat( int aCountX, int aCountY, const wxPoint& aStep );
+
+    /**
+     * Function GetInstanceCount
+     * @return the number of times this item is drawn: 1, or the number of
+     * instances of its step and repeat block.
+     */
+    int GetInstanceCount() const { return m_repeatCount.x * m_repeatCount.y; }
+
+    /**
+     * Function GetInstanceOffset
+     * @return the offset of the instance aInstance (0 to GetInstanceCount() - 1)
+     * in XY gerber axis
+     */
+    wxPoint GetInstanceOffset( int aInstance ) const;
+
     /**
      * Function GetABPosition
      * returns the image position of aPosition for this object.
@@ -205,7 +244,13 @@ public:
 
     const EDA_RECT GetBoundingBox() const;  // Virtual
 
-    /* Display on screen: */
+    /// @copydoc VIEW_ITEM::ViewBBox()
+    virtual const BOX2I ViewBBox() const override;
+
+    /// @copydoc VIEW_ITEM::ViewGetLayers()
+    virtual void ViewGetLayers( int aLayers[], int& aCount ) const override;
+
+    /* Display on screen (all the instances): */
     void Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC,
                GR_DRAWMODE aDrawMode, const wxPoint&aOffset, GBR_DISPLAY_OPTIONS* aDrawOptions );
 
@@ -233,7 +278,7 @@ public:
 
     /**
      * Function HitTest
-     * tests if the given wxPoint is within the bounds of this object.
+     * tests if the given wxPoint is within the bounds of one instance of this object.
      * @param aRefPos a wxPoint to test
      * @return bool - true if a hit, else false
      */
@@ -241,7 +286,7 @@ public:
 
     /**
      * Function HitTest (overloaded)
-     * tests if the given wxRect intersect this object.
+     * tests if the given wxRect intersect one instance of this object.
      * For now, an ending point must be inside this rect.
      * @param aRefArea a wxPoint to test
      * @return bool - true if a hit, else false
@@ -284,6 +329,15 @@ public:
     void Show( int nestLevel, std::ostream& os ) const;  // override
 #endif
 
+private:
+    /// Draw the instance at aInstanceOffset (in XY gerber axis)
+    void drawInstance( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
+                       const wxPoint& aOffset, GBR_DISPLAY_OPTIONS* aDrawOptions,
+                       const wxPoint& aInstanceOffset );
+
+    /// Bounding box of the instance at aInstanceOffset
+    const EDA_RECT instanceBoundingBox( const wxPoint& aInstanceOffset ) const;
+
 };
 
 #endif /* CLASS_GERBER_DRAW_ITEM_H */
@@ -282,33 +282,23 @@ void GERBER_FILE_IMAGE::InitToolTable()
  * This function must be called when reading a gerber file and
  * after creating a new gerber item that must be repeated
  * (i.e when m_XRepeatCount or m_YRepeatCount are > 1)
+ * The item is not duplicated: it is drawn once for each instance.
  * @param aItem = the item to repeat
  */
-void GERBER_FILE_IMAGE::StepAndRepeatItem( const GERBER_DRAW_ITEM& aItem )
+void GERBER_FILE_IMAGE::StepAndRepeatItem( GERBER_DRAW_ITEM& aItem )
 {
     if( GetLayerParams().m_XRepeatCount < 2 &&
         GetLayerParams().m_YRepeatCount < 2 )
         return; // Nothing to repeat
 
-    // Duplicate item:
-    for( int ii = 0; ii < GetLayerParams().m_XRepeatCount; ii++ )
-    {
-        for( int jj = 0; jj < GetLayerParams().m_YRepeatCount; jj++ )
-        {
-            // the first gerber item already exists (this is the template)
-            // create duplicate only if ii or jj > 0
-            if( jj == 0 && ii == 0 )
-                continue;
-            GERBER_DRAW_ITEM* dupItem = new GERBER_DRAW_ITEM( aItem );
-            wxPoint           move_vector;
-            move_vector.x = scaletoIU( ii * GetLayerParams().m_StepForRepeat.x,
-                                   GetLayerParams().m_StepForRepeatMetric );
-            move_vector.y = scaletoIU( jj * GetLayerParams().m_StepForRepeat.y,
-                                   GetLayerParams().m_StepForRepeatMetric );
-            dupItem->MoveXY( move_vector );
-            m_Drawings.Append( dupItem );
-        }
-    }
+    wxPoint step;
+    step.x = scaletoIU( GetLayerParams().m_StepForRepeat.x,
+                        GetLayerParams().m_StepForRepeatMetric );
+    step.y = scaletoIU( GetLayerParams().m_StepForRepeat.y,
+                        GetLayerParams().m_StepForRepeatMetric );
+
+    aItem.SetStepAndRepeat( GetLayerParams().m_XRepeatCount,
+                            GetLayerParams().m_YRepeatCount, step );
 }
 
 
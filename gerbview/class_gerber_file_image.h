@@ -331,7 +331,7 @@ public:
      * (i.e when m_XRepeatCount or m_YRepeatCount are > 1)
      * @param aItem = the item to repeat
      */
-    void            StepAndRepeatItem( const GERBER_DRAW_ITEM& aItem );
+    void            StepAndRepeatItem( GERBER_DRAW_ITEM& aItem );
 
     /**
      * Function DisplayImageInfo
@@ -40,6 +40,7 @@
 #include <class_gerber_file_image_list.h>
 #include <layer_widget.h>
 #include <class_gerbview_layer_widget.h>
+#include <gerbview_draw_panel_gal.h>
 
 
 /*
@@ -210,6 +211,15 @@ void GERBER_LAYER_WIDGET::onPopupSelection( wxCommandEvent& event )
 
     case ID_SORT_GBR_LAYERS:
         GetImagesList()->SortImagesByZOrder();
+
+        // The items are now on other graphic layers: the view must be rebuilt
+        if( myframe->IsGalCanvasActive() )
+        {
+            GERBVIEW_DRAW_PANEL_GAL* galCanvas =
+                    static_cast<GERBVIEW_DRAW_PANEL_GAL*>( myframe->GetGalCanvas() );
+            galCanvas->DisplayLayout( myframe->GetGerberLayout() );
+        }
+
         myframe->ReFillLayerWidget();
         myframe->syncLayerBox( true );
         myframe->GetCanvas()->Refresh();
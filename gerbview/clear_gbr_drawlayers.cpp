@@ -35,6 +35,8 @@
 #include <class_gerber_file_image.h>
 #include <class_gerber_file_image_list.h>
 #include <class_gerbview_layer_widget.h>
+#include <class_draw_panel_gal.h>
+#include <view/view.h>
 
 bool GERBVIEW_FRAME::Clear_DrawLayers( bool query )
 {
@@ -47,6 +49,10 @@ bool GERBVIEW_FRAME::Clear_DrawLayers( bool query )
             return false;
     }
 
+    // Faster than removing the items one by one from the view, when they are deleted
+    if( IsGalCanvasActive() )
+        GetGalCanvas()->GetView()->Clear();
+
     GetImagesList()->DeleteAllImages();
 
     GetGerberLayout()->SetBoundingBox( EDA_RECT() );
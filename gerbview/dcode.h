@@ -193,6 +193,19 @@ public:
                              EDA_RECT* aClipBox, wxDC* aDC, EDA_COLOR_T aColor,
                              bool aFilled, const wxPoint& aPosition );
 
+    /**
+     * Function GetShapePolygon
+     * @return the polygon used to draw the shape (relative to the shape position, in X,Y
+     * gerber axis), built by ConvertShapeToPolygon() on the first call
+     */
+    const std::vector<wxPoint>& GetShapePolygon()
+    {
+        if( m_PolyCorners.size() == 0 )
+            ConvertShapeToPolygon();
+
+        return m_PolyCorners;
+    }
+
     /**
      * Function ConvertShapeToPolygon
      * convert a shape to an equivalent polygon.
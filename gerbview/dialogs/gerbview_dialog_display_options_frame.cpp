@@ -162,6 +162,7 @@ void DIALOG_DISPLAY_OPTIONS::OnOKBUttonClick( wxCommandEvent& event )
         m_Parent->m_DisplayOptions.m_DisplayPolygonsFill = true;
 
     m_Parent->SetElementVisibility( DCODES_VISIBLE, m_OptDisplayDCodes->GetValue() );
+    m_Parent->UpdateGalDisplayOptions();
 
     int idx = m_ShowPageLimits->GetSelection();
 
@@ -159,7 +159,6 @@ static EXCELLON_CMD excellon_G_CmdList[] =
 
 bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
 {
-    wxString msg;
     int layerId = getActiveLayer();      // current layer used in GerbView
     GERBER_FILE_IMAGE_LIST* images = GetGerberLayout()->GetImagesList();
     EXCELLON_IMAGE* drill_Layer = (EXCELLON_IMAGE*) images->GetGbrImage( layerId );
@@ -179,21 +178,30 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
     // Read the Excellon drill file:
     bool success = drill_Layer->LoadFile( aFullFileName );
 
-    if( !success )
+    return reportExcellonFileLoad( drill_Layer, aFullFileName, success );
+}
+
+
+bool GERBVIEW_FRAME::reportExcellonFileLoad( GERBER_FILE_IMAGE* aDrillLayer,
+                                             const wxString& aFileName, bool aSuccess )
+{
+    if( !aSuccess )
     {
-        msg.Printf( _( "File %s not found" ), GetChars( aFullFileName ) );
+        wxString msg;
+        msg.Printf( _( "File %s not found" ), GetChars( aFileName ) );
         DisplayError( this, msg );
         return false;
     }
 
     // Display errors list
-    if( drill_Layer->GetMessages().size() > 0 )
+    if( aDrillLayer->GetMessages().size() > 0 )
     {
         HTML_MESSAGE_BOX dlg( this, _( "Error reading EXCELLON drill file" ) );
-        dlg.ListSet( drill_Layer->GetMessages() );
+        dlg.ListSet( aDrillLayer->GetMessages() );
         dlg.ShowModal();
     }
-    return success;
+
+    return true;
 }
 
 /*
@@ -242,7 +242,22 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
         GERBER_DRAW_ITEM* gerb_item = gerber->GetItemsList();
 
         for( ; gerb_item; gerb_item = gerb_item->Next() )
-            export_non_copper_item( gerb_item, pcb_layer_number );
+        {
+            if( gerb_item->GetInstanceCount() == 1 )
+            {
+                export_non_copper_item( gerb_item, pcb_layer_number );
+                continue;
+            }
+
+            // Step and repeat: export a copy of the item for each instance
+            for( int ii = 0; ii < gerb_item->GetInstanceCount(); ii++ )
+            {
+                GERBER_DRAW_ITEM instance( *gerb_item );
+
+                instance.MoveXY( gerb_item->GetInstanceOffset( ii ) );
+                export_non_copper_item( &instance, pcb_layer_number );
+            }
+        }
     }
 
     // Copper layers
@@ -261,7 +276,22 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
         GERBER_DRAW_ITEM* gerb_item = gerber->GetItemsList();
 
         for( ; gerb_item; gerb_item = gerb_item->Next() )
-            export_copper_item( gerb_item, pcb_layer_number );
+        {
+            if( gerb_item->GetInstanceCount() == 1 )
+            {
+                export_copper_item( gerb_item, pcb_layer_number );
+                continue;
+            }
+
+            // Step and repeat: export a copy of the item for each instance
+            for( int ii = 0; ii < gerb_item->GetInstanceCount(); ii++ )
+            {
+                GERBER_DRAW_ITEM instance( *gerb_item );
+
+                instance.MoveXY( gerb_item->GetInstanceOffset( ii ) );
+                export_copper_item( &instance, pcb_layer_number );
+            }
+        }
     }
 
     fprintf( m_fp, ")\n" );
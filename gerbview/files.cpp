@@ -34,6 +34,13 @@
 #include <gerbview_id.h>
 #include <class_gerbview_layer_widget.h>
 #include <wildcards_and_files_ext.h>
+#include <class_gerber_file_image.h>
+#include <class_gerber_file_image_list.h>
+#include <class_excellon.h>
+#include <gerbview_draw_panel_gal.h>
+
+// Trace mask used to print the load time of the files
+static const wxChar traceGerbviewLoad[] = wxT( "GerbviewLoad" );
 
 
 void GERBVIEW_FRAME::OnGbrFileHistory( wxCommandEvent& event )
@@ -174,9 +181,6 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         m_mruPath = currentPath;
     }
 
-    // Read gerber files: each file is loaded on a new GerbView layer
-    int layer = getActiveLayer();
-
     for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
     {
         filename = filenamesList[ii];
@@ -184,35 +188,12 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         if( !filename.IsAbsolute() )
             filename.SetPath( currentPath );
 
-        m_lastFileName = filename.GetFullPath();
-
-        setActiveLayer( layer, false );
-
-        if( Read_GERBER_File( filename.GetFullPath() ) )
-        {
-            UpdateFileHistory( m_lastFileName );
-
-            layer = getNextAvailableLayer( layer );
-
-            if( layer == NO_AVAILABLE_LAYERS )
-            {
-                wxString msg = wxT( "No more empty available layers.\n"
-                                    "The remaining gerber files will not be loaded." );
-                wxMessageBox( msg );
-                break;
-            }
-
-            setActiveLayer( layer, false );
-        }
+        filenamesList[ii] = filename.GetFullPath();
     }
 
-    Zoom_Automatique( false );
+    // Read gerber files: each file is loaded on a new GerbView layer
+    loadFiles( filenamesList, false );
 
-    // Synchronize layers tools with actual active layer:
-    ReFillLayerWidget();
-    setActiveLayer( getActiveLayer() );
-    m_LayersManager->UpdateLayerIcons();
-    syncLayerBox();
     return true;
 }
 
@@ -258,9 +239,6 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
         m_mruPath = currentPath;
     }
 
-    // Read gerber files: each file is loaded on a new GerbView layer
-    int layer = getActiveLayer();
-
     for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
     {
         filename = filenamesList[ii];
@@ -268,27 +246,139 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
         if( !filename.IsAbsolute() )
             filename.SetPath( currentPath );
 
-        m_lastFileName = filename.GetFullPath();
+        filenamesList[ii] = filename.GetFullPath();
+    }
 
-        setActiveLayer( layer, false );
+    // Read drill files: each file is loaded on a new GerbView layer
+    loadFiles( filenamesList, true );
 
-        if( Read_EXCELLON_File( filename.GetFullPath() ) )
-        {
-            // Update the list of recent drill files.
-            UpdateFileHistory( filename.GetFullPath(),  &m_drillFileHistory );
+    return true;
+}
 
+
+void GERBVIEW_FRAME::loadFiles( const wxArrayString& aFileNames, bool aExcellon )
+{
+    GERBER_FILE_IMAGE_LIST* images = GetImagesList();
+    std::vector<GERBER_FILE_IMAGE*> fileImages;
+    std::vector<int> layers;
+
+    // Give a layer and an image to each file, the first one in the active layer.
+    // This is done before reading the files, which can then be read in parallel.
+    int layer = getActiveLayer();
+
+    for( unsigned ii = 0; ii < aFileNames.GetCount(); ii++ )
+    {
+        if( ii > 0 )
             layer = getNextAvailableLayer( layer );
 
-            if( layer == NO_AVAILABLE_LAYERS )
+        if( layer == NO_AVAILABLE_LAYERS )
+        {
+            wxString msg = wxT( "No more empty available layers.\n"
+                                "The remaining gerber files will not be loaded." );
+            wxMessageBox( msg );
+            break;
+        }
+
+        // The previous image of the layer is deleted here, and not cleared by the reader:
+        // its items can be in the GAL view, and must be removed from the main thread.
+        // (it also gives an EXCELLON_IMAGE to a drill file)
+        if( GetGbrImage( layer ) )
+            images->DeleteImage( layer );
+
+        GERBER_FILE_IMAGE* image;
+
+        if( aExcellon )
+            image = new EXCELLON_IMAGE( layer );
+        else
+            image = new GERBER_FILE_IMAGE( layer );
+
+        images->AddGbrImage( image, layer );
+
+        fileImages.push_back( image );
+        layers.push_back( layer );
+    }
+
+    int count = fileImages.size();
+    std::vector<char> success( count );
+    std::vector<unsigned> times( count );
+    unsigned start = GetRunningMicroSecs();
+
+    // Switch the locale to standard C once for all the files: the LOCALE_IO of the
+    // readers in the worker threads then leave the locale untouched.
+    LOCALE_IO toggle;
+
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 ) private( i )
+#endif /* USE_OPENMP */
+    for( i = 0; i < count; i++ )
+    {
+        unsigned fileStart = GetRunningMicroSecs();
+
+        if( aExcellon )
+            success[i] = static_cast<EXCELLON_IMAGE*>( fileImages[i] )->LoadFile( aFileNames[i] );
+        else
+            success[i] = fileImages[i]->LoadGerberFile( aFileNames[i] );
+
+        times[i] = GetRunningMicroSecs() - fileStart;
+    }
+
+    wxLogTrace( traceGerbviewLoad, wxT( "%d files read in %.1f ms" ),
+                count, ( GetRunningMicroSecs() - start ) / 1000.0 );
+
+    // Report the errors, in the file order
+    for( i = 0; i < count; i++ )
+    {
+        if( wxLog::IsAllowedTraceMask( traceGerbviewLoad ) )
+        {
+            // The items are stored once, and drawn once per step and repeat instance
+            int items = 0;
+            int instances = 0;
+
+            for( GERBER_DRAW_ITEM* item = fileImages[i]->GetItemsList(); item;
+                 item = item->Next() )
             {
-                wxString msg = wxT( "No more empty available layers.\n"
-                                    "The remaining gerber files will not be loaded." );
-                wxMessageBox( msg );
-                break;
+                items++;
+                instances += item->GetInstanceCount();
             }
 
-            setActiveLayer( layer, false );
+            wxLogTrace( traceGerbviewLoad, wxT( "%8.1f ms  %s (%d items, %d drawn)" ),
+                        times[i] / 1000.0, GetChars( aFileNames[i] ), items, instances );
+        }
+
+        m_lastFileName = aFileNames[i];
+
+        bool loaded;
+
+        if( aExcellon )
+            loaded = reportExcellonFileLoad( fileImages[i], aFileNames[i], success[i] );
+        else
+            loaded = reportGerberFileLoad( fileImages[i], aFileNames[i], success[i] );
+
+        if( !loaded )
+        {
+            images->DeleteImage( layers[i] );
+            continue;
         }
+
+        if( IsGalCanvasActive() )
+            static_cast<GERBVIEW_DRAW_PANEL_GAL*>( GetGalCanvas() )->AddImage( fileImages[i] );
+
+        // Update the list of recent files.
+        if( aExcellon )
+            UpdateFileHistory( aFileNames[i], &m_drillFileHistory );
+        else
+            UpdateFileHistory( aFileNames[i] );
+    }
+
+    // The next files will be loaded in the next available layer
+    if( count > 0 )
+    {
+        layer = getNextAvailableLayer( layers.back() );
+
+        if( layer != NO_AVAILABLE_LAYERS )
+            setActiveLayer( layer, false );
     }
 
     Zoom_Automatique( false );
@@ -298,6 +388,4 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
     setActiveLayer( getActiveLayer() );
     m_LayersManager->UpdateLayerIcons();
     syncLayerBox();
-
-    return true;
 }
@@ -38,12 +38,23 @@
 */
 #define GERBER_BUFZ     4000
 
+/// size of the stdio buffer of the gerber files being read
+#define GERBER_FILE_BUFFER_SIZE ( 256 * 1024 )
+
 /// List of page sizes
 extern const wxChar* g_GerberPageSizeList[8];
 
 // number fo draw layers in Gerbview
 #define GERBER_DRAWLAYERS_COUNT 32
 
+/// GAL layers: each graphic layer x has one GAL layer for each polarity run of its
+/// image (the items between two polarity changes), drawn above the previous runs, so
+/// the dark and clear items hide each other in file order.
+/// The runs beyond GERBER_GAL_RUN_COUNT share the last two GAL layers of their graphic layer.
+#define GERBER_GAL_RUN_COUNT            8
+#define GERBER_GAL_LAYER( x, run )      ( ( x ) * GERBER_GAL_RUN_COUNT + ( run ) )
+#define GERBER_GAL_LAYER_COUNT          ( GERBER_DRAWLAYERS_COUNT * GERBER_GAL_RUN_COUNT )
+
 /**
  * Enum GERBER_VISIBLE_ID
  * is a set of visible GERBVIEW elements.
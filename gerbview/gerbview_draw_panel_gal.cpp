@@ -0,0 +1,145 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <gerbview_draw_panel_gal.h>
+#include <view/view.h>
+#include <gerbview_painter.h>
+
+#include <class_colors_design_settings.h>
+#include <class_gbr_display_options.h>
+#include <class_gbr_layout.h>
+#include <class_gerber_file_image.h>
+#include <class_gerber_file_image_list.h>
+#include <class_gerber_draw_item.h>
+
+
+GERBVIEW_DRAW_PANEL_GAL::GERBVIEW_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWindowId,
+                                                  const wxPoint& aPosition, const wxSize& aSize,
+                                                  GAL_TYPE aGalType ) :
+EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
+{
+    m_painter = new KIGFX::GERBVIEW_PAINTER( m_gal );
+    m_view->SetPainter( m_painter );
+
+    setDefaultLayerOrder();
+}
+
+
+GERBVIEW_DRAW_PANEL_GAL::~GERBVIEW_DRAW_PANEL_GAL()
+{
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::DisplayLayout( GBR_LAYOUT* aLayout )
+{
+    m_view->Clear();
+
+    GERBER_FILE_IMAGE_LIST* images = aLayout->GetImagesList();
+
+    for( unsigned ii = 0; ii < images->ImagesMaxCount(); ii++ )
+    {
+        GERBER_FILE_IMAGE* image = images->GetGbrImage( ii );
+
+        if( image )
+            AddImage( image );
+    }
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::AddImage( GERBER_FILE_IMAGE* aImage )
+{
+    GERBER_DRAW_ITEM* item = aImage->GetItemsList();
+
+    // The items are in file order: count the polarity changes to find their runs
+    int  run = 0;
+    bool negative = item && item->HasNegativeItems();
+
+    // The geometry of each item is built once, in its cached group
+    for( ; item; item = item->Next() )
+    {
+        if( item->HasNegativeItems() != negative )
+        {
+            negative = !negative;
+            run++;
+        }
+
+        item->SetPolarityRun( run );
+        m_view->Add( item );
+    }
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::UseColorScheme( const COLORS_DESIGN_SETTINGS* aSettings )
+{
+    KIGFX::GERBVIEW_RENDER_SETTINGS* rs;
+    rs = static_cast<KIGFX::GERBVIEW_RENDER_SETTINGS*>( m_view->GetPainter()->GetSettings() );
+    rs->ImportLegacyColors( aSettings );
+
+    m_view->UpdateAllLayersColor();
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::UseDisplayOptions( const GBR_DISPLAY_OPTIONS* aOptions )
+{
+    KIGFX::GERBVIEW_RENDER_SETTINGS* rs;
+    rs = static_cast<KIGFX::GERBVIEW_RENDER_SETTINGS*>( m_view->GetPainter()->GetSettings() );
+    rs->LoadDisplayOptions( aOptions );
+
+    // The fill modes change the geometry itself, not only its color
+    m_view->RecacheAllItems();
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::SetGraphicLayerVisible( int aLayer, bool aVisible )
+{
+    for( int run = 0; run < GERBER_GAL_RUN_COUNT; run++ )
+        m_view->SetLayerVisible( GERBER_GAL_LAYER( aLayer, run ), aVisible );
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::SetTopLayer( LAYER_ID aLayer )
+{
+    m_view->ClearTopLayers();
+    setDefaultLayerOrder();
+
+    // The polarity runs of the layer keep their order
+    for( int run = 0; run < GERBER_GAL_RUN_COUNT; run++ )
+        m_view->SetTopLayer( GERBER_GAL_LAYER( aLayer, run ) );
+
+    m_view->UpdateAllLayersOrder();
+}
+
+
+void GERBVIEW_DRAW_PANEL_GAL::setDefaultLayerOrder()
+{
+    wxASSERT( GERBER_GAL_LAYER_COUNT <= KIGFX::VIEW::VIEW_MAX_LAYERS );
+
+    // The first graphic layer is drawn on top, and the polarity runs of a layer
+    // are drawn above the previous ones
+    for( int layer = 0; layer < GERBER_DRAWLAYERS_COUNT; layer++ )
+    {
+        for( int run = 0; run < GERBER_GAL_RUN_COUNT; run++ )
+            m_view->SetLayerOrder( GERBER_GAL_LAYER( layer, run ),
+                                   GERBER_GAL_LAYER( layer, GERBER_GAL_RUN_COUNT - 1 - run ) );
+    }
+}
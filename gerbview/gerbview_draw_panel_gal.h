@@ -0,0 +1,87 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef GERBVIEW_DRAW_PANEL_GAL_H_
+#define GERBVIEW_DRAW_PANEL_GAL_H_
+
+#include <class_draw_panel_gal.h>
+
+class COLORS_DESIGN_SETTINGS;
+class GBR_DISPLAY_OPTIONS;
+class GBR_LAYOUT;
+class GERBER_FILE_IMAGE;
+
+class GERBVIEW_DRAW_PANEL_GAL : public EDA_DRAW_PANEL_GAL
+{
+public:
+    GERBVIEW_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWindowId,
+                             const wxPoint& aPosition, const wxSize& aSize,
+                             GAL_TYPE aGalType = GAL_TYPE_OPENGL );
+
+    virtual ~GERBVIEW_DRAW_PANEL_GAL();
+
+    /**
+     * Function DisplayLayout
+     * adds all the items of all the gerber images of aLayout to the VIEW,
+     * so they can be displayed by GAL.
+     * @param aLayout is the layout to be loaded.
+     */
+    void DisplayLayout( GBR_LAYOUT* aLayout );
+
+    /**
+     * Function AddImage
+     * adds the items of a newly loaded gerber image to the VIEW.
+     * @param aImage is the gerber image to be added.
+     */
+    void AddImage( GERBER_FILE_IMAGE* aImage );
+
+    /**
+     * Function UseColorScheme
+     * Applies layer color settings.
+     * @param aSettings are the new settings.
+     */
+    void UseColorScheme( const COLORS_DESIGN_SETTINGS* aSettings );
+
+    /**
+     * Function UseDisplayOptions
+     * Applies the display options (filled or sketch modes, negative objects color) and
+     * rebuilds the cached geometry.
+     * @param aOptions are the new options.
+     */
+    void UseDisplayOptions( const GBR_DISPLAY_OPTIONS* aOptions );
+
+    /**
+     * Function SetGraphicLayerVisible
+     * shows or hides the items of a graphic layer (all its polarity runs).
+     */
+    void SetGraphicLayerVisible( int aLayer, bool aVisible );
+
+    ///> @copydoc EDA_DRAW_PANEL_GAL::SetTopLayer()
+    virtual void SetTopLayer( LAYER_ID aLayer );
+
+protected:
+    ///> Reassigns layer order to the initial settings.
+    void setDefaultLayerOrder();
+};
+
+#endif /* GERBVIEW_DRAW_PANEL_GAL_H_ */
@@ -47,6 +47,10 @@
 #include <dialog_helpers.h>
 #include <class_DCodeSelectionbox.h>
 #include <class_gerbview_layer_widget.h>
+#include <gerbview_draw_panel_gal.h>
+#include <view/view.h>
+#include <gal/graphics_abstraction_layer.h>
+#include <painter.h>
 
 
 // Config keywords
@@ -84,6 +88,12 @@ GERBVIEW_FRAME::GERBVIEW_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     if( m_canvas )
         m_canvas->SetEnableBlockCommands( true );
 
+    // Create GAL canvas
+    EDA_DRAW_PANEL_GAL* galCanvas = new GERBVIEW_DRAW_PANEL_GAL( this, -1, wxPoint( 0, 0 ),
+                                                m_FrameSize, EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE );
+
+    SetGalCanvas( galCanvas );
+
     // Give an icon
     wxIcon icon;
     icon.CopyFromBitmap( KiBitmap( icon_gerbview_xpm ) );
@@ -168,6 +178,10 @@ GERBVIEW_FRAME::GERBVIEW_FRAME( KIWAY* aKiway, wxWindow* aParent ):
         m_auimgr.AddPane( m_canvas,
                           wxAuiPaneInfo().Name( wxT( "DrawFrame" ) ).CentrePane() );
 
+    if( GetGalCanvas() )
+        m_auimgr.AddPane( (wxWindow*) GetGalCanvas(),
+                          wxAuiPaneInfo().Name( wxT( "DrawFrameGal" ) ).CentrePane().Hide() );
+
     if( m_messagePanel )
         m_auimgr.AddPane( m_messagePanel,
                           wxAuiPaneInfo( mesg ).Name( wxT( "MsgPanel" ) ).Bottom().Layer( 10 ) );
@@ -179,11 +193,22 @@ GERBVIEW_FRAME::GERBVIEW_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     setActiveLayer( 0, true );
     Zoom_Automatique( false );           // Gives a default zoom value
     UpdateTitleAndInfo();
+
+    EDA_DRAW_PANEL_GAL::GAL_TYPE canvasType = LoadCanvasTypeSetting();
+
+    if( canvasType != EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE )
+    {
+        if( GetGalCanvas()->SwitchBackend( canvasType ) )
+            UseGalCanvas( true );
+    }
 }
 
 
 GERBVIEW_FRAME::~GERBVIEW_FRAME()
 {
+    // The view must not keep references to the items of the layout
+    GetGalCanvas()->StopDrawing();
+    GetGalCanvas()->GetView()->Clear();
 }
 
 
@@ -360,6 +385,7 @@ void GERBVIEW_FRAME::SetElementVisibility( GERBER_VISIBLE_ID aItemIdVisible,
 
     case NEGATIVE_OBJECTS_VISIBLE:
         m_DisplayOptions.m_DisplayNegativeObjects = aNewState;
+        UpdateGalDisplayOptions();
         break;
 
     case GERBER_GRID_VISIBLE:
@@ -578,6 +604,14 @@ long GERBVIEW_FRAME::GetVisibleLayers() const
 void GERBVIEW_FRAME::SetVisibleLayers( long aLayerMask )
 {
 //    GetGerberLayout()->SetVisibleLayers( aLayerMask );
+
+    if( IsGalCanvasActive() )
+    {
+        GERBVIEW_DRAW_PANEL_GAL* galCanvas = static_cast<GERBVIEW_DRAW_PANEL_GAL*>( GetGalCanvas() );
+
+        for( int layer = 0; layer < GERBER_DRAWLAYERS_COUNT; layer++ )
+            galCanvas->SetGraphicLayerVisible( layer, aLayerMask & ( 1 << layer ) );
+    }
 }
 
 
@@ -618,6 +652,12 @@ void GERBVIEW_FRAME::SetGridVisibility( bool aVisible )
 {
     EDA_DRAW_FRAME::SetGridVisibility( aVisible );
     m_LayersManager->SetRenderState( GERBER_GRID_VISIBLE, aVisible );
+
+    if( IsGalCanvasActive() )
+    {
+        GetGalCanvas()->GetGAL()->SetGridVisibility( aVisible );
+        GetGalCanvas()->GetView()->MarkTargetDirty( KIGFX::TARGET_NONCACHED );
+    }
 }
 
 
@@ -640,6 +680,8 @@ void GERBVIEW_FRAME::SetVisibleElementColor( GERBER_VISIBLE_ID aItemIdVisible,
         wxLogDebug( wxT( "GERBVIEW_FRAME::SetVisibleElementColor(): bad arg %d" ),
                     (int) aItemIdVisible );
     }
+
+    UpdateGalDisplayOptions();
 }
 
 EDA_COLOR_T GERBVIEW_FRAME::GetNegativeItemsColor() const
@@ -660,6 +702,9 @@ EDA_COLOR_T GERBVIEW_FRAME::GetLayerColor( int aLayer ) const
 void GERBVIEW_FRAME::SetLayerColor( int aLayer, EDA_COLOR_T aColor )
 {
     m_colorsSettings->SetLayerColor( aLayer, aColor );
+
+    if( IsGalCanvasActive() )
+        static_cast<GERBVIEW_DRAW_PANEL_GAL*>( GetGalCanvas() )->UseColorScheme( m_colorsSettings );
 }
 
 
@@ -675,6 +720,10 @@ void GERBVIEW_FRAME::setActiveLayer( int aLayer, bool doLayerWidgetUpdate )
 
     if( doLayerWidgetUpdate )
         m_LayersManager->SelectLayer( getActiveLayer() );
+
+    // The active layer is drawn on top of the other layers
+    if( IsGalCanvasActive() )
+        GetGalCanvas()->SetTopLayer( (LAYER_ID) aLayer );
 }
 
 
@@ -874,4 +923,79 @@ void GERBVIEW_FRAME::unitsChangeRefresh()
 {   // Called on units change (see EDA_DRAW_FRAME)
     EDA_DRAW_FRAME::unitsChangeRefresh();
     updateDCodeSelectBox();
-}
\ No newline at end of file
+}
+
+
+void GERBVIEW_FRAME::UseGalCanvas( bool aEnable )
+{
+    EDA_DRAW_FRAME::UseGalCanvas( aEnable );
+
+    if( aEnable )
+    {
+        GERBVIEW_DRAW_PANEL_GAL* galCanvas = static_cast<GERBVIEW_DRAW_PANEL_GAL*>( GetGalCanvas() );
+
+        // The items geometry is cached by the view: it is built only once
+        galCanvas->DisplayLayout( GetGerberLayout() );
+        galCanvas->GetGAL()->SetGridVisibility( IsGridVisible() );
+
+        UpdateGalDisplayOptions();
+
+        for( int layer = 0; layer < GERBER_DRAWLAYERS_COUNT; layer++ )
+            galCanvas->SetGraphicLayerVisible( layer, IsLayerVisible( layer ) );
+
+        galCanvas->SetTopLayer( (LAYER_ID) getActiveLayer() );
+        galCanvas->StartDrawing();
+    }
+    else
+    {
+        GetGalCanvas()->StopDrawing();
+    }
+}
+
+
+void GERBVIEW_FRAME::SwitchCanvas( wxCommandEvent& aEvent )
+{
+    bool use_gal = false;
+    EDA_DRAW_PANEL_GAL::GAL_TYPE canvasType = EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE;
+
+    switch( aEvent.GetId() )
+    {
+    case ID_MENU_CANVAS_LEGACY:
+        break;
+
+    case ID_MENU_CANVAS_CAIRO:
+        use_gal = GetGalCanvas()->SwitchBackend( EDA_DRAW_PANEL_GAL::GAL_TYPE_CAIRO );
+
+        if( use_gal )
+            canvasType = EDA_DRAW_PANEL_GAL::GAL_TYPE_CAIRO;
+        break;
+
+    case ID_MENU_CANVAS_OPENGL:
+        use_gal = GetGalCanvas()->SwitchBackend( EDA_DRAW_PANEL_GAL::GAL_TYPE_OPENGL );
+
+        if( use_gal )
+            canvasType = EDA_DRAW_PANEL_GAL::GAL_TYPE_OPENGL;
+        break;
+    }
+
+    SaveCanvasTypeSetting( canvasType );
+    UseGalCanvas( use_gal );
+}
+
+
+void GERBVIEW_FRAME::UpdateGalDisplayOptions()
+{
+    if( !IsGalCanvasActive() )
+        return;
+
+    GERBVIEW_DRAW_PANEL_GAL* galCanvas = static_cast<GERBVIEW_DRAW_PANEL_GAL*>( GetGalCanvas() );
+    KIGFX::RENDER_SETTINGS*  settings = galCanvas->GetView()->GetPainter()->GetSettings();
+
+    m_DisplayOptions.m_NegativeDrawColor = GetNegativeItemsColor();
+    m_DisplayOptions.m_BgDrawColor = GetDrawBgColor();
+
+    settings->SetGridColor( settings->TranslateColor( GetGridColor() ) );
+
+    galCanvas->UseColorScheme( m_colorsSettings );
+    galCanvas->UseDisplayOptions( &m_DisplayOptions );
+}
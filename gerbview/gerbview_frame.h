@@ -149,6 +149,23 @@ public:
      */
     int SelectPCBLayer( int aDefaultLayer, int aOpperLayerCount, bool aNullLayer = false );
 
+    ///> @copydoc EDA_DRAW_FRAME::UseGalCanvas
+    virtual void UseGalCanvas( bool aEnable );
+
+    /**
+     * Function SwitchCanvas
+     * switches currently used canvas (default / Cairo / OpenGL).
+     */
+    void SwitchCanvas( wxCommandEvent& aEvent );
+
+    /**
+     * Function UpdateGalDisplayOptions
+     * applies the display options and the colors to the GAL canvas, if it is the
+     * active canvas. The cached items are rebuilt, because the fill modes change the
+     * geometry of the items.
+     */
+    void UpdateGalDisplayOptions();
+
 protected:
     GERBER_LAYER_WIDGET*    m_LayersManager;
 
@@ -194,6 +211,33 @@ private:
     void            updateDCodeSelectBox();
     virtual void    unitsChangeRefresh() override;      // See class EDA_DRAW_FRAME
 
+    /**
+     * Function loadFiles
+     * loads a list of Gerber or Excellon files, each one in a new image: the first one
+     * in the active layer, the next ones in the next available layers. The files are
+     * independent, so they are read in parallel; the errors are reported, and the file
+     * histories updated, once all of them are read.
+     * @param aFileNames = the full file names
+     * @param aExcellon = true for drill files, false for Gerber files
+     */
+    void            loadFiles( const wxArrayString& aFileNames, bool aExcellon );
+
+    /**
+     * Function reportGerberFileLoad
+     * shows the errors and warnings of the Gerber file aFileName, read in aGerber.
+     * @return aSuccess
+     */
+    bool            reportGerberFileLoad( GERBER_FILE_IMAGE* aGerber,
+                                          const wxString& aFileName, bool aSuccess );
+
+    /**
+     * Function reportExcellonFileLoad
+     * shows the errors of the drill file aFileName, read in aDrillLayer.
+     * @return aSuccess
+     */
+    bool            reportExcellonFileLoad( GERBER_FILE_IMAGE* aDrillLayer,
+                                            const wxString& aFileName, bool aSuccess );
+
     // An array string to store warning messages when reading a gerber file.
     wxArrayString   m_Messages;
 
@@ -0,0 +1,373 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <trigo.h>
+#include <class_colors_design_settings.h>
+#include <class_gbr_display_options.h>
+#include <class_gerber_draw_item.h>
+#include <class_aperture_macro.h>
+#include <dcode.h>
+
+#include <gerbview_painter.h>
+#include <gal/graphics_abstraction_layer.h>
+#include <geometry/shape_poly_set.h>
+
+using namespace KIGFX;
+
+GERBVIEW_RENDER_SETTINGS::GERBVIEW_RENDER_SETTINGS()
+{
+    m_backgroundColor    = COLOR4D( 0.0, 0.0, 0.0, 1.0 );
+    m_negativeColor      = m_backgroundColor;
+    m_flashedItemsSketch = false;
+    m_linesSketch        = false;
+    m_polygonsSketch     = false;
+
+    update();
+}
+
+
+void GERBVIEW_RENDER_SETTINGS::ImportLegacyColors( const COLORS_DESIGN_SETTINGS* aSettings )
+{
+    for( int i = 0; i < GERBER_DRAWLAYERS_COUNT; i++ )
+        m_layerColors[i] = m_legacyColorMap[aSettings->GetLayerColor( i )];
+
+    update();
+}
+
+
+void GERBVIEW_RENDER_SETTINGS::LoadDisplayOptions( const GBR_DISPLAY_OPTIONS* aOptions )
+{
+    if( aOptions == NULL )
+        return;
+
+    m_flashedItemsSketch = !aOptions->m_DisplayFlashedItemsFill;
+    m_linesSketch        = !aOptions->m_DisplayLinesFill;
+    m_polygonsSketch     = !aOptions->m_DisplayPolygonsFill;
+
+    // The negative objects hide the positive ones below them: they are opaque
+    m_negativeColor   = TranslateColor( aOptions->m_NegativeDrawColor );
+    m_negativeColor.a = 1.0;
+
+    m_backgroundColor   = TranslateColor( aOptions->m_BgDrawColor );
+    m_backgroundColor.a = 1.0;
+
+    update();
+}
+
+
+const COLOR4D& GERBVIEW_RENDER_SETTINGS::GetColor( const VIEW_ITEM* aItem, int aLayer ) const
+{
+    const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
+
+    // The negative items are drawn in the negative objects color, whatever their layer
+    if( item && item->Type() == TYPE_GERBER_DRAW_ITEM
+        && static_cast<const GERBER_DRAW_ITEM*>( item )->HasNegativeItems() )
+        return m_negativeColor;
+
+    return m_layerColors[aLayer / GERBER_GAL_RUN_COUNT];
+}
+
+
+GERBVIEW_PAINTER::GERBVIEW_PAINTER( GAL* aGal ) :
+    PAINTER( aGal )
+{
+}
+
+
+bool GERBVIEW_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
+{
+    const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
+
+    if( item->Type() != TYPE_GERBER_DRAW_ITEM )
+        return false;
+
+    // The D_CODE and the aperture macro shapes are built on request
+    GERBER_DRAW_ITEM* gbrItem = const_cast<GERBER_DRAW_ITEM*>(
+                                        static_cast<const GERBER_DRAW_ITEM*>( item ) );
+
+    // Step and repeat: all the instances are drawn in the cached group of the item
+    for( int ii = 0; ii < gbrItem->GetInstanceCount(); ii++ )
+        draw( gbrItem, gbrItem->GetInstanceOffset( ii ), aLayer );
+
+    return true;
+}
+
+
+void GERBVIEW_PAINTER::setupStyle( const COLOR4D& aColor, bool aFilled )
+{
+    m_gal->SetStrokeColor( aColor );
+
+    if( aFilled )
+    {
+        m_gal->SetFillColor( aColor );
+        m_gal->SetIsFill( true );
+        m_gal->SetIsStroke( false );
+    }
+    else
+    {
+        m_gal->SetLineWidth( m_gerbviewSettings.m_outlineWidth );
+        m_gal->SetIsFill( false );
+        m_gal->SetIsStroke( true );
+    }
+}
+
+
+void GERBVIEW_PAINTER::draw( GERBER_DRAW_ITEM* aItem, const wxPoint& aOffset, int aLayer )
+{
+    // used when a D_CODE is not found. default D_CODE to draw a flashed item
+    static D_CODE dummyD_CODE( 0 );
+
+    const COLOR4D& color = m_gerbviewSettings.GetColor( aItem, aLayer );
+    bool isNegative = aItem->HasNegativeItems();
+    D_CODE* dcode = aItem->GetDcodeDescr();
+
+    if( dcode == NULL )
+        dcode = &dummyD_CODE;
+
+    bool isFilled = !m_gerbviewSettings.m_linesSketch;
+
+    switch( aItem->m_Shape )
+    {
+    case GBR_POLYGON:
+        // Negative polygons are always filled, as in legacy mode
+        isFilled = !m_gerbviewSettings.m_polygonsSketch || isNegative;
+        setupStyle( color, isFilled );
+        drawPolygon( aItem, aItem->m_PolyCorners, aOffset, isFilled );
+        break;
+
+    case GBR_CIRCLE:
+    {
+        VECTOR2D center( aItem->GetABPosition( aItem->m_Start + aOffset ) );
+        double   radius = GetLineLength( aItem->GetABPosition( aItem->m_Start ),
+                                         aItem->GetABPosition( aItem->m_End ) );
+        double   width = aItem->m_Size.x;
+
+        m_gal->SetStrokeColor( color );
+        m_gal->SetIsStroke( true );
+        m_gal->SetIsFill( false );
+
+        if( isFilled )
+        {
+            m_gal->SetLineWidth( width );
+            m_gal->DrawCircle( center, radius );
+        }
+        else
+        {
+            // draw the border of the pen's path using two circles, each as narrow as possible
+            m_gal->SetLineWidth( m_gerbviewSettings.m_outlineWidth );
+            m_gal->DrawCircle( center, radius - width / 2 );
+            m_gal->DrawCircle( center, radius + width / 2 );
+        }
+    }
+    break;
+
+    case GBR_ARC:
+    {
+        // Currently, arcs plotted with a rectangular aperture are not supported.
+        // a round pen only is expected.
+        wxPoint start  = aItem->GetABPosition( aItem->m_Start + aOffset );
+        wxPoint end    = aItem->GetABPosition( aItem->m_End + aOffset );
+        wxPoint center = aItem->GetABPosition( aItem->m_ArcCentre + aOffset );
+        double  radius = GetLineLength( start, center );
+
+        // As GRArc1(), draw counterclockwise (on screen) from start to end, i.e.
+        // from end to start with increasing angles in the screen axis
+        double startAngle = atan2( double( end.y - center.y ), double( end.x - center.x ) );
+        double endAngle   = atan2( double( start.y - center.y ), double( start.x - center.x ) );
+
+        if( endAngle <= startAngle )
+            endAngle += 2 * M_PI;
+
+        m_gal->SetStrokeColor( color );
+        m_gal->SetIsStroke( true );
+        m_gal->SetIsFill( false );
+        m_gal->SetLineWidth( isFilled ? aItem->m_Size.x : m_gerbviewSettings.m_outlineWidth );
+        m_gal->DrawArc( VECTOR2D( center ), radius, startAngle, endAngle );
+    }
+    break;
+
+    case GBR_SPOT_CIRCLE:
+    case GBR_SPOT_RECT:
+    case GBR_SPOT_OVAL:
+    case GBR_SPOT_POLY:
+    case GBR_SPOT_MACRO:
+        isFilled = !m_gerbviewSettings.m_flashedItemsSketch;
+        setupStyle( color, isFilled );
+        drawFlashedShape( aItem, dcode, aItem->m_Start + aOffset, isFilled );
+        break;
+
+    case GBR_SEGMENT:
+        setupStyle( color, isFilled );
+
+        // Usually, a round pen is used, but some gerber files use a rectangular pen
+        if( dcode->m_Shape == APT_RECT )
+        {
+            if( aItem->m_PolyCorners.size() == 0 )
+                aItem->ConvertSegmentToPolygon();
+
+            drawPolygon( aItem, aItem->m_PolyCorners, aOffset, isFilled );
+        }
+        else
+        {
+            // Cairo draws filled segments by stroking them
+            m_gal->SetIsStroke( true );
+            m_gal->DrawSegment( VECTOR2D( aItem->GetABPosition( aItem->m_Start + aOffset ) ),
+                                VECTOR2D( aItem->GetABPosition( aItem->m_End + aOffset ) ),
+                                aItem->m_Size.x );
+        }
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void GERBVIEW_PAINTER::drawFlashedShape( GERBER_DRAW_ITEM* aItem, D_CODE* aDcode,
+                                         const wxPoint& aShapePos, bool aFilled )
+{
+    switch( aDcode->m_Shape )
+    {
+    case APT_MACRO:
+    {
+        SHAPE_POLY_SET shapeBuffer;
+
+        if( aDcode->GetMacro() == NULL )
+            break;
+
+        aDcode->GetMacro()->GetApertureMacroShape( aItem, aShapePos, shapeBuffer );
+
+        for( int ii = 0; ii < shapeBuffer.OutlineCount(); ii++ )
+        {
+            const SHAPE_LINE_CHAIN& outline = shapeBuffer.COutline( ii );
+            std::deque<VECTOR2D> points;
+
+            for( int jj = 0; jj < outline.PointCount(); jj++ )
+                points.push_back( VECTOR2D( outline.CPoint( jj ) ) );
+
+            if( aFilled )
+            {
+                m_gal->DrawPolygon( points );
+            }
+            else
+            {
+                points.push_back( points[0] );
+                m_gal->DrawPolyline( points );
+            }
+        }
+    }
+    break;
+
+    case APT_CIRCLE:
+        if( aDcode->m_DrillShape == APT_DEF_NO_HOLE )
+            m_gal->DrawCircle( VECTOR2D( aItem->GetABPosition( aShapePos ) ),
+                               aDcode->m_Size.x / 2 );
+        else
+            drawPolygon( aItem, aDcode->GetShapePolygon(), aShapePos, aFilled );
+
+        break;
+
+    case APT_RECT:
+        if( aDcode->m_DrillShape == APT_DEF_NO_HOLE )
+        {
+            std::vector<wxPoint> corners( 4 );
+            wxSize half = aDcode->m_Size / 2;
+
+            corners[0] = wxPoint( -half.x, -half.y );
+            corners[1] = wxPoint( half.x, -half.y );
+            corners[2] = wxPoint( half.x, half.y );
+            corners[3] = wxPoint( -half.x, half.y );
+
+            drawPolygon( aItem, corners, aShapePos, aFilled );
+        }
+        else
+        {
+            drawPolygon( aItem, aDcode->GetShapePolygon(), aShapePos, aFilled );
+        }
+
+        break;
+
+    case APT_OVAL:
+        if( aDcode->m_DrillShape == APT_DEF_NO_HOLE )
+        {
+            wxPoint start = aShapePos;
+            wxPoint end   = aShapePos;
+            int     width;
+
+            if( aDcode->m_Size.x > aDcode->m_Size.y )   // horizontal oval
+            {
+                int delta = ( aDcode->m_Size.x - aDcode->m_Size.y ) / 2;
+                start.x -= delta;
+                end.x   += delta;
+                width    = aDcode->m_Size.y;
+            }
+            else                                        // vertical oval
+            {
+                int delta = ( aDcode->m_Size.y - aDcode->m_Size.x ) / 2;
+                start.y -= delta;
+                end.y   += delta;
+                width    = aDcode->m_Size.x;
+            }
+
+            m_gal->SetIsStroke( true );
+            m_gal->DrawSegment( VECTOR2D( aItem->GetABPosition( start ) ),
+                                VECTOR2D( aItem->GetABPosition( end ) ), width );
+        }
+        else
+        {
+            drawPolygon( aItem, aDcode->GetShapePolygon(), aShapePos, aFilled );
+        }
+
+        break;
+
+    case APT_POLYGON:
+        drawPolygon( aItem, aDcode->GetShapePolygon(), aShapePos, aFilled );
+        break;
+    }
+}
+
+
+void GERBVIEW_PAINTER::drawPolygon( GERBER_DRAW_ITEM* aItem,
+                                    const std::vector<wxPoint>& aCorners,
+                                    const wxPoint& aOffset, bool aFilled )
+{
+    if( aCorners.size() == 0 )
+        return;
+
+    std::deque<VECTOR2D> points;
+
+    for( unsigned ii = 0; ii < aCorners.size(); ii++ )
+        points.push_back( VECTOR2D( aItem->GetABPosition( aCorners[ii] + aOffset ) ) );
+
+    if( aFilled )
+    {
+        m_gal->DrawPolygon( points );
+    }
+    else
+    {
+        points.push_back( points[0] );
+        m_gal->DrawPolyline( points );
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __GERBVIEW_PAINTER_H
+#define __GERBVIEW_PAINTER_H
+
+#include <painter.h>
+#include <gerbview.h>
+
+#include <vector>
+
+
+class EDA_ITEM;
+class COLORS_DESIGN_SETTINGS;
+class GBR_DISPLAY_OPTIONS;
+class GERBER_DRAW_ITEM;
+class D_CODE;
+
+namespace KIGFX
+{
+class GAL;
+
+/**
+ * Class GERBVIEW_RENDER_SETTINGS
+ * Stores GerbView specific render settings.
+ */
+class GERBVIEW_RENDER_SETTINGS : public RENDER_SETTINGS
+{
+public:
+    friend class GERBVIEW_PAINTER;
+
+    GERBVIEW_RENDER_SETTINGS();
+
+    /// @copydoc RENDER_SETTINGS::ImportLegacyColors()
+    void ImportLegacyColors( const COLORS_DESIGN_SETTINGS* aSettings );
+
+    /**
+     * Function LoadDisplayOptions
+     * Loads settings related to display options (filled or sketch modes, color of the
+     * negative objects and background).
+     * @param aOptions are settings that you want to use for displaying items.
+     */
+    void LoadDisplayOptions( const GBR_DISPLAY_OPTIONS* aOptions );
+
+    /// @copydoc RENDER_SETTINGS::GetColor()
+    virtual const COLOR4D& GetColor( const VIEW_ITEM* aItem, int aLayer ) const;
+
+    /**
+     * Function GetLayerColor
+     * Returns the color used to draw the positive items of a graphic layer.
+     * @param aLayer is the graphic layer number.
+     */
+    inline const COLOR4D& GetLayerColor( int aLayer ) const
+    {
+        return m_layerColors[aLayer];
+    }
+
+    /**
+     * Function SetLayerColor
+     * Changes the color used to draw the positive items of a graphic layer.
+     * @param aLayer is the graphic layer number.
+     * @param aColor is the new color.
+     */
+    inline void SetLayerColor( int aLayer, const COLOR4D& aColor )
+    {
+        m_layerColors[aLayer] = aColor;
+    }
+
+protected:
+    ///> Colors of the positive items of each graphic layer
+    COLOR4D m_layerColors[GERBER_DRAWLAYERS_COUNT];
+
+    ///> Color of the negative objects, as set by the display options
+    COLOR4D m_negativeColor;
+
+    ///> Flags determining if items are drawn as an outline or filled
+    bool    m_flashedItemsSketch;
+    bool    m_linesSketch;
+    bool    m_polygonsSketch;
+};
+
+
+/**
+ * Class GERBVIEW_PAINTER
+ * Contains methods for drawing GerbView-specific items.
+ */
+class GERBVIEW_PAINTER : public PAINTER
+{
+public:
+    GERBVIEW_PAINTER( GAL* aGal );
+
+    /// @copydoc PAINTER::ApplySettings()
+    virtual void ApplySettings( const RENDER_SETTINGS* aSettings )
+    {
+        m_gerbviewSettings = *static_cast<const GERBVIEW_RENDER_SETTINGS*>( aSettings );
+    }
+
+    /// @copydoc PAINTER::GetSettings()
+    virtual GERBVIEW_RENDER_SETTINGS* GetSettings()
+    {
+        return &m_gerbviewSettings;
+    }
+
+    /// @copydoc PAINTER::Draw()
+    virtual bool Draw( const VIEW_ITEM* aItem, int aLayer );
+
+protected:
+    GERBVIEW_RENDER_SETTINGS m_gerbviewSettings;
+
+    // Draws one instance of a gerber item, at the XY offset aOffset
+    void draw( GERBER_DRAW_ITEM* aItem, const wxPoint& aOffset, int aLayer );
+
+    // Draws a flashed shape, at the XY position aShapePos
+    void drawFlashedShape( GERBER_DRAW_ITEM* aItem, D_CODE* aDcode, const wxPoint& aShapePos,
+                           bool aFilled );
+
+    // Draws a polygon, given in XY gerber axis, moved by aOffset
+    void drawPolygon( GERBER_DRAW_ITEM* aItem, const std::vector<wxPoint>& aCorners,
+                      const wxPoint& aOffset, bool aFilled );
+
+    // Sets the fill and stroke parameters of the GAL for aColor
+    void setupStyle( const COLOR4D& aColor, bool aFilled );
+};
+} // namespace KIGFX
+
+#endif /* __GERBVIEW_PAINTER_H */
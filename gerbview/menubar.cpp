@@ -169,6 +169,26 @@ void GERBVIEW_FRAME::ReCreateMenuBar()
                  KiBitmap( preference_xpm ) );
 #endif // __WXMAC__
 
+    // Canvas selection
+    configMenu->AppendSeparator();
+
+    AddMenuItem( configMenu, ID_MENU_CANVAS_LEGACY,
+                 _( "&Switch Canvas to Legacy" ),
+                 _( "Switch the canvas implementation to Legacy" ),
+                 KiBitmap( tools_xpm ) );
+
+    AddMenuItem( configMenu, ID_MENU_CANVAS_OPENGL,
+                 _( "Switch Canvas to Open&GL" ),
+                 _( "Switch the canvas implementation to OpenGL" ),
+                 KiBitmap( tools_xpm ) );
+
+    AddMenuItem( configMenu, ID_MENU_CANVAS_CAIRO,
+                 _( "Switch Canvas to &Cairo" ),
+                 _( "Switch the canvas implementation to Cairo" ),
+                 KiBitmap( tools_xpm ) );
+
+    configMenu->AppendSeparator();
+
     // Language submenu
     Pgm().AddMenuLanguageList( configMenu );
 
@@ -38,8 +38,6 @@
  */
 bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
 {
-    wxString msg;
-
     int layer = getActiveLayer();
     GERBER_FILE_IMAGE_LIST* images = GetImagesList();
     GERBER_FILE_IMAGE* gerber = GetGbrImage( layer );
@@ -53,25 +51,34 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
     /* Read the gerber file */
     bool success = gerber->LoadGerberFile( GERBER_FullFileName );
 
-    if( !success )
+    return reportGerberFileLoad( gerber, GERBER_FullFileName, success );
+}
+
+
+bool GERBVIEW_FRAME::reportGerberFileLoad( GERBER_FILE_IMAGE* aGerber,
+                                           const wxString& aFileName, bool aSuccess )
+{
+    wxString msg;
+
+    if( !aSuccess )
     {
-        msg.Printf( _( "File <%s> not found" ), GetChars( GERBER_FullFileName ) );
+        msg.Printf( _( "File <%s> not found" ), GetChars( aFileName ) );
         DisplayError( this, msg, 10 );
         return false;
     }
 
     // Display errors list
-    if( gerber->GetMessages().size() > 0 )
+    if( aGerber->GetMessages().size() > 0 )
     {
         HTML_MESSAGE_BOX dlg( this, _("Errors") );
-        dlg.ListSet(gerber->GetMessages());
+        dlg.ListSet(aGerber->GetMessages());
         dlg.ShowModal();
     }
 
     /* if the gerber file is only a RS274D file
      * (i.e. without any aperture information), wran the user:
      */
-    if( !gerber->m_Has_DCode )
+    if( !aGerber->m_Has_DCode )
     {
         msg = _("Warning: this file has no D-Code definition\n"
                 "It is perhaps an old RS274D file\n"
@@ -99,13 +106,12 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
     if( m_Current_File == 0 )
         return false;
 
-    m_FileName = aFullFileName;
+    // The file is read line by line: a large buffer saves a lot of read calls
+    setvbuf( m_Current_File, NULL, _IOFBF, GERBER_FILE_BUFFER_SIZE );
 
-    wxString path = wxPathOnly( aFullFileName );
-
-    // This change is needed to load included files, if exists:
-    if( path != wxEmptyString )
-        wxSetWorkingDirectory( path );
+    // The included files are searched relative to the path of this file (the working
+    // directory is not changed, this function can be called from worker threads)
+    m_FileName = aFullFileName;
 
     LOCALE_IO toggleIo;
 
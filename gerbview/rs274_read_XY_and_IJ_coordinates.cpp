@@ -69,14 +69,77 @@ int scaletoIU( double aCoord, bool isMetric )
 }
 
 
+/**
+ * Helper function readCoordinate
+ * reads the number at aText (the sign, digits and decimal point following a X, Y, I
+ * or J letter) in place, without copying it, and converts it to internal units.
+ * @param aText = the text to read; on exit, points the first char after the number
+ * @param aIsFloat = true if the number is in decimal format. Set to true if a decimal
+ *                   point is found
+ * @param aMetric = true for mm, false for inches
+ * @param aNoTrailingZeros = true if the trailing zeros of the integer format are omitted
+ * @param aFmtScale = the number of digits after the point of the integer format
+ * @param aFmtLen = the number of digits of the integer format
+ */
+static int readCoordinate( char*& aText, bool& aIsFloat, bool aMetric,
+                           bool aNoTrailingZeros, int aFmtScale, int aFmtLen )
+{
+    char* start = aText;
+    int   nbdigits = 0;
+
+    while( IsNumber( *aText ) )
+    {
+        if( *aText == '.' )  // Force decimal format if reading a floating point number
+            aIsFloat = true;
+        else if( *aText >= '0' && *aText <= '9' ) // count digits only
+            nbdigits++;
+
+        aText++;
+    }
+
+    if( aIsFloat )
+    {
+        // When X or Y values are float numbers, they are given in mm or inches
+        if( aMetric )   // units are mm
+            return KiROUND( strtod( start, NULL ) * IU_PER_MILS / 0.0254 );
+        else            // units are inches
+            return KiROUND( strtod( start, NULL ) * IU_PER_MILS * 1000 );
+    }
+
+    // Integer format: read the value as atoi() does
+    char*   text = start;
+    bool    negative = false;
+    int64_t value = 0;
+
+    if( *text == '-' || *text == '+' )
+        negative = *text++ == '-';
+
+    while( *text >= '0' && *text <= '9' )
+        value = value * 10 + ( *text++ - '0' );
+
+    // Restore the omitted trailing zeros
+    if( aNoTrailingZeros )
+    {
+        for( ; nbdigits < aFmtLen; nbdigits++ )
+            value *= 10;
+    }
+
+    if( negative )
+        value = -value;
+
+    double real_scale = scale_list[aFmtScale];
+
+    if( aMetric )
+        real_scale = real_scale / 25.4;
+
+    return KiROUND( (int) value * real_scale );
+}
+
+
 wxPoint GERBER_FILE_IMAGE::ReadXYCoord( char*& Text )
 {
     wxPoint pos;
-    int     type_coord = 0, current_coord, nbdigits;
     bool    is_float   = m_DecimalFormat;
-    char*   text;
-    char    line[256];
-
 
     if( m_Relative )
         pos.x = pos.y = 0;
@@ -86,72 +149,14 @@ wxPoint GERBER_FILE_IMAGE::ReadXYCoord( char*& Text )
     if( Text == NULL )
         return pos;
 
-    text = line;
-    while( *Text )
+    while( *Text == 'X' || *Text == 'Y' )
     {
-        if( (*Text == 'X') || (*Text == 'Y') )
-        {
-            type_coord = *Text;
-            Text++;
-            text     = line;
-            nbdigits = 0;
-
-            while( IsNumber( *Text ) )
-            {
-                if( *Text == '.' )  // Force decimat format if reading a floating point number
-                    is_float = true;
-
-                // count digits only (sign and decimal point are not counted)
-                if( (*Text >= '0') && (*Text <='9') )
-                    nbdigits++;
-                *(text++) = *(Text++);
-            }
-
-            *text = 0;
-
-            if( is_float )
-            {
-                // When X or Y values are float numbers, they are given in mm or inches
-                if( m_GerbMetric )  // units are mm
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS / 0.0254 );
-                else    // units are inches
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS * 1000 );
-            }
-            else
-            {
-                int fmt_scale = (type_coord == 'X') ? m_FmtScale.x : m_FmtScale.y;
-
-                if( m_NoTrailingZeros )
-                {
-                    int min_digit =
-                        (type_coord == 'X') ? m_FmtLen.x : m_FmtLen.y;
-                    while( nbdigits < min_digit )
-                    {
-                        *(text++) = '0';
-                        nbdigits++;
-                    }
-
-                    *text = 0;
-                }
-
-                current_coord = atoi( line );
-                double real_scale = scale_list[fmt_scale];
-
-                if( m_GerbMetric )
-                    real_scale = real_scale / 25.4;
-
-                current_coord = KiROUND( current_coord * real_scale );
-            }
-
-            if( type_coord == 'X' )
-                pos.x = current_coord;
-            else if( type_coord == 'Y' )
-                pos.y = current_coord;
-
-            continue;
-        }
+        if( *Text++ == 'X' )
+            pos.x = readCoordinate( Text, is_float, m_GerbMetric, m_NoTrailingZeros,
+                                    m_FmtScale.x, m_FmtLen.x );
         else
-            break;
+            pos.y = readCoordinate( Text, is_float, m_GerbMetric, m_NoTrailingZeros,
+                                    m_FmtScale.y, m_FmtLen.y );
     }
 
     if( m_Relative )
@@ -172,81 +177,19 @@ wxPoint GERBER_FILE_IMAGE::ReadXYCoord( char*& Text )
 wxPoint GERBER_FILE_IMAGE::ReadIJCoord( char*& Text )
 {
     wxPoint pos( 0, 0 );
-
-    int     type_coord = 0, current_coord, nbdigits;
     bool    is_float   = false;
-    char*   text;
-    char    line[256];
 
     if( Text == NULL )
         return pos;
 
-    text = line;
-    while( *Text )
+    while( *Text == 'I' || *Text == 'J' )
     {
-        if( (*Text == 'I') || (*Text == 'J') )
-        {
-            type_coord = *Text;
-            Text++;
-            text     = line;
-            nbdigits = 0;
-            while( IsNumber( *Text ) )
-            {
-                if( *Text == '.' )
-                    is_float = true;
-
-                // count digits only (sign and decimal point are not counted)
-                if( (*Text >= '0') && (*Text <='9') )
-                    nbdigits++;
-
-                *(text++) = *(Text++);
-            }
-
-            *text = 0;
-            if( is_float )
-            {
-                // When X or Y values are float numbers, they are given in mm or inches
-                if( m_GerbMetric )  // units are mm
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS / 0.0254 );
-                else    // units are inches
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS * 1000 );
-            }
-            else
-            {
-                int fmt_scale =
-                    (type_coord == 'I') ? m_FmtScale.x : m_FmtScale.y;
-
-                if( m_NoTrailingZeros )
-                {
-                    int min_digit =
-                        (type_coord == 'I') ? m_FmtLen.x : m_FmtLen.y;
-                    while( nbdigits < min_digit )
-                    {
-                        *(text++) = '0';
-                        nbdigits++;
-                    }
-
-                    *text = 0;
-                }
-
-                current_coord = atoi( line );
-
-                double real_scale = scale_list[fmt_scale];
-
-                if( m_GerbMetric )
-                    real_scale = real_scale / 25.4;
-
-                current_coord = KiROUND( current_coord * real_scale );
-            }
-            if( type_coord == 'I' )
-                pos.x = current_coord;
-            else if( type_coord == 'J' )
-                pos.y = current_coord;
-
-            continue;
-        }
+        if( *Text++ == 'I' )
+            pos.x = readCoordinate( Text, is_float, m_GerbMetric, m_NoTrailingZeros,
+                                    m_FmtScale.x, m_FmtLen.x );
         else
-            break;
+            pos.y = readCoordinate( Text, is_float, m_GerbMetric, m_NoTrailingZeros,
+                                    m_FmtScale.y, m_FmtLen.y );
     }
 
     m_IJPos = pos;
@@ -344,8 +344,9 @@ static void fillArcPOLY(  GERBER_DRAW_ITEM* aGbrItem,
 {
     /* in order to calculate arc parameters, we use fillArcGBRITEM
      * so we muse create a dummy track and use its geometric parameters
+     * (a local item: files are read concurrently)
      */
-    static GERBER_DRAW_ITEM dummyGbrItem( NULL );
+    GERBER_DRAW_ITEM dummyGbrItem( NULL );
 
     aGbrItem->SetLayerPolarity( aLayerNegative );
 
@@ -412,22 +413,16 @@ static void fillArcPOLY(  GERBER_DRAW_ITEM* aGbrItem,
  */
 int GERBER_FILE_IMAGE::GCodeNumber( char*& Text )
 {
-    int   ii = 0;
-    char* text;
-    char  line[1024];
-
     if( Text == NULL )
         return 0;
+
     Text++;
-    text = line;
+    char* start = Text;
+
     while( IsNumber( *Text ) )
-    {
-        *(text++) = *(Text++);
-    }
+        Text++;
 
-    *text = 0;
-    ii    = atoi( line );
-    return ii;
+    return atoi( start );
 }
 
 
@@ -435,21 +430,16 @@ int GERBER_FILE_IMAGE::GCodeNumber( char*& Text )
  */
 int GERBER_FILE_IMAGE::DCodeNumber( char*& Text )
 {
-    int   ii = 0;
-    char* text;
-    char  line[1024];
-
     if( Text == NULL )
         return 0;
 
     Text++;
-    text = line;
+    char* start = Text;
+
     while( IsNumber( *Text ) )
-        *(text++) = *(Text++);
+        Text++;
 
-    *text = 0;
-    ii    = atoi( line );
-    return ii;
+    return atoi( start );
 }
 
 
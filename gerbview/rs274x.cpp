@@ -34,6 +34,7 @@
 #include <gerbview.h>
 #include <class_gerber_file_image.h>
 #include <class_X2_gerber_attributes.h>
+#include <wx/filename.h>
 
 extern int ReadInt( char*& text, bool aSkipSeparator = true );
 extern double ReadDouble( char*& text, bool aSkipSeparator = true );
@@ -711,10 +712,19 @@ bool GERBER_FILE_IMAGE::ExecuteRS274XCommand( int command, char* buff, char*& te
         strncpy( line, text, sizeof(line)-1 );
         line[sizeof(line)-1] = '\0';
 
-        strtok( line, "*%%\n\r" );
+        line[ strcspn( line, "*%\n\r" ) ] = '\0';     // strtok() is not thread safe
         m_FilesList[m_FilesPtr] = m_Current_File;
 
-        m_Current_File = fopen( line, "rt" );
+        {
+            // A relative name is relative to the path of the main file
+            wxFileName includeFile( FROM_UTF8( line ) );
+
+            if( !includeFile.IsAbsolute() )
+                includeFile.MakeAbsolute( wxPathOnly( m_FileName ) );
+
+            m_Current_File = wxFopen( includeFile.GetFullPath(), wxT( "rt" ) );
+        }
+
         if( m_Current_File == 0 )
         {
             msg.Printf( wxT( "include file <%s> not found." ), line );
@@ -723,6 +733,8 @@ bool GERBER_FILE_IMAGE::ExecuteRS274XCommand( int command, char* buff, char*& te
             m_Current_File = m_FilesList[m_FilesPtr];
             break;
         }
+
+        setvbuf( m_Current_File, NULL, _IOFBF, GERBER_FILE_BUFFER_SIZE );
         m_FilesPtr++;
         break;
 
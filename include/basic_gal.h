@@ -158,6 +158,8 @@ private:
 };
 
 
-extern BASIC_GAL basic_gal;
+// The drawing state (plotter, callback, pen, text attributes) is set for each text, so
+// every thread has its own instance: texts can be plotted concurrently.
+extern thread_local BASIC_GAL basic_gal;
 
 #endif      // define BASIC_GAL_H
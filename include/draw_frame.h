@@ -28,6 +28,7 @@
 
 #include <wxstruct.h>
 #include <kiway_player.h>
+#include <class_draw_panel_gal.h>
 #include <climits>
 
 class wxSingleInstanceChecker;
@@ -805,6 +806,21 @@ public:
      */
     TOOL_MANAGER* GetToolManager() const            { return m_toolManager; }
 
+    /**
+     * Function LoadCanvasTypeSetting()
+     * Returns the canvas type stored in the application (kiface) settings.
+     */
+    EDA_DRAW_PANEL_GAL::GAL_TYPE LoadCanvasTypeSetting() const;
+
+    /**
+     * Function SaveCanvasTypeSetting()
+     * Stores the canvas type in the application (kiface) settings.
+     */
+    bool SaveCanvasTypeSetting( EDA_DRAW_PANEL_GAL::GAL_TYPE aCanvasType );
+
+    ///> Key in KifaceSettings to store the canvas type.
+    static const wxChar CANVAS_TYPE_KEY[];
+
     /**
      * Function GetDisplayOptions
      * A way to pass info to draw functions. the base class has no knowledge about
@@ -0,0 +1,661 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PACKED_RTREE_H
+#define __PACKED_RTREE_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * Class PACKED_RTREE
+ *
+ * Static R-tree of 2D integer boxes, bulk loaded with the Sort-Tile-Recursive algorithm
+ * and stored in flat arrays. Each level of the tree keeps the bounding boxes of its nodes
+ * as separate min x/min y/max x/max y arrays, and the children of the node i are the nodes
+ * [i * FANOUT, (i + 1) * FANOUT) of the level below. A search tests all the children of a
+ * node in a single branch-free loop, which the compiler turns into SIMD code.
+ *
+ * The leaves are filled to 3/4 of their capacity. Entries inserted after a bulk load go
+ * to the free slot of the leaf whose bounding box grows the least, or to an unsorted
+ * overflow buffer if there is no free slot left on the way, and removed entries free their
+ * slot. The tree is rebuilt from the live entries at the next search once the overflow
+ * buffer grows too large or enough edits have loosened the node bounding boxes, so
+ * inserting many entries and searching afterwards is a bulk load.
+ *
+ * The interface is the subset of RTree<> used by the spatial indices (Insert(), Remove(),
+ * Search(), RemoveAll(), Count() and an Iterator), so both can be used interchangeably.
+ * The non-const Search() may rebuild the tree, the const one does not and can be called
+ * from several threads as long as the tree is not modified.
+ */
+template <class DATATYPE, int FANOUT = 16>
+class PACKED_RTREE
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator() :
+            m_tree( NULL ),
+            m_index( 0 )
+        {}
+
+        /// Is iterator invalid
+        bool IsNull() const
+        {
+            return !m_tree || m_index >= m_tree->slotCount();
+        }
+
+        /// Is iterator pointing to valid data
+        bool IsNotNull() const
+        {
+            return !IsNull();
+        }
+
+        /// Access the current data element. Caller must be sure iterator is not NULL first.
+        DATATYPE& operator*()
+        {
+            return m_tree->slotData( m_index );
+        }
+
+        /// Find the next data element
+        bool operator++()
+        {
+            do
+            {
+                m_index++;
+            } while( IsNotNull() && m_tree->isDeadSlot( m_index ) );
+
+            return IsNotNull();
+        }
+
+    private:
+        friend class PACKED_RTREE;
+
+        PACKED_RTREE* m_tree;
+        int           m_index;
+    };
+
+    PACKED_RTREE() :
+        m_liveCount( 0 ),
+        m_edits( 0 )
+    {
+    }
+
+    /**
+     * Function Insert()
+     *
+     * Adds an entry to a free slot of the packed tree, or to the overflow buffer.
+     */
+    void Insert( const int aMin[2], const int aMax[2], const DATATYPE& aData )
+    {
+        m_edits++;
+
+        if( insertPacked( aMin, aMax, aData ) )
+            return;
+
+        m_overflow.Append( aMin, aMax );
+        m_overflowData.push_back( aData );
+    }
+
+    /**
+     * Function Remove()
+     *
+     * Removes the entry aData, whose bounding box overlaps (aMin, aMax). Entries are
+     * compared by value.
+     */
+    void Remove( const int aMin[2], const int aMax[2], const DATATYPE& aData )
+    {
+        for( unsigned i = 0; i < m_overflowData.size(); i++ )
+        {
+            if( m_overflowData[i] == aData )
+            {
+                m_edits++;
+                m_overflow.SwapRemove( i );
+                m_overflowData[i] = m_overflowData.back();
+                m_overflowData.pop_back();
+                return;
+            }
+        }
+
+        if( !m_levels.empty() )
+            removePacked( m_levels.size() - 1, 0, aMin, aMax, aData );
+    }
+
+    /**
+     * Function Search()
+     *
+     * Calls aVisitor for each entry whose bounding box overlaps (aMin, aMax). The visitor
+     * returns false to stop the search. The tree is packed first if needed.
+     * @return the number of entries for which the visitor returned true.
+     */
+    template <class VISITOR>
+    int Search( const int aMin[2], const int aMax[2], VISITOR& aVisitor )
+    {
+        if( needsPack() )
+            Pack();
+
+        return static_cast<const PACKED_RTREE*>( this )->Search( aMin, aMax, aVisitor );
+    }
+
+    /**
+     * Function Search()
+     *
+     * Same as above, but never packs the tree, so that several threads can search a tree
+     * nobody modifies.
+     */
+    template <class VISITOR>
+    int Search( const int aMin[2], const int aMax[2], VISITOR& aVisitor ) const
+    {
+        int count = 0;
+
+        if( !m_levels.empty() && !searchNode( m_levels.size() - 1, 0, aMin, aMax,
+                                              aVisitor, count ) )
+            return count;
+
+        const int n = m_overflowData.size();
+
+        for( int first = 0; first < n; first += FANOUT )
+        {
+            char hit[FANOUT];
+            const int cnt = std::min( FANOUT, n - first );
+
+            m_overflow.Overlaps( first, cnt, aMin, aMax, hit );
+
+            for( int i = 0; i < cnt; i++ )
+            {
+                if( !hit[i] )
+                    continue;
+
+                if( !aVisitor( m_overflowData[first + i] ) )
+                    return count;
+
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * Function Pack()
+     *
+     * Rebuilds the packed tree from all the live entries and empties the overflow buffer.
+     */
+    void Pack()
+    {
+        std::vector<ENTRY> entries;
+
+        entries.reserve( Count() );
+
+        if( !m_levels.empty() )
+        {
+            const LEVEL& leaves = m_levels[0];
+
+            for( int i = 0; i < leaves.m_count; i++ )
+            {
+                if( !m_dead[i] )
+                    entries.push_back( leaves.Entry( i, m_data[i] ) );
+            }
+        }
+
+        for( unsigned i = 0; i < m_overflowData.size(); i++ )
+            entries.push_back( m_overflow.Entry( i, m_overflowData[i] ) );
+
+        RemoveAll();
+        build( entries );
+    }
+
+    /// Remove all entries from tree
+    void RemoveAll()
+    {
+        m_levels.clear();
+        m_data.clear();
+        m_dead.clear();
+        m_liveCount = 0;
+        m_edits = 0;
+        m_overflow.Clear();
+        m_overflowData.clear();
+    }
+
+    /// Count the live data elements in this container
+    int Count() const
+    {
+        return m_liveCount + m_overflowData.size();
+    }
+
+    /// Points aIter to the first live entry
+    void GetFirst( Iterator& aIter )
+    {
+        aIter.m_tree = this;
+        aIter.m_index = -1;
+        ++aIter;
+    }
+
+private:
+    enum
+    {
+        MinOverflow = 64,               ///< overflow entries below which the tree is never packed
+        MaxOverflow = 1024,             ///< overflow entries above which the tree is always packed
+        LeafFill    = FANOUT * 3 / 4    ///< entries stored in a leaf by a bulk load
+    };
+
+    struct ENTRY
+    {
+        int      m_min[2];
+        int      m_max[2];
+        DATATYPE m_data;
+
+        int64_t CenterX() const { return (int64_t) m_min[0] + m_max[0]; }
+        int64_t CenterY() const { return (int64_t) m_min[1] + m_max[1]; }
+    };
+
+    ///> Bounding boxes of a level of the tree, padded to a multiple of FANOUT
+    struct LEVEL
+    {
+        std::vector<int> m_minX, m_minY, m_maxX, m_maxY;
+        std::vector<int> m_free;    ///< free leaf slots below each node (not for the leaves)
+        int              m_count;
+
+        LEVEL() :
+            m_count( 0 )
+        {}
+
+        void Clear()
+        {
+            m_minX.clear();
+            m_minY.clear();
+            m_maxX.clear();
+            m_maxY.clear();
+            m_free.clear();
+            m_count = 0;
+        }
+
+        void Resize( int aCount )
+        {
+            int padded = ( aCount + FANOUT - 1 ) / FANOUT * FANOUT;
+
+            m_minX.resize( padded, INT_MAX );
+            m_minY.resize( padded, INT_MAX );
+            m_maxX.resize( padded, INT_MIN );
+            m_maxY.resize( padded, INT_MIN );
+            m_free.resize( padded, 0 );
+            m_count = aCount;
+        }
+
+        void Set( int aIndex, const int aMin[2], const int aMax[2] )
+        {
+            m_minX[aIndex] = aMin[0];
+            m_minY[aIndex] = aMin[1];
+            m_maxX[aIndex] = aMax[0];
+            m_maxY[aIndex] = aMax[1];
+        }
+
+        void Grow( int aIndex, const int aMin[2], const int aMax[2] )
+        {
+            m_minX[aIndex] = std::min( m_minX[aIndex], aMin[0] );
+            m_minY[aIndex] = std::min( m_minY[aIndex], aMin[1] );
+            m_maxX[aIndex] = std::max( m_maxX[aIndex], aMax[0] );
+            m_maxY[aIndex] = std::max( m_maxY[aIndex], aMax[1] );
+        }
+
+        ///> Area of the box aIndex once enlarged to contain (aMin, aMax)
+        double GrownArea( int aIndex, const int aMin[2], const int aMax[2] ) const
+        {
+            double w = (double) std::max( m_maxX[aIndex], aMax[0] )
+                       - std::min( m_minX[aIndex], aMin[0] );
+            double h = (double) std::max( m_maxY[aIndex], aMax[1] )
+                       - std::min( m_minY[aIndex], aMin[1] );
+
+            return w * h;
+        }
+
+        double Area( int aIndex ) const
+        {
+            if( m_maxX[aIndex] < m_minX[aIndex] )
+                return 0.0;
+
+            return ( (double) m_maxX[aIndex] - m_minX[aIndex] )
+                   * ( (double) m_maxY[aIndex] - m_minY[aIndex] );
+        }
+
+        void Append( const int aMin[2], const int aMax[2] )
+        {
+            m_minX.push_back( aMin[0] );
+            m_minY.push_back( aMin[1] );
+            m_maxX.push_back( aMax[0] );
+            m_maxY.push_back( aMax[1] );
+            m_count++;
+        }
+
+        void SwapRemove( int aIndex )
+        {
+            m_minX[aIndex] = m_minX.back();
+            m_minY[aIndex] = m_minY.back();
+            m_maxX[aIndex] = m_maxX.back();
+            m_maxY[aIndex] = m_maxY.back();
+            m_minX.pop_back();
+            m_minY.pop_back();
+            m_maxX.pop_back();
+            m_maxY.pop_back();
+            m_count--;
+        }
+
+        ENTRY Entry( int aIndex, const DATATYPE& aData ) const
+        {
+            ENTRY e = { { m_minX[aIndex], m_minY[aIndex] },
+                        { m_maxX[aIndex], m_maxY[aIndex] }, aData };
+
+            return e;
+        }
+
+        ///> Tests aCount boxes starting at aFirst against (aMin, aMax). No branches, so that
+        ///> the loop is vectorized.
+        void Overlaps( int aFirst, int aCount, const int aMin[2], const int aMax[2],
+                       char* aHit ) const
+        {
+            const int* minX = &m_minX[aFirst];
+            const int* minY = &m_minY[aFirst];
+            const int* maxX = &m_maxX[aFirst];
+            const int* maxY = &m_maxY[aFirst];
+
+            for( int i = 0; i < aCount; i++ )
+            {
+                aHit[i] = ( minX[i] <= aMax[0] ) & ( maxX[i] >= aMin[0] )
+                          & ( minY[i] <= aMax[1] ) & ( maxY[i] >= aMin[1] );
+            }
+        }
+    };
+
+    bool needsPack() const
+    {
+        int overflow = m_overflowData.size();
+        int limit = std::min( std::max( m_liveCount / 8, (int) MinOverflow ), (int) MaxOverflow );
+
+        return overflow > limit || m_edits > std::max( m_liveCount / 4, (int) MinOverflow );
+    }
+
+    int slotCount() const
+    {
+        return m_data.size() + m_overflowData.size();
+    }
+
+    DATATYPE& slotData( int aSlot )
+    {
+        if( aSlot < (int) m_data.size() )
+            return m_data[aSlot];
+
+        return m_overflowData[aSlot - m_data.size()];
+    }
+
+    bool isDeadSlot( int aSlot ) const
+    {
+        return aSlot < (int) m_data.size() && m_dead[aSlot];
+    }
+
+    static bool compareX( const ENTRY& aA, const ENTRY& aB )
+    {
+        return aA.CenterX() < aB.CenterX();
+    }
+
+    static bool compareY( const ENTRY& aA, const ENTRY& aB )
+    {
+        return aA.CenterY() < aB.CenterY();
+    }
+
+    /**
+     * Function build()
+     *
+     * Sort-Tile-Recursive bulk load: the entries are sorted by x into vertical slices of
+     * about sqrt(leaf count) leaves, and each slice is sorted by y, alternately upwards and
+     * downwards so that consecutive leaves stay close across slice boundaries. The upper
+     * levels group FANOUT consecutive nodes of the level below.
+     */
+    void build( std::vector<ENTRY>& aEntries )
+    {
+        const int n = aEntries.size();
+
+        if( n == 0 )
+            return;
+
+        const int leafCount = ( n + LeafFill - 1 ) / LeafFill;
+        const int sliceCount = (int) std::ceil( std::sqrt( (double) leafCount ) );
+        const int sliceSize = sliceCount * LeafFill;
+
+        std::sort( aEntries.begin(), aEntries.end(), compareX );
+
+        for( int first = 0, slice = 0; first < n; first += sliceSize, slice++ )
+        {
+            typename std::vector<ENTRY>::iterator begin = aEntries.begin() + first;
+            typename std::vector<ENTRY>::iterator end = aEntries.begin() + std::min( n, first + sliceSize );
+
+            std::sort( begin, end, compareY );
+
+            if( slice % 2 )
+                std::reverse( begin, end );
+        }
+
+        // the free slots are dead entries with an empty bounding box
+        m_levels.push_back( LEVEL() );
+        m_levels[0].Resize( leafCount * FANOUT );
+        m_data.resize( leafCount * FANOUT );
+        m_dead.assign( leafCount * FANOUT, 1 );
+        m_liveCount = n;
+
+        for( int i = 0; i < n; i++ )
+        {
+            int slot = ( i / LeafFill ) * FANOUT + i % LeafFill;
+
+            m_levels[0].Set( slot, aEntries[i].m_min, aEntries[i].m_max );
+            m_data[slot] = aEntries[i].m_data;
+            m_dead[slot] = 0;
+        }
+
+        while( m_levels.back().m_count > FANOUT )
+        {
+            const int childCount = m_levels.back().m_count;
+            const int nodeCount = ( childCount + FANOUT - 1 ) / FANOUT;
+            const bool leaves = ( m_levels.size() == 1 );
+
+            m_levels.push_back( LEVEL() );
+
+            const LEVEL& children = m_levels[m_levels.size() - 2];
+            LEVEL& nodes = m_levels.back();
+
+            nodes.Resize( nodeCount );
+
+            for( int i = 0; i < nodeCount; i++ )
+            {
+                int bmin[2] = { INT_MAX, INT_MAX };
+                int bmax[2] = { INT_MIN, INT_MIN };
+                int free = 0;
+
+                for( int j = i * FANOUT; j < std::min( childCount, ( i + 1 ) * FANOUT ); j++ )
+                {
+                    bmin[0] = std::min( bmin[0], children.m_minX[j] );
+                    bmin[1] = std::min( bmin[1], children.m_minY[j] );
+                    bmax[0] = std::max( bmax[0], children.m_maxX[j] );
+                    bmax[1] = std::max( bmax[1], children.m_maxY[j] );
+                    free += leaves ? m_dead[j] : children.m_free[j];
+                }
+
+                nodes.Set( i, bmin, bmax );
+                nodes.m_free[i] = free;
+            }
+        }
+    }
+
+    /**
+     * Function insertPacked()
+     *
+     * Descends the tree towards the node whose bounding box grows the least, skipping the
+     * full ones, and stores the entry in a free slot of the leaf reached.
+     * @return false if the tree has no free slot.
+     */
+    bool insertPacked( const int aMin[2], const int aMax[2], const DATATYPE& aData )
+    {
+        if( m_liveCount == (int) m_data.size() )
+            return false;
+
+        int node = 0;
+
+        for( int l = m_levels.size() - 1; l > 0; l-- )
+        {
+            const LEVEL& level = m_levels[l];
+            const int first = node * FANOUT;
+            const int last = std::min( level.m_count, first + FANOUT );
+            int best = -1;
+            double bestGrowth = 0.0, bestArea = 0.0;
+
+            for( int i = first; i < last; i++ )
+            {
+                if( !level.m_free[i] )
+                    continue;
+
+                double area = level.Area( i );
+                double growth = level.GrownArea( i, aMin, aMax ) - area;
+
+                if( best < 0 || growth < bestGrowth || ( growth == bestGrowth && area < bestArea ) )
+                {
+                    best = i;
+                    bestGrowth = growth;
+                    bestArea = area;
+                }
+            }
+
+            if( best < 0 )
+                return false;
+
+            node = best;
+        }
+
+        int slot = node * FANOUT;
+
+        while( slot < ( node + 1 ) * FANOUT && !m_dead[slot] )
+            slot++;
+
+        if( slot == ( node + 1 ) * FANOUT )
+            return false;
+
+        m_levels[0].Set( slot, aMin, aMax );
+        m_data[slot] = aData;
+        m_dead[slot] = 0;
+        m_liveCount++;
+
+        for( unsigned l = 1, i = slot / FANOUT; l < m_levels.size(); l++, i /= FANOUT )
+        {
+            m_levels[l].Grow( i, aMin, aMax );
+            m_levels[l].m_free[i]--;
+        }
+
+        return true;
+    }
+
+    template <class VISITOR>
+    bool searchNode( int aLevel, int aNode, const int aMin[2], const int aMax[2],
+                     VISITOR& aVisitor, int& aCount ) const
+    {
+        const LEVEL& level = m_levels[aLevel];
+        const int first = aNode * FANOUT;
+        const int cnt = std::min( FANOUT, level.m_count - first );
+        char hit[FANOUT];
+
+        level.Overlaps( first, FANOUT, aMin, aMax, hit );
+
+        for( int i = 0; i < cnt; i++ )
+        {
+            if( !hit[i] )
+                continue;
+
+            if( aLevel > 0 )
+            {
+                if( !searchNode( aLevel - 1, first + i, aMin, aMax, aVisitor, aCount ) )
+                    return false;
+            }
+            else if( !m_dead[first + i] )
+            {
+                if( !aVisitor( m_data[first + i] ) )
+                    return false;
+
+                aCount++;
+            }
+        }
+
+        return true;
+    }
+
+    bool removePacked( int aLevel, int aNode, const int aMin[2], const int aMax[2],
+                       const DATATYPE& aData )
+    {
+        LEVEL& level = m_levels[aLevel];
+        const int first = aNode * FANOUT;
+        const int cnt = std::min( FANOUT, level.m_count - first );
+        char hit[FANOUT];
+
+        level.Overlaps( first, FANOUT, aMin, aMax, hit );
+
+        for( int i = 0; i < cnt; i++ )
+        {
+            if( !hit[i] )
+                continue;
+
+            if( aLevel > 0 )
+            {
+                if( removePacked( aLevel - 1, first + i, aMin, aMax, aData ) )
+                    return true;
+            }
+            else if( !m_dead[first + i] && m_data[first + i] == aData )
+            {
+                // an empty box, so that the following searches skip the entry early
+                const int emptyMin[2] = { INT_MAX, INT_MAX };
+                const int emptyMax[2] = { INT_MIN, INT_MIN };
+
+                level.Set( first + i, emptyMin, emptyMax );
+                m_dead[first + i] = 1;
+                m_liveCount--;
+                m_edits++;
+
+                for( unsigned l = 1, j = ( first + i ) / FANOUT; l < m_levels.size(); l++, j /= FANOUT )
+                    m_levels[l].m_free[j]++;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<LEVEL>    m_levels;        ///< m_levels[0]: the packed entries
+    std::vector<DATATYPE> m_data;          ///< data of the packed entries
+    std::vector<char>     m_dead;          ///< free slots of the packed tree
+    int                   m_liveCount;     ///< used slots of the packed tree
+    int                   m_edits;         ///< insertions and removals since the last Pack()
+    LEVEL                 m_overflow;      ///< entries inserted since the last Pack()
+    std::vector<DATATYPE> m_overflowData;
+};
+
+#endif
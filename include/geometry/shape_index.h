@@ -28,7 +28,7 @@
 
 #include <vector>
 #include <geometry/shape.h>
-#include <geometry/rtree.h>
+#include <geometry/packed_rtree.h>
 
 
 /**
@@ -110,16 +110,16 @@ class SHAPE_INDEX
         class Iterator
         {
         private:
-            typedef typename RTree<T, int, 2, float>::Iterator RTreeIterator;
+            typedef typename PACKED_RTREE<T>::Iterator RTreeIterator;
             RTreeIterator iterator;
 
             /**
              * Function Init()
              *
              * Setup the internal tree iterator.
-             * @param aTree pointer to a RTREE object
+             * @param aTree pointer to a PACKED_RTREE object
              */
-            void Init( RTree<T, int, 2, float>* aTree )
+            void Init( PACKED_RTREE<T>* aTree )
             {
                 aTree->GetFirst( iterator );
             }
@@ -287,7 +287,7 @@ class SHAPE_INDEX
         Iterator Begin();
 
     private:
-        RTree<T, int, 2, float>* m_tree;
+        PACKED_RTREE<T>* m_tree;
 };
 
 /*
@@ -297,7 +297,7 @@ class SHAPE_INDEX
 template <class T>
 SHAPE_INDEX<T>::SHAPE_INDEX()
 {
-    this->m_tree = new RTree<T, int, 2, float>();
+    this->m_tree = new PACKED_RTREE<T>();
 }
 
 template <class T>
@@ -335,8 +335,8 @@ void SHAPE_INDEX<T>::RemoveAll()
 template <class T>
 void SHAPE_INDEX<T>::Reindex()
 {
-    RTree<T, int, 2, float>* newTree;
-    newTree = new RTree<T, int, 2, float>();
+    PACKED_RTREE<T>* newTree;
+    newTree = new PACKED_RTREE<T>();
 
     Iterator iter = this->Begin();
 
@@ -207,6 +207,26 @@ public:
         m_backgroundColor = aColor;
     }
 
+    /**
+     * Function GetGridColor
+     * Returns the color used to draw the grid.
+     * @return Grid color.
+     */
+    virtual const COLOR4D& GetGridColor() const
+    {
+        return m_gridColor;
+    }
+
+    /**
+     * Function SetGridColor
+     * Sets new color for the grid.
+     * @param aColor is the new grid color.
+     */
+    inline void SetGridColor( const COLOR4D& aColor )
+    {
+        m_gridColor = aColor;
+    }
+
 protected:
     /**
      * Function update
@@ -234,6 +254,7 @@ protected:
     float   m_worksheetLineWidth;   ///< Line width used when drawing worksheet
 
     COLOR4D m_backgroundColor;      ///< The background color
+    COLOR4D m_gridColor;            ///< The grid color
 
     /// Map of colors that were usually used for display
     std::map<EDA_COLOR_T, COLOR4D> m_legacyColorMap;
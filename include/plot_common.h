@@ -33,10 +33,13 @@
 #define PLOT_COMMON_H_
 
 #include <vector>
+#include <string>
+#include <unordered_map>
 #include <math/box2.h>
 #include <drawtxt.h>
 #include <class_page_info.h>
 #include <eda_text.h>       // FILL_T
+#include <plot_output_buffer.h>
 
 class SHAPE_POLY_SET;
 
@@ -725,8 +728,11 @@ public:
     PDF_PLOTTER() : pageStreamHandle( 0 ), workFile( NULL )
     {
         // Avoid non initialized variables:
-        pageStreamHandle = streamLengthHandle = fontResDictHandle = 0;
+        pageStreamHandle = streamHandle = streamLengthHandle = fontResDictHandle = 0;
         pageTreeHandle = 0;
+        compressionLevel = 9;       // best compression
+        parallelStreams = false;
+        pendingStreamsSize = 0;
     }
 
     virtual PlotFormat GetPlotterType() const
@@ -756,6 +762,23 @@ public:
     virtual void SetCurrentLineWidth( int width );
     virtual void SetDash( bool dashed );
 
+    /**
+     * Function SetCompressionLevel
+     * sets the zlib compression level of the page streams, from 0 (no compression,
+     * fastest) to 9 (best compression, the default)
+     */
+    void SetCompressionLevel( int aLevel ) { compressionLevel = aLevel; }
+
+    /**
+     * Function SetParallelStreams
+     * enables the compression of the page streams in worker threads: the streams of
+     * the closed pages are kept in memory, and compressed and written by batches
+     * (of one page per thread, or when they use too much memory, and at the end of
+     * the plot). The streams are written after their page objects, which the xref
+     * table allows. Useful for documents having many pages.
+     */
+    void SetParallelStreams( bool aEnable ) { parallelStreams = aEnable; }
+
     /** PDF can have multiple pages, so SetPageSettings can be called
      * with the outputFile open (but not inside a page stream!) */
     virtual void SetPageSettings( const PAGE_INFO& aPageSettings );
@@ -796,14 +819,37 @@ protected:
     void closePdfObject();
     int startPdfStream(int handle = -1);
     void closePdfStream();
+
+    /// A stream object waiting to be compressed and written
+    struct PDF_STREAM
+    {
+        int         handle;
+        int         lengthHandle;
+        std::string data;        /// The stream, raw then compressed
+    };
+
+    /// Replace aData by its ZLIB compressed version. Can be called from any thread
+    static void deflateStream( std::string& aData, int aLevel );
+
+    /// Write a compressed stream object, and its length object
+    void writePdfStream( const PDF_STREAM& aStream );
+
+    /// Compress the pending streams in parallel, and write them
+    void flushPendingStreams();
+
     int pageTreeHandle;		 /// Handle to the root of the page tree object
     int fontResDictHandle;	 /// Font resource dictionary
     std::vector<int> pageHandles;/// Handles to the page objects
     int pageStreamHandle;	 /// Handle of the page content object
+    int streamHandle;            /// Handle of the stream being built
     int streamLengthHandle;      /// Handle to the deferred stream length
     wxString workFilename;
     FILE* workFile;  	         /// Temporary file to costruct the stream before zipping
     std::vector<long> xrefTable; /// The PDF xref offset table
+    int compressionLevel;        /// The zlib level of the streams (0 to 9)
+    bool parallelStreams;        /// Compress the streams by batches, in worker threads
+    std::vector<PDF_STREAM> pendingStreams; /// The streams not yet written
+    size_t pendingStreamsSize;   /// Raw size of the pending streams
 };
 
 class SVG_PLOTTER : public PSLIKE_PLOTTER
@@ -868,6 +914,17 @@ protected:
                                     // color, pen size, fil mode ...
                                     // the new SVG stype must be output on file
     bool m_dashed;                  // true to use plot dashed line style
+    bool m_pathOpen;                // true if the last <path> element is not closed:
+                                    // the next pen strokes are added to it
+
+    PLOT_OUTPUT_BUFFER m_out;       // all the output goes through this buffer
+
+    /**
+     * function closePath()
+     * closes the <path> element of the previous pen strokes, if still open.
+     * Must be called before writing anything else.
+     */
+    void closePath();
 
     /**
      * function emitSetRGBColor()
@@ -955,6 +1012,14 @@ public:
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH );
 
+    /**
+     * Function PlotRegions
+     * plots the polygons of aPolygons as G36/G37 regions, without outline.
+     * The holes are handled by the cut-ins of fractured polygons: the polygons
+     * having holes are fractured first.
+     */
+    void PlotRegions( const SHAPE_POLY_SET& aPolygons );
+
     virtual void PenTo( const wxPoint& pos, char plume );
 
     /**
@@ -1027,8 +1092,25 @@ protected:
     std::vector<APERTURE>::iterator
     getAperture( const wxSize& size, APERTURE::APERTURE_TYPE type );
 
-    FILE* workFile;
-    FILE* finalFile;
+    /**
+     * Function writeBody
+     * appends aText to the body of the file (everything after the aperture list).
+     * The body is kept in memory, and moved to a work file only when it grows
+     * above m_bodyLimit.
+     */
+    void writeBody( const char* aText, size_t aLength );
+    void writeBody( const char* aText ) { writeBody( aText, strlen( aText ) ); }
+
+    /**
+     * Function spillBody
+     * moves the body buffer to the work file (created on first use).
+     * @return false if the work file cannot be written; the body then stays in memory
+     */
+    bool spillBody();
+
+    std::string m_body;         ///< the body of the file not yet in the work file
+    size_t   m_bodyLimit;       ///< the size of m_body triggering a spillBody()
+    FILE*    workFile;          ///< the part of the body too large to be kept in memory
     wxString m_workFilename;
 
     /**
@@ -1036,9 +1118,34 @@ protected:
      */
     void writeApertureList();
 
+    /// The key of the apertures in m_apertureIndex
+    struct APERTURE_KEY
+    {
+        int m_Type;
+        int m_X;
+        int m_Y;
+
+        bool operator==( const APERTURE_KEY& aOther ) const
+        {
+            return m_Type == aOther.m_Type && m_X == aOther.m_X && m_Y == aOther.m_Y;
+        }
+    };
+
+    struct APERTURE_KEY_HASH
+    {
+        size_t operator()( const APERTURE_KEY& aKey ) const
+        {
+            return ( (size_t) aKey.m_X * 73856093 ) ^ ( (size_t) aKey.m_Y * 19349663 )
+                   ^ ( (size_t) aKey.m_Type * 83492791 );
+        }
+    };
+
     std::vector<APERTURE>           apertures;
     std::vector<APERTURE>::iterator currentAperture;
 
+    /// index in apertures of each aperture, by type and size
+    std::unordered_map<APERTURE_KEY, int, APERTURE_KEY_HASH> m_apertureIndex;
+
     bool     m_gerberUnitInch;  // true if the gerber units are inches, false for mm
     int      m_gerberUnitFmt;   // number of digits in mantissa.
                                 // usually 6 in Inches and 5 or 6  in mm
@@ -1051,7 +1158,7 @@ public:
     DXF_PLOTTER() : textAsLines( false )
     {
         textAsLines = true;
-        m_currentColor = BLACK;
+        setCurrentColor( BLACK );
     }
 
     virtual PlotFormat GetPlotterType() const
@@ -1135,6 +1242,11 @@ public:
 protected:
     bool textAsLines;
     EDA_COLOR_T m_currentColor;
+    std::string m_currentLayerName;     // the DXF layer of m_currentColor (UTF8)
+    PLOT_OUTPUT_BUFFER m_out;           // all the output goes through this buffer
+
+    /// Set m_currentColor, and the name of its layer
+    void setCurrentColor( EDA_COLOR_T aColor );
 };
 
 class TITLE_BLOCK;
@@ -0,0 +1,119 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file plot_output_buffer.h
+ */
+
+#ifndef PLOT_OUTPUT_BUFFER_H_
+#define PLOT_OUTPUT_BUFFER_H_
+
+#include <stdio.h>
+#include <string>
+
+/// Default size of the buffer of a PLOT_OUTPUT_BUFFER
+#define PLOT_OUTPUT_BUFFER_SIZE ( 1024 * 1024 )
+
+
+/**
+ * Class PLOT_OUTPUT_BUFFER
+ * is a buffered writer for the plotters writing large text files (SVG, DXF...).
+ * The numbers are formatted by hand (much faster than printf, and independent of the
+ * locale) and the text is written to the file by large blocks.
+ *
+ * Everything written to the plot file between SetFile() and Flush() must go through
+ * the buffer, otherwise the output is out of order.
+ */
+class PLOT_OUTPUT_BUFFER
+{
+public:
+    PLOT_OUTPUT_BUFFER( size_t aSize = PLOT_OUTPUT_BUFFER_SIZE );
+
+    /// Flushes the buffer, if the file is still set
+    ~PLOT_OUTPUT_BUFFER();
+
+    /**
+     * Function SetFile
+     * flushes the buffer to the current file, if any, and writes the next output to aFile
+     * (which can be NULL)
+     */
+    void SetFile( FILE* aFile );
+
+    /**
+     * Function Flush
+     * writes the buffer content to the file.
+     * @return false on a write error
+     */
+    bool Flush();
+
+    void WriteChar( char aChar )
+    {
+        if( m_buffer.size() >= m_size )
+            Flush();
+
+        m_buffer.push_back( aChar );
+    }
+
+    void Write( const char* aText, size_t aLength );
+    void Write( const char* aText );
+    void Write( const std::string& aText ) { Write( aText.data(), aText.size() ); }
+
+    /// Writes aValue, as "%d" does
+    void WriteInt( int aValue );
+
+    /// Writes aValue with at most aDecimals digits after the point, trailing zeros removed
+    void WriteDouble( double aValue, int aDecimals );
+
+    /// Writes aValue in uppercase hexadecimal, on aDigits digits at least, as "%*.*lX" does
+    void WriteHex( unsigned long aValue, int aDigits );
+
+    /**
+     * Function Printf
+     * writes a formatted string, for the few things which are not worth formatting
+     * by hand (headers...). The locale must be the C one.
+     */
+    void Printf( const char* aFormat, ... );
+
+    /**
+     * Function FormatInt
+     * writes the decimal representation of aValue at aBuffer, as "%d" does.
+     * @return the end of the written text (not null terminated)
+     */
+    static char* FormatInt( char* aBuffer, int aValue );
+
+    /**
+     * Function FormatDouble
+     * writes the decimal representation of aValue at aBuffer, rounded to aDecimals
+     * digits after the point (0 to 9), without trailing zeros nor exponent. Huge
+     * values and NaNs are written by sprintf( "%g" ). aBuffer must hold 32 chars.
+     * @return the end of the written text (not null terminated)
+     */
+    static char* FormatDouble( char* aBuffer, double aValue, int aDecimals );
+
+private:
+    FILE*       m_file;
+    std::string m_buffer;
+    size_t      m_size;
+};
+
+#endif  // PLOT_OUTPUT_BUFFER_H_
@@ -27,11 +27,11 @@
 
 #include <math/box2.h>
 
-#include <geometry/rtree.h>
+#include <geometry/packed_rtree.h>
 
 namespace KIGFX
 {
-typedef RTree<VIEW_ITEM*, int, 2, float> VIEW_RTREE_BASE;
+typedef PACKED_RTREE<VIEW_ITEM*> VIEW_RTREE_BASE;
 
 /**
  * Class VIEW_RTREE -
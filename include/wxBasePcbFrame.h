@@ -686,21 +686,6 @@ public:
      */
     void SwitchCanvas( wxCommandEvent& aEvent );
 
-    /**
-     * Function LoadCanvasTypeSetting()
-     * Returns the canvas type stored in the application settings.
-     */
-    EDA_DRAW_PANEL_GAL::GAL_TYPE LoadCanvasTypeSetting() const;
-
-    /**
-     * Function SaveCanvasTypeSetting()
-     * Stores the canvas type in the application settings.
-     */
-    bool SaveCanvasTypeSetting( EDA_DRAW_PANEL_GAL::GAL_TYPE aCanvasType );
-
-    ///> Key in KifaceSettings to store the canvas type.
-    static const wxChar CANVAS_TYPE_KEY[];
-
     DECLARE_EVENT_TABLE()
 };
 
@@ -96,6 +96,18 @@ protected:
 
     wxString          m_lastNetListRead;        ///< Last net list read with relative path.
 
+    /// The last undo command seen by OnModify(), to find the items changed since then
+    /// and update only their layers in the 3D view. Only compared, never dereferenced.
+    PICKED_ITEMS_LIST* m_lastUndoCommand3D;
+
+    /**
+     * Function get3DViewChanges
+     * collects the layers of the items changed by the undo commands issued (or the
+     * command undone) since the last call to OnModify().
+     * @return false if the changes are not known, and the 3D view must be fully reloaded.
+     */
+    bool get3DViewChanges( LSET& aLayers, bool& aHoles );
+
     // The Tool Framework initalization
     void setupTools();
 
@@ -803,6 +815,8 @@ public:
      * @param aFormatCSV = true to use a comma separated file (CSV) format; defautl = false
      * @return the number of footprints found on aSide side,
      *    or -1 if the file could not be created
+     * The footprints with only smd pads are marked as SMD when aForceSmdItems is true;
+     * the file itself is written by WriteFootprintsPositionFile().
      */
     int DoGenFootprintsPositionFile( const wxString& aFullFileName, bool aUnitsMM,
                                       bool aForceSmdItems, int aSide, bool aFormatCSV = false );
@@ -537,8 +537,7 @@ int genPlacementRoutingMatrix( BOARD* aBrd, EDA_MSG_PANEL* messagePanel )
 
     // Initialize top layer. to the same value as the bottom layer
     if( RoutingMatrix.m_BoardSide[TOP] )
-        memcpy( RoutingMatrix.m_BoardSide[TOP], RoutingMatrix.m_BoardSide[BOTTOM],
-                nbCells * sizeof(MATRIX_CELL) );
+        RoutingMatrix.CopyCells( BOTTOM, TOP );
 
     return 1;
 }
@@ -33,6 +33,9 @@
 #define AUTOROUT_H
 
 
+#include <cstring>
+#include <vector>
+
 #include <base_struct.h>
 #include <layers_id_colors_and_visibility.h>
 
@@ -77,6 +80,23 @@ typedef unsigned char MATRIX_CELL;
 typedef int  DIST_CELL;
 typedef char DIR_CELL;
 
+/* Distance and direction of a cell are packed in a single word:
+ * the direction back to source (FROM_xxx) in the 4 lower bits,
+ * the distance in the upper bits.
+ */
+typedef unsigned int ROUTE_CELL;
+#define ROUTE_DIR_BITS  4
+#define ROUTE_DIR_MASK  ( ( 1 << ROUTE_DIR_BITS ) - 1 )
+
+/* The matrices are stored by square tiles of MATRIX_TILE_SIZE x MATRIX_TILE_SIZE
+ * cells, so that the 8 neighbours of a cell visited by the router are usually
+ * in the same cache lines.
+ */
+#define MATRIX_TILE_SHIFT   3
+#define MATRIX_TILE_SIZE    ( 1 << MATRIX_TILE_SHIFT )
+#define MATRIX_TILE_MASK    ( MATRIX_TILE_SIZE - 1 )
+#define MATRIX_TILE_CELLS   ( MATRIX_TILE_SIZE * MATRIX_TILE_SIZE )
+
 
 /**
  * class MATRIX_ROUTING_HEAD
@@ -86,15 +106,16 @@ class MATRIX_ROUTING_HEAD
 {
 public:
     MATRIX_CELL* m_BoardSide[MAX_ROUTING_LAYERS_COUNT]; // the image map of 2 board sides
-    DIST_CELL*   m_DistSide[MAX_ROUTING_LAYERS_COUNT];  // the image map of 2 board sides:
-                                                        // distance to cells
-    DIR_CELL*    m_DirSide[MAX_ROUTING_LAYERS_COUNT];   // the image map of 2 board sides:
+    ROUTE_CELL*  m_RouteSide[MAX_ROUTING_LAYERS_COUNT]; // the image map of 2 board sides:
+                                                        // distance to cells and
                                                         // pointers back to source
     bool         m_InitMatrixDone;
     int          m_RoutingLayersCount;          // Number of layers for autorouting (0 or 1)
     int          m_GridRouting;                 // Size of grid for autoplace/autoroute
     EDA_RECT     m_BrdBox;                      // Actual board bounding box
     int          m_Nrows, m_Ncols;              // Matrix size
+    int          m_TileRows, m_TileCols;        // Matrix size, in tiles
+    int          m_CellCount;                   // Number of allocated cells per side
     int          m_MemSize;                     // Memory requirement, just for statistics
     int          m_RouteCount;                  // Number of routes
 
@@ -103,6 +124,32 @@ private:
     void        (MATRIX_ROUTING_HEAD::* m_opWriteCell)( int aRow, int aCol,
                                                         int aSide, MATRIX_CELL aCell);
 
+    // tiles of m_RouteSide written since the last ClearRouteCells() call
+    std::vector<int>            m_DirtyTiles[MAX_ROUTING_LAYERS_COUNT];
+    std::vector<unsigned char>  m_DirtyFlags[MAX_ROUTING_LAYERS_COUNT];
+
+    // index of the cell ( aRow, aCol ) in the tiled matrices
+    int cellIndex( int aRow, int aCol ) const
+    {
+        int tile = ( aRow >> MATRIX_TILE_SHIFT ) * m_TileCols + ( aCol >> MATRIX_TILE_SHIFT );
+
+        return ( tile << ( 2 * MATRIX_TILE_SHIFT ) )
+               | ( ( aRow & MATRIX_TILE_MASK ) << MATRIX_TILE_SHIFT )
+               | ( aCol & MATRIX_TILE_MASK );
+    }
+
+    // remember the tile holding the cell aIndex has to be cleared
+    void markDirty( int aSide, int aIndex )
+    {
+        int tile = aIndex >> ( 2 * MATRIX_TILE_SHIFT );
+
+        if( !m_DirtyFlags[aSide][tile] )
+        {
+            m_DirtyFlags[aSide][tile] = 1;
+            m_DirtyTiles[aSide].push_back( tile );
+        }
+    }
+
 public:
     MATRIX_ROUTING_HEAD();
     ~MATRIX_ROUTING_HEAD();
@@ -142,20 +189,91 @@ public:
 
     void UnInitRoutingMatrix();
 
+    /**
+     * Function ClearRouteCells
+     * resets the distance and direction of the cells written since the previous call,
+     * i.e. only the tiles reached by the last search are cleared.
+     */
+    void ClearRouteCells();
+
     // Initialize WriteCell to make the aLogicOp
     void SetCellOperation( int aLogicOp );
 
     // functions to read/write one cell ( point on grid routing matrix:
-    MATRIX_CELL GetCell( int aRow, int aCol, int aSide);
-    void SetCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    void OrCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    void XorCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    void AndCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    void AddCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    DIST_CELL GetDist( int aRow, int aCol, int aSide );
-    void SetDist( int aRow, int aCol, int aSide, DIST_CELL );
-    int GetDir( int aRow, int aCol, int aSide );
-    void SetDir( int aRow, int aCol, int aSide, int aDir);
+    MATRIX_CELL GetCell( int aRow, int aCol, int aSide )
+    {
+        return m_BoardSide[aSide][cellIndex( aRow, aCol )];
+    }
+
+    void SetCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
+    {
+        m_BoardSide[aSide][cellIndex( aRow, aCol )] = aCell;
+    }
+
+    void OrCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
+    {
+        m_BoardSide[aSide][cellIndex( aRow, aCol )] |= aCell;
+    }
+
+    void XorCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
+    {
+        m_BoardSide[aSide][cellIndex( aRow, aCol )] ^= aCell;
+    }
+
+    void AndCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
+    {
+        m_BoardSide[aSide][cellIndex( aRow, aCol )] &= aCell;
+    }
+
+    void AddCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
+    {
+        m_BoardSide[aSide][cellIndex( aRow, aCol )] += aCell;
+    }
+
+    // copy the cells of aFromSide to aToSide
+    void CopyCells( int aFromSide, int aToSide )
+    {
+        memcpy( m_BoardSide[aToSide], m_BoardSide[aFromSide],
+                m_CellCount * sizeof(MATRIX_CELL) );
+    }
+
+    DIST_CELL GetDist( int aRow, int aCol, int aSide )
+    {
+        return (DIST_CELL) ( m_RouteSide[aSide][cellIndex( aRow, aCol )] >> ROUTE_DIR_BITS );
+    }
+
+    void SetDist( int aRow, int aCol, int aSide, DIST_CELL aDist )
+    {
+        int         idx  = cellIndex( aRow, aCol );
+        ROUTE_CELL& cell = m_RouteSide[aSide][idx];
+
+        cell = ( (ROUTE_CELL) aDist << ROUTE_DIR_BITS ) | ( cell & ROUTE_DIR_MASK );
+        markDirty( aSide, idx );
+    }
+
+    int GetDir( int aRow, int aCol, int aSide )
+    {
+        return (int) ( m_RouteSide[aSide][cellIndex( aRow, aCol )] & ROUTE_DIR_MASK );
+    }
+
+    void SetDir( int aRow, int aCol, int aSide, int aDir )
+    {
+        int         idx  = cellIndex( aRow, aCol );
+        ROUTE_CELL& cell = m_RouteSide[aSide][idx];
+
+        cell = ( cell & ~(ROUTE_CELL) ROUTE_DIR_MASK ) | ( aDir & ROUTE_DIR_MASK );
+        markDirty( aSide, idx );
+    }
+
+    // store both the direction and the distance of a cell
+    void SetDirDist( int aRow, int aCol, int aSide, int aDir, DIST_CELL aDist )
+    {
+        int idx = cellIndex( aRow, aCol );
+
+        m_RouteSide[aSide][idx] = ( (ROUTE_CELL) aDist << ROUTE_DIR_BITS )
+                                  | ( aDir & ROUTE_DIR_MASK );
+        markDirty( aSide, idx );
+    }
 
     // calculate distance (with penalty) of a trace through a cell
     int CalcDist(int x,int y,int z ,int side );
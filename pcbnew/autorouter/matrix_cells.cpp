@@ -0,0 +1,202 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2012 Jean-Pierre Charras, jean-pierre.charras@ujf-grenoble.fr
+ * Copyright (C) 2012 SoftPLC Corporation, Dick Hollenbeck <dick@softplc.com>
+ * Copyright (C) 2011 Wayne Stambaugh <stambaughw@verizon.net>
+ *
+ * Copyright (C) 1992-2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file matrix_cells.cpp
+ * @brief Storage of the routing matrix cells
+ */
+
+#include <fctsys.h>
+#include <common.h>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#include <autorout.h>
+#include <cell.h>
+
+
+MATRIX_ROUTING_HEAD::MATRIX_ROUTING_HEAD()
+{
+    m_BoardSide[0] = m_BoardSide[1] = NULL;
+    m_RouteSide[0] = m_RouteSide[1] = NULL;
+    m_opWriteCell        = NULL;
+    m_InitMatrixDone     = false;
+    m_Nrows              = 0;
+    m_Ncols              = 0;
+    m_TileRows           = 0;
+    m_TileCols           = 0;
+    m_CellCount          = 0;
+    m_MemSize            = 0;
+    m_RoutingLayersCount = 1;
+    m_GridRouting        = 0;
+    m_RouteCount         = 0;
+}
+
+
+MATRIX_ROUTING_HEAD::~MATRIX_ROUTING_HEAD()
+{
+}
+
+
+int MATRIX_ROUTING_HEAD::InitRoutingMatrix()
+{
+    if( m_Nrows <= 0 || m_Ncols <= 0 )
+        return 0;
+
+    m_InitMatrixDone = true;     // we have been called
+
+    // give a small margin for memory allocation, and round up to whole tiles:
+    m_TileRows  = ( m_Nrows + 1 + MATRIX_TILE_MASK ) >> MATRIX_TILE_SHIFT;
+    m_TileCols  = ( m_Ncols + 1 + MATRIX_TILE_MASK ) >> MATRIX_TILE_SHIFT;
+    m_CellCount = m_TileRows * m_TileCols * MATRIX_TILE_CELLS;
+
+    int ii = m_CellCount;
+
+    int side = BOTTOM;
+    for( int jj = 0; jj < m_RoutingLayersCount; jj++ )  // m_RoutingLayersCount = 1 or 2
+    {
+        m_BoardSide[side] = NULL;
+        m_RouteSide[side] = NULL;
+
+        // allocate matrix & initialize everything to empty
+        m_BoardSide[side] = (MATRIX_CELL*) operator new( ii * sizeof(MATRIX_CELL), std::nothrow );
+
+        if( m_BoardSide[side] == NULL )
+            return -1;
+
+        memset( m_BoardSide[side], 0, ii * sizeof(MATRIX_CELL) );
+
+        // allocate Distances and Dirs
+        m_RouteSide[side] = (ROUTE_CELL*) operator new( ii * sizeof(ROUTE_CELL), std::nothrow );
+
+        if( m_RouteSide[side] == NULL )
+            return -1;
+
+        memset( m_RouteSide[side], 0, ii * sizeof(ROUTE_CELL) );
+
+        m_DirtyTiles[side].clear();
+        m_DirtyFlags[side].assign( m_TileRows * m_TileCols, 0 );
+
+        side = TOP;
+    }
+
+    m_MemSize = m_RouteCount * ii * ( sizeof(MATRIX_CELL) + sizeof(ROUTE_CELL) );
+
+    return m_MemSize;
+}
+
+
+void MATRIX_ROUTING_HEAD::UnInitRoutingMatrix()
+{
+    int ii;
+
+    m_InitMatrixDone = false;
+
+    for( ii = 0; ii < MAX_ROUTING_LAYERS_COUNT; ii++ )
+    {
+        // de-allocate Distances and Dirs matrix
+        if( m_RouteSide[ii] )
+        {
+            delete m_RouteSide[ii];
+            m_RouteSide[ii] = NULL;
+        }
+
+        m_DirtyTiles[ii].clear();
+        m_DirtyFlags[ii].clear();
+
+        // de-allocate cells matrix
+        if( m_BoardSide[ii] )
+        {
+            delete m_BoardSide[ii];
+            m_BoardSide[ii] = NULL;
+        }
+    }
+
+    m_Nrows = m_Ncols = 0;
+    m_TileRows = m_TileCols = m_CellCount = 0;
+}
+
+
+void MATRIX_ROUTING_HEAD::ClearRouteCells()
+{
+    for( int side = 0; side < MAX_ROUTING_LAYERS_COUNT; side++ )
+    {
+        if( m_RouteSide[side] == NULL )
+            continue;
+
+        std::vector<int>& dirty = m_DirtyTiles[side];
+        int               count = (int) dirty.size();
+        int               ii;
+
+        // Each tile is a contiguous block of cells, so the tiles can be cleared
+        // independently. Only worth spreading over threads for large searches.
+#ifdef USE_OPENMP
+        #pragma omp parallel for if( count > 1024 ) private(ii)
+#endif /* USE_OPENMP */
+        for( ii = 0; ii < count; ii++ )
+        {
+            int tile = dirty[ii];
+
+            memset( m_RouteSide[side] + ( tile << ( 2 * MATRIX_TILE_SHIFT ) ), 0,
+                    MATRIX_TILE_CELLS * sizeof(ROUTE_CELL) );
+            m_DirtyFlags[side][tile] = 0;
+        }
+
+        dirty.clear();
+    }
+}
+
+
+// Initialize m_opWriteCell member to make the aLogicOp
+void MATRIX_ROUTING_HEAD::SetCellOperation( int aLogicOp )
+{
+    switch( aLogicOp )
+    {
+    default:
+    case WRITE_CELL:
+        m_opWriteCell = &MATRIX_ROUTING_HEAD::SetCell;
+        break;
+
+    case WRITE_OR_CELL:
+        m_opWriteCell = &MATRIX_ROUTING_HEAD::OrCell;
+        break;
+
+    case WRITE_XOR_CELL:
+        m_opWriteCell = &MATRIX_ROUTING_HEAD::XorCell;
+        break;
+
+    case WRITE_AND_CELL:
+        m_opWriteCell = &MATRIX_ROUTING_HEAD::AndCell;
+        break;
+
+    case WRITE_ADD_CELL:
+        m_opWriteCell = &MATRIX_ROUTING_HEAD::AddCell;
+        break;
+    }
+}
@@ -30,8 +30,16 @@
 
 /**
  * @file queue.cpp
+ *
+ * The search queue is a bucketed priority queue: the open nodes are grouped in buckets
+ * by their estimated total cost ( distance so far + approximate distance to target ),
+ * so inserting or repositioning a node does not need to walk the whole open list.
+ * Open nodes are also indexed by cell, to find them in ReSetQueue().
  */
 
+#include <map>
+#include <vector>
+
 #include <fctsys.h>
 #include <common.h>
 
@@ -43,6 +51,7 @@
 struct PcbQueue /* search queue structure */
 {
     struct PcbQueue* Next;
+    struct PcbQueue* Prev;
     int              Row;       /* current row                  */
     int              Col;       /* current column               */
     int              Side;      /* 0=top, 1=bottom              */
@@ -50,10 +59,51 @@ struct PcbQueue /* search queue structure */
     int              ApxDist;   /* approximate distance to target from here */
 };
 
-static long             qlen = 0;   /* current queue length */
-static struct PcbQueue* Head = NULL;
-static struct PcbQueue* Tail = NULL;
-static struct PcbQueue* Save = NULL;    /* hold empty queue structs */
+struct PcbQueueBucket /* open nodes having the same estimated cost */
+{
+    struct PcbQueue* Head;
+    struct PcbQueue* Tail;
+
+    PcbQueueBucket() : Head( NULL ), Tail( NULL ) {}
+};
+
+typedef std::map<int, PcbQueueBucket> PCB_QUEUE_BUCKETS;
+
+static long                   qlen = 0;     /* current queue length */
+static PCB_QUEUE_BUCKETS      Buckets;      /* open nodes, by estimated cost */
+static std::vector<PcbQueue*> Index;        /* open node of each cell, or NULL */
+static struct PcbQueue*       Save = NULL;  /* hold empty queue structs */
+
+
+static inline int cellKey( int r, int c, int s )
+{
+    return ( s * RoutingMatrix.m_Nrows + r ) * RoutingMatrix.m_Ncols + c;
+}
+
+
+/* remove a node from its bucket, and the bucket from the queue if it is empty */
+static void unlinkNode( PCB_QUEUE_BUCKETS::iterator aBucket, struct PcbQueue* p )
+{
+    PcbQueueBucket& bucket = aBucket->second;
+
+    if( p->Prev )
+        p->Prev->Next = p->Next;
+    else
+        bucket.Head = p->Next;
+
+    if( p->Next )
+        p->Next->Prev = p->Prev;
+    else
+        bucket.Tail = p->Prev;
+
+    if( bucket.Head == NULL )
+        Buckets.erase( aBucket );
+
+    Index[cellKey( p->Row, p->Col, p->Side )] = NULL;
+
+    p->Prev = NULL;
+    p->Next = Save; Save = p;
+}
 
 
 /* Free the memory used for storing all the queue */
@@ -68,6 +118,8 @@ void FreeQueue()
         Save = p->Next;
         delete p;
     }
+
+    Index.clear();
 }
 
 
@@ -75,14 +127,27 @@ void FreeQueue()
 void InitQueue()
 {
     struct PcbQueue* p;
+    size_t cellCount = (size_t) RoutingMatrix.m_Nrows * RoutingMatrix.m_Ncols
+                       * MAX_ROUTING_LAYERS_COUNT;
+    bool   resized   = Index.size() != cellCount;
 
-    while( (p = Head) != NULL )
+    if( resized )
+        Index.assign( cellCount, NULL );
+
+    for( PCB_QUEUE_BUCKETS::iterator it = Buckets.begin(); it != Buckets.end(); ++it )
     {
-        Head    = p->Next;
-        p->Next = Save; Save = p;
+        while( (p = it->second.Head) != NULL )
+        {
+            if( !resized )
+                Index[cellKey( p->Row, p->Col, p->Side )] = NULL;
+
+            it->second.Head = p->Next;
+            p->Next = Save; Save = p;
+        }
     }
 
-    Tail = NULL;
+    Buckets.clear();
+
     OpenNodes = ClosNodes = MoveNodes = MaxNodes = qlen = 0;
 }
 
@@ -92,17 +157,18 @@ void GetQueue( int* r, int* c, int* s, int* d, int* a )
 {
     struct PcbQueue* p;
 
-    if( (p = Head) != NULL )  /* return first item in list */
+    if( !Buckets.empty() )  /* return first item of the cheapest bucket */
     {
+        PCB_QUEUE_BUCKETS::iterator first = Buckets.begin();
+
+        p = first->second.Head;
+
         *r = p->Row; *c = p->Col;
         *s = p->Side;
         *d = p->Dist; *a = p->ApxDist;
 
-        if( (Head = p->Next) == NULL )
-            Tail = NULL;
-
         /* put node on free list */
-        p->Next = Save; Save = p;
+        unlinkNode( first, p );
         ClosNodes++; qlen--;
     }
     else /* empty list */
@@ -120,9 +186,6 @@ void GetQueue( int* r, int* c, int* s, int* d, int* a )
 bool SetQueue( int r, int c, int side, int d, int a, int r2, int c2 )
 {
     struct PcbQueue* p, * q, * t;
-    int i, j;
-
-    j = 0;                      // gcc warning fix
 
     if( (p = Save) != NULL )    /* try free list first */
     {
@@ -136,42 +199,44 @@ bool SetQueue( int r, int c, int side, int d, int a, int r2, int c2 )
     p->Row  = r;
     p->Col  = c;
     p->Side = side;
-    i = (p->Dist = d) + (p->ApxDist = a);
-    p->Next = NULL;
+    p->Dist = d;
+    p->ApxDist = a;
 
-    if( (q = Head) != NULL ) /* insert in proper position in list */
+    PCB_QUEUE_BUCKETS::iterator it = Buckets.insert(
+            std::make_pair( d + a, PcbQueueBucket() ) ).first;
+    PcbQueueBucket& bucket = it->second;
+
+    /* the newest node of a bucket is explored first, except that the head of
+     * the whole queue stays first, and a goal node stays ahead of the new node */
+    t = NULL;
+    q = bucket.Head;
+
+    if( q && it == Buckets.begin() )
     {
-        if( q->Dist + q->ApxDist > i ) /* insert at head */
-        {
-            p->Next = q; Head = p;
-        }
-        else   /* search for proper position */
-        {
-            for( t = q, q = q->Next; q && i > ( j = q->Dist + q->ApxDist ); t = q, q = q->Next )
-                ;
-
-            if( q && i == j && q->Row == r2 && q->Col == c2 )
-            {
-                /* insert after q, which is a goal node */
-                if( ( p->Next = q->Next ) == NULL )
-                    Tail = p;
-
-                q->Next = p;
-            }
-            else  /* insert in front of q */
-            {
-                if( ( p->Next = q ) == NULL )
-                    Tail = p;
-
-                t->Next = p;
-            }
-        }
+        t = q; q = q->Next;
     }
-    else /* empty search list */
+
+    if( q && q->Row == r2 && q->Col == c2 )
     {
-        Head = Tail = p;
+        t = q; q = q->Next;
     }
 
+    /* insert between t and q */
+    p->Prev = t;
+    p->Next = q;
+
+    if( t )
+        t->Next = p;
+    else
+        bucket.Head = p;
+
+    if( q )
+        q->Prev = p;
+    else
+        bucket.Tail = p;
+
+    Index[cellKey( r, c, side )] = p;
+
     OpenNodes++;
 
     if( ++qlen > MaxNodes )
@@ -184,35 +249,21 @@ bool SetQueue( int r, int c, int side, int d, int a, int r2, int c2 )
 /* reposition node in list */
 void ReSetQueue( int r, int c, int s, int d, int a, int r2, int c2 )
 {
-    struct PcbQueue* p, * q;
+    struct PcbQueue* p;
 
     /* first, see if it is already in the list */
-    for( q = NULL, p = Head; p; q = p, p = p->Next )
+    if( ( p = Index[cellKey( r, c, s )] ) != NULL )
     {
-        if( p->Row == r && p->Col == c && p->Side == s )
-        {
-            /* old one to remove */
-            if( q )
-            {
-                if( ( q->Next = p->Next ) == NULL )
-                    Tail = q;
-            }
-            else if( ( Head = p->Next ) == NULL )
-            {
-                Tail = NULL;
-            }
-
-            p->Next = Save;
-            Save = p;
-            OpenNodes--;
-            MoveNodes++;
-            qlen--;
-            break;
-        }
+        /* old one to remove */
+        unlinkNode( Buckets.find( p->Dist + p->ApxDist ), p );
+        OpenNodes--;
+        MoveNodes++;
+        qlen--;
     }
-
-    if( !p )            /* not found, it has already been closed once */
+    else                /* not found, it has already been closed once */
+    {
         ClosNodes--;    /* we will close it again, but just count once */
+    }
 
     /* if it was there, it's gone now; insert it at the proper position */
     bool res = SetQueue( r, c, s, d, a, r2, c2 );
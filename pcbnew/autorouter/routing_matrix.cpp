@@ -45,27 +45,6 @@
 #include <class_pcb_text.h>
 
 
-MATRIX_ROUTING_HEAD::MATRIX_ROUTING_HEAD()
-{
-    m_BoardSide[0] = m_BoardSide[1] = NULL;
-    m_DistSide[0] = m_DistSide[1] = NULL;
-    m_DirSide[0] = m_DirSide[1] = NULL;
-    m_opWriteCell        = NULL;
-    m_InitMatrixDone     = false;
-    m_Nrows              = 0;
-    m_Ncols              = 0;
-    m_MemSize            = 0;
-    m_RoutingLayersCount = 1;
-    m_GridRouting        = 0;
-    m_RouteCount         = 0;
-}
-
-
-MATRIX_ROUTING_HEAD::~MATRIX_ROUTING_HEAD()
-{
-}
-
-
 bool MATRIX_ROUTING_HEAD::ComputeMatrixSize( BOARD* aPcb, bool aUseBoardEdgesOnly )
 {
     aPcb->ComputeBoundingBox( aUseBoardEdgesOnly );
@@ -100,88 +79,6 @@ bool MATRIX_ROUTING_HEAD::ComputeMatrixSize( BOARD* aPcb, bool aUseBoardEdgesOnl
 }
 
 
-int MATRIX_ROUTING_HEAD::InitRoutingMatrix()
-{
-    if( m_Nrows <= 0 || m_Ncols <= 0 )
-        return 0;
-
-    m_InitMatrixDone = true;     // we have been called
-
-    // give a small margin for memory allocation:
-    int ii = (RoutingMatrix.m_Nrows + 1) * (RoutingMatrix.m_Ncols + 1);
-
-    int side = BOTTOM;
-    for( int jj = 0; jj < m_RoutingLayersCount; jj++ )  // m_RoutingLayersCount = 1 or 2
-    {
-        m_BoardSide[side] = NULL;
-        m_DistSide[side]  = NULL;
-        m_DirSide[side]   = NULL;
-
-        // allocate matrix & initialize everything to empty
-        m_BoardSide[side] = (MATRIX_CELL*) operator new( ii * sizeof(MATRIX_CELL) );
-        memset( m_BoardSide[side], 0, ii * sizeof(MATRIX_CELL) );
-
-        if( m_BoardSide[side] == NULL )
-            return -1;
-
-        // allocate Distances
-        m_DistSide[side] = (DIST_CELL*) operator new( ii * sizeof(DIST_CELL) );
-        memset( m_DistSide[side], 0, ii * sizeof(DIST_CELL) );
-
-        if( m_DistSide[side] == NULL )
-            return -1;
-
-        // allocate Dir (chars)
-        m_DirSide[side] = (char*) operator new( ii );
-        memset( m_DirSide[side], 0, ii );
-
-        if( m_DirSide[side] == NULL )
-            return -1;
-
-        side = TOP;
-    }
-
-    m_MemSize = m_RouteCount * ii * ( sizeof(MATRIX_CELL)
-                + sizeof(DIST_CELL) + sizeof(char) );
-
-    return m_MemSize;
-}
-
-
-void MATRIX_ROUTING_HEAD::UnInitRoutingMatrix()
-{
-    int ii;
-
-    m_InitMatrixDone = false;
-
-    for( ii = 0; ii < MAX_ROUTING_LAYERS_COUNT; ii++ )
-    {
-        // de-allocate Dir matrix
-        if( m_DirSide[ii] )
-        {
-            delete m_DirSide[ii];
-            m_DirSide[ii] = NULL;
-        }
-
-        // de-allocate Distances matrix
-        if( m_DistSide[ii] )
-        {
-            delete m_DistSide[ii];
-            m_DistSide[ii] = NULL;
-        }
-
-        // de-allocate cells matrix
-        if( m_BoardSide[ii] )
-        {
-            delete m_BoardSide[ii];
-            m_BoardSide[ii] = NULL;
-        }
-    }
-
-    m_Nrows = m_Ncols = 0;
-}
-
-
 /**
  * Function PlaceCells
  * Initialize the matrix routing by setting obstacles for each occupied cell
@@ -414,137 +311,3 @@ int Build_Work( BOARD* Pcb )
     SortWork();
     return cellCount;
 }
-
-// Initialize m_opWriteCell member to make the aLogicOp
-void MATRIX_ROUTING_HEAD::SetCellOperation( int aLogicOp )
-{
-    switch( aLogicOp )
-    {
-    default:
-    case WRITE_CELL:
-        m_opWriteCell = &MATRIX_ROUTING_HEAD::SetCell;
-        break;
-
-    case WRITE_OR_CELL:
-        m_opWriteCell = &MATRIX_ROUTING_HEAD::OrCell;
-        break;
-
-    case WRITE_XOR_CELL:
-        m_opWriteCell = &MATRIX_ROUTING_HEAD::XorCell;
-        break;
-
-    case WRITE_AND_CELL:
-        m_opWriteCell = &MATRIX_ROUTING_HEAD::AndCell;
-        break;
-
-    case WRITE_ADD_CELL:
-        m_opWriteCell = &MATRIX_ROUTING_HEAD::AddCell;
-        break;
-    }
-}
-
-
-/* return the value stored in a cell
- */
-MATRIX_CELL MATRIX_ROUTING_HEAD::GetCell( int aRow, int aCol, int aSide )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    return p[aRow * m_Ncols + aCol];
-}
-
-
-/* basic cell operation : WRITE operation
- */
-void MATRIX_ROUTING_HEAD::SetCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] = x;
-}
-
-
-/* basic cell operation : OR operation
- */
-void MATRIX_ROUTING_HEAD::OrCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] |= x;
-}
-
-
-/* basic cell operation : XOR operation
- */
-void MATRIX_ROUTING_HEAD::XorCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] ^= x;
-}
-
-
-/* basic cell operation : AND operation
- */
-void MATRIX_ROUTING_HEAD::AndCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] &= x;
-}
-
-
-/* basic cell operation : ADD operation
- */
-void MATRIX_ROUTING_HEAD::AddCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] += x;
-}
-
-
-// fetch distance cell
-DIST_CELL MATRIX_ROUTING_HEAD::GetDist( int aRow, int aCol, int aSide ) // fetch distance cell
-{
-    DIST_CELL* p;
-
-    p = RoutingMatrix.m_DistSide[aSide];
-    return p[aRow * m_Ncols + aCol];
-}
-
-
-// store distance cell
-void MATRIX_ROUTING_HEAD::SetDist( int aRow, int aCol, int aSide, DIST_CELL x )
-{
-    DIST_CELL* p;
-
-    p = RoutingMatrix.m_DistSide[aSide];
-    p[aRow * m_Ncols + aCol] = x;
-}
-
-
-// fetch direction cell
-int MATRIX_ROUTING_HEAD::GetDir( int aRow, int aCol, int aSide )
-{
-    DIR_CELL* p;
-
-    p = RoutingMatrix.m_DirSide[aSide];
-    return (int) (p[aRow * m_Ncols + aCol]);
-}
-
-
-// store direction cell
-void MATRIX_ROUTING_HEAD::SetDir( int aRow, int aCol, int aSide, int x )
-{
-    DIR_CELL* p;
-
-    p = RoutingMatrix.m_DirSide[aSide];
-    p[aRow * m_Ncols + aCol] = (char) x;
-}
@@ -436,12 +436,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
 
     marge = s_Clearance + ( pcbframe->GetDesignSettings().GetCurrentTrackWidth() / 2 );
 
-    // clear direction flags
-    i = RoutingMatrix.m_Nrows * RoutingMatrix.m_Ncols * sizeof(DIR_CELL);
-
-    if( two_sides )
-        memset( RoutingMatrix.m_DirSide[TOP], FROM_NOWHERE, i );
-    memset( RoutingMatrix.m_DirSide[BOTTOM], FROM_NOWHERE, i );
+    // clear direction flags (only the tiles reached by the previous search)
+    RoutingMatrix.ClearRouteCells();
 
     lastopen = lastclos = lastmove = 0;
 
@@ -520,16 +516,28 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
     PlacePad( pt_cur_ch->m_PadEnd, CURRENT_PAD, marge, WRITE_OR_CELL );
 
     // Regenerates the remaining barriers (which may encroach on the
-    // placement bits precedent)
-    i = pcbframe->GetBoard()->GetPadCount();
-
-    for( unsigned ii = 0; ii < pcbframe->GetBoard()->GetPadCount(); ii++ )
+    // placement bits precedent).
+    // Only the pads overlapping the 2 pads of the link can have cells
+    // marked CURRENT_PAD, the other ones are skipped.
     {
-        D_PAD* ptr = pcbframe->GetBoard()->GetPad( ii );
+        EDA_RECT startArea = pt_cur_ch->m_PadStart->GetBoundingBox();
+        EDA_RECT endArea   = pt_cur_ch->m_PadEnd->GetBoundingBox();
+
+        startArea.Inflate( marge + RoutingMatrix.m_GridRouting );
+        endArea.Inflate( marge + RoutingMatrix.m_GridRouting );
 
-        if( ( pt_cur_ch->m_PadStart != ptr ) && ( pt_cur_ch->m_PadEnd != ptr ) )
+        for( unsigned ii = 0; ii < pcbframe->GetBoard()->GetPadCount(); ii++ )
         {
-            PlacePad( ptr, ~CURRENT_PAD, marge, WRITE_AND_CELL );
+            D_PAD* ptr = pcbframe->GetBoard()->GetPad( ii );
+
+            if( ( pt_cur_ch->m_PadStart == ptr ) || ( pt_cur_ch->m_PadEnd == ptr ) )
+                continue;
+
+            EDA_RECT padArea = ptr->GetBoundingBox();
+            padArea.Inflate( marge + RoutingMatrix.m_GridRouting );
+
+            if( padArea.Intersects( startArea ) || padArea.Intersects( endArea ) )
+                PlacePad( ptr, ~CURRENT_PAD, marge, WRITE_AND_CELL );
         }
     }
 
@@ -733,8 +741,7 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
             // found a better path, add it to queue
             if( !RoutingMatrix.GetDir( nr, nc, side ) )
             {
-                RoutingMatrix.SetDir( nr, nc, side, ndir[i] );
-                RoutingMatrix.SetDist( nr, nc, side, newdist );
+                RoutingMatrix.SetDirDist( nr, nc, side, ndir[i], newdist );
 
                 if( SetQueue( nr, nc, side, newdist,
                               RoutingMatrix.GetApxDist( nr, nc, row_target, col_target ),
@@ -745,8 +752,7 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
             }
             else if( newdist < RoutingMatrix.GetDist( nr, nc, side ) )
             {
-                RoutingMatrix.SetDir( nr, nc, side, ndir[i] );
-                RoutingMatrix.SetDist( nr, nc, side, newdist );
+                RoutingMatrix.SetDirDist( nr, nc, side, ndir[i], newdist );
                 ReSetQueue( nr, nc, side, newdist,
                             RoutingMatrix.GetApxDist( nr, nc, row_target, col_target ),
                             row_target, col_target );
@@ -800,8 +806,7 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
              *  add it to queue */
             if( !RoutingMatrix.GetDir( r, c, 1 - side ) )
             {
-                RoutingMatrix.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
-                RoutingMatrix.SetDist( r, c, 1 - side, newdist );
+                RoutingMatrix.SetDirDist( r, c, 1 - side, FROM_OTHERSIDE, newdist );
 
                 if( SetQueue( r, c, 1 - side, newdist, apx_dist, row_target, col_target ) == 0 )
                 {
@@ -810,8 +815,7 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
             }
             else if( newdist < RoutingMatrix.GetDist( r, c, 1 - side ) )
             {
-                RoutingMatrix.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
-                RoutingMatrix.SetDist( r, c, 1 - side, newdist );
+                RoutingMatrix.SetDirDist( r, c, 1 - side, FROM_OTHERSIDE, newdist );
                 ReSetQueue( r, c,
                             1 - side,
                             newdist,
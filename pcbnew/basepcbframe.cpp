@@ -60,8 +60,6 @@
 #include <tool/tool_manager.h>
 #include <tool/tool_dispatcher.h>
 
-const wxChar PCB_BASE_FRAME::CANVAS_TYPE_KEY[] = wxT( "canvas_type" );
-
 // Configuration entry names.
 static const wxChar UserGridSizeXEntry[] = wxT( "PcbUserGrid_X" );
 static const wxChar UserGridSizeYEntry[] = wxT( "PcbUserGrid_Y" );
@@ -796,6 +794,10 @@ void PCB_BASE_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
+    // The data cached from the board is now out of date
+    if( m_Pcb )
+        m_Pcb->IncrementRevision();
+
     if( IsGalCanvasActive() )
     {
         UpdateStatusBar();
@@ -986,41 +988,3 @@ void PCB_BASE_FRAME::UseGalCanvas( bool aEnable )
         galCanvas->SetEventDispatcher( NULL );
     }
 }
-
-
-EDA_DRAW_PANEL_GAL::GAL_TYPE PCB_BASE_FRAME::LoadCanvasTypeSetting() const
-{
-    EDA_DRAW_PANEL_GAL::GAL_TYPE canvasType = EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE;
-    wxConfigBase* cfg = Kiface().KifaceSettings();
-
-    if( cfg )
-        canvasType = (EDA_DRAW_PANEL_GAL::GAL_TYPE) cfg->ReadLong( CANVAS_TYPE_KEY,
-                                                                   EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE );
-
-    if( canvasType < EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE
-            || canvasType >= EDA_DRAW_PANEL_GAL::GAL_TYPE_LAST )
-    {
-        assert( false );
-        canvasType = EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE;
-    }
-
-    return canvasType;
-}
-
-
-bool PCB_BASE_FRAME::SaveCanvasTypeSetting( EDA_DRAW_PANEL_GAL::GAL_TYPE aCanvasType )
-{
-    if( aCanvasType < EDA_DRAW_PANEL_GAL::GAL_TYPE_NONE
-            || aCanvasType >= EDA_DRAW_PANEL_GAL::GAL_TYPE_LAST )
-    {
-        assert( false );
-        return false;
-    }
-
-    wxConfigBase* cfg = Kiface().KifaceSettings();
-
-    if( cfg )
-        return cfg->Write( CANVAS_TYPE_KEY, (long) aCanvasType );
-
-    return false;
-}
@@ -50,9 +50,10 @@
 // These variables are parameters used in addTextSegmToPoly.
 // But addTextSegmToPoly is a call-back function,
 // so we cannot send them as arguments.
-static int s_textWidth;
-static int s_textCircle2SegmentCount;
-static SHAPE_POLY_SET* s_cornerBuffer;
+// They are thread local, because the board layers can be plotted in parallel.
+static thread_local int s_textWidth;
+static thread_local int s_textCircle2SegmentCount;
+static thread_local SHAPE_POLY_SET* s_cornerBuffer;
 
 // This is a call back function, used by DrawGraphicText to draw the 3D text shape:
 static void addTextSegmToPoly( int x0, int y0, int xf, int yf )
@@ -126,6 +127,152 @@ void BOARD::ConvertBrdLayerToPolygonalContours( LAYER_ID aLayer, SHAPE_POLY_SET&
 }
 
 
+/* Builds the openings of the solder mask layer aLayer of aBoard.
+ * The algo is:
+ * 1 - build all pad shapes as polygons with a size inflated by
+ *      mask clearance + (min width solder mask /2)
+ * 2 - Merge shapes
+ * 3 - deflate result by (min width solder mask /2)
+ * 4 - ORing result by all pad shapes as polygons with a size inflated by
+ *      mask clearance only (because deflate sometimes creates shape artifacts)
+ */
+static void buildMergedMaskLayer( const BOARD* aBoard, LAYER_ID aLayer, int aMinThickness,
+                                  bool aWithVias, bool aWithZones, SHAPE_POLY_SET& aOpenings )
+{
+    int inflate = aMinThickness/2;
+
+    // Build polygons for each pad shape.
+    // the size of the shape on solder mask should be:
+    // size of pad + clearance around the pad.
+    // clearance = solder mask clearance + extra margin
+    // extra margin is half the min width for solder mask
+    // This extra margin is used to merge too close shapes
+    // (distance < aMinThickness), and will be removed when creating
+    // the actual shapes
+    SHAPE_POLY_SET initialPolys;    // Contains exact shapes
+
+    /* calculates the coeff to compensate radius reduction of holes clearance
+     * due to the segment approx ( 1 /cos( PI/circleToSegmentsCount )
+     */
+    int circleToSegmentsCount = 32;
+    double correction = 1.0 / cos( M_PI / circleToSegmentsCount );
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        // add shapes with exact size
+        module->TransformPadsShapesWithClearanceToPolygon( aLayer,
+                        initialPolys, 0,
+                        circleToSegmentsCount, correction );
+        // add shapes inflated by aMinThickness/2
+        module->TransformPadsShapesWithClearanceToPolygon( aLayer,
+                        aOpenings, inflate,
+                        circleToSegmentsCount, correction );
+    }
+
+    if( aWithVias )
+    {
+        // The current layer is a solder mask,
+        // use the global mask clearance for vias
+        int via_clearance = aBoard->GetDesignSettings().m_SolderMaskMargin;
+        int via_margin = via_clearance + inflate;
+
+        for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        {
+            const VIA* via = dyn_cast<const VIA*>( track );
+
+            if( !via )
+                continue;
+
+            // vias are on the mask only if they are on the corresponding
+            // external copper layer
+            LSET via_set = via->GetLayerSet();
+
+            if( via_set[B_Cu] )
+                via_set.set( B_Mask );
+
+            if( via_set[F_Cu] )
+                via_set.set( F_Mask );
+
+            if( !via_set[aLayer] )
+                continue;
+
+            via->TransformShapeWithClearanceToPolygon( aOpenings, via_margin,
+                    circleToSegmentsCount,
+                    correction );
+            via->TransformShapeWithClearanceToPolygon( initialPolys, via_clearance,
+                    circleToSegmentsCount,
+                    correction );
+        }
+    }
+
+    // Add filled zone areas.
+#if 0   // Set to 1 if a solder mask margin must be applied to zones on solder mask
+    int zone_margin = aBoard->GetDesignSettings().m_SolderMaskMargin;
+#else
+    int zone_margin = 0;
+#endif
+
+    for( int ii = 0; aWithZones && ii < aBoard->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        if( zone->GetLayer() != aLayer )
+            continue;
+
+        zone->TransformOutlinesShapeWithClearanceToPolygon( aOpenings,
+                    inflate+zone_margin, false );
+        zone->TransformOutlinesShapeWithClearanceToPolygon( initialPolys,
+                    zone_margin, false );
+    }
+
+    aOpenings.BooleanAdd( initialPolys, SHAPE_POLY_SET::PM_FAST );
+    aOpenings.Inflate( -inflate, circleToSegmentsCount );
+
+    // Combine the current areas to initial areas. This is mandatory because
+    // inflate/deflate transform is not perfect, and we want the initial areas perfectly kept
+    aOpenings.BooleanAdd( initialPolys, SHAPE_POLY_SET::PM_FAST );
+}
+
+
+void BOARD::GetMergedMaskLayer( LAYER_ID aLayer, int aMinThickness, bool aWithVias,
+                                bool aWithZones, SHAPE_POLY_SET& aOpenings ) const
+{
+    wxASSERT( aLayer == F_Mask || aLayer == B_Mask );
+
+    MASK_LAYER_CACHE& cache = m_maskLayerCache[( aLayer == F_Mask ? 0 : 2 ) + aWithZones];
+    unsigned revision = m_revision;
+    int maskMargin = m_designSettings.m_SolderMaskMargin;
+
+    {
+        MUTLOCK lock( m_maskLayerCacheLock );
+
+        if( cache.m_valid && cache.m_revision == revision
+                && cache.m_maskMargin == maskMargin
+                && cache.m_minThickness == aMinThickness
+                && cache.m_withVias == aWithVias )
+        {
+            aOpenings = cache.m_openings;
+            return;
+        }
+    }
+
+    // Build it without the lock, so both mask layers can be built at the same time
+    SHAPE_POLY_SET openings;
+    buildMergedMaskLayer( this, aLayer, aMinThickness, aWithVias, aWithZones, openings );
+
+    MUTLOCK lock( m_maskLayerCacheLock );
+
+    cache.m_valid = true;
+    cache.m_revision = revision;
+    cache.m_maskMargin = maskMargin;
+    cache.m_minThickness = aMinThickness;
+    cache.m_withVias = aWithVias;
+    cache.m_openings = openings;
+
+    aOpenings = openings;
+}
+
+
 void MODULE::TransformPadsShapesWithClearanceToPolygon( LAYER_ID aLayer,
                         SHAPE_POLY_SET& aCornerBuffer,
                         int                    aInflateValue,
@@ -0,0 +1,303 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_snapshot.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <class_netclass.h>
+
+#include <board_snapshot.h>
+
+
+static bool sortNetsByCode( const NETINFO_ITEM* aA, const NETINFO_ITEM* aB )
+{
+    return aA->GetNet() < aB->GetNet();
+}
+
+
+BOARD_SNAPSHOT::BOARD_SNAPSHOT( BOARD* aBoard ) :
+    m_board( new BOARD )
+{
+    m_board->SetFileName( aBoard->GetFileName() );
+    m_board->SetPageSettings( aBoard->GetPageSettings() );
+    m_board->SetTitleBlock( aBoard->GetTitleBlock() );
+    m_board->SetPlotOptions( aBoard->GetPlotOptions() );
+    m_board->SetZoneSettings( aBoard->GetZoneSettings() );
+
+    // The net classes are held by shared pointers: copying the design settings
+    // would share them with the live board. Keep our own ones, and copy their contents.
+    NETCLASSES ownClasses = m_board->GetDesignSettings().m_NetClasses;
+    const NETCLASSES& liveClasses = aBoard->GetDesignSettings().m_NetClasses;
+
+    m_board->SetDesignSettings( aBoard->GetDesignSettings() );
+
+    NETCLASSES& classes = m_board->GetDesignSettings().m_NetClasses;
+
+    classes = ownClasses;
+    classes.Clear();
+    classes.GetDefault()->SetParams( *liveClasses.GetDefault() );
+
+    for( NETCLASSES::const_iterator it = liveClasses.begin(); it != liveClasses.end(); ++it )
+        classes.Add( std::make_shared<NETCLASS>( *it->second ) );
+
+    m_board->SetEnabledLayers( aBoard->GetEnabledLayers() );
+    m_board->SetVisibleLayers( aBoard->GetVisibleLayers() );
+    m_board->SetVisibleElements( aBoard->GetVisibleElements() );
+
+    for( LAYER_NUM layer = 0; layer < LAYER_ID_COUNT; ++layer )
+    {
+        LAYER_ID id = ToLAYER_ID( layer );
+
+        m_board->SetLayerName( id, aBoard->GetLayerName( id ) );
+
+        if( IsCopperLayer( layer ) )
+            m_board->SetLayerType( id, aBoard->GetLayerType( id ) );
+    }
+
+    std::unordered_map<const NETINFO_ITEM*, NETINFO_ITEM*> netMap;
+
+    copyNets( aBoard, netMap );
+
+    // the copies still refer to the nets of the live board
+    auto remapNet = [&netMap] ( BOARD_CONNECTED_ITEM* aItem )
+    {
+        auto it = netMap.find( aItem->GetNet() );
+
+        aItem->SetNet( it != netMap.end() ? it->second : &NETINFO_LIST::ORPHANED_ITEM );
+    };
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        MODULE* copy = new MODULE( *module );
+
+        for( D_PAD* pad = copy->Pads(); pad; pad = pad->Next() )
+            remapNet( pad );
+
+        m_board->Add( copy, ADD_APPEND );
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        TRACK* copy = static_cast<TRACK*>( track->Clone() );
+
+        remapNet( copy );
+        m_board->Add( copy, ADD_APPEND );
+    }
+
+    for( SEGZONE* seg = aBoard->m_Zone; seg; seg = seg->Next() )
+    {
+        SEGZONE* copy = static_cast<SEGZONE*>( seg->Clone() );
+
+        remapNet( copy );
+        m_board->Add( copy, ADD_APPEND );
+    }
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* copy = new ZONE_CONTAINER( *aBoard->GetArea( ii ) );
+
+        remapNet( copy );
+        m_board->Add( copy, ADD_APPEND );
+    }
+
+    for( BOARD_ITEM* item = aBoard->m_Drawings; item; item = item->Next() )
+        m_board->Add( static_cast<BOARD_ITEM*>( item->Clone() ), ADD_APPEND );
+
+    m_board->BuildListOfNets();
+    m_board->SynchronizeNetsAndNetClasses();
+
+    // Build the lookup tables and the spatial index
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        m_modules.push_back( module );
+        m_modulesByRef.insert( std::make_pair( module->GetReference(), module ) );
+        index( module );
+
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+        {
+            EDA_RECT bbox = pad->GetBoundingBox();
+            bbox.Normalize();
+
+            const int min[2] = { bbox.GetX(), bbox.GetY() };
+            const int max[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+            m_padIndex.Insert( min, max, pad );
+            m_pads.push_back( pad );
+            index( pad );
+            indexNet( pad );
+        }
+    }
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+    {
+        m_tracks.push_back( track );
+        m_tracksByNet[track->GetNetCode()].push_back( track );
+        index( track );
+        indexNet( track );
+    }
+
+    for( SEGZONE* seg = m_board->m_Zone; seg; seg = seg->Next() )
+        index( seg );
+
+    for( int ii = 0; ii < m_board->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = m_board->GetArea( ii );
+
+        m_zones.push_back( zone );
+        index( zone );
+        indexNet( zone );
+    }
+
+    for( BOARD_ITEM* item = m_board->m_Drawings; item; item = item->Next() )
+    {
+        m_drawings.push_back( item );
+        index( item );
+    }
+
+    // From now on the indices are only searched, never modified
+    m_itemIndex.Pack();
+    m_padIndex.Pack();
+}
+
+
+BOARD_SNAPSHOT::~BOARD_SNAPSHOT()
+{
+}
+
+
+void BOARD_SNAPSHOT::copyNets( BOARD* aBoard,
+                               std::unordered_map<const NETINFO_ITEM*, NETINFO_ITEM*>& aNetMap )
+{
+    std::vector<NETINFO_ITEM*> liveNets;
+
+    for( NETINFO_LIST::iterator net = aBoard->GetNetInfo().begin();
+         net != aBoard->GetNetInfo().end(); ++net )
+    {
+        liveNets.push_back( *net );
+    }
+
+    // NETINFO_LIST::AppendNet() keeps the net codes only if they are appended in order
+    std::sort( liveNets.begin(), liveNets.end(), sortNetsByCode );
+
+    aNetMap[&NETINFO_LIST::ORPHANED_ITEM] = &NETINFO_LIST::ORPHANED_ITEM;
+
+    for( NETINFO_ITEM* liveNet : liveNets )
+    {
+        // the unconnected net exists in every board
+        NETINFO_ITEM* net = m_board->FindNet( liveNet->GetNetname() );
+
+        if( !net )
+        {
+            net = new NETINFO_ITEM( m_board.get(), liveNet->GetNetname(), liveNet->GetNet() );
+            m_board->GetNetInfo().AppendNet( net );
+        }
+
+        aNetMap[liveNet] = net;
+    }
+}
+
+
+void BOARD_SNAPSHOT::index( BOARD_ITEM* aItem )
+{
+    EDA_RECT bbox = aItem->GetBoundingBox();
+    bbox.Normalize();
+
+    const int min[2] = { bbox.GetX(), bbox.GetY() };
+    const int max[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    m_itemIndex.Insert( min, max, aItem );
+}
+
+
+void BOARD_SNAPSHOT::indexNet( BOARD_CONNECTED_ITEM* aItem )
+{
+    m_itemsByNet[aItem->GetNetCode()].push_back( aItem );
+}
+
+
+NETINFO_ITEM* BOARD_SNAPSHOT::FindNet( int aNetCode ) const
+{
+    return m_board->FindNet( aNetCode );
+}
+
+
+MODULE* BOARD_SNAPSHOT::FindModuleByReference( const wxString& aReference ) const
+{
+    auto it = m_modulesByRef.find( aReference );
+
+    return it != m_modulesByRef.end() ? it->second : NULL;
+}
+
+
+const TRACKS& BOARD_SNAPSHOT::TracksInNet( int aNetCode ) const
+{
+    static const TRACKS empty;
+
+    auto it = m_tracksByNet.find( aNetCode );
+
+    return it != m_tracksByNet.end() ? it->second : empty;
+}
+
+
+const std::vector<BOARD_CONNECTED_ITEM*>& BOARD_SNAPSHOT::ItemsInNet( int aNetCode ) const
+{
+    static const std::vector<BOARD_CONNECTED_ITEM*> empty;
+
+    auto it = m_itemsByNet.find( aNetCode );
+
+    return it != m_itemsByNet.end() ? it->second : empty;
+}
+
+
+D_PAD* BOARD_SNAPSHOT::GetPad( const wxPoint& aPosition, LSET aLayerSet ) const
+{
+    if( !aLayerSet.any() )
+        aLayerSet = LSET::AllCuMask();
+
+    D_PAD* found = NULL;
+
+    auto visitor = [&] ( D_PAD* aPad ) -> bool
+    {
+        if( ( aPad->GetLayerSet() & aLayerSet ).any() && aPad->HitTest( aPosition ) )
+        {
+            found = aPad;
+            return false;
+        }
+
+        return true;
+    };
+
+    const int p[2] = { aPosition.x, aPosition.y };
+
+    m_padIndex.Search( p, p, visitor );
+
+    return found;
+}
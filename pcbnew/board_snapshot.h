@@ -0,0 +1,152 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_snapshot.h
+ * @brief Immutable copy of a BOARD, for worker threads.
+ */
+
+#ifndef BOARD_SNAPSHOT_H_
+#define BOARD_SNAPSHOT_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <hashtables.h>
+#include <geometry/packed_rtree.h>
+#include <class_board.h>
+
+
+/**
+ * Class BOARD_SNAPSHOT
+ * is a read-only copy of a BOARD, with a spatial index and hashed lookups built once
+ * at creation. The BOARD methods are not thread safe (they walk the item lists and some
+ * of them cache results in the board), so work spread over several threads (DRC, zone
+ * filling, plotting) should take a snapshot on the UI thread and query it instead: all
+ * the queries below are const and lock-free, and the live BOARD can keep being edited
+ * meanwhile.
+ *
+ * The snapshot owns a private BOARD holding copies of all the items, nets and net classes,
+ * so the items it returns never point back to the live board. Net codes are kept.
+ * Code needing a whole BOARD (plotters, exporters) can use GetBoard(), as long as it does
+ * not modify it.
+ */
+class BOARD_SNAPSHOT
+{
+public:
+    /**
+     * Constructor
+     * copies aBoard. Must be called from the thread that edits aBoard.
+     */
+    BOARD_SNAPSHOT( BOARD* aBoard );
+    ~BOARD_SNAPSHOT();
+
+    /**
+     * Function GetBoard
+     * @return the private copy of the board. It must not be modified.
+     */
+    const BOARD* GetBoard() const { return m_board.get(); }
+
+    const std::vector<MODULE*>& Modules() const { return m_modules; }
+    const TRACKS& Tracks() const { return m_tracks; }
+    const std::vector<D_PAD*>& Pads() const { return m_pads; }
+    const std::vector<ZONE_CONTAINER*>& Zones() const { return m_zones; }
+    const std::vector<BOARD_ITEM*>& Drawings() const { return m_drawings; }
+
+    /**
+     * Function FindNet
+     * @return the net with code aNetCode, or NULL.
+     */
+    NETINFO_ITEM* FindNet( int aNetCode ) const;
+
+    /**
+     * Function FindModuleByReference
+     * @return the module with reference aReference, or NULL. Hashed, unlike
+     * BOARD::FindModuleByReference().
+     */
+    MODULE* FindModuleByReference( const wxString& aReference ) const;
+
+    /**
+     * Function TracksInNet
+     * @return the tracks and vias of the net aNetCode, in board order.
+     */
+    const TRACKS& TracksInNet( int aNetCode ) const;
+
+    /**
+     * Function ItemsInNet
+     * @return the pads, tracks, vias and zones of the net aNetCode.
+     */
+    const std::vector<BOARD_CONNECTED_ITEM*>& ItemsInNet( int aNetCode ) const;
+
+    /**
+     * Function GetPad
+     * finds a pad at \a aPosition on one of the layers of \a aLayerSet, as
+     * BOARD::GetPad() does, using the spatial index.
+     * @return the pad, or NULL if none found.
+     */
+    D_PAD* GetPad( const wxPoint& aPosition, LSET aLayerSet = LSET() ) const;
+
+    /**
+     * Function Query
+     * calls aVisitor( BOARD_ITEM* ) for each module, pad, track, via, zone and drawing
+     * whose bounding box intersects aArea. The visitor returns false to stop the search.
+     * @return the number of items visited.
+     */
+    template <class VISITOR>
+    int Query( const EDA_RECT& aArea, VISITOR& aVisitor ) const
+    {
+        EDA_RECT area = aArea;
+        area.Normalize();
+
+        const int min[2] = { area.GetX(), area.GetY() };
+        const int max[2] = { area.GetRight(), area.GetBottom() };
+
+        return m_itemIndex.Search( min, max, aVisitor );
+    }
+
+private:
+    typedef PACKED_RTREE<BOARD_ITEM*> ITEM_INDEX;
+    typedef PACKED_RTREE<D_PAD*>      PAD_INDEX;
+
+    void copyNets( BOARD* aBoard, std::unordered_map<const NETINFO_ITEM*, NETINFO_ITEM*>& aNetMap );
+    void index( BOARD_ITEM* aItem );
+    void indexNet( BOARD_CONNECTED_ITEM* aItem );
+
+    std::unique_ptr<BOARD> m_board;
+
+    std::vector<MODULE*>         m_modules;
+    TRACKS                       m_tracks;
+    std::vector<D_PAD*>          m_pads;
+    std::vector<ZONE_CONTAINER*> m_zones;
+    std::vector<BOARD_ITEM*>     m_drawings;
+
+    ITEM_INDEX m_itemIndex;
+    PAD_INDEX  m_padIndex;
+
+    std::unordered_map<wxString, MODULE*, WXSTRING_HASH>            m_modulesByRef;
+    std::unordered_map<int, TRACKS>                                 m_tracksByNet;
+    std::unordered_map<int, std::vector<BOARD_CONNECTED_ITEM*> >    m_itemsByNet;
+};
+
+#endif  // BOARD_SNAPSHOT_H_
@@ -78,6 +78,10 @@ BOARD::BOARD() :
     SetColorsSettings( &g_ColorsSettings );
     m_nodeCount     = 0;                    // Number of connected pads.
     m_unconnectedNetCount   = 0;            // Number of unconnected nets.
+    m_revision      = 0;
+
+    for( unsigned ii = 0; ii < DIM( m_maskLayerCache ); ++ii )
+        m_maskLayerCache[ii].m_valid = false;
 
     m_CurrentZoneContour = NULL;            // This ZONE_CONTAINER handle the
                                             // zone contour currently in progress
@@ -866,6 +870,8 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
         return;
     }
 
+    IncrementRevision();
+
     switch( aBoardItem->Type() )
     {
     case PCB_NETINFO_T:
@@ -957,6 +963,8 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
     // find these calls and fix them!  Don't send me no stinking' NULL.
     wxASSERT( aBoardItem );
 
+    IncrementRevision();
+
     switch( aBoardItem->Type() )
     {
     case PCB_NETINFO_T:
@@ -1063,6 +1071,14 @@ unsigned BOARD::GetNodesCount() const
 
 
 EDA_RECT BOARD::ComputeBoundingBox( bool aBoardEdgesOnly )
+{
+    m_BoundingBox = CalculateBoundingBox( aBoardEdgesOnly );   // save for BOARD::GetBoundingBox()
+
+    return m_BoundingBox;
+}
+
+
+EDA_RECT BOARD::CalculateBoundingBox( bool aBoardEdgesOnly ) const
 {
     bool hasItems = false;
     EDA_RECT area;
@@ -1131,8 +1147,6 @@ EDA_RECT BOARD::ComputeBoundingBox( bool aBoardEdgesOnly )
         }
     }
 
-    m_BoundingBox = area;   // save for BOARD::GetBoundingBox()
-
     return area;
 }
 
@@ -42,6 +42,8 @@
 #include <class_title_block.h>
 #include <class_zone_settings.h>
 #include <pcb_plot_params.h>
+#include <geometry/shape_poly_set.h>
+#include <ki_mutex.h>
 
 
 class PCB_BASE_FRAME;
@@ -201,6 +203,24 @@ private:
     /// Number of unconnected nets in the current rats nest.
     int                     m_unconnectedNetCount;
 
+    /// Incremented on each change of the board content, to invalidate the caches
+    unsigned                m_revision;
+
+    /// The merged openings of a solder mask layer, and the settings used to build them
+    struct MASK_LAYER_CACHE
+    {
+        bool            m_valid;
+        unsigned        m_revision;
+        int             m_maskMargin;
+        int             m_minThickness;
+        bool            m_withVias;
+        SHAPE_POLY_SET  m_openings;
+    };
+
+    /// Cache of GetMergedMaskLayer(), for F_Mask and B_Mask, with and without the zones
+    mutable MASK_LAYER_CACHE m_maskLayerCache[4];
+    mutable MUTEX            m_maskLayerCacheLock;
+
     /**
      * Function chainMarkedSegments
      * is used by MarkTrace() to set the BUSY flag of connected segments of the trace
@@ -617,6 +637,34 @@ public:
      */
     void ConvertBrdLayerToPolygonalContours( LAYER_ID aLayer, SHAPE_POLY_SET& aOutlines );
 
+    /**
+     * Function GetMergedMaskLayer
+     * returns the openings of a solder mask layer: the pads (and optionally the vias)
+     * inflated by their solder mask margin, and optionally the zones on this layer, merged.
+     * Openings closer than aMinThickness are joined, because the mask between them
+     * would be too thin to be manufactured.
+     * The result is cached for each layer until the board revision or the mask settings
+     * change, so the plotters, the 3D viewer and the exporters share it.
+     * It can be called from several threads.
+     * @param aLayer = F_Mask or B_Mask
+     * @param aMinThickness = the min width of the solder mask
+     * @param aWithVias = true to add the vias on the external copper layers
+     * @param aWithZones = true to add the zone outlines on this layer
+     * @param aOpenings = the SHAPE_POLY_SET to fill (not fractured)
+     */
+    void GetMergedMaskLayer( LAYER_ID aLayer, int aMinThickness, bool aWithVias,
+                             bool aWithZones, SHAPE_POLY_SET& aOpenings ) const;
+
+    /**
+     * Function IncrementRevision
+     * must be called after a change of the board content, so the data cached from it
+     * (like the merged solder mask layers) is built again.
+     * Add() and Remove() call it, and the board editor calls it on each modification.
+     */
+    void IncrementRevision()            { m_revision++; }
+
+    unsigned GetRevision() const        { return m_revision; }
+
     /**
      * Function GetLayerID
      * returns the ID of a layer given by aLayerName.  Copper layers may
@@ -855,6 +903,16 @@ public:
      */
     EDA_RECT ComputeBoundingBox( bool aBoardEdgesOnly = false );
 
+    /**
+     * Function CalculateBoundingBox
+     * calculates the same bounding box as ComputeBoundingBox(), but does not save it
+     * for GetBoundingBox(): the board is not modified, so several threads can call it
+     * on a shared board (as the plot functions do).
+     * @param aBoardEdgesOnly is true if we are interested in board edge segments only.
+     * @return EDA_RECT - the board's bounding box
+     */
+    EDA_RECT CalculateBoundingBox( bool aBoardEdgesOnly = false ) const;
+
     /**
      * Function GetBoundingBox
      * may be called soon after ComputeBoundingBox() to return the same EDA_RECT,
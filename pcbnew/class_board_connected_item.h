@@ -110,6 +110,16 @@ public:
      */
     bool SetNetCode( int aNetCode, bool aNoAssert=false );
 
+    /**
+     * Function SetNet
+     * sets the NETINFO_ITEM of the item directly, without looking it up in the BOARD.
+     * Used when copying items between boards.
+     */
+    void SetNet( NETINFO_ITEM* aNetInfo )
+    {
+        m_netinfo = aNetInfo;
+    }
+
     /**
      * Function GetSubNet
      * @return int - the sub net code.
@@ -97,6 +97,11 @@ DIALOG_GENDRILL_BASE::DIALOG_GENDRILL_BASE( wxWindow* parent, wxWindowID id, con
 	
 	sbOptSizer->Add( m_Check_Merge_PTH_NPTH, 0, wxALL, 5 );
 	
+	m_Check_Optimize_Path = new wxCheckBox( sbOptSizer->GetStaticBox(), wxID_ANY, _("Optimize drill path"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_Check_Optimize_Path->SetToolTip( _("Reorder the holes drilled by each tool to shorten the drill head travel.") );
+	
+	sbOptSizer->Add( m_Check_Optimize_Path, 0, wxBOTTOM|wxRIGHT|wxLEFT, 5 );
+	
 	
 	bMiddleBoxSizer->Add( sbOptSizer, 0, wxEXPAND|wxRIGHT|wxLEFT, 5 );
 	
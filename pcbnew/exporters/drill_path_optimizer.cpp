@@ -0,0 +1,461 @@
+/**
+ * @file drill_path_optimizer.cpp
+ * @brief Ordering of the holes drilled by one tool, to shorten the drill head travel.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 1992-2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <common.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <stdint.h>
+
+#include <drill_path_optimizer.h>
+
+
+/// Count of nearest nodes tried as new neighbors of a node
+static const int NEIGHBOR_COUNT = 8;
+
+/// Max distance between the positions of the path modified by one move.
+/// It bounds the cost of applying a move on large paths.
+static const int MAX_MOVE_SPAN = 1000;
+
+/// Max count of consecutive holes moved by an Or-opt move
+static const int MAX_SEGMENT_LENGTH = 3;
+
+/// Min gain of a move (in internal units), so rounding errors cannot make moves cycle
+static const double MIN_GAIN = 1.0;
+
+
+/* Returns the position along a Hilbert curve of the point aX, aY of a
+ * 65536 x 65536 grid. Near points of the grid have most of the time near positions.
+ */
+static uint64_t hilbertIndex( unsigned aX, unsigned aY )
+{
+    const unsigned n = 1 << 16;
+    uint64_t index = 0;
+
+    for( unsigned s = n / 2; s > 0; s /= 2 )
+    {
+        unsigned rx = ( aX & s ) ? 1 : 0;
+        unsigned ry = ( aY & s ) ? 1 : 0;
+
+        index += (uint64_t) s * s * ( ( 3 * rx ) ^ ry );
+
+        // Rotate the quadrant
+        if( ry == 0 )
+        {
+            if( rx == 1 )
+            {
+                aX = n - 1 - aX;
+                aY = n - 1 - aY;
+            }
+
+            std::swap( aX, aY );
+        }
+    }
+
+    return index;
+}
+
+
+/* The nearest nodes found so far during a k-d tree search, by increasing distance
+ */
+struct NEAREST_NODES
+{
+    int     m_count;
+    int     m_node[NEIGHBOR_COUNT];
+    double  m_dist2[NEIGHBOR_COUNT];
+
+    NEAREST_NODES() : m_count( 0 ) {}
+
+    void Add( int aNode, double aDist2 )
+    {
+        if( m_count == NEIGHBOR_COUNT && aDist2 >= m_dist2[NEIGHBOR_COUNT - 1] )
+            return;
+
+        int ii = m_count < NEIGHBOR_COUNT ? m_count++ : NEIGHBOR_COUNT - 1;
+
+        for( ; ii > 0 && m_dist2[ii - 1] > aDist2; ii-- )
+        {
+            m_node[ii] = m_node[ii - 1];
+            m_dist2[ii] = m_dist2[ii - 1];
+        }
+
+        m_node[ii] = aNode;
+        m_dist2[ii] = aDist2;
+    }
+
+    double Worst() const
+    {
+        return m_count < NEIGHBOR_COUNT ? DBL_MAX : m_dist2[NEIGHBOR_COUNT - 1];
+    }
+};
+
+
+/* Builds a k-d tree in aTree[aFirst, aLast): the node list is recursively split at its
+ * median, alternately in x and in y
+ */
+static void buildKdTree( std::vector<int>& aTree, const std::vector<wxPoint>& aNodes,
+                         int aFirst, int aLast, bool aSplitX )
+{
+    if( aLast - aFirst < 2 )
+        return;
+
+    int mid = ( aFirst + aLast ) / 2;
+
+    std::nth_element( aTree.begin() + aFirst, aTree.begin() + mid, aTree.begin() + aLast,
+                      [&]( int a, int b )
+                      {
+                          return aSplitX ? aNodes[a].x < aNodes[b].x : aNodes[a].y < aNodes[b].y;
+                      } );
+
+    buildKdTree( aTree, aNodes, aFirst, mid, !aSplitX );
+    buildKdTree( aTree, aNodes, mid + 1, aLast, !aSplitX );
+}
+
+
+static void searchKdTree( const std::vector<int>& aTree, const std::vector<wxPoint>& aNodes,
+                          int aFirst, int aLast, bool aSplitX, int aNode,
+                          NEAREST_NODES& aNearest )
+{
+    if( aFirst >= aLast )
+        return;
+
+    int mid = ( aFirst + aLast ) / 2;
+    const wxPoint& pos = aNodes[aNode];
+    const wxPoint& split = aNodes[aTree[mid]];
+
+    if( aTree[mid] != aNode )
+    {
+        double dx = (double) split.x - pos.x;
+        double dy = (double) split.y - pos.y;
+        aNearest.Add( aTree[mid], dx * dx + dy * dy );
+    }
+
+    double delta = aSplitX ? (double) pos.x - split.x : (double) pos.y - split.y;
+
+    // Search first the side of the split containing aNode, then the other side
+    // only if it can contain nearer nodes
+    if( delta < 0 )
+    {
+        searchKdTree( aTree, aNodes, aFirst, mid, !aSplitX, aNode, aNearest );
+
+        if( delta * delta < aNearest.Worst() )
+            searchKdTree( aTree, aNodes, mid + 1, aLast, !aSplitX, aNode, aNearest );
+    }
+    else
+    {
+        searchKdTree( aTree, aNodes, mid + 1, aLast, !aSplitX, aNode, aNearest );
+
+        if( delta * delta < aNearest.Worst() )
+            searchKdTree( aTree, aNodes, aFirst, mid, !aSplitX, aNode, aNearest );
+    }
+}
+
+
+DRILL_PATH_OPTIMIZER::DRILL_PATH_OPTIMIZER( const wxPoint& aStart,
+                                            const std::vector<wxPoint>& aHoles )
+{
+    m_nodes.reserve( aHoles.size() + 1 );
+    m_nodes.push_back( aStart );
+    m_nodes.insert( m_nodes.end(), aHoles.begin(), aHoles.end() );
+}
+
+
+std::vector<int> DRILL_PATH_OPTIMIZER::Optimize( unsigned aTimeBudget )
+{
+    unsigned startTime = GetRunningMicroSecs();
+    int count = m_nodes.size();
+
+    // The initial order is kept if the optimized path is not shorter
+    m_path.resize( count );
+
+    for( int ii = 0; ii < count; ii++ )
+        m_path[ii] = ii;
+
+    double initialLength = pathLength();
+
+    if( count > 2 )
+    {
+        buildHilbertPath();
+        buildNeighbors();
+
+        m_position.resize( count );
+        updatePositions( 0, count - 1 );
+
+        bool improved = true;
+        bool timeout = false;
+
+        while( improved && !timeout )
+        {
+            improved = false;
+
+            for( int node = 0; node < count && !timeout; node++ )
+            {
+                if( improve2Opt( node ) || improveOrOpt( node ) )
+                    improved = true;
+
+                if( ( node & 0xFF ) == 0 )
+                    timeout = GetRunningMicroSecs() - startTime > aTimeBudget;
+            }
+        }
+
+        if( pathLength() >= initialLength )
+        {
+            for( int ii = 0; ii < count; ii++ )
+                m_path[ii] = ii;
+        }
+    }
+
+    // Skip the start point
+    std::vector<int> order;
+    order.reserve( count - 1 );
+
+    for( int ii = 1; ii < count; ii++ )
+        order.push_back( m_path[ii] - 1 );
+
+    return order;
+}
+
+
+double DRILL_PATH_OPTIMIZER::dist( int aNodeA, int aNodeB ) const
+{
+    double dx = (double) m_nodes[aNodeA].x - m_nodes[aNodeB].x;
+    double dy = (double) m_nodes[aNodeA].y - m_nodes[aNodeB].y;
+
+    return hypot( dx, dy );
+}
+
+
+double DRILL_PATH_OPTIMIZER::pathDist( int aPosA, int aPosB ) const
+{
+    int count = m_path.size();
+
+    if( aPosA >= count || aPosB >= count )
+        return 0.0;
+
+    return dist( m_path[aPosA], m_path[aPosB] );
+}
+
+
+double DRILL_PATH_OPTIMIZER::pathLength() const
+{
+    double length = 0.0;
+
+    for( unsigned ii = 1; ii < m_path.size(); ii++ )
+        length += dist( m_path[ii - 1], m_path[ii] );
+
+    return length;
+}
+
+
+void DRILL_PATH_OPTIMIZER::buildHilbertPath()
+{
+    int count = m_nodes.size();
+    int xmin = INT_MAX, ymin = INT_MAX;
+    int xmax = INT_MIN, ymax = INT_MIN;
+
+    for( int ii = 1; ii < count; ii++ )
+    {
+        xmin = std::min( xmin, m_nodes[ii].x );
+        ymin = std::min( ymin, m_nodes[ii].y );
+        xmax = std::max( xmax, m_nodes[ii].x );
+        ymax = std::max( ymax, m_nodes[ii].y );
+    }
+
+    double size = std::max( (double) xmax - xmin, (double) ymax - ymin );
+    double scale = 65535.0 / std::max( size, 1.0 );
+
+    std::vector< std::pair<uint64_t, int> > keys;
+    keys.reserve( count - 1 );
+
+    for( int ii = 1; ii < count; ii++ )
+    {
+        unsigned x = KiROUND( ( (double) m_nodes[ii].x - xmin ) * scale );
+        unsigned y = KiROUND( ( (double) m_nodes[ii].y - ymin ) * scale );
+
+        keys.push_back( std::make_pair( hilbertIndex( x, y ), ii ) );
+    }
+
+    std::sort( keys.begin(), keys.end() );
+
+    for( int ii = 1; ii < count; ii++ )
+        m_path[ii] = keys[ii - 1].second;
+
+    // Start by the end of the curve nearest to the start point
+    if( dist( 0, m_path.back() ) < dist( 0, m_path[1] ) )
+        std::reverse( m_path.begin() + 1, m_path.end() );
+}
+
+
+void DRILL_PATH_OPTIMIZER::buildNeighbors()
+{
+    int count = m_nodes.size();
+    std::vector<int> tree( count );
+
+    for( int ii = 0; ii < count; ii++ )
+        tree[ii] = ii;
+
+    buildKdTree( tree, m_nodes, 0, count, true );
+
+    m_neighbors.assign( count * NEIGHBOR_COUNT, -1 );
+
+    for( int node = 0; node < count; node++ )
+    {
+        NEAREST_NODES nearest;
+        searchKdTree( tree, m_nodes, 0, count, true, node, nearest );
+
+        for( int ii = 0; ii < nearest.m_count; ii++ )
+            m_neighbors[node * NEIGHBOR_COUNT + ii] = nearest.m_node[ii];
+    }
+}
+
+
+bool DRILL_PATH_OPTIMIZER::improve2Opt( int aNode )
+{
+    int pos = m_position[aNode];
+    const int* neighbors = &m_neighbors[aNode * NEIGHBOR_COUNT];
+
+    for( int ii = 0; ii < NEIGHBOR_COUNT && neighbors[ii] >= 0; ii++ )
+    {
+        int other = m_position[neighbors[ii]];
+        int first = std::min( pos, other );
+        int last = std::max( pos, other );
+
+        // Both reversals make aNode and its neighbor adjacent
+        if( tryReverse( first + 1, last ) || tryReverse( first, last - 1 ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+bool DRILL_PATH_OPTIMIZER::tryReverse( int aFirst, int aLast )
+{
+    // The start point cannot move
+    if( aFirst < 1 || aLast <= aFirst || aLast - aFirst > MAX_MOVE_SPAN )
+        return false;
+
+    double gain = pathDist( aFirst - 1, aFirst ) + pathDist( aLast, aLast + 1 )
+                  - pathDist( aFirst - 1, aLast ) - pathDist( aFirst, aLast + 1 );
+
+    if( gain < MIN_GAIN )
+        return false;
+
+    std::reverse( m_path.begin() + aFirst, m_path.begin() + aLast + 1 );
+    updatePositions( aFirst, aLast );
+
+    return true;
+}
+
+
+bool DRILL_PATH_OPTIMIZER::improveOrOpt( int aNode )
+{
+    int count = m_path.size();
+    int pos = m_position[aNode];
+    const int* neighbors = &m_neighbors[aNode * NEIGHBOR_COUNT];
+
+    for( int length = 1; length <= MAX_SEGMENT_LENGTH; length++ )
+    {
+        // Try the segments starting and ending at aNode
+        for( int side = 0; side < ( length == 1 ? 1 : 2 ); side++ )
+        {
+            int first = side == 0 ? pos : pos - length + 1;
+            int last = first + length - 1;
+
+            if( first < 1 || last >= count )
+                continue;
+
+            double removeGain = pathDist( first - 1, first ) + pathDist( last, last + 1 )
+                                - pathDist( first - 1, last + 1 );
+
+            if( removeGain < MIN_GAIN )
+                continue;
+
+            for( int ii = 0; ii < NEIGHBOR_COUNT && neighbors[ii] >= 0; ii++ )
+            {
+                int other = m_position[neighbors[ii]];
+
+                // Insert the segment between the nodes at gap and gap + 1,
+                // before or after the neighbor
+                for( int gap = other - 1; gap <= other; gap++ )
+                {
+                    if( gap < 0 || ( gap >= first - 1 && gap <= last )
+                            || std::abs( gap - first ) > MAX_MOVE_SPAN )
+                        continue;
+
+                    double oldEdge = pathDist( gap, gap + 1 );
+                    double cost = dist( m_path[gap], m_path[first] )
+                                  + pathDist( last, gap + 1 ) - oldEdge;
+                    double reversedCost = dist( m_path[gap], m_path[last] )
+                                          + pathDist( first, gap + 1 ) - oldEdge;
+                    bool reversed = reversedCost < cost;
+
+                    if( removeGain - std::min( cost, reversedCost ) < MIN_GAIN )
+                        continue;
+
+                    if( gap > last )
+                    {
+                        std::rotate( m_path.begin() + first, m_path.begin() + last + 1,
+                                     m_path.begin() + gap + 1 );
+
+                        if( reversed )
+                            std::reverse( m_path.begin() + gap - length + 1,
+                                          m_path.begin() + gap + 1 );
+
+                        updatePositions( first, gap );
+                    }
+                    else
+                    {
+                        std::rotate( m_path.begin() + gap + 1, m_path.begin() + first,
+                                     m_path.begin() + last + 1 );
+
+                        if( reversed )
+                            std::reverse( m_path.begin() + gap + 1,
+                                          m_path.begin() + gap + 1 + length );
+
+                        updatePositions( gap + 1, last );
+                    }
+
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void DRILL_PATH_OPTIMIZER::updatePositions( int aFirst, int aLast )
+{
+    for( int ii = aFirst; ii <= aLast; ii++ )
+        m_position[m_path[ii]] = ii;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file drill_path_optimizer.h
+ * @brief Ordering of the holes drilled by one tool, to shorten the drill head travel.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 1992-2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRILL_PATH_OPTIMIZER_H
+#define DRILL_PATH_OPTIMIZER_H
+
+#include <vector>
+#include <wx/gdicmn.h>
+
+
+/**
+ * Class DRILL_PATH_OPTIMIZER
+ * finds a short open path visiting a set of holes, starting from a given position
+ * (usually the last hole drilled with the previous tool).
+ * The path is seeded by the order of the holes along a Hilbert curve, then refined
+ * by 2-opt and Or-opt moves between near neighbors, until no move shortens it or
+ * the time budget is spent.
+ */
+class DRILL_PATH_OPTIMIZER
+{
+public:
+    /**
+     * @param aStart = the position of the drill head before drilling the first hole
+     * @param aHoles = the positions of the holes to drill
+     */
+    DRILL_PATH_OPTIMIZER( const wxPoint& aStart, const std::vector<wxPoint>& aHoles );
+
+    /**
+     * Function Optimize
+     * @param aTimeBudget = the max time spent to refine the path, in microseconds
+     * @return the order to drill the holes, as indexes in the hole list given to
+     * the constructor. It is never longer than the initial order.
+     */
+    std::vector<int> Optimize( unsigned aTimeBudget );
+
+private:
+    std::vector<wxPoint>    m_nodes;        // node 0 is the start point, then the holes
+    std::vector<int>        m_neighbors;    // NEIGHBOR_COUNT nearest nodes for each node
+    std::vector<int>        m_path;         // node at each position of the path
+    std::vector<int>        m_position;     // position of each node in the path
+
+    double dist( int aNodeA, int aNodeB ) const;
+
+    // Distance between the nodes at the positions aPosA and aPosB of the path,
+    // 0 if one of the positions is after the end of the path
+    double pathDist( int aPosA, int aPosB ) const;
+
+    double pathLength() const;
+
+    void buildHilbertPath();
+    void buildNeighbors();
+
+    // Tries the 2-opt and Or-opt moves creating an edge from aNode to one of its
+    // neighbors, and applies the first one shortening the path
+    bool improve2Opt( int aNode );
+    bool improveOrOpt( int aNode );
+
+    // Reverses the path between the positions aFirst and aLast if it is shorter
+    bool tryReverse( int aFirst, int aLast );
+
+    void updatePositions( int aFirst, int aLast );
+};
+
+#endif  // DRILL_PATH_OPTIMIZER_H
@@ -43,6 +43,7 @@
 #include <class_module.h>
 
 #include <pcbnew.h>
+#include <pcbplot.h>
 #include <wildcards_and_files_ext.h>
 #include <kiface_i.h>
 #include <wx_html_report_panel.h>
@@ -72,11 +73,6 @@
 #define PLACEFILE_OPT_KEY    wxT( "PlaceFileOpts" )
 #define PLACEFILE_FORMAT_KEY wxT( "PlaceFileFormat" )
 
-
-#define PCB_BACK_SIDE 0
-#define PCB_FRONT_SIDE 1
-#define PCB_BOTH_SIDES 2
-
 class LIST_MOD      // An helper class used to build a list of useful footprints.
 {
 public:
@@ -417,6 +413,41 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
                                                  bool aUnitsMM,
                                                  bool aForceSmdItems, int aSide,
                                                  bool aFormatCSV )
+{
+    // Fix a bunch of mis-labeled footprints: mark the footprints having only SMD pins
+    // for pick and place. WriteFootprintsPositionFile() lists them anyway, but does not
+    // modify the board.
+    if( aForceSmdItems )
+    {
+        for( MODULE* footprint = GetBoard()->m_Modules; footprint; footprint = footprint->Next() )
+        {
+            if( aSide != PCB_BOTH_SIDES )
+            {
+                if( footprint->GetLayer() == B_Cu && aSide == PCB_FRONT_SIDE)
+                    continue;
+                if( footprint->GetLayer() == F_Cu && aSide == PCB_BACK_SIDE)
+                    continue;
+            }
+
+            if( footprint->GetAttributes() & ( MOD_VIRTUAL | MOD_CMS ) )
+                continue;
+
+            if( !HasNonSMDPins( footprint ) )
+            {
+                footprint->SetAttributes( footprint->GetAttributes() | MOD_CMS );
+                OnModify();
+            }
+        }
+    }
+
+    return WriteFootprintsPositionFile( GetBoard(), aFullFileName, aUnitsMM,
+                                        aForceSmdItems, aSide, aFormatCSV );
+}
+
+
+int WriteFootprintsPositionFile( const BOARD* aBoard, const wxString& aFullFileName,
+                                 bool aUnitsMM, bool aForceSmdItems, int aSide,
+                                 bool aFormatCSV )
 {
     MODULE*     footprint;
 
@@ -425,7 +456,8 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
     int lenValText = 8;
     int lenPkgText = 16;
 
-    File_Place_Offset = GetAuxOrigin();
+    // Offset coordinates for generated file
+    const wxPoint placeOffset = aBoard->GetAuxOrigin();
 
     // Calculating the number of useful footprints (CMS attribute, not VIRTUAL)
     int footprintCount = 0;
@@ -438,7 +470,7 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
     std::vector<LIST_MOD> list;
     list.reserve( footprintCount );
 
-    for( footprint = GetBoard()->m_Modules; footprint; footprint = footprint->Next() )
+    for( footprint = aBoard->m_Modules; footprint; footprint = footprint->Next() )
     {
         if( aSide != PCB_BOTH_SIDES )
         {
@@ -457,15 +489,10 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
 
         if( ( footprint->GetAttributes() & MOD_CMS ) == 0 )
         {
-            if( aForceSmdItems )    // true to fix a bunch of mis-labeled footprints:
+            if( aForceSmdItems )    // true to list also the mis-labeled footprints:
             {
-                if( !HasNonSMDPins( footprint ) )
-                {
-                    // all footprint's pins are SMD, mark the part for pick and place
-                    footprint->SetAttributes( footprint->GetAttributes() | MOD_CMS );
-                    OnModify();
-                }
-                else
+                // list the footprint if all its pins are SMD
+                if( HasNonSMDPins( footprint ) )
                 {
                     DBG(printf( "skipping %s because its attribute is not CMS and it has non SMD pins\n",
                                 TO_UTF8(footprint->GetReference()) ) );
@@ -515,7 +542,7 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
         {
             wxPoint  footprint_pos;
             footprint_pos  = list[ii].m_Module->GetPosition();
-            footprint_pos -= File_Place_Offset;
+            footprint_pos -= placeOffset;
 
             LAYER_NUM layer = list[ii].m_Module->GetLayer();
             wxASSERT( layer == F_Cu || layer == B_Cu );
@@ -572,7 +599,7 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
         {
             wxPoint  footprint_pos;
             footprint_pos  = list[ii].m_Module->GetPosition();
-            footprint_pos -= File_Place_Offset;
+            footprint_pos -= placeOffset;
 
             LAYER_NUM layer = list[ii].m_Module->GetLayer();
             wxASSERT( layer == F_Cu || layer == B_Cu );
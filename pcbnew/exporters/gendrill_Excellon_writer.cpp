@@ -53,6 +53,7 @@
 #include <pcbplot.h>
 #include <pcbnew.h>
 #include <gendrill_Excellon_writer.h>
+#include <drill_path_optimizer.h>
 #include <wildcards_and_files_ext.h>
 #include <reporter.h>
 #include <collectors.h>
@@ -62,6 +63,9 @@
 // tools used for PTH and tools used for NPTH
 // #define WRITE_PTH_NPTH_COMMENT
 
+// Max time spent to optimize the drill path of one drill file, in microseconds
+static const unsigned DRILL_PATH_TIME_BUDGET = 2000000;
+
 
 EXCELLON_WRITER::EXCELLON_WRITER( BOARD* aPcb )
 {
@@ -72,6 +76,9 @@ EXCELLON_WRITER::EXCELLON_WRITER( BOARD* aPcb )
     m_unitsDecimal    = true;
     m_mirror = false;
     m_merge_PTH_NPTH = false;
+    m_optimizeDrillPath = false;
+    m_drillPathLength = 0.0;
+    m_optimizedPathLength = 0.0;
     m_minimalHeader = false;
     m_ShortHeader = false;
     m_mapFileFmt = PLOT_FORMAT_PDF;
@@ -134,6 +141,16 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                 }
 
                 CreateDrillFile( file );
+
+                if( m_optimizeDrillPath && aReporter )
+                {
+                    const wxChar* units = m_unitsDecimal ? wxT( "mm" ) : wxT( "in" );
+
+                    msg.Printf( _( "Drill path length %.1f %s (%.1f %s before optimization)\n" ),
+                                m_optimizedPathLength * m_conversionUnits, units,
+                                m_drillPathLength * m_conversionUnits, units );
+                    aReporter->Report( msg );
+                }
             }
 
             if( aGenMap )
@@ -190,6 +207,9 @@ int EXCELLON_WRITER::CreateDrillFile( FILE* aFile )
 
     LOCALE_IO dummy;    // Use the standard notation for double numbers
 
+    if( m_optimizeDrillPath )
+        optimizeDrillPath();
+
     WriteEXCELLONHeader();
 
     holes_count = 0;
@@ -348,6 +368,90 @@ int EXCELLON_WRITER::CreateDrillFile( FILE* aFile )
 }
 
 
+/* Helper function for sorting hole list in the order the holes are drilled
+ * by CreateDrillFile: round holes first, then oblong holes, tool by tool
+ */
+static bool CmpHoleDrillingOrder( const HOLE_INFO& a, const HOLE_INFO& b )
+{
+    if( ( a.m_Hole_Shape != 0 ) != ( b.m_Hole_Shape != 0 ) )
+        return b.m_Hole_Shape != 0;
+
+    return a.m_Tool_Reference < b.m_Tool_Reference;
+}
+
+
+void EXCELLON_WRITER::optimizeDrillPath()
+{
+    std::stable_sort( m_holeListBuffer.begin(), m_holeListBuffer.end(), CmpHoleDrillingOrder );
+
+    m_drillPathLength = drillPathLength();
+
+    // Each group of holes drilled by the same tool starts from the last hole of the
+    // previous group, and the first one from the drill origin
+    wxPoint  position = m_offset;
+    unsigned first = 0;
+
+    for( unsigned ii = 1; ii <= m_holeListBuffer.size(); ii++ )
+    {
+        if( ii < m_holeListBuffer.size() )
+        {
+            const HOLE_INFO& hole = m_holeListBuffer[ii];
+            const HOLE_INFO& firstHole = m_holeListBuffer[first];
+
+            if( hole.m_Tool_Reference == firstHole.m_Tool_Reference
+                    && ( hole.m_Hole_Shape != 0 ) == ( firstHole.m_Hole_Shape != 0 ) )
+                continue;
+        }
+
+        std::vector<HOLE_INFO> group( m_holeListBuffer.begin() + first,
+                                      m_holeListBuffer.begin() + ii );
+        std::vector<wxPoint>   holes;
+
+        for( unsigned jj = 0; jj < group.size(); jj++ )
+            holes.push_back( group[jj].m_Hole_Pos );
+
+        // Share the time budget between tools, by hole count
+        unsigned budget = (unsigned) ( (double) DRILL_PATH_TIME_BUDGET * group.size()
+                                       / m_holeListBuffer.size() );
+
+        DRILL_PATH_OPTIMIZER optimizer( position, holes );
+        std::vector<int> order = optimizer.Optimize( budget );
+
+        for( unsigned jj = 0; jj < order.size(); jj++ )
+            m_holeListBuffer[first + jj] = group[order[jj]];
+
+        position = m_holeListBuffer[ii - 1].m_Hole_Pos;
+        first = ii;
+    }
+
+    m_optimizedPathLength = drillPathLength();
+}
+
+
+double EXCELLON_WRITER::drillPathLength() const
+{
+    double  length = 0.0;
+    wxPoint position = m_offset;
+
+    // Round holes are drilled first, then oblong holes
+    for( int oblong = 0; oblong < 2; oblong++ )
+    {
+        for( unsigned ii = 0; ii < m_holeListBuffer.size(); ii++ )
+        {
+            const HOLE_INFO& hole = m_holeListBuffer[ii];
+
+            if( ( hole.m_Hole_Shape != 0 ) != ( oblong != 0 ) )
+                continue;
+
+            length += GetLineLength( position, hole.m_Hole_Pos );
+            position = hole.m_Hole_Pos;
+        }
+    }
+
+    return length;
+}
+
+
 void EXCELLON_WRITER::SetFormat( bool      aMetric,
                                  ZEROS_FMT aZerosFmt,
                                  int       aLeftDigits,
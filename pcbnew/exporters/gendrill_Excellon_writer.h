@@ -148,6 +148,10 @@ private:
     bool                     m_mirror;
     wxPoint                  m_offset;                  // Drill offset coordinates
     bool                     m_merge_PTH_NPTH;          // True to generate only one drill file
+    bool                     m_optimizeDrillPath;       // True to reorder the holes of each tool
+                                                        // to shorten the drill head travel
+    double                   m_drillPathLength;         // Drill head travel of the last drill file,
+    double                   m_optimizedPathLength;     // before and after optimization
     std::vector<HOLE_INFO>   m_holeListBuffer;          // Buffer containing holes
     std::vector<DRILL_TOOL>  m_toolListBuffer;          // Buffer containing tools
 
@@ -215,6 +219,13 @@ public:
         m_merge_PTH_NPTH = aMerge_PTH_NPTH;
     }
 
+    /**
+     * Function SetOptimizeDrillPath
+     * @param aOptimize = true to reorder the holes drilled by each tool, to shorten the
+     * travel of the drill head. Otherwise holes are drilled by increasing X then Y position.
+     */
+    void SetOptimizeDrillPath( bool aOptimize ) { m_optimizeDrillPath = aOptimize; }
+
     /**
      * Function BuildHolesList
      * Create the list of holes and tools for a given board
@@ -337,6 +348,17 @@ private:
      */
     void WriteCoordinates( char* aLine, double aCoordX, double aCoordY );
 
+    /**
+     * Function optimizeDrillPath
+     * reorders the holes of m_holeListBuffer drilled by each tool, to shorten the travel
+     * of the drill head, and stores this travel before and after optimization.
+     * The time spent is bounded, so it stays usable for boards with many holes.
+     */
+    void optimizeDrillPath();
+
+    /// @return the travel of the drill head to drill the holes of m_holeListBuffer
+    double drillPathLength() const;
+
     /** Helper function.
      * Writes the drill marks in HPGL, POSTSCRIPT or other supported formats
      * Each hole size has a symbol (circle, cross X, cross + ...) up to
@@ -0,0 +1,330 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fab_job.cpp
+ */
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#include <fctsys.h>
+#include <common.h>
+#include <plot_common.h>
+#include <reporter.h>
+#include <wildcards_and_files_ext.h>
+
+#include <class_board.h>
+#include <class_pad.h>
+#include <board_snapshot.h>
+#include <pcbplot.h>
+#include <gendrill_Excellon_writer.h>
+#include <fab_job.h>
+
+
+FAB_JOB::FAB_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOpts ) :
+    m_board( aBoard ),
+    m_plotOpts( aPlotOpts ),
+    m_drillMetric( true ),
+    m_drillMerge_PTH_NPTH( false ),
+    m_drillUseAuxOrigin( false ),
+    m_drillGenMap( false ),
+    m_drillMapFormat( PLOT_FORMAT_PDF ),
+    m_posUnitsMM( true ),
+    m_posForceSmdItems( false ),
+    m_posFormatCSV( false ),
+    m_totalTime( 0 )
+{
+}
+
+
+void FAB_JOB::AddLayer( LAYER_ID aLayer )
+{
+    TASK task = { TASK_LAYER, aLayer, PCB_BOTH_SIDES };
+
+    m_tasks.push_back( task );
+}
+
+
+void FAB_JOB::AddLayers( LSET aLayers )
+{
+    for( LSEQ seq = ( aLayers & m_board->GetEnabledLayers() ).UIOrder();  seq;  ++seq )
+        AddLayer( *seq );
+}
+
+
+void FAB_JOB::AddDrillFiles( bool aMetric, bool aMerge_PTH_NPTH, bool aUseAuxOrigin,
+                             bool aGenMap, PlotFormat aMapFormat )
+{
+    m_drillMetric = aMetric;
+    m_drillMerge_PTH_NPTH = aMerge_PTH_NPTH;
+    m_drillUseAuxOrigin = aUseAuxOrigin;
+    m_drillGenMap = aGenMap;
+    m_drillMapFormat = aMapFormat;
+
+    TASK task = { TASK_DRILL, UNDEFINED_LAYER, PCB_BOTH_SIDES };
+
+    m_tasks.push_back( task );
+}
+
+
+void FAB_JOB::AddPositionFiles( bool aUnitsMM, bool aSingleFile, bool aForceSmdItems,
+                                bool aFormatCSV )
+{
+    m_posUnitsMM = aUnitsMM;
+    m_posForceSmdItems = aForceSmdItems;
+    m_posFormatCSV = aFormatCSV;
+
+    if( aSingleFile )
+    {
+        TASK task = { TASK_POSITION, UNDEFINED_LAYER, PCB_BOTH_SIDES };
+        m_tasks.push_back( task );
+    }
+    else
+    {
+        TASK front = { TASK_POSITION, UNDEFINED_LAYER, PCB_FRONT_SIDE };
+        TASK back = { TASK_POSITION, UNDEFINED_LAYER, PCB_BACK_SIDE };
+        m_tasks.push_back( front );
+        m_tasks.push_back( back );
+    }
+}
+
+
+wxString FAB_JOB::outputName( const BOARD* aBoard, const TASK& aTask,
+                              const wxString& aOutputDir ) const
+{
+    wxFileName fn( aBoard->GetFileName() );
+
+    switch( aTask.m_Type )
+    {
+    case TASK_LAYER:
+    {
+        wxString fileExt = GetDefaultPlotExtension( m_plotOpts.GetFormat() );
+
+        if( m_plotOpts.GetFormat() == PLOT_FORMAT_GERBER &&
+            m_plotOpts.GetUseGerberProtelExtensions() )
+            fileExt = GetGerberProtelExtension( aTask.m_Layer );
+
+        BuildPlotFileName( &fn, aOutputDir, aBoard->GetLayerName( aTask.m_Layer ), fileExt );
+        return fn.GetFullPath();
+    }
+
+    case TASK_DRILL:
+        // the drill writer names its files itself
+        return _( "Drill files" );
+
+    case TASK_POSITION:
+    {
+        // the names used by the footprint position file dialog
+        const wxChar* side = aTask.m_Side == PCB_FRONT_SIDE ? wxT( "top" ) :
+                             aTask.m_Side == PCB_BACK_SIDE ? wxT( "bottom" ) : wxT( "all" );
+
+        fn.SetPath( aOutputDir );
+        fn.SetName( fn.GetName() + wxT( "-" ) + side );
+
+        if( m_posFormatCSV )
+        {
+            fn.SetName( fn.GetName() + wxT( "-" ) + FootprintPlaceFileExtension );
+            fn.SetExt( wxT( "csv" ) );
+        }
+        else
+            fn.SetExt( FootprintPlaceFileExtension );
+
+        return fn.GetFullPath();
+    }
+    }
+
+    return wxEmptyString;
+}
+
+
+bool FAB_JOB::runTask( BOARD* aBoard, const TASK& aTask, const wxString& aOutputName,
+                       const wxString& aOutputDir, wxString& aMessages ) const
+{
+    switch( aTask.m_Type )
+    {
+    case TASK_LAYER:
+    {
+        // StartPlotBoard() may change the options: each task has its own copy
+        PCB_PLOT_PARAMS plotOpts = m_plotOpts;
+        PLOTTER* plotter = StartPlotBoard( aBoard, &plotOpts, aTask.m_Layer,
+                                           aOutputName, wxEmptyString );
+
+        if( !plotter )
+        {
+            aMessages.Printf( _( "Unable to create file '%s'." ), GetChars( aOutputName ) );
+            return false;
+        }
+
+        PlotOneBoardLayer( aBoard, plotter, aTask.m_Layer, plotOpts );
+        plotter->EndPlot();
+        delete plotter;
+
+        aMessages.Printf( _( "Plot file '%s' created." ), GetChars( aOutputName ) );
+        return true;
+    }
+
+    case TASK_DRILL:
+    {
+        EXCELLON_WRITER writer( aBoard );
+        wxPoint offset = m_drillUseAuxOrigin ? aBoard->GetAuxOrigin() : wxPoint( 0, 0 );
+
+        writer.SetFormat( m_drillMetric );
+        writer.SetOptions( false, false, offset, m_drillMerge_PTH_NPTH );
+        writer.SetMapFileFormat( m_drillMapFormat );
+
+        WX_STRING_REPORTER reporter( &aMessages );
+        writer.CreateDrillandMapFilesSet( aOutputDir, true, m_drillGenMap, &reporter );
+
+        // the writer reports its failures as "** Unable to create <file> **"
+        return aMessages.Find( wxT( "**" ) ) == wxNOT_FOUND;
+    }
+
+    case TASK_POSITION:
+    {
+        int count = WriteFootprintsPositionFile( aBoard, aOutputName, m_posUnitsMM,
+                                                 m_posForceSmdItems, aTask.m_Side,
+                                                 m_posFormatCSV );
+
+        if( count < 0 )
+        {
+            aMessages.Printf( _( "Unable to create file '%s'." ), GetChars( aOutputName ) );
+            return false;
+        }
+
+        aMessages.Printf( _( "Place file '%s' created, component count: %d." ),
+                          GetChars( aOutputName ), count );
+        return true;
+    }
+    }
+
+    return false;
+}
+
+
+bool FAB_JOB::Run( REPORTER* aReporter )
+{
+    unsigned start = GetRunningMicroSecs();
+
+    m_timings.clear();
+    m_totalTime = 0;
+
+    // Switch the locale to standard C once for the whole job: the LOCALE_IO of the
+    // plotters and writers in the worker threads then leave the locale untouched.
+    LOCALE_IO toggle;
+
+    // Create output directory if it does not exist (also transform it in
+    // absolute path). Bail if it fails
+    wxFileName outputDir = wxFileName::DirName( m_plotOpts.GetOutputDirectory() );
+
+    if( !EnsureFileDirectoryExists( &outputDir, m_board->GetFileName(), aReporter ) )
+    {
+        if( aReporter )
+        {
+            wxString msg;
+            msg.Printf( _( "Could not write plot files to folder \"%s\"." ),
+                        GetChars( outputDir.GetPath() ) );
+            aReporter->Report( msg, REPORTER::RPT_ERROR );
+        }
+
+        return false;
+    }
+
+    // The plot functions take a BOARD*, but do not modify it
+    BOARD_SNAPSHOT snapshot( m_board );
+    BOARD* board = const_cast<BOARD*>( snapshot.GetBoard() );
+
+    // The pads compute their bounding radius on first use: do it now, rather than
+    // in all the workers at the same time
+    for( D_PAD* pad : snapshot.Pads() )
+        pad->GetBoundingRadius();
+
+    int count = m_tasks.size();
+    std::vector<wxString> messages( count );
+
+    m_timings.resize( count );
+
+    for( int i = 0; i < count; i++ )
+        m_timings[i].m_Name = outputName( board, m_tasks[i], outputDir.GetPath() );
+
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule( dynamic, 1 ) private( i )
+#endif /* USE_OPENMP */
+    for( i = 0; i < count; i++ )
+    {
+        unsigned taskStart = GetRunningMicroSecs();
+
+        m_timings[i].m_Success = runTask( board, m_tasks[i], m_timings[i].m_Name,
+                                          outputDir.GetPath(), messages[i] );
+        m_timings[i].m_Time = GetRunningMicroSecs() - taskStart;
+    }
+
+    m_totalTime = GetRunningMicroSecs() - start;
+
+    bool success = true;
+
+    for( int ii = 0; ii < count; ii++ )
+    {
+        success &= m_timings[ii].m_Success;
+
+        if( aReporter )
+            aReporter->Report( messages[ii], m_timings[ii].m_Success ?
+                               REPORTER::RPT_ACTION : REPORTER::RPT_ERROR );
+    }
+
+    if( aReporter )
+        aReporter->Report( GetReport(), REPORTER::RPT_INFO );
+
+    return success;
+}
+
+
+wxString FAB_JOB::GetReport() const
+{
+    wxString report;
+    unsigned sum = 0;
+
+    for( unsigned ii = 0; ii < m_timings.size(); ii++ )
+    {
+        const OUTPUT_TIMING& timing = m_timings[ii];
+        wxString status = timing.m_Success ? wxString() : _( " (failed)" );
+
+        report << wxString::Format( wxT( "%8.1f ms  %s%s\n" ), timing.m_Time / 1000.0,
+                                    GetChars( timing.m_Name ), GetChars( status ) );
+        sum += timing.m_Time;
+    }
+
+#ifdef USE_OPENMP
+    int threads = omp_get_max_threads();
+#else
+    int threads = 1;
+#endif /* USE_OPENMP */
+
+    report << wxString::Format( _( "%8.1f ms  total (%.1f ms for the outputs, %d threads)\n" ),
+                                m_totalTime / 1000.0, sum / 1000.0, threads );
+
+    return report;
+}
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fab_job.h
+ * @brief Headless generation of the fabrication outputs of a board.
+ */
+
+#ifndef FAB_JOB_H_
+#define FAB_JOB_H_
+
+#include <vector>
+#include <wx/string.h>
+
+#include <plot_common.h>
+#include <pcb_plot_params.h>
+#include <layers_id_colors_and_visibility.h>
+
+class BOARD;
+class REPORTER;
+
+
+/**
+ * Class FAB_JOB
+ * writes the fabrication outputs of a board (the plot files of a set of layers, the
+ * drill and drill map files and the footprint position files) in one run, without
+ * any dialog. Especially useful in scripts.
+ *
+ * The outputs are independent: each one is written by its own task, on its own
+ * PLOTTER (or writer), and the tasks run in parallel worker threads. They all read a
+ * BOARD_SNAPSHOT taken when the job starts, so the board is never modified by the
+ * job and can be edited again as soon as Run() returns.
+ * The time spent on each output is measured, see GetTimings() and GetReport().
+ */
+class FAB_JOB
+{
+public:
+    /// The time spent on one output
+    struct OUTPUT_TIMING
+    {
+        wxString m_Name;        ///< the file name, or the description of the file set
+        unsigned m_Time;        ///< in microseconds
+        bool     m_Success;
+    };
+
+    /**
+     * Constructor
+     * @param aBoard = the board to plot
+     * @param aPlotOpts = the plot options (format, output directory...) of the layers
+     */
+    FAB_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOpts );
+
+    /**
+     * Function AddLayer
+     * adds the plot file of aLayer to the outputs. It is named from the board file
+     * name and the layer name, as in the plot dialog.
+     */
+    void AddLayer( LAYER_ID aLayer );
+
+    /**
+     * Function AddLayers
+     * adds the plot files of the enabled layers of aLayers to the outputs.
+     */
+    void AddLayers( LSET aLayers );
+
+    /**
+     * Function AddDrillFiles
+     * adds the Excellon drill files (decimal format) and optionally their drill maps
+     * to the outputs.
+     * @param aMetric = true for mm, false for inches
+     * @param aMerge_PTH_NPTH = true to write one drill file for the plated and not
+     *                          plated holes
+     * @param aUseAuxOrigin = true to use the auxiliary axis as drill origin
+     * @param aGenMap = true to write also the drill maps
+     * @param aMapFormat = the format of the drill maps
+     */
+    void AddDrillFiles( bool aMetric, bool aMerge_PTH_NPTH, bool aUseAuxOrigin,
+                        bool aGenMap, PlotFormat aMapFormat = PLOT_FORMAT_PDF );
+
+    /**
+     * Function AddPositionFiles
+     * adds the footprint position files to the outputs (see WriteFootprintsPositionFile()).
+     * @param aUnitsMM = true to use mm, false to use inches
+     * @param aSingleFile = true for one file for both sides, false for one file per side
+     * @param aForceSmdItems = true to list also the footprints having only smd pads
+     * @param aFormatCSV = true to use the CSV format
+     */
+    void AddPositionFiles( bool aUnitsMM, bool aSingleFile, bool aForceSmdItems,
+                           bool aFormatCSV );
+
+    /**
+     * Function Run
+     * writes all the outputs, in parallel. Must be called from the thread which edits
+     * the board. The messages of the outputs are sent to aReporter (from the calling
+     * thread) once all of them are written.
+     * @return true if all the outputs were written
+     */
+    bool Run( REPORTER* aReporter = NULL );
+
+    /**
+     * Function GetTimings
+     * @return the time spent on each output by the last Run(), in the order
+     * the outputs were added
+     */
+    const std::vector<OUTPUT_TIMING>& GetTimings() const { return m_timings; }
+
+    /**
+     * Function GetReport
+     * @return the timing report of the last Run(), one line per output
+     */
+    wxString GetReport() const;
+
+private:
+    enum TASK_TYPE
+    {
+        TASK_LAYER,
+        TASK_DRILL,
+        TASK_POSITION
+    };
+
+    struct TASK
+    {
+        TASK_TYPE m_Type;
+        LAYER_ID  m_Layer;      ///< for TASK_LAYER
+        int       m_Side;       ///< for TASK_POSITION
+    };
+
+    /// @return the full file name of the output of aTask (or its description)
+    wxString outputName( const BOARD* aBoard, const TASK& aTask,
+                         const wxString& aOutputDir ) const;
+
+    /// writes the output of aTask; called from the worker threads
+    bool runTask( BOARD* aBoard, const TASK& aTask, const wxString& aOutputName,
+                  const wxString& aOutputDir, wxString& aMessages ) const;
+
+    BOARD*                      m_board;
+    PCB_PLOT_PARAMS             m_plotOpts;
+    std::vector<TASK>           m_tasks;
+
+    bool                        m_drillMetric;
+    bool                        m_drillMerge_PTH_NPTH;
+    bool                        m_drillUseAuxOrigin;
+    bool                        m_drillGenMap;
+    PlotFormat                  m_drillMapFormat;
+
+    bool                        m_posUnitsMM;
+    bool                        m_posForceSmdItems;
+    bool                        m_posFormatCSV;
+
+    std::vector<OUTPUT_TIMING>  m_timings;
+    unsigned                    m_totalTime;    ///< wall clock time of the last Run()
+};
+
+#endif // FAB_JOB_H_
@@ -104,6 +104,9 @@ EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
     m_worksheet = NULL;
     m_ratsnest = NULL;
 
+    m_painter = new KIGFX::PCB_PAINTER( m_gal );
+    m_view->SetPainter( m_painter );
+
     setDefaultLayerOrder();
     setDefaultLayerDeps();
 
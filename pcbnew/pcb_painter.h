@@ -94,6 +94,12 @@ public:
     /// @copydoc RENDER_SETTINGS::GetColor()
     virtual const COLOR4D& GetColor( const VIEW_ITEM* aItem, int aLayer ) const;
 
+    /// @copydoc RENDER_SETTINGS::GetGridColor()
+    const COLOR4D& GetGridColor() const override
+    {
+        return m_layerColors[ITEM_GAL_LAYER( GRID_VISIBLE )];
+    }
+
     /**
      * Function GetLayerColor
      * Returns the color used to draw a layer.
@@ -30,6 +30,7 @@
  */
 
 #include <fctsys.h>
+#include <algorithm>
 #include <kiface_i.h>
 #include <pgm_base.h>
 #include <class_drawpanel.h>
@@ -62,6 +63,7 @@
 #include <class_track.h>
 #include <class_board.h>
 #include <class_module.h>
+#include <class_pad.h>
 #include <worksheet_viewitem.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
@@ -326,6 +328,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_hotkeysDescrList = g_Board_Editor_Hokeys_Descr;
     m_hasAutoSave = true;
     m_microWaveToolBar = NULL;
+    m_lastUndoCommand3D = NULL;
 
     m_rotationAngle = 900;
 
@@ -950,6 +953,117 @@ void PCB_EDIT_FRAME::SetLastNetListRead( const wxString& aLastNetListRead )
 }
 
 
+/**
+ * Function itemLayersFor3D
+ * adds to aLayers the layers shown in the 3D view that aItem is drawn on, and sets aHoles
+ * if aItem has holes.
+ * @return false for the items the 3D view cannot update per layer (board outlines are
+ * handled by the 3D view itself).
+ */
+static bool itemLayersFor3D( const BOARD_ITEM* aItem, LSET& aLayers, bool& aHoles )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            itemLayersFor3D( pad, aLayers, aHoles );
+
+        for( const BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+            aLayers.set( item->GetLayer() );
+
+        aLayers.set( module->Reference().GetLayer() );
+        aLayers.set( module->Value().GetLayer() );
+        return true;
+    }
+
+    case PCB_PAD_T:
+        aLayers |= aItem->GetLayerSet();
+
+        if( static_cast<const D_PAD*>( aItem )->GetDrillSize().x )
+            aHoles = true;
+
+        return true;
+
+    case PCB_VIA_T:
+        aLayers |= aItem->GetLayerSet();
+        aHoles = true;
+        return true;
+
+    case PCB_MODULE_TEXT_T:
+    case PCB_MODULE_EDGE_T:
+    case PCB_TRACE_T:
+    case PCB_ZONE_T:
+    case PCB_ZONE_AREA_T:
+    case PCB_LINE_T:
+    case PCB_TEXT_T:
+    case PCB_DIMENSION_T:
+    case PCB_TARGET_T:
+        aLayers |= aItem->GetLayerSet();
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+bool PCB_EDIT_FRAME::get3DViewChanges( LSET& aLayers, bool& aHoles )
+{
+    const std::vector<PICKED_ITEMS_LIST*>& undoList = GetScreen()->m_UndoList.m_CommandsList;
+    const std::vector<PICKED_ITEMS_LIST*>& redoList = GetScreen()->m_RedoList.m_CommandsList;
+    std::vector<PICKED_ITEMS_LIST*> commands;
+
+    std::vector<PICKED_ITEMS_LIST*>::const_iterator last =
+            std::find( undoList.begin(), undoList.end(), m_lastUndoCommand3D );
+
+    if( last != undoList.end() )
+    {
+        // the commands issued (or redone) since the last change
+        commands.assign( last + 1, undoList.end() );
+    }
+    else if( !redoList.empty() && redoList.back() == m_lastUndoCommand3D )
+    {
+        // the last command was undone
+        commands.push_back( redoList.back() );
+    }
+    else if( m_lastUndoCommand3D == NULL )
+    {
+        commands = undoList;
+    }
+
+    // No undo command: this change is not known
+    if( commands.empty() )
+        return false;
+
+    for( PICKED_ITEMS_LIST* command : commands )
+    {
+        for( unsigned ii = 0; ii < command->GetCount(); ii++ )
+        {
+            LSET layers;
+            BOARD_ITEM* item = static_cast<BOARD_ITEM*>( command->GetPickedItem( ii ) );
+            BOARD_ITEM* link = static_cast<BOARD_ITEM*>( command->GetPickedItemLink( ii ) );
+
+            if( !item || !itemLayersFor3D( item, layers, aHoles ) )
+                return false;
+
+            if( link && !itemLayersFor3D( link, layers, aHoles ) )
+                return false;
+
+            // the item is on the opposite layers before (or after) a flip
+            if( command->GetPickedItemStatus( ii ) == UR_FLIPPED )
+                layers |= FlipLayerMask( layers );
+
+            aLayers |= layers;
+        }
+    }
+
+    return true;
+}
+
+
 void PCB_EDIT_FRAME::OnModify( )
 {
     PCB_BASE_FRAME::OnModify();
@@ -957,7 +1071,19 @@ void PCB_EDIT_FRAME::OnModify( )
     EDA_3D_VIEWER* draw3DFrame = Get3DViewerFrame();
 
     if( draw3DFrame )
-        draw3DFrame->ReloadRequest();
+    {
+        LSET layers;
+        bool holes = false;
+
+        if( get3DViewChanges( layers, holes ) )
+            draw3DFrame->UpdateRequest( layers, holes );
+        else
+            draw3DFrame->ReloadRequest();
+    }
+
+    const std::vector<PICKED_ITEMS_LIST*>& undoList = GetScreen()->m_UndoList.m_CommandsList;
+
+    m_lastUndoCommand3D = undoList.empty() ? NULL : undoList.back();
 }
 
 
@@ -282,4 +282,28 @@ extern wxString GetGerberFileFunctionAttribute( const BOARD *aBoard,
  */
 extern void AddGerberX2Attribute( PLOTTER * aPlotter, const BOARD *aBoard, LAYER_NUM aLayer );
 
+/// Sides of the footprint position files
+#define PCB_BACK_SIDE 0
+#define PCB_FRONT_SIDE 1
+#define PCB_BOTH_SIDES 2
+
+/**
+ * Function WriteFootprintsPositionFile
+ * creates an ascii footprint position file (pick and place file).
+ * The board is not modified, so the file can be written from a worker thread
+ * on a shared (or snapshot) board.
+ * @param aBoard = the board
+ * @param aFullFileName = the full file name of the file to create; if empty,
+ *                        only the count of footprints to place is returned
+ * @param aUnitsMM = false to use inches, true to use mm in coordinates
+ * @param aForceSmdItems = true to list also the footprints having only smd pads
+ *                       = false to list only footprints with option "INSERT"
+ * @param aSide = PCB_BACK_SIDE, PCB_FRONT_SIDE or PCB_BOTH_SIDES
+ * @param aFormatCSV = true to use a comma separated file (CSV) format; default = false
+ * @return the number of footprints found on aSide, or -1 if the file could not be created
+ */
+int WriteFootprintsPositionFile( const BOARD* aBoard, const wxString& aFullFileName,
+                                 bool aUnitsMM, bool aForceSmdItems, int aSide,
+                                 bool aFormatCSV = false );
+
 #endif // PCBPLOT_H_
@@ -628,13 +628,10 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter,
  * Solder mask layers have a minimum thickness value and cannot be drawn like standard layers,
  * unless the minimum thickness is 0.
  * Currently the algo is:
- * 1 - build all pad shapes as polygons with a size inflated by
- *      mask clearance + (min width solder mask /2)
- * 2 - Merge shapes
- * 3 - deflate result by (min width solder mask /2)
- * 4 - ORing result by all pad shapes as polygons with a size inflated by
- *      mask clearance only (because deflate sometimes creates shape artifacts)
- * 5 - draw result as polygons
+ * 1 - get the merged openings of the layer (see BOARD::GetMergedMaskLayer()):
+ *      pad shapes inflated by their mask clearance, with the openings closer
+ *      than the min width solder mask merged
+ * 2 - draw result as polygons
  *
  * TODO:
  * make this calculation only for shapes with clearance near than (min width solder mask)
@@ -647,7 +644,6 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
                           int aMinThickness )
 {
     LAYER_ID    layer = aLayerMask[B_Mask] ? B_Mask : F_Mask;
-    int         inflate = aMinThickness/2;
 
     BRDITEMS_PLOTTER itemplotter( aPlotter, aBoard, aPlotOpt );
     itemplotter.SetLayerSet( aLayerMask );
@@ -676,92 +672,12 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
         }
     }
 
-    // Build polygons for each pad shape.
-    // the size of the shape on solder mask should be:
-    // size of pad + clearance around the pad.
-    // clearance = solder mask clearance + extra margin
-    // extra margin is half the min width for solder mask
-    // This extra margin is used to merge too close shapes
-    // (distance < aMinThickness), and will be removed when creating
-    // the actual shapes
-    SHAPE_POLY_SET areas;           // Contains shapes to plot
-    SHAPE_POLY_SET initialPolys;    // Contains exact shapes to plot
-
-    /* calculates the coeff to compensate radius reduction of holes clearance
-     * due to the segment approx ( 1 /cos( PI/circleToSegmentsCount )
-     */
-    int circleToSegmentsCount = 32;
-    double correction = 1.0 / cos( M_PI / circleToSegmentsCount );
-
-    // Plot pads
-    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
-    {
-        // add shapes with exact size
-        module->TransformPadsShapesWithClearanceToPolygon( layer,
-                        initialPolys, 0,
-                        circleToSegmentsCount, correction );
-        // add shapes inflated by aMinThickness/2
-        module->TransformPadsShapesWithClearanceToPolygon( layer,
-                        areas, inflate,
-                        circleToSegmentsCount, correction );
-    }
+    // The merged pad, via and zone openings are shared with the other users
+    // of this mask layer (the other plots, the 3D viewer...)
+    SHAPE_POLY_SET areas;
 
-    // Plot vias on solder masks, if aPlotOpt.GetPlotViaOnMaskLayer() is true,
-    if( aPlotOpt.GetPlotViaOnMaskLayer() )
-    {
-        // The current layer is a solder mask,
-        // use the global mask clearance for vias
-        int via_clearance = aBoard->GetDesignSettings().m_SolderMaskMargin;
-        int via_margin = via_clearance + inflate;
-
-        for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
-        {
-            const VIA* via = dyn_cast<const VIA*>( track );
-
-            if( !via )
-                continue;
-
-            // vias are plotted only if they are on the corresponding
-            // external copper layer
-            LSET via_set = via->GetLayerSet();
-
-            if( via_set[B_Cu] )
-                via_set.set( B_Mask );
-
-            if( via_set[F_Cu] )
-                via_set.set( F_Mask );
-
-            if( !( via_set & aLayerMask ).any() )
-                continue;
-
-            via->TransformShapeWithClearanceToPolygon( areas, via_margin,
-                    circleToSegmentsCount,
-                    correction );
-            via->TransformShapeWithClearanceToPolygon( initialPolys, via_clearance,
-                    circleToSegmentsCount,
-                    correction );
-        }
-    }
-
-    // Add filled zone areas.
-#if 0   // Set to 1 if a solder mask margin must be applied to zones on solder mask
-    int zone_margin = aBoard->GetDesignSettings().m_SolderMaskMargin;
-#else
-    int zone_margin = 0;
-#endif
-
-    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
-    {
-        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
-
-        if( zone->GetLayer() != layer )
-            continue;
-
-        zone->TransformOutlinesShapeWithClearanceToPolygon( areas,
-                    inflate+zone_margin, false );
-        zone->TransformOutlinesShapeWithClearanceToPolygon( initialPolys,
-                    zone_margin, false );
-    }
+    aBoard->GetMergedMaskLayer( layer, aMinThickness, aPlotOpt.GetPlotViaOnMaskLayer(),
+                                true, areas );
 
     // To avoid a lot of code, use a ZONE_CONTAINER
     // to handle and plot polygons, because our polygons look exactly like
@@ -774,12 +690,6 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
     zone.SetMinThickness( 0 );      // trace polygons only
     zone.SetLayer ( layer );
 
-    areas.BooleanAdd( initialPolys, SHAPE_POLY_SET::PM_FAST );
-    areas.Inflate( -inflate, circleToSegmentsCount );
-
-    // Combine the current areas to initial areas. This is mandatory because
-    // inflate/deflate transform is not perfect, and we want the initial areas perfectly kept
-    areas.BooleanAdd( initialPolys, SHAPE_POLY_SET::PM_FAST );
     areas.Fracture( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
 
     zone.AddFilledPolysList( areas );
@@ -829,7 +739,7 @@ static void initializePlotter( PLOTTER *aPlotter, BOARD * aBoard,
         autocenter  = (aPlotOpts->GetScale() != 1.0);
     }
 
-    EDA_RECT bbox = aBoard->ComputeBoundingBox();
+    EDA_RECT bbox = aBoard->CalculateBoundingBox();
     wxPoint boardCenter = bbox.Centre();
     wxSize boardSize = bbox.GetSize();
 
@@ -1011,7 +921,7 @@ PLOTTER* StartPlotBoard( BOARD *aBoard, PCB_PLOT_PARAMS *aPlotOpts,
          * in the driver (if supported) */
         if( aPlotOpts->GetNegative() )
         {
-            EDA_RECT bbox = aBoard->ComputeBoundingBox();
+            EDA_RECT bbox = aBoard->CalculateBoundingBox();
             FillNegativeKnockout( plotter, bbox );
         }
 
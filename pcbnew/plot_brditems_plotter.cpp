@@ -501,8 +501,33 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone )
     if( polysList.IsEmpty() )
         return;
 
-    // We need a buffer to store corners coordinates:
-    static std::vector< wxPoint > cornerList;
+    // Gerber files: plot the actual copper of the zone as regions. The filled areas
+    // are shrunk by half the outline thickness, so inflate them back rather than
+    // plotting thick outlines (or filling segments) around them.
+    if( m_plotter->GetPlotterType() == PLOT_FORMAT_GERBER && GetPlotMode() == FILLED )
+    {
+        m_plotter->SetColor( getColor( aZone->GetLayer() ) );
+
+        if( aZone->GetMinThickness() > 0 )
+        {
+            SHAPE_POLY_SET areas = polysList;
+
+            areas.Inflate( aZone->GetMinThickness() / 2, ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF );
+            areas.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+            static_cast<GERBER_PLOTTER*>( m_plotter )->PlotRegions( areas );
+        }
+        else
+        {
+            static_cast<GERBER_PLOTTER*>( m_plotter )->PlotRegions( polysList );
+        }
+
+        return;
+    }
+
+    // We need a buffer to store corners coordinates
+    // (one per thread: several layers can be plotted at the same time):
+    static thread_local std::vector< wxPoint > cornerList;
     cornerList.clear();
 
     m_plotter->SetColor( getColor( aZone->GetLayer() ) );
@@ -0,0 +1,614 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#include <class_undoredo_container.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <ratsnest_data.h>
+#include <wxPcbStruct.h>
+#include <profile.h>
+
+#include "pns_kicad_iface.h"
+#include "pns_autorouter.h"
+#include "pns_router.h"
+#include "pns_placement_algo.h"
+#include "pns_sizes_settings.h"
+#include "pns_node.h"
+#include "pns_line.h"
+#include "pns_itemset.h"
+
+namespace PNS {
+
+/**
+ * Private copy of the world used to evaluate connections in a worker thread.
+ * Workers never commit anything: they only search for a path, which is then
+ * checked and committed to the board by the master router.
+ */
+struct AUTOROUTER::WORKER
+{
+    WORKER( BOARD* aBoard, const ROUTING_SETTINGS& aSettings ) :
+        m_router( false )
+    {
+        m_iface.SetBoard( aBoard );
+        m_router.SetInterface( &m_iface );
+        m_router.LoadSettings( aSettings );
+
+        // Shoving would modify items outside of the evaluated region, which could not be
+        // merged back into the master world safely.
+        m_router.Settings().SetMode( RM_Walkaround );
+    }
+
+    PNS_KICAD_IFACE m_iface;
+    ROUTER          m_router;
+};
+
+
+AUTOROUTER::AUTOROUTER( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_iface( new PNS_KICAD_IFACE ),
+    m_router( new ROUTER( false ) ),
+    m_order( ORDER_SHORTEST_FIRST ),
+    m_ripupPasses( 3 ),
+    m_clearance( 0 ),
+    m_stats()
+{
+#ifdef USE_OPENMP
+    m_threadCount = omp_get_max_threads();
+#else
+    m_threadCount = 1;
+#endif
+
+    m_iface->SetBoard( m_board );
+    m_router->SetInterface( m_iface.get() );
+
+    if( m_settings.Mode() == RM_MarkObstacles )
+        m_settings.SetMode( RM_Walkaround );
+}
+
+
+AUTOROUTER::~AUTOROUTER()
+{
+    m_workers.clear();
+    m_router.reset();
+}
+
+
+int AUTOROUTER::CollectConnections()
+{
+    prof_counter cnt;
+    prof_start( &cnt );
+
+    RN_DATA* ratsnest = m_board->GetRatsnest();
+
+    ratsnest->ProcessBoard();
+    ratsnest->Recalculate();
+
+    m_connections.clear();
+
+    LSET copper = LSET::AllCuMask( m_board->GetCopperLayerCount() );
+
+    // Start with net number 1, as 0 stands for not connected
+    for( int net = 1; net < ratsnest->GetNetCount(); ++net )
+    {
+        if( !m_nets.empty() && m_nets.find( net ) == m_nets.end() )
+            continue;
+
+        const std::vector<RN_EDGE_MST_PTR>* edges = ratsnest->GetNet( net ).GetUnconnected();
+
+        if( !edges )
+            continue;
+
+        for( const RN_EDGE_MST_PTR& edge : *edges )
+        {
+            const RN_NODE_PTR& source = edge->GetSourceNode();
+            const RN_NODE_PTR& target = edge->GetTargetNode();
+
+            CONNECTION conn;
+
+            conn.m_net = net;
+            conn.m_source = VECTOR2I( source->GetX(), source->GetY() );
+            conn.m_target = VECTOR2I( target->GetX(), target->GetY() );
+            conn.m_layers = source->GetLayers() & target->GetLayers() & copper;
+            conn.m_bbox = BOX2I( conn.m_source, conn.m_target - conn.m_source );
+            conn.m_netSize = edges->size();
+            conn.m_priority = 0;
+            conn.m_ripups = 0;
+            conn.m_routed = false;
+
+            m_connections.push_back( conn );
+        }
+    }
+
+    prof_end( &cnt );
+
+    m_stats.m_collectTime = cnt.msecs();
+    m_stats.m_connections = m_connections.size();
+
+    return m_connections.size();
+}
+
+
+bool AUTOROUTER::Run()
+{
+    prof_counter totalCnt, routeCnt;
+    prof_start( &totalCnt );
+
+    m_stats = STATS();
+
+    CollectConnections();
+
+    // Mark the existing tracks, to know which ones are added by this run.
+    // The tracks the router adds are created with no flags.
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+        track->SetFlags( FLAG0 );
+
+    m_clearance = 4 * m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    m_router->LoadSettings( m_settings );
+    m_router->SyncWorld();
+
+    std::vector<CONNECTION*> pending;
+
+    for( CONNECTION& conn : m_connections )
+    {
+        // Layer changes are not handled (yet), such links are left to the user
+        if( conn.m_layers.any() )
+            pending.push_back( &conn );
+        else
+            m_stats.m_skipped++;
+    }
+
+    prof_start( &routeCnt );
+
+    for( int pass = 0; !pending.empty(); pass++ )
+    {
+        std::vector<CONNECTION*> failed;
+
+        m_stats.m_passes++;
+        sortPending( pending );
+
+        while( !pending.empty() )
+        {
+            std::vector<CONNECTION*> batch;
+
+            makeBatch( pending, batch );
+            routeBatch( batch, failed );
+        }
+
+        if( failed.empty() || pass >= m_ripupPasses )
+            break;
+
+        int ripped = 0;
+
+        for( CONNECTION* conn : failed )
+        {
+            conn->m_priority++;
+            ripped += ripUp( *conn );
+        }
+
+        if( !ripped )
+            break;
+
+        // Give another chance to everything that is not routed now
+        for( CONNECTION& conn : m_connections )
+        {
+            if( !conn.m_routed && conn.m_layers.any() )
+                pending.push_back( &conn );
+        }
+    }
+
+    prof_end( &routeCnt );
+
+    m_board->GetRatsnest()->Recalculate();
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+        track->ClearFlags( FLAG0 );
+
+    for( const CONNECTION& conn : m_connections )
+    {
+        if( conn.m_routed )
+            m_stats.m_routed++;
+        else if( conn.m_layers.any() )
+            m_stats.m_failed++;
+    }
+
+    prof_end( &totalCnt );
+
+    m_stats.m_routeTime = routeCnt.msecs();
+    m_stats.m_totalTime = totalCnt.msecs();
+
+    return m_stats.m_routed == m_stats.m_connections;
+}
+
+
+const wxString AUTOROUTER::FormatReport() const
+{
+    wxString report;
+
+    report << wxString::Format( wxT( "Routed %d of %d connections (%d failed, %d skipped)\n" ),
+                                m_stats.m_routed, m_stats.m_connections,
+                                m_stats.m_failed, m_stats.m_skipped );
+    report << wxString::Format( wxT( "Passes: %d, rip-ups: %d, parallel batches: %d (%d conflicts)\n" ),
+                                m_stats.m_passes, m_stats.m_ripups,
+                                m_stats.m_parallelBatches, m_stats.m_parallelConflicts );
+    report << wxString::Format( wxT( "Collect: %.1f ms\n" ), m_stats.m_collectTime );
+    report << wxString::Format( wxT( "Route: %.1f ms (parallel evaluation: %.1f ms, commit: %.1f ms)\n" ),
+                                m_stats.m_routeTime, m_stats.m_parallelTime,
+                                m_stats.m_commitTime );
+    report << wxString::Format( wxT( "Total: %.1f ms\n" ), m_stats.m_totalTime );
+
+    return report;
+}
+
+
+void AUTOROUTER::sortPending( std::vector<CONNECTION*>& aPending ) const
+{
+    ORDER order = m_order;
+
+    std::stable_sort( aPending.begin(), aPending.end(),
+        [order]( const CONNECTION* aA, const CONNECTION* aB ) -> bool
+        {
+            // connections that failed before go first, so they can claim their space
+            if( aA->m_priority != aB->m_priority )
+                return aA->m_priority > aB->m_priority;
+
+            switch( order )
+            {
+            case ORDER_LONGEST_FIRST:
+                return aA->Length() > aB->Length();
+
+            case ORDER_SMALLEST_NET_FIRST:
+                if( aA->m_netSize != aB->m_netSize )
+                    return aA->m_netSize < aB->m_netSize;
+
+                return aA->Length() < aB->Length();
+
+            case ORDER_SHORTEST_FIRST:
+            default:
+                return aA->Length() < aB->Length();
+            }
+        } );
+}
+
+
+void AUTOROUTER::makeBatch( std::vector<CONNECTION*>& aPending,
+                            std::vector<CONNECTION*>& aBatch ) const
+{
+    if( m_threadCount < 2 )
+    {
+        aBatch.swap( aPending );
+        aPending.clear();
+        return;
+    }
+
+    // Pick (in order) connections whose surroundings do not overlap, so they can be
+    // evaluated independently. The rest is left for the next batches.
+    const unsigned maxSize = m_threadCount * 4;
+    std::vector<BOX2I> regions;
+    std::set<int> nets;
+    std::vector<CONNECTION*> rest;
+
+    for( CONNECTION* conn : aPending )
+    {
+        BOX2I region( conn->m_bbox );
+        region.Inflate( m_clearance, m_clearance );
+
+        bool fits = aBatch.size() < maxSize && nets.find( conn->m_net ) == nets.end();
+
+        for( unsigned i = 0; fits && i < regions.size(); i++ )
+        {
+            if( regions[i].Intersects( region ) )
+                fits = false;
+        }
+
+        if( fits )
+        {
+            aBatch.push_back( conn );
+            regions.push_back( region );
+            nets.insert( conn->m_net );
+        }
+        else
+        {
+            rest.push_back( conn );
+        }
+    }
+
+    aPending.swap( rest );
+}
+
+
+ITEM* AUTOROUTER::findAnchor( NODE* aWorld, const VECTOR2I& aP, int aNet, int aLayer ) const
+{
+    const ITEM_SET candidates = aWorld->HitTest( aP );
+    ITEM* rv = NULL;
+
+    for( ITEM* item : candidates.CItems() )
+    {
+        if( item->Net() != aNet || !item->Layers().Overlaps( aLayer ) )
+            continue;
+
+        // pads and vias are preferred over tracks ending at the same point
+        if( item->OfKind( ITEM::SOLID_T | ITEM::VIA_T ) )
+            return item;
+
+        if( !rv && item->OfKind( ITEM::SEGMENT_T ) )
+            rv = item;
+    }
+
+    return rv;
+}
+
+
+bool AUTOROUTER::startRoute( ROUTER* aRouter, const CONNECTION& aConn, int aLayer, bool aFlip,
+                             ITEM*& aEndItem )
+{
+    NODE* world = aRouter->GetWorld();
+    ITEM* startItem = findAnchor( world, aConn.m_source, aConn.m_net, aLayer );
+
+    aEndItem = findAnchor( world, aConn.m_target, aConn.m_net, aLayer );
+
+    if( !startItem || !aEndItem )
+        return false;
+
+    SIZES_SETTINGS sizes( aRouter->Sizes() );
+    sizes.Init( m_board, startItem, aConn.m_net );
+    aRouter->UpdateSizes( sizes );
+
+    if( !aRouter->StartRouting( aConn.m_source, startItem, aLayer ) )
+        return false;
+
+    if( aFlip )
+        aRouter->FlipPosture();
+
+    aRouter->Move( aConn.m_target, aEndItem );
+
+    if( aRouter->Placer()->CurrentEnd() == aConn.m_target )
+        return true;
+
+    aRouter->StopRouting();
+    return false;
+}
+
+
+bool AUTOROUTER::routeSerial( CONNECTION& aConn )
+{
+    for( LSEQ layers = aConn.m_layers.CuStack(); layers; ++layers )
+    {
+        for( int attempt = 0; attempt < 2; attempt++ )
+        {
+            ITEM* endItem = NULL;
+
+            if( !startRoute( m_router.get(), aConn, *layers, attempt > 0, endItem ) )
+                continue;
+
+            const ITEM_SET traces = m_router->Placer()->Traces();
+            BOX2I bbox = traces.CItems().front().item->Shape()->BBox();
+
+            if( m_router->FixRoute( aConn.m_target, endItem ) )
+            {
+                aConn.m_routed = true;
+                aConn.m_routeBBox = bbox;
+                return true;
+            }
+
+            m_router->StopRouting();
+        }
+    }
+
+    return false;
+}
+
+
+void AUTOROUTER::evaluate( ROUTER* aRouter, const CONNECTION& aConn, EVALUATION& aResult )
+{
+    aResult.m_found = false;
+
+    for( LSEQ layers = aConn.m_layers.CuStack(); layers; ++layers )
+    {
+        for( int attempt = 0; attempt < 2; attempt++ )
+        {
+            ITEM* endItem = NULL;
+
+            if( !startRoute( aRouter, aConn, *layers, attempt > 0, endItem ) )
+                continue;
+
+            const ITEM_SET traces = aRouter->Placer()->Traces();
+            const LINE* trace = static_cast<const LINE*>( traces.CItems().front().item );
+
+            aResult.m_found = true;
+            aResult.m_path = trace->CLine();
+            aResult.m_width = trace->Width();
+            aResult.m_layer = *layers;
+
+            aRouter->StopRouting();
+            return;
+        }
+    }
+}
+
+
+bool AUTOROUTER::commitEvaluation( CONNECTION& aConn, const EVALUATION& aResult )
+{
+    NODE* world = m_router->GetWorld();
+    LINE line;
+
+    line.SetShape( aResult.m_path );
+    line.SetWidth( aResult.m_width );
+    line.SetNet( aConn.m_net );
+    line.SetLayer( aResult.m_layer );
+
+    // The world may have changed since the worker was synchronized
+    if( world->CheckColliding( &line ) )
+    {
+        m_stats.m_parallelConflicts++;
+        return false;
+    }
+
+    NODE* branch = world->Branch();
+    branch->Add( line );
+    m_router->CommitRouting( branch );
+
+    aConn.m_routed = true;
+    aConn.m_routeBBox = aResult.m_path.BBox();
+
+    return true;
+}
+
+
+void AUTOROUTER::routeBatch( std::vector<CONNECTION*>& aBatch, std::vector<CONNECTION*>& aFailed )
+{
+    if( m_threadCount < 2 || aBatch.size() < 2 )
+    {
+        for( CONNECTION* conn : aBatch )
+        {
+            if( !routeSerial( *conn ) )
+                aFailed.push_back( conn );
+        }
+
+        return;
+    }
+
+    int workerCount = std::min<int>( m_threadCount, aBatch.size() );
+
+    while( (int) m_workers.size() < workerCount )
+        m_workers.push_back( std::unique_ptr<WORKER>( new WORKER( m_board, m_settings ) ) );
+
+    // Synchronization reads the board, which is not safe to do concurrently
+    for( int i = 0; i < workerCount; i++ )
+        m_workers[i]->m_router.SyncWorld();
+
+    std::vector<EVALUATION> results( aBatch.size() );
+    prof_counter evalCnt, commitCnt;
+
+    prof_start( &evalCnt );
+
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for num_threads( workerCount ) schedule( dynamic, 1 ) private( i )
+#endif /* USE_OPENMP */
+    for( i = 0; i < (int) aBatch.size(); i++ )
+    {
+#ifdef USE_OPENMP
+        WORKER* worker = m_workers[omp_get_thread_num()].get();
+#else
+        WORKER* worker = m_workers[0].get();
+#endif /* USE_OPENMP */
+
+        evaluate( &worker->m_router, *aBatch[i], results[i] );
+    }
+
+    prof_end( &evalCnt );
+    prof_start( &commitCnt );
+
+    for( unsigned j = 0; j < aBatch.size(); j++ )
+    {
+        CONNECTION* conn = aBatch[j];
+
+        if( results[j].m_found && commitEvaluation( *conn, results[j] ) )
+            continue;
+
+        // Walkaround already failed on a less crowded world, no point trying it again
+        if( !results[j].m_found && m_settings.Mode() == RM_Walkaround )
+        {
+            aFailed.push_back( conn );
+            continue;
+        }
+
+        if( !routeSerial( *conn ) )
+            aFailed.push_back( conn );
+    }
+
+    prof_end( &commitCnt );
+
+    m_stats.m_parallelBatches++;
+    m_stats.m_parallelTime += evalCnt.msecs();
+    m_stats.m_commitTime += commitCnt.msecs();
+}
+
+
+int AUTOROUTER::ripUp( CONNECTION& aFailed )
+{
+    BOX2I region( aFailed.m_bbox );
+    region.Inflate( m_clearance, m_clearance );
+
+    std::set<int> nets;
+
+    for( const CONNECTION& conn : m_connections )
+    {
+        if( !conn.m_routed || conn.m_net == aFailed.m_net || conn.m_ripups >= m_ripupPasses )
+            continue;
+
+        if( conn.m_routeBBox.Intersects( region ) )
+            nets.insert( conn.m_net );
+    }
+
+    for( int net : nets )
+        ripUpNet( net );
+
+    return nets.size();
+}
+
+
+void AUTOROUTER::ripUpNet( int aNet )
+{
+    NODE* world = m_router->GetWorld();
+    std::set<ITEM*> items;
+
+    world->AllItemsInNet( aNet, items );
+
+    NODE* branch = world->Branch();
+    int removed = 0;
+
+    for( ITEM* item : items )
+    {
+        if( !item->OfKind( ITEM::SEGMENT_T | ITEM::VIA_T ) || item->IsLocked() )
+            continue;
+
+        // Only tracks added by this run are ripped up, never the user's ones
+        if( !item->Parent() || ( item->Parent()->GetFlags() & FLAG0 ) )
+            continue;
+
+        branch->Remove( item );
+        removed++;
+    }
+
+    if( removed )
+        m_router->CommitRouting( branch );
+    else
+        world->KillChildren();
+
+    for( CONNECTION& conn : m_connections )
+    {
+        if( conn.m_net == aNet && conn.m_routed )
+        {
+            conn.m_routed = false;
+            conn.m_ripups++;
+            m_stats.m_ripups++;
+        }
+    }
+}
+
+}
@@ -0,0 +1,208 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_AUTOROUTER_H
+#define __PNS_AUTOROUTER_H
+
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <wx/string.h>
+
+#include <math/vector2d.h>
+#include <math/box2.h>
+#include <geometry/shape_line_chain.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include "pns_routing_settings.h"
+
+class BOARD;
+class BOARD_CONNECTED_ITEM;
+class PNS_KICAD_IFACE;
+
+namespace PNS {
+
+class ROUTER;
+class ITEM;
+class NODE;
+class LINE;
+
+/**
+ * Class AUTOROUTER
+ *
+ * Batch (non-interactive) router. Takes the unrouted connections of the board ratsnest
+ * and routes them one by one with the push-and-shove ROUTER, without any view attached.
+ * Connections that cannot be completed trigger rip-up of the nearby nets routed in the
+ * same run, which are then re-routed in the next pass. Connections lying in disjoint
+ * regions of the board are evaluated concurrently on private copies of the world and
+ * committed to the board serially.
+ */
+class AUTOROUTER
+{
+public:
+    ///> Order in which the connections are routed
+    enum ORDER
+    {
+        ORDER_SHORTEST_FIRST = 0,   ///> shortest connections first (default)
+        ORDER_LONGEST_FIRST,        ///> longest connections first
+        ORDER_SMALLEST_NET_FIRST    ///> connections of nets with fewest unrouted links first
+    };
+
+    ///> A single unrouted link of the ratsnest
+    struct CONNECTION
+    {
+        int      m_net;
+        VECTOR2I m_source;
+        VECTOR2I m_target;
+        LSET     m_layers;      ///> copper layers shared by both ends
+        BOX2I    m_bbox;        ///> bounding box of the two ends
+        BOX2I    m_routeBBox;   ///> bounding box of the route, valid if m_routed
+        int      m_netSize;     ///> number of unrouted links in the net
+        int      m_priority;    ///> raised each time the connection caused a rip-up
+        int      m_ripups;      ///> number of times the connection was ripped up
+        bool     m_routed;
+
+        ///> Manhattan length of the connection
+        int64_t Length() const
+        {
+            return (int64_t) std::abs( m_target.x - m_source.x )
+                   + (int64_t) std::abs( m_target.y - m_source.y );
+        }
+    };
+
+    ///> Counters and timings (in milliseconds) of the last run
+    struct STATS
+    {
+        int    m_connections;
+        int    m_routed;
+        int    m_failed;
+        int    m_skipped;
+        int    m_ripups;
+        int    m_passes;
+        int    m_parallelBatches;
+        int    m_parallelConflicts;
+        double m_collectTime;
+        double m_routeTime;
+        double m_parallelTime;
+        double m_commitTime;
+        double m_totalTime;
+    };
+
+    AUTOROUTER( BOARD* aBoard );
+    ~AUTOROUTER();
+
+    /**
+     * Function Settings()
+     *
+     * Returns the routing settings used by the batch router. The interactive defaults
+     * are used, except that the router never marks obstacles.
+     */
+    ROUTING_SETTINGS& Settings() { return m_settings; }
+
+    ///> Sets the order in which the connections are routed.
+    void SetOrder( ORDER aOrder ) { m_order = aOrder; }
+
+    ///> Sets the maximum number of rip-up and re-route passes.
+    void SetRipupPasses( int aPasses ) { m_ripupPasses = aPasses; }
+
+    ///> Sets the number of worker threads evaluating disjoint connections (1 = serial).
+    void SetThreadCount( int aCount ) { m_threadCount = std::max( 1, aCount ); }
+
+    /**
+     * Function AddNet()
+     *
+     * Restricts the routing to the given net. If no net has been added, all the nets
+     * with unrouted connections are routed.
+     */
+    void AddNet( int aNetCode ) { m_nets.insert( aNetCode ); }
+
+    /**
+     * Function CollectConnections()
+     *
+     * Rebuilds the board ratsnest and collects the unrouted connections.
+     * @return the number of connections to be routed.
+     */
+    int CollectConnections();
+
+    /**
+     * Function Run()
+     *
+     * Collects the unrouted connections, routes them and adds the resulting tracks
+     * to the board.
+     * @return true if all the connections were routed.
+     */
+    bool Run();
+
+    const std::vector<CONNECTION>& Connections() const { return m_connections; }
+
+    const STATS& Stats() const { return m_stats; }
+
+    ///> Returns a human-readable summary of the last run, with timings.
+    const wxString FormatReport() const;
+
+private:
+    struct WORKER;
+
+    ///> Result of a connection evaluated by a worker
+    struct EVALUATION
+    {
+        bool             m_found;
+        SHAPE_LINE_CHAIN m_path;
+        int              m_width;
+        int              m_layer;
+    };
+
+    void sortPending( std::vector<CONNECTION*>& aPending ) const;
+    void makeBatch( std::vector<CONNECTION*>& aPending, std::vector<CONNECTION*>& aBatch ) const;
+
+    ITEM* findAnchor( NODE* aWorld, const VECTOR2I& aP, int aNet, int aLayer ) const;
+    bool startRoute( ROUTER* aRouter, const CONNECTION& aConn, int aLayer, bool aFlip,
+                     ITEM*& aEndItem );
+
+    bool routeSerial( CONNECTION& aConn );
+    void evaluate( ROUTER* aRouter, const CONNECTION& aConn, EVALUATION& aResult );
+    bool commitEvaluation( CONNECTION& aConn, const EVALUATION& aResult );
+    void routeBatch( std::vector<CONNECTION*>& aBatch, std::vector<CONNECTION*>& aFailed );
+
+    int ripUp( CONNECTION& aFailed );
+    void ripUpNet( int aNet );
+
+    BOARD* m_board;
+
+    std::unique_ptr<PNS_KICAD_IFACE> m_iface;
+    std::unique_ptr<ROUTER>          m_router;
+
+    ROUTING_SETTINGS m_settings;
+    ORDER            m_order;
+    int              m_ripupPasses;
+    int              m_threadCount;
+    int              m_clearance;
+
+    std::set<int>                         m_nets;
+    std::vector<CONNECTION>               m_connections;
+    std::vector<std::unique_ptr<WORKER> > m_workers;
+
+    STATS m_stats;
+};
+
+}
+
+#endif
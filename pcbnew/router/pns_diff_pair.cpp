@@ -212,62 +212,99 @@ void DP_GATEWAY::Reverse()
 }
 
 
+// checks the angle between the last segment of aPrev and the first segment of aNext
+static bool checkJoinAngle( const SHAPE_LINE_CHAIN& aPrev, const SHAPE_LINE_CHAIN& aNext,
+                            int aAllowedAngles )
+{
+    if( aPrev.SegmentCount() == 0 || aNext.SegmentCount() == 0 )
+        return true;
+
+    DIRECTION_45 d0( aPrev.CSegment( -1 ) );
+    DIRECTION_45 d1( aNext.CSegment( 0 ) );
+
+    return ( d0.Angle( d1 ) & aAllowedAngles ) != 0;
+}
+
+
+// same as checkJoinAngle(), with aNext taken in reverse order
+static bool checkJoinAngleReversed( const SHAPE_LINE_CHAIN& aPrev, const SHAPE_LINE_CHAIN& aNext,
+                                    int aAllowedAngles )
+{
+    if( aPrev.SegmentCount() == 0 || aNext.SegmentCount() == 0 )
+        return true;
+
+    DIRECTION_45 d0( aPrev.CSegment( -1 ) );
+    DIRECTION_45 d1( SEG( aNext.CPoint( -1 ), aNext.CPoint( -2 ) ) );
+
+    return ( d0.Angle( d1 ) & aAllowedAngles ) != 0;
+}
+
+
+// appends aLine in reverse order to aTarget, without building a reversed copy
+static void appendReversed( SHAPE_LINE_CHAIN& aTarget, const SHAPE_LINE_CHAIN& aLine )
+{
+    int n = aLine.PointCount();
+
+    if( n == 0 )
+        return;
+
+    aTarget.Append( aLine.CPoint( n - 1 ) );
+
+    for( int i = n - 2; i >= 0; i-- )
+        aTarget.Append( aLine.CPoint( i ), true );
+}
+
+
 bool DIFF_PAIR::BuildInitial( const DP_GATEWAY& aEntry, const DP_GATEWAY &aTarget, bool aPrefDiagonal )
 {
     SHAPE_LINE_CHAIN p = DIRECTION_45().BuildInitialTrace ( aEntry.AnchorP(), aTarget.AnchorP(), aPrefDiagonal );
     SHAPE_LINE_CHAIN n = DIRECTION_45().BuildInitialTrace ( aEntry.AnchorN(), aTarget.AnchorN(), aPrefDiagonal );
 
-    int mask = aEntry.AllowedAngles() | DIRECTION_45::ANG_STRAIGHT | DIRECTION_45::ANG_OBTUSE;
+    // Reject the candidate on its connecting lines first: it does not need the
+    // entry lines to be assembled.
+    if( !checkGap ( p, n, m_gapConstraint ) )
+        return false;
+
+    if( p.SelfIntersecting() || n.SelfIntersecting() )
+        return false;
+
+    if( p.Intersects( n ) )
+        return false;
 
-    SHAPE_LINE_CHAIN sum_n, sum_p;
-    m_p = p;
-    m_n = n;
+    int mask = aEntry.AllowedAngles() | DIRECTION_45::ANG_STRAIGHT | DIRECTION_45::ANG_OBTUSE;
 
+    // m_p and m_n are assigned (not rebuilt), so a DIFF_PAIR reused for several
+    // candidates keeps its point buffers.
     if( aEntry.HasEntryLines() )
     {
-        if( !aEntry.Entry().CheckConnectionAngle( *this, mask ) )
+        if( !checkJoinAngle( aEntry.EntryP(), p, mask ) ||
+            !checkJoinAngle( aEntry.EntryN(), n, mask ) )
             return false;
 
-        sum_p = aEntry.Entry().CP();
-        sum_n = aEntry.Entry().CN();
-        sum_p.Append( p );
-        sum_n.Append( n );
+        m_p = aEntry.EntryP();
+        m_n = aEntry.EntryN();
+        m_p.Append( p );
+        m_n.Append( n );
     }
     else
     {
-        sum_p = p;
-        sum_n = n;
+        m_p = p;
+        m_n = n;
     }
 
     mask = aTarget.AllowedAngles() | DIRECTION_45::ANG_STRAIGHT | DIRECTION_45::ANG_OBTUSE;
 
-    m_p = sum_p;
-    m_n = sum_n;
-
     if( aTarget.HasEntryLines() )
     {
-        DP_GATEWAY t(aTarget) ;
-        t.Reverse();
-
-        if( !CheckConnectionAngle( t.Entry(), mask ) )
+        // the target entry lines lead to the gateway, so they are followed backwards
+        if( !checkJoinAngleReversed( m_p, aTarget.EntryP(), mask ) ||
+            !checkJoinAngleReversed( m_n, aTarget.EntryN(), mask ) )
             return false;
 
-        sum_p.Append( t.Entry().CP() );
-        sum_n.Append( t.Entry().CN() );
+        appendReversed( m_p, aTarget.EntryP() );
+        appendReversed( m_n, aTarget.EntryN() );
     }
 
-    m_p = sum_p;
-    m_n = sum_n;
-
-    if( !checkGap ( p, n, m_gapConstraint ) )
-        return false;
-
-    if( p.SelfIntersecting() || n.SelfIntersecting() )
-        return false;
-
-    if( p.Intersects( n ) )
-        return false;
-
     return true;
 }
 
@@ -309,7 +346,9 @@ const DIFF_PAIR DP_GATEWAY::Entry() const
 void DP_GATEWAYS::BuildOrthoProjections( DP_GATEWAYS& aEntries,
         const VECTOR2I& aCursorPos, int aOrthoScore )
 {
-    for( DP_GATEWAY g : aEntries.Gateways() )
+    DP_GATEWAYS targets( m_gap );
+
+    for( const DP_GATEWAY& g : aEntries.Gateways() )
     {
         VECTOR2I midpoint( ( g.AnchorP() + g.AnchorN() ) / 2 );
         SEG guide_s( midpoint, midpoint + VECTOR2I( 1, 0 ) );
@@ -324,18 +363,17 @@ void DP_GATEWAYS::BuildOrthoProjections( DP_GATEWAYS& aEntries,
 
         VECTOR2I proj = ( dist_s < dist_d ? proj_s : proj_d );
 
-        DP_GATEWAYS targets( m_gap );
-
+        targets.Clear();
         targets.m_viaGap = m_viaGap;
         targets.m_viaDiameter = m_viaDiameter;
         targets.m_fitVias = m_fitVias;
 
         targets.BuildForCursor( proj );
 
-        for( DP_GATEWAY t : targets.Gateways() )
+        for( const DP_GATEWAY& t : targets.Gateways() )
         {
-            t.SetPriority( aOrthoScore );
             m_gateways.push_back( t );
+            m_gateways.back().SetPriority( aOrthoScore );
         }
     }
 }
@@ -350,6 +388,10 @@ bool DP_GATEWAYS::FitGateways( DP_GATEWAYS& aEntry, DP_GATEWAYS& aTarget,
     int bestScore = -1000;
     bool found = false;
 
+    // a single pair is used for all the candidates, so that its lines are not
+    // reallocated for every entry/target combination
+    DIFF_PAIR l( m_gap );
+
     for( const DP_GATEWAY& g_entry : aEntry.Gateways() )
     {
         for( const DP_GATEWAY& g_target : aTarget.Gateways() )
@@ -365,8 +407,6 @@ bool DP_GATEWAYS::FitGateways( DP_GATEWAYS& aEntry, DP_GATEWAYS& aTarget,
                 if( score < bestScore )
                     continue;
 
-                DIFF_PAIR l( m_gap );
-
                 if( l.BuildInitial( g_entry, g_target, aPrefDiagonal ^ ( attempt ? true : false ) ) )
                 {
                     best.p = l.CP();
@@ -36,7 +36,9 @@
 namespace PNS {
 
 DIFF_PAIR_PLACER::DIFF_PAIR_PLACER( ROUTER* aRouter ) :
-    PLACEMENT_ALGO( aRouter )
+    PLACEMENT_ALGO( aRouter ),
+    m_gwsEntry( 0 ),
+    m_gwsTarget( 0 )
 {
     m_state = RT_START;
     m_chainedPlacement = false;
@@ -645,8 +647,15 @@ bool DIFF_PAIR_PLACER::routeHead( const VECTOR2I& aP )
 {
     m_fitOk = false;
 
-    DP_GATEWAYS gwsEntry( gap() );
-    DP_GATEWAYS gwsTarget( gap() );
+    DP_GATEWAYS& gwsEntry = m_gwsEntry;
+    DP_GATEWAYS& gwsTarget = m_gwsTarget;
+
+    gwsEntry.Clear();
+    gwsEntry.SetGap( gap() );
+    gwsEntry.SetFitVias( true );
+    gwsTarget.Clear();
+    gwsTarget.SetGap( gap() );
+    gwsTarget.SetFitVias( true );
 
     if( !m_prevPair )
         m_prevPair = m_start;
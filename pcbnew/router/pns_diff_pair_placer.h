@@ -292,6 +292,9 @@ private:
     VECTOR2I m_currentEnd, m_currentStart;
     DIFF_PAIR m_currentTrace;
 
+    ///> entry/target gateways of the head, kept between moves to reuse their storage
+    DP_GATEWAYS m_gwsEntry, m_gwsTarget;
+
     ITEM* m_currentEndItem;
     PNS_MODE m_currentMode;
 
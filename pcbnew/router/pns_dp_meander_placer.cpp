@@ -194,7 +194,7 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
     //Router()->DisplayDebugLine( m_originPair.CP(), 5, 20000 );
     //Router()->DisplayDebugLine( m_originPair.CN(), 4, 20000 );
 
-    m_result = MEANDERED_LINE( this, true );
+    m_result.Reset( this, true );
     m_result.SetWidth( tuned.Width() );
 
     int offset = ( tuned.Gap() + tuned.Width() ) / 2;
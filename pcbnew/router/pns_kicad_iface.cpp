@@ -374,6 +374,9 @@ public:
 
     void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth ) override
     {
+        if( !m_items )
+            return;
+
         ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_items );
 
         pitem->Line( aLine, aWidth, aType );
@@ -412,7 +415,9 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_previewItems = nullptr;
     m_world = nullptr;
     m_router = nullptr;
-    m_debugDecorator = nullptr;
+
+    // A view-less decorator, replaced in SetView().  Keeps the router usable headless.
+    m_debugDecorator = new PNS_PCBNEW_DEBUG_DECORATOR();
 }
 
 
@@ -785,6 +790,10 @@ void PNS_KICAD_IFACE::DisplayItem( const PNS::ITEM* aItem, int aColor, int aClea
 {
     wxLogTrace( "PNS", "DisplayItem %p", aItem );
 
+    // Nothing to display when running without a view (batch routing)
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -804,7 +813,7 @@ void PNS_KICAD_IFACE::HideItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_view )
     {
         if( parent->ViewIsVisible() )
             m_hiddenItems.insert( parent );
@@ -821,7 +830,9 @@ void PNS_KICAD_IFACE::RemoveItem( PNS::ITEM* aItem )
 
     if( parent )
     {
-        m_view->Remove( parent );
+        if( m_view )
+            m_view->Remove( parent );
+
         m_board->Remove( parent );
         m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
     }
@@ -871,10 +882,14 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
     {
         aItem->SetParent( newBI );
         newBI->ClearFlags();
-        m_view->Add( newBI );
         m_board->Add( newBI );
         m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
-        newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
+
+        if( m_view )
+        {
+            m_view->Add( newBI );
+            newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
+        }
     }
 }
 
@@ -882,9 +897,24 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     m_board->GetRatsnest()->Recalculate();
-    m_frame->SaveCopyInUndoList( m_undoBuffer, UR_UNSPECIFIED );
+
+    if( m_frame )
+    {
+        m_frame->SaveCopyInUndoList( m_undoBuffer, UR_UNSPECIFIED );
+        m_frame->OnModify();
+    }
+    else
+    {
+        // No undo list when running headless: items removed from the board
+        // are not referenced anywhere else and can be freed right away.
+        for( unsigned i = 0; i < m_undoBuffer.GetCount(); i++ )
+        {
+            if( m_undoBuffer.GetPickedItemStatus( i ) == UR_DELETED )
+                delete m_undoBuffer.GetPickedItem( i );
+        }
+    }
+
     m_undoBuffer.ClearItemsList();
-    m_frame->OnModify();
 }
 
 
@@ -47,8 +47,6 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
 {
     double base_len = aBase.Length();
 
-    SHAPE_LINE_CHAIN lc;
-
     bool side = true;
     VECTOR2D dir( aBase.B - aBase.A );
 
@@ -60,10 +58,12 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
 
     m_last = aBase.A;
 
+    // the candidate shape is reused for all the meanders of the segment, so its
+    // point buffers are allocated only once
+    MEANDER_SHAPE m( m_placer, m_width, m_dual );
+
     do
     {
-        MEANDER_SHAPE m( m_placer, m_width, m_dual );
-
         m.SetBaselineOffset( m_baselineOffset );
         m.SetBaseIndex( aBaseIndex );
 
@@ -84,7 +84,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
                     if( m.Fit( MT_CHECK_START, aBase, m_last, i ) )
                     {
                         turning = true;
-                        AddMeander( new MEANDER_SHAPE( m ) );
+                        AddMeander( NewShape( m ) );
                         side = !i;
                         started = true;
                         break;
@@ -99,7 +99,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
                     {
                         if( m.Fit( MT_SINGLE, aBase, m_last, i ) )
                         {
-                            AddMeander( new MEANDER_SHAPE( m ) );
+                            AddMeander( NewShape( m ) );
                             fail = false;
                             started = false;
                             side = !i;
@@ -113,12 +113,12 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
                 if( rv )
                 {
                     m.Fit( MT_TURN, aBase, m_last, side );
-                    AddMeander( new MEANDER_SHAPE( m ) );
+                    AddMeander( NewShape( m ) );
                     started = true;
                 } else {
                     m.Fit( MT_FINISH, aBase, m_last, side );
                     started = false;
-                    AddMeander( new MEANDER_SHAPE( m ) );
+                    AddMeander( NewShape( m ) );
                     turning = false;
                 }
 
@@ -128,7 +128,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
         {
             bool rv = m.Fit( MT_FINISH, aBase, m_last, side );
             if( rv )
-                AddMeander( new MEANDER_SHAPE( m ) );
+                AddMeander( NewShape( m ) );
 
             break;
 
@@ -143,11 +143,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
 
         if( fail )
         {
-            MEANDER_SHAPE tmp( m_placer, m_width, m_dual );
-            tmp.SetBaselineOffset( m_baselineOffset );
-            tmp.SetBaseIndex( aBaseIndex );
-
-            int nextP = tmp.spacing() - 2 * tmp.cornerRadius() + Settings().m_step;
+            int nextP = m.spacing() - 2 * m.cornerRadius() + Settings().m_step;
             VECTOR2I pn = m_last + dir.Resize( nextP );
 
             if( aBase.Contains( pn ) && !m_dual )
@@ -183,14 +179,15 @@ int MEANDER_SHAPE::spacing( ) const
 }
 
 
-SHAPE_LINE_CHAIN MEANDER_SHAPE::makeMiterShape( VECTOR2D aP, VECTOR2D aDir, bool aSide )
+void MEANDER_SHAPE::makeMiterShape( SHAPE_LINE_CHAIN& aTarget, VECTOR2D aP, VECTOR2D aDir,
+                                    bool aSide )
 {
-    SHAPE_LINE_CHAIN lc;
+    SHAPE_LINE_CHAIN& lc = aTarget;
 
     if( aDir.EuclideanNorm( ) == 0.0f )
     {
         lc.Append( aP );
-        return lc;
+        return;
     }
 
     VECTOR2D dir_u( aDir );
@@ -249,8 +246,6 @@ SHAPE_LINE_CHAIN MEANDER_SHAPE::makeMiterShape( VECTOR2D aP, VECTOR2D aDir, bool
 
     p = aP + dir_u + dir_v * ( aSide ? -1.0 : 1.0 );
     lc.Append( ( int ) p.x, ( int ) p.y );
-
-    return lc;
 }
 
 
@@ -305,12 +300,10 @@ void MEANDER_SHAPE::miter( int aRadius, bool aSide )
     }
 
     VECTOR2D dir = m_currentDir.Resize( (double) aRadius );
-    SHAPE_LINE_CHAIN lc = makeMiterShape( m_currentPos, dir, aSide );
+    makeMiterShape( *m_currentTarget, m_currentPos, dir, aSide );
 
-    m_currentPos = lc.CPoint( -1 );
+    m_currentPos = m_currentTarget->CPoint( -1 );
     m_currentDir = dir.Rotate( aSide ? -M_PI / 2.0 : M_PI / 2.0 );
-
-    m_currentTarget->Append( lc );
 }
 
 
@@ -324,7 +317,7 @@ void MEANDER_SHAPE::uShape( int aSides, int aCorner, int aTop )
 }
 
 
-SHAPE_LINE_CHAIN MEANDER_SHAPE::genMeanderShape( VECTOR2D aP, VECTOR2D aDir,
+void MEANDER_SHAPE::genMeanderShape( SHAPE_LINE_CHAIN& aTarget, VECTOR2D aP, VECTOR2D aDir,
         bool aSide, MEANDER_TYPE aType, int aAmpl, int aBaselineOffset )
 {
     const MEANDER_SETTINGS& st = Settings();
@@ -350,7 +343,7 @@ SHAPE_LINE_CHAIN MEANDER_SHAPE::genMeanderShape( VECTOR2D aP, VECTOR2D aDir,
 
     m_meanCornerRadius = cr;
 
-    SHAPE_LINE_CHAIN lc;
+    SHAPE_LINE_CHAIN& lc = aTarget;
 
     start( &lc, aP + dir_v_b, aDir );
 
@@ -412,8 +405,6 @@ SHAPE_LINE_CHAIN MEANDER_SHAPE::genMeanderShape( VECTOR2D aP, VECTOR2D aDir,
         for( int i = 0; i < lc.PointCount(); i++ )
             lc.Point( i ) = reflect( lc.CPoint( i ), axis );
     }
-
-    return lc;
 }
 
 
@@ -465,8 +456,13 @@ bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP
 
     if( checkMode )
     {
-        MEANDER_SHAPE m1( m_placer, m_width, m_dual );
-        MEANDER_SHAPE m2( m_placer, m_width, m_dual );
+        // scratch shapes owned by the placer, to avoid allocating new point
+        // buffers for every checked position
+        MEANDER_SHAPE& m1 = m_placer->m_checkShapes[0];
+        MEANDER_SHAPE& m2 = m_placer->m_checkShapes[1];
+
+        m1.reset( m_width, m_dual );
+        m2.reset( m_width, m_dual );
 
         m1.SetBaselineOffset( m_baselineOffset );
         m2.SetBaselineOffset( m_baselineOffset );
@@ -509,12 +505,12 @@ bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP
     {
         if( m_dual )
         {
-            m_shapes[0] = genMeanderShape( aP, aSeg.B - aSeg.A, aSide, aType, ampl, m_baselineOffset );
-            m_shapes[1] = genMeanderShape( aP, aSeg.B - aSeg.A, aSide, aType, ampl, -m_baselineOffset );
+            genMeanderShape( m_shapes[0], aP, aSeg.B - aSeg.A, aSide, aType, ampl, m_baselineOffset );
+            genMeanderShape( m_shapes[1], aP, aSeg.B - aSeg.A, aSide, aType, ampl, -m_baselineOffset );
         }
         else
         {
-            m_shapes[0] = genMeanderShape( aP, aSeg.B - aSeg.A, aSide, aType, ampl, 0 );
+            genMeanderShape( m_shapes[0], aP, aSeg.B - aSeg.A, aSide, aType, ampl, 0 );
         }
 
         m_type = aType;
@@ -535,10 +531,10 @@ bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP
 
 void MEANDER_SHAPE::Recalculate()
 {
-    m_shapes[0] = genMeanderShape( m_p0, m_baseSeg.B - m_baseSeg.A, m_side, m_type, m_amplitude, m_dual ? m_baselineOffset : 0 );
+    genMeanderShape( m_shapes[0], m_p0, m_baseSeg.B - m_baseSeg.A, m_side, m_type, m_amplitude, m_dual ? m_baselineOffset : 0 );
 
     if( m_dual )
-        m_shapes[1] = genMeanderShape( m_p0, m_baseSeg.B - m_baseSeg.A, m_side, m_type, m_amplitude, -m_baselineOffset );
+        genMeanderShape( m_shapes[1], m_p0, m_baseSeg.B - m_baseSeg.A, m_side, m_type, m_amplitude, -m_baselineOffset );
 
     updateBaseSegment();
 }
@@ -563,16 +559,35 @@ void MEANDER_SHAPE::MakeEmpty()
 
     m_type = MT_EMPTY;
 
-    m_shapes[0] = genMeanderShape( m_p0, dir, m_side, m_type, 0, m_dual ? m_baselineOffset : 0 );
+    genMeanderShape( m_shapes[0], m_p0, dir, m_side, m_type, 0, m_dual ? m_baselineOffset : 0 );
 
     if( m_dual )
-        m_shapes[1] = genMeanderShape( m_p0, dir, m_side, m_type, 0, -m_baselineOffset );
+        genMeanderShape( m_shapes[1], m_p0, dir, m_side, m_type, 0, -m_baselineOffset );
+}
+
+
+void MEANDER_SHAPE::reset( int aWidth, bool aIsDual )
+{
+    m_width = aWidth;
+    m_dual = aIsDual;
+    m_type = MT_SINGLE;
+    m_amplitude = 0;
+    m_baselineOffset = 0;
+    m_meanCornerRadius = 0;
+    m_p0 = VECTOR2I( 0, 0 );
+    m_baseSeg = SEG();
+    m_clippedBaseSeg = SEG();
+    m_side = false;
+    m_shapes[0].Clear();
+    m_shapes[1].Clear();
+    m_baseIndex = 0;
+    m_currentTarget = NULL;
 }
 
 
 void MEANDERED_LINE::AddCorner( const VECTOR2I& aA, const VECTOR2I& aB )
 {
-    MEANDER_SHAPE* m = new MEANDER_SHAPE( m_placer, m_width, m_dual );
+    MEANDER_SHAPE* m = NewShape( MEANDER_SHAPE( m_placer, m_width, m_dual ) );
 
     m->MakeCorner( aA, aB );
     m_last = aA;
@@ -602,15 +617,46 @@ void MEANDERED_LINE::AddMeander( MEANDER_SHAPE* aShape )
 
 void MEANDERED_LINE::Clear()
 {
-    for( MEANDER_SHAPE* m : m_meanders )
-    {
-        delete m;
-    }
-
+    m_pool.insert( m_pool.end(), m_meanders.begin(), m_meanders.end() );
     m_meanders.clear( );
 }
 
 
+void MEANDERED_LINE::Reset( MEANDER_PLACER_BASE* aPlacer, bool aIsDual )
+{
+    Clear();
+
+    m_placer = aPlacer;
+    m_dual = aIsDual;
+    m_width = 0;
+    m_baselineOffset = 0;
+}
+
+
+MEANDER_SHAPE* MEANDERED_LINE::NewShape( const MEANDER_SHAPE& aShape )
+{
+    if( m_pool.empty() )
+        return new MEANDER_SHAPE( aShape );
+
+    MEANDER_SHAPE* m = m_pool.back();
+    m_pool.pop_back();
+
+    // the assignment keeps the point buffers of the recycled shape
+    *m = aShape;
+
+    return m;
+}
+
+
+MEANDERED_LINE::~MEANDERED_LINE()
+{
+    Clear();
+
+    for( MEANDER_SHAPE* m : m_pool )
+        delete m;
+}
+
+
 int MEANDER_SHAPE::BaselineLength() const
 {
     return m_clippedBaseSeg.Length();
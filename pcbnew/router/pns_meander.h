@@ -333,14 +333,18 @@ private:
     ///> tells the turtle to draw an U-like shape
     void uShape( int aSides, int aCorner, int aTop );
 
-    ///> generates a 90-degree circular arc
-    SHAPE_LINE_CHAIN makeMiterShape( VECTOR2D aP, VECTOR2D aDir, bool aSide );
+    ///> appends a 90-degree circular arc to aTarget
+    void makeMiterShape( SHAPE_LINE_CHAIN& aTarget, VECTOR2D aP, VECTOR2D aDir, bool aSide );
 
     ///> reflects a point onto other side of a given segment
     VECTOR2I reflect( VECTOR2I aP, const SEG& aLine );
 
-    ///> produces a meander shape of given type
-    SHAPE_LINE_CHAIN genMeanderShape( VECTOR2D aP, VECTOR2D aDir, bool aSide, MEANDER_TYPE aType, int aAmpl, int aBaselineOffset = 0 );
+    ///> produces a meander shape of given type in aTarget, reusing its point buffer
+    void genMeanderShape( SHAPE_LINE_CHAIN& aTarget, VECTOR2D aP, VECTOR2D aDir, bool aSide,
+                          MEANDER_TYPE aType, int aAmpl, int aBaselineOffset = 0 );
+
+    ///> brings the shape back to its just-constructed state, keeping the point buffers
+    void reset( int aWidth, bool aIsDual );
 
     ///> recalculates the clipped baseline after the parameters of
     ///> the meander have been changed.
@@ -419,10 +423,7 @@ public:
         m_baselineOffset = 0;
     }
 
-    ~MEANDERED_LINE()
-    {
-        Clear();
-    }
+    ~MEANDERED_LINE();
 
     /**
      * Function AddCorner()
@@ -449,6 +450,14 @@ public:
      */
     void Clear();
 
+    /**
+     * Function NewShape()
+     *
+     * Returns a copy of aShape, allocated from the shapes recycled by Clear() if possible,
+     * so that the point buffers of the previous meandering pass are reused.
+     */
+    MEANDER_SHAPE* NewShape( const MEANDER_SHAPE& aShape );
+
     /**
      * Function SetWidth()
      *
@@ -459,6 +468,16 @@ public:
         m_width = aWidth;
     }
 
+    /**
+     * Function Reset()
+     *
+     * Clears the line geometry and sets the placer and the type of the line. The meander
+     * shapes are recycled by the next meandering pass, instead of being reallocated.
+     * @param aPlacer the meander placer instance
+     * @param aIsDual when true, the meanders are generated for two coupled lines
+     */
+    void Reset( MEANDER_PLACER_BASE* aPlacer, bool aIsDual );
+
     /**
      * Function MeanderSegment()
      *
@@ -508,6 +527,8 @@ private:
 
     MEANDER_PLACER_BASE* m_placer;
     std::vector<MEANDER_SHAPE*> m_meanders;
+    ///> shapes released by Clear(), reused by NewShape()
+    std::vector<MEANDER_SHAPE*> m_pool;
 
     bool m_dual;
     int m_width;
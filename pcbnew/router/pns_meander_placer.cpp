@@ -121,7 +121,7 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, int aTargetLeng
 
     cutTunedLine( m_originLine.CLine(), m_currentStart, aP, pre, tuned, post );
 
-    m_result = MEANDERED_LINE( this, false );
+    m_result.Reset( this, false );
     m_result.SetWidth( m_originLine.Width() );
     m_result.SetBaselineOffset( 0 );
 
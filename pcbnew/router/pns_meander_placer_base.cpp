@@ -26,7 +26,8 @@
 namespace PNS {
 
 MEANDER_PLACER_BASE::MEANDER_PLACER_BASE( ROUTER* aRouter ) :
-        PLACEMENT_ALGO( aRouter )
+        PLACEMENT_ALGO( aRouter ),
+        m_checkShapes{ MEANDER_SHAPE( this, 0 ), MEANDER_SHAPE( this, 0 ) }
 {
     m_currentWidth = 0;
 }
@@ -162,6 +162,12 @@ protected:
     MEANDER_SETTINGS m_settings;
     ///> current end point
     VECTOR2I m_currentEnd;
+
+private:
+    friend class MEANDER_SHAPE;
+
+    ///> scratch shapes for MEANDER_SHAPE::Fit(), kept to reuse their point buffers
+    MEANDER_SHAPE m_checkShapes[2];
 };
 
 }
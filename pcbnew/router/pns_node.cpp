@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <cassert>
+#include <mutex>
 
 #include <math/vector2d.h>
 
@@ -44,7 +45,9 @@ using boost::unordered_map;
 namespace PNS {
 
 #ifdef DEBUG
+// guarded by a mutex, as the batch autorouter creates nodes from several threads
 static boost::unordered_set<NODE*> allocNodes;
+static std::mutex allocNodesLock;
 #endif
 
 NODE::NODE()
@@ -58,6 +61,7 @@ NODE::NODE()
     m_index = new INDEX;
 
 #ifdef DEBUG
+    std::lock_guard<std::mutex> lock( allocNodesLock );
     allocNodes.insert( this );
 #endif
 }
@@ -74,13 +78,17 @@ NODE::~NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
     {
-        wxLogTrace( "PNS", "attempting to free an already-free'd node." );
-        assert( false );
-    }
+        std::lock_guard<std::mutex> lock( allocNodesLock );
 
-    allocNodes.erase( this );
+        if( allocNodes.find( this ) == allocNodes.end() )
+        {
+            wxLogTrace( "PNS", "attempting to free an already-free'd node." );
+            assert( false );
+        }
+
+        allocNodes.erase( this );
+    }
 #endif
 
     m_joints.clear();
@@ -281,7 +289,10 @@ int NODE::QueryColliding( const ITEM* aItem,
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    {
+        std::lock_guard<std::mutex> lock( allocNodesLock );
+        assert( allocNodes.find( this ) != allocNodes.end() );
+    }
 #endif
 
     visitor.SetCountLimit( aLimitCount );
@@ -64,10 +64,10 @@ namespace PNS {
 // To be fixed sometime in the future.
 static ROUTER* theRouter;
 
-ROUTER::ROUTER()
+ROUTER::ROUTER( bool aGlobalInstance )
 {
-    theRouter = this;
-
+    if( aGlobalInstance )
+        theRouter = this;
 
     m_state = IDLE;
     m_mode = PNS_MODE_ROUTE_SINGLE;
@@ -92,7 +92,9 @@ ROUTER* ROUTER::GetInstance()
 ROUTER::~ROUTER()
 {
     ClearWorld();
-    theRouter = nullptr;
+
+    if( theRouter == this )
+        theRouter = nullptr;
 }
 
 void ROUTER::SyncWorld( )
@@ -108,7 +108,11 @@ private:
     };
 
 public:
-    ROUTER();
+    /**
+     * @param aGlobalInstance tells if the router is the one returned by GetInstance().
+     * Batch routers must not replace the interactive router instance.
+     */
+    ROUTER( bool aGlobalInstance = true );
     ~ROUTER();
 
     void SetInterface( ROUTER_IFACE* aIface );
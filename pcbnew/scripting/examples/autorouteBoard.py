@@ -0,0 +1,19 @@
+#!/usr/bin/env python
+#
+# Routes the unconnected links of a board with the batch push and shove router
+# and prints a timing report.
+#
+# usage: autorouteBoard.py <board.kicad_pcb> [output.kicad_pcb] [ripup passes]
+#
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+output = sys.argv[2] if len(sys.argv) > 2 else "routed_" + filename
+passes = int(sys.argv[3]) if len(sys.argv) > 3 else 3
+
+pcb = LoadBoard(filename)
+
+print AutorouteBoard(pcb, passes)
+
+SaveBoard(output, pcb)
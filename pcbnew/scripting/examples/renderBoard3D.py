@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+#
+# Renders a board with the 3D viewer ray tracer into a PNG file, without display
+# nor GPU, and prints the time spent in each stage.
+#
+# usage: renderBoard3D.py <board.kicad_pcb> [output.png] [view] [width]x[height] [samples]
+#   view is one of top, bottom, front, back, left, right, iso (default top)
+#
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+output = sys.argv[2] if len(sys.argv) > 2 else filename.rsplit(".", 1)[0] + ".png"
+view = sys.argv[3] if len(sys.argv) > 3 else "top"
+width, height = map(int, sys.argv[4].split("x")) if len(sys.argv) > 4 else (1600, 1200)
+samples = int(sys.argv[5]) if len(sys.argv) > 5 else 4
+
+pcb = LoadBoard(filename)
+
+report = RenderBoard3D(pcb, output, view, width, height, samples)
+
+if not report:
+    print "unable to render view '%s' into %s" % (view, output)
+    sys.exit(1)
+
+print report
@@ -114,6 +114,7 @@ class BASE_SET {};
   #include <pcbnew_scripting_helpers.h>
 
   #include <plotcontroller.h>
+  #include <fab_job.h>
   #include <pcb_plot_params.h>
   #include <exporters/gendrill_Excellon_writer.h>
 
@@ -151,6 +152,7 @@ class BASE_SET {};
 
 %include <class_board_design_settings.h>
 %include <plotcontroller.h>
+%include <fab_job.h>
 %include <pcb_plot_params.h>
 %include <plot_common.h>
 %include <exporters/gendrill_Excellon_writer.h>
@@ -38,6 +38,11 @@
 #include <io_mgr.h>
 #include <macros.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <router/pns_autorouter.h>
+#include <3d_canvas/cinfo3d_visu.h>
+#include <3d_rendering/3d_render_raytracing/c3d_render_raytracing.h>
+#include <wx/image.h>
 
 static PCB_EDIT_FRAME* PcbEditFrame = NULL;
 
@@ -107,3 +112,116 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+wxString AutorouteBoard( BOARD* aBoard, int aRipupPasses )
+{
+    // The batch router frees the items it removes and does not update any view,
+    // so it cannot work on the board shown by the editor.
+    if( PcbEditFrame && aBoard == PcbEditFrame->GetBoard() )
+        return wxT( "Error: the board opened in Pcbnew cannot be autorouted from a script\n" );
+
+    PNS::AUTOROUTER autorouter( aBoard );
+
+    autorouter.SetRipupPasses( aRipupPasses );
+    autorouter.Run();
+
+    return autorouter.FormatReport();
+}
+
+
+// Camera presets of RenderBoard3D(): rotations applied to the top view, as the
+// view hotkeys of EDA_3D_CANVAS do
+struct CAMERA_PRESET
+{
+    const wxChar*   name;
+    float           rotateX;
+    float           rotateZ;
+};
+
+static const CAMERA_PRESET cameraPresets[] =
+{
+    { wxT( "top" ),       0.0f,    0.0f },
+    { wxT( "bottom" ), -180.0f,    0.0f },
+    { wxT( "front" ),   -90.0f,    0.0f },
+    { wxT( "back" ),    -90.0f, -180.0f },
+    { wxT( "left" ),    -90.0f,  -90.0f },
+    { wxT( "right" ),   -90.0f,   90.0f },
+    { wxT( "iso" ),     -55.0f,  -45.0f },
+};
+
+
+wxString RenderBoard3D( BOARD* aBoard, wxString& aFileName, wxString& aView,
+                        int aWidth, int aHeight, int aSamples )
+{
+    const CAMERA_PRESET* preset = NULL;
+
+    for( unsigned ii = 0; ii < DIM( cameraPresets ); ii++ )
+    {
+        if( aView.CmpNoCase( cameraPresets[ii].name ) == 0 )
+            preset = &cameraPresets[ii];
+    }
+
+    if( !preset )
+        return wxEmptyString;
+
+    const wxSize size( std::max( aWidth, 64 ), std::max( aHeight, 64 ) );
+
+    CINFO3D_VISU settings;
+
+    settings.SetBoard( aBoard );
+    settings.RenderEngineSet( RENDER_ENGINE_RAYTRACING );
+    settings.SetFlag( FL_RENDER_RAYTRACING_SHADOWS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_REFRACTIONS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_REFLECTIONS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING, aSamples > 1 );
+
+    CCAMERA& camera = settings.CameraGet();
+
+    camera.Reset();
+    camera.RotateX( glm::radians( preset->rotateX ) );
+    camera.RotateZ( glm::radians( preset->rotateZ ) );
+
+    C3D_RENDER_RAYTRACING renderer( settings );
+    std::vector<GLubyte> rgba;
+
+    renderer.SetAntiAliasingPasses( std::max( aSamples - 1, 1 ) );
+    renderer.RenderToBuffer( size, rgba, NULL );
+
+    // wxImage wants a malloc'ed RGB buffer, top row first
+    unsigned char* rgb = (unsigned char*) malloc( size.x * size.y * 3 );
+
+    for( int y = 0; y < size.y; y++ )
+    {
+        const GLubyte* src = &rgba[( size.y - 1 - y ) * size.x * 4];
+        unsigned char* dst = &rgb[y * size.x * 3];
+
+        for( int x = 0; x < size.x; x++, src += 4, dst += 3 )
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+
+    wxImage image( size.x, size.y, rgb );
+
+    // not registered when running from a python interpreter
+    if( !wxImage::FindHandler( wxBITMAP_TYPE_PNG ) )
+        wxImage::AddHandler( new wxPNGHandler );
+
+    if( !image.SaveFile( aFileName, wxBITMAP_TYPE_PNG ) )
+        return wxEmptyString;
+
+    const RT_RENDER_STATS& stats = renderer.GetStats();
+
+    return wxString::Format( wxT( "%dx%d, %d samples, view %s\n"
+                                  "scene build:     %.1f ms\n"
+                                  "BVH build:       %.1f ms\n"
+                                  "trace:           %.1f ms\n"
+                                  "post processing: %.1f ms" ),
+                             size.x, size.y, std::max( aSamples, 1 ), preset->name,
+                             stats.m_sceneBuild / 1e3, stats.m_acceleratorBuild / 1e3,
+                             stats.m_tracing / 1e3, stats.m_postProcessing / 1e3 );
+}
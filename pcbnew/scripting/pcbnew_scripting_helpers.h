@@ -43,5 +43,32 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function AutorouteBoard
+ * routes the unconnected ratsnest links of aBoard with the batch push and shove router.
+ * aBoard must not be the board opened in the editor (see GetBoard()): it is modified
+ * without undo nor view update.
+ * @param aBoard is the board to route.
+ * @param aRipupPasses is the maximum number of rip-up and re-route passes.
+ * @return a report of the routed connections and the time spent in each stage.
+ */
+wxString AutorouteBoard( BOARD* aBoard, int aRipupPasses = 3 );
+
+/**
+ * Function RenderBoard3D
+ * renders aBoard with the 3D viewer ray tracer into a PNG file, on the CPU only:
+ * no display nor OpenGL context is needed. 3D models are not rendered.
+ * @param aBoard is the board to render.
+ * @param aFileName is the PNG file to write.
+ * @param aView is the camera preset: "top", "bottom", "front", "back", "left", "right"
+ * or "iso".
+ * @param aWidth and aHeight are the image size in pixels (at least 64).
+ * @param aSamples is the number of rays per pixel, 1 disables the anti-aliasing.
+ * @return the time spent in each stage, or an empty string if the view is unknown or
+ * the file cannot be written.
+ */
+wxString RenderBoard3D( BOARD* aBoard, wxString& aFileName, wxString& aView,
+                        int aWidth = 1600, int aHeight = 1200, int aSamples = 4 );
+
 
 #endif
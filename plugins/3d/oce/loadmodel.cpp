@@ -78,6 +78,8 @@
 #define MASK_OCE "PLUGIN_OCE"
 
 // precision for mesh creation; 0.07 should be good enough for ECAD viewing
+// (bump PLUGIN_OCE_REVNO in oce.cpp when changing USER_PREC or USER_ANGLE, so
+// the models cached with the former tessellation are not reused)
 #define USER_PREC (0.14)
 // angular deflection for meshing
 // 10 deg (36 faces per circle) = 0.17453293
@@ -458,6 +460,27 @@ bool readSTEP( Handle(TDocStd_Document)& m_doc, const char* fname )
 }
 
 
+// Mesh the free shapes before they are translated to the scene graph. Each shape is
+// meshed as a whole, so the faces and edges shared by its solids are meshed once; the
+// mesher processes the faces in parallel. The instances of a shape share its geometry,
+// which is meshed once.
+void meshShapes( DATA& data, TDF_LabelSequence& frshapes )
+{
+    for( int id = 1; id <= frshapes.Length(); ++id )
+    {
+        TopoDS_Shape shape = data.m_assy->GetShape( frshapes.Value( id ) );
+
+        if( shape.IsNull() )
+            continue;
+
+        BRepMesh_IncrementalMesh IM( shape, USER_PREC, Standard_False, USER_ANGLE,
+                                     Standard_True );
+    }
+
+    return;
+}
+
+
 SCENEGRAPH* LoadModel( char const* filename )
 {
     DATA data;
@@ -492,6 +515,8 @@ SCENEGRAPH* LoadModel( char const* filename )
     TDF_LabelSequence frshapes;
     data.m_assy->GetFreeShapes( frshapes );
 
+    meshShapes( data, frshapes );
+
     int nshapes = frshapes.Length();
     int id = 1;
     bool ret = false;
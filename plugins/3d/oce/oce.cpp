@@ -34,7 +34,9 @@ SCENEGRAPH* LoadModel( char const* filename );
 
 #define PLUGIN_OCE_MAJOR 1
 #define PLUGIN_OCE_MINOR 1
-#define PLUGIN_OCE_PATCH 1
+#define PLUGIN_OCE_PATCH 2
+// the 3D cache keys the cached models on the plugin version: bump the revision
+// when the meshing precision (USER_PREC, USER_ANGLE in loadmodel.cpp) changes
 #define PLUGIN_OCE_REVNO 0
 
 
@@ -21,8 +21,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <cctype>
+#include <climits>
 #include <wx/filename.h>
 #include <wx/string.h>
 #include <wx/log.h>
@@ -46,6 +49,159 @@
     } } while( 0 )
 
 
+// Locale independent number parsers for the bulk array readers. They return the
+// position following the number, or NULL if aStart is not a number followed by a
+// separator (blank space, comma, closing bracket or comment).
+
+static inline bool isSeparator( char aChar )
+{
+    return (unsigned char) aChar <= 0x20 || ',' == aChar || ']' == aChar || '#' == aChar;
+}
+
+
+static const char* parseFloat( const char* aStart, float& aValue )
+{
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* cp = aStart;
+    bool negative = false;
+
+    if( '-' == *cp || '+' == *cp )
+        negative = ( '-' == *cp++ );
+
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+
+    for( ; *cp >= '0' && *cp <= '9'; ++cp, ++digits )
+    {
+        // past 19 digits the remaining ones only scale the value
+        if( mantissa < 1000000000000000000ULL )
+            mantissa = mantissa * 10 + ( *cp - '0' );
+        else
+            ++exponent;
+    }
+
+    if( '.' == *cp )
+    {
+        for( ++cp; *cp >= '0' && *cp <= '9'; ++cp, ++digits )
+        {
+            if( mantissa < 1000000000000000000ULL )
+            {
+                mantissa = mantissa * 10 + ( *cp - '0' );
+                --exponent;
+            }
+        }
+    }
+
+    if( 0 == digits )
+        return NULL;
+
+    if( 'e' == *cp || 'E' == *cp )
+    {
+        ++cp;
+        bool negexp = false;
+
+        if( '-' == *cp || '+' == *cp )
+            negexp = ( '-' == *cp++ );
+
+        if( *cp < '0' || *cp > '9' )
+            return NULL;
+
+        int exp = 0;
+
+        for( ; *cp >= '0' && *cp <= '9'; ++cp )
+        {
+            if( exp < 10000 )
+                exp = exp * 10 + ( *cp - '0' );
+        }
+
+        exponent += negexp ? -exp : exp;
+    }
+
+    if( !isSeparator( *cp ) )
+        return NULL;
+
+    double value = (double) mantissa;
+
+    if( 0 == mantissa )
+        exponent = 0;
+
+    while( exponent > 22 )
+    {
+        value *= 1e22;
+        exponent -= 22;
+    }
+
+    while( exponent < -22 )
+    {
+        value /= 1e22;
+        exponent += 22;
+    }
+
+    if( exponent > 0 )
+        value *= pow10[exponent];
+    else if( exponent < 0 )
+        value /= pow10[-exponent];
+
+    aValue = (float)( negative ? -value : value );
+    return cp;
+}
+
+
+static const char* parseInt( const char* aStart, int& aValue )
+{
+    const char* cp = aStart;
+    bool negative = false;
+
+    if( '-' == *cp || '+' == *cp )
+        negative = ( '-' == *cp++ );
+
+    long long value = 0;
+    int digits = 0;
+
+    if( '0' == cp[0] && ( 'x' == cp[1] || 'X' == cp[1] ) )
+    {
+        // Rules: "0x" + "0-9, A-F"; as in ReadSFInt() the case is not enforced
+        for( cp += 2; isxdigit( (unsigned char) *cp ); ++cp, ++digits )
+        {
+            int nibble = *cp <= '9' ? *cp - '0' : ( *cp | 0x20 ) - 'a' + 10;
+            value = value * 16 + nibble;
+
+            if( value > 0xFFFFFFFFLL )
+                return NULL;
+        }
+
+        // hexadecimal values are 32 bit patterns
+        value = (int) (unsigned int) value;
+    }
+    else
+    {
+        for( ; *cp >= '0' && *cp <= '9'; ++cp, ++digits )
+        {
+            value = value * 10 + ( *cp - '0' );
+
+            if( value > 0x80000000LL )
+                return NULL;
+        }
+    }
+
+    if( 0 == digits || !isSeparator( *cp ) )
+        return NULL;
+
+    if( negative )
+        value = -value;
+
+    if( value > INT_MAX || value < INT_MIN )
+        return NULL;
+
+    aValue = (int) value;
+    return cp;
+}
+
+
 WRLPROC::WRLPROC( LINE_READER* aLineReader )
 {
     m_fileVersion = VRML_INVALID;
@@ -1157,6 +1313,144 @@ bool WRLPROC::ReadSFVec3f( WRLVEC3F& aSFVec3f )
 }
 
 
+bool WRLPROC::readFloatList( std::vector< float >& aList, size_t aTupleSize )
+{
+    aList.clear();
+    size_t fileline = m_fileline;
+    size_t linepos = m_bufpos;
+
+    while( true )
+    {
+        if( !EatSpace() )
+            return false;
+
+        const char* start = m_buf.c_str();
+        const char* cp = start + m_bufpos;
+
+        // guess the number of values from the line length; long lists are often
+        // written on a single line
+        size_t need = aList.size() + ( m_buf.size() - m_bufpos ) / 8;
+
+        if( need > aList.capacity() )
+            aList.reserve( std::max( need, 2 * aList.capacity() ) );
+
+        while( true )
+        {
+            while( *cp && ( (unsigned char) *cp <= 0x20 || ',' == *cp ) )
+                ++cp;
+
+            if( '\0' == *cp || '#' == *cp )
+                break;
+
+            if( ']' == *cp )
+            {
+                m_bufpos = cp - start + 1;
+
+                if( aList.size() % aTupleSize )
+                {
+                    std::ostringstream ostr;
+                    ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
+                    ostr << " * [INFO] failed on file '" << m_filename << "'\n";
+                    ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
+                    ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
+                    ostr << " * [INFO] incomplete tuple in list";
+                    m_error = ostr.str();
+
+                    return false;
+                }
+
+                return true;
+            }
+
+            float value;
+            const char* end = parseFloat( cp, value );
+
+            if( NULL == end )
+            {
+                m_bufpos = cp - start;
+
+                std::ostringstream ostr;
+                ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
+                ostr << " * [INFO] failed on file '" << m_filename << "'\n";
+                ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
+                ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
+                ostr << " * [INFO] invalid character in SFFloat";
+                m_error = ostr.str();
+
+                return false;
+            }
+
+            aList.push_back( value );
+            cp = end;
+        }
+
+        // the rest of the line is blank or a comment
+        m_buf.clear();
+    }
+}
+
+
+bool WRLPROC::readIntList( std::vector< int >& aList )
+{
+    aList.clear();
+    size_t fileline = m_fileline;
+    size_t linepos = m_bufpos;
+
+    while( true )
+    {
+        if( !EatSpace() )
+            return false;
+
+        const char* start = m_buf.c_str();
+        const char* cp = start + m_bufpos;
+
+        size_t need = aList.size() + ( m_buf.size() - m_bufpos ) / 4;
+
+        if( need > aList.capacity() )
+            aList.reserve( std::max( need, 2 * aList.capacity() ) );
+
+        while( true )
+        {
+            while( *cp && ( (unsigned char) *cp <= 0x20 || ',' == *cp ) )
+                ++cp;
+
+            if( '\0' == *cp || '#' == *cp )
+                break;
+
+            if( ']' == *cp )
+            {
+                m_bufpos = cp - start + 1;
+                return true;
+            }
+
+            int value;
+            const char* end = parseInt( cp, value );
+
+            if( NULL == end )
+            {
+                m_bufpos = cp - start;
+
+                std::ostringstream ostr;
+                ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
+                ostr << " * [INFO] failed on file '" << m_filename << "'\n";
+                ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
+                ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
+                ostr << " * [INFO] invalid character in SFInt";
+                m_error = ostr.str();
+
+                return false;
+            }
+
+            aList.push_back( value );
+            cp = end;
+        }
+
+        // the rest of the line is blank or a comment
+        m_buf.clear();
+    }
+}
+
+
 bool WRLPROC::ReadMFString( std::vector< std::string >& aMFString )
 {
     aMFString.clear();
@@ -1339,51 +1633,30 @@ bool WRLPROC::ReadMFColor( std::vector< WRLVEC3F >& aMFColor )
 
     ++m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( !ReadSFColor( lcolor ) )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] " << m_error;
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        aMFColor.push_back( lcolor );
+    if( !readFloatList( m_floats, 3 ) )
+        return false;
 
-        if( !EatSpace() )
+    for( size_t i = 0; i < m_floats.size(); ++i )
+    {
+        if( m_floats[i] < 0.0 || m_floats[i] > 1.0 )
         {
             std::ostringstream ostr;
             ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
             ostr << " * [INFO] failed on file '" << m_filename << "'\n";
             ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
             ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] could not check characters after the string";
+            ostr << " * [INFO] invalid RGB value in color triplet";
             m_error = ostr.str();
 
             return false;
         }
+    }
 
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( ',' == m_buf[m_bufpos] )
-            Pop();
+    aMFColor.resize( m_floats.size() / 3 );
 
-    }
+    for( size_t i = 0, j = 0; i < aMFColor.size(); ++i, j += 3 )
+        aMFColor[i] = WRLVEC3F( m_floats[j], m_floats[j + 1], m_floats[j + 2] );
 
-    ++m_bufpos;
     return true;
 }
 
@@ -1451,52 +1724,7 @@ bool WRLPROC::ReadMFFloat( std::vector< float >& aMFFloat )
 
     ++m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( !ReadSFFloat( temp ) )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] " << m_error;
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        aMFFloat.push_back( temp );
-
-        if( !EatSpace() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] could not check characters after the string";
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( ',' == m_buf[m_bufpos] )
-            Pop();
-
-    }
-
-    ++m_bufpos;
-    return true;
+    return readFloatList( aMFFloat, 1 );
 }
 
 
@@ -1563,52 +1791,7 @@ bool WRLPROC::ReadMFInt( std::vector< int >& aMFInt32 )
 
     ++m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( !ReadSFInt( temp ) )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] " << m_error;
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        aMFInt32.push_back( temp );
-
-        if( !EatSpace() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] could not check characters after the string";
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( ',' == m_buf[m_bufpos] )
-            Pop();
-
-    }
-
-    ++m_bufpos;
-    return true;
+    return readIntList( aMFInt32 );
 }
 
 
@@ -1787,51 +1970,14 @@ bool WRLPROC::ReadMFVec2f( std::vector< WRLVEC2F >& aMFVec2f )
 
     ++m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( !ReadSFVec2f( lvec2f ) )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] " << m_error;
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        aMFVec2f.push_back( lvec2f );
-
-        if( !EatSpace() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] could not check characters after the string";
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
+    if( !readFloatList( m_floats, 2 ) )
+        return false;
 
-        if( ',' == m_buf[m_bufpos] )
-            Pop();
+    aMFVec2f.resize( m_floats.size() / 2 );
 
-    }
+    for( size_t i = 0, j = 0; i < aMFVec2f.size(); ++i, j += 2 )
+        aMFVec2f[i] = WRLVEC2F( m_floats[j], m_floats[j + 1] );
 
-    ++m_bufpos;
     return true;
 }
 
@@ -1899,54 +2045,14 @@ bool WRLPROC::ReadMFVec3f( std::vector< WRLVEC3F >& aMFVec3f )
 
     ++m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
-
-        if( !ReadSFVec3f( lvec3f ) )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] " << m_error;
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        aMFVec3f.push_back( lvec3f );
-
-        if( !EatSpace() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] could not check characters after the string";
-            m_error = ostr.str();
-
-            return false;
-        }
-
-        if( !EatSpace() )
-            return false;
-
-        if( ']' == m_buf[m_bufpos] )
-            break;
+    if( !readFloatList( m_floats, 3 ) )
+        return false;
 
-        if( ',' == m_buf[m_bufpos] )
-            Pop();
+    aMFVec3f.resize( m_floats.size() / 3 );
 
-    }
+    for( size_t i = 0, j = 0; i < aMFVec3f.size(); ++i, j += 3 )
+        aMFVec3f[i] = WRLVEC3F( m_floats[j], m_floats[j + 1], m_floats[j + 2] );
 
-    ++m_bufpos;
     return true;
 }
 
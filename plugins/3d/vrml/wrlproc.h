@@ -58,6 +58,16 @@ private:
     // parameters are updated as appropriate.
     bool getRawLine( void );
 
+    // Bulk array readers, used for the lists of the MF readers once the opening
+    // bracket has been consumed: they scan the numbers straight from the line
+    // buffer up to the closing bracket, with a locale independent parser, instead
+    // of extracting each value as a string. readFloatList() fails if the number
+    // of values is not a multiple of aTupleSize.
+    bool readFloatList( std::vector< float >& aList, size_t aTupleSize );
+    bool readIntList( std::vector< int >& aList );
+
+    std::vector< float > m_floats;  // values of the last vector list, reused between lists
+
 public:
     WRLPROC( LINE_READER* aLineReader );
     ~WRLPROC();
@@ -0,0 +1,138 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Load time benchmark of the 3D model cache.
+// The render data of the given models is loaded three times, in a new cache directory:
+//  - cold: the models are parsed by the plugins (the installed ones are used)
+//  - scene cache: the scene graph cache files (.3dc) are read and converted to meshes
+//  - mesh cache: the mesh cache files (.3dm) are mapped
+// The model is emptied between the passes; the cache files are kept.
+//
+// usage: 3d_cache_bench <model file> [<model file> ...]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <wx/app.h>
+#include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <common.h>
+
+#include <3d_cache/3d_cache.h>
+
+
+struct LOAD_RESULT
+{
+    unsigned usecs;
+    int      models;
+    long     triangles;
+};
+
+
+static LOAD_RESULT loadModels( S3D_CACHE& aCache, int aCount, char** aFiles )
+{
+    LOAD_RESULT result = { 0, 0, 0 };
+
+    unsigned start = GetRunningMicroSecs();
+
+    for( int i = 0; i < aCount; ++i )
+    {
+        S3DMODEL* model = aCache.GetModel( wxString::FromUTF8( aFiles[i] ) );
+
+        if( !model )
+            continue;
+
+        result.models++;
+
+        for( unsigned int j = 0; j < model->m_MeshesSize; ++j )
+            result.triangles += model->m_Meshes[j].m_FaceIdxSize / 3;
+    }
+
+    result.usecs = GetRunningMicroSecs() - start;
+
+    return result;
+}
+
+
+static void removeFiles( const wxString& aDir, const wxString& aSpec )
+{
+    wxArrayString files;
+
+    wxDir::GetAllFiles( aDir, &files, aSpec, wxDIR_FILES );
+
+    for( unsigned i = 0; i < files.GetCount(); ++i )
+        wxRemoveFile( files[i] );
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+    {
+        printf( "usage: %s <model file> [<model file> ...]\n", argv[0] );
+        return 1;
+    }
+
+    wxInitializer initializer;
+
+    // keep the user cache untouched: the cache directory follows XDG_CACHE_HOME
+    wxString tmpDir = wxFileName::CreateTempFileName( wxT( "3dbench" ) );
+    wxRemoveFile( tmpDir );
+    wxFileName::Mkdir( tmpDir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL );
+    wxSetEnv( wxT( "XDG_CACHE_HOME" ), tmpDir );
+
+    S3D_CACHE cache;
+
+    if( !cache.Set3DConfigDir( tmpDir + wxT( "/config" ) ) )
+    {
+        printf( "cannot create the cache directory in %s\n", (const char*) tmpDir.mb_str() );
+        return 1;
+    }
+
+    wxString cacheDir = tmpDir + wxT( "/kicad/3d" );
+
+    const char* passes[] = { "cold", "scene cache", "mesh cache" };
+
+    for( int pass = 0; pass < 3; ++pass )
+    {
+        // the mesh cache files are read first: remove them to time the scene cache
+        if( pass == 1 )
+            removeFiles( cacheDir, wxT( "*.3dm" ) );
+
+        LOAD_RESULT result = loadModels( cache, argc - 1, argv + 1 );
+
+        printf( "%-12s: %d models, %ld triangles in %u usecs\n",
+                passes[pass], result.models, result.triangles, result.usecs );
+
+        cache.FlushCache( false );
+    }
+
+    wxFileName::Rmdir( tmpDir, wxPATH_RMDIR_RECURSIVE );
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Benchmark of the legacy autorouter routing matrix and search queue.
+// A 2 layer board is generated on the routing grid: rows of IC pads, with random
+// blockers, and random connections between pads are routed one after the other,
+// each routed path becoming an obstacle for the next ones.
+//
+// usage: autorouter_bench [grid size (default 1000)] [connections (default 100)] [seed]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include <fctsys.h>
+#include <common.h>
+
+#include <autorout.h>
+#include <cell.h>
+
+
+MATRIX_ROUTING_HEAD RoutingMatrix;
+
+int OpenNodes;
+int ClosNodes;
+int MoveNodes;
+int MaxNodes;
+
+
+// neighbours of a cell, and the direction back to source stored in the neighbour
+static const int delta[8][2] =
+{
+    {  1, -1 }, {  1, 0 }, {  1, 1 }, {  0, -1 },
+    {  0, 1  }, { -1, -1 }, { -1, 0 }, { -1, 1 }
+};
+
+static const int ndir[8] =
+{
+    FROM_SOUTHEAST, FROM_SOUTH, FROM_SOUTHWEST, FROM_EAST,
+    FROM_WEST, FROM_NORTHEAST, FROM_NORTH, FROM_NORTHWEST
+};
+
+// offset to the previous cell, indexed by FROM_xxx
+static const int back[9][2] =
+{
+    { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+    { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+};
+
+
+static void fillRect( int r0, int c0, int r1, int c1, MATRIX_CELL aCell )
+{
+    for( int r = std::max( r0, 0 ); r <= std::min( r1, RoutingMatrix.m_Nrows - 1 ); r++ )
+    {
+        for( int c = std::max( c0, 0 ); c <= std::min( c1, RoutingMatrix.m_Ncols - 1 ); c++ )
+        {
+            RoutingMatrix.OrCell( r, c, TOP, aCell );
+            RoutingMatrix.OrCell( r, c, BOTTOM, aCell );
+        }
+    }
+}
+
+
+static void clearRect( int r0, int c0, int r1, int c1, MATRIX_CELL aCell )
+{
+    for( int r = std::max( r0, 0 ); r <= std::min( r1, RoutingMatrix.m_Nrows - 1 ); r++ )
+    {
+        for( int c = std::max( c0, 0 ); c <= std::min( c1, RoutingMatrix.m_Ncols - 1 ); c++ )
+        {
+            RoutingMatrix.AndCell( r, c, TOP, ~aCell );
+            RoutingMatrix.AndCell( r, c, BOTTOM, ~aCell );
+        }
+    }
+}
+
+
+// generate the board, and returns the pad positions (the connection end points)
+static void generateBoard( std::vector<wxPoint>& aPads )
+{
+    int size = RoutingMatrix.m_Nrows;
+
+    // rows of DIP-like footprints: 2 columns of pads, 4 cells apart
+    for( int fr = 20; fr < size - 60; fr += 80 )
+    {
+        for( int fc = 20; fc < size - 40; fc += 60 )
+        {
+            for( int pin = 0; pin < 16; pin++ )
+            {
+                int r = fr + pin * 4;
+
+                fillRect( r - 1, fc - 1, r + 1, fc + 1, HOLE );
+                fillRect( r - 1, fc + 23, r + 1, fc + 25, HOLE );
+                aPads.push_back( wxPoint( fc, r ) );
+                aPads.push_back( wxPoint( fc + 24, r ) );
+            }
+        }
+    }
+
+    // random blockers (vias, texts, mounting holes ...)
+    for( int ii = 0; ii < size / 2; ii++ )
+    {
+        int r = rand() % size;
+        int c = rand() % size;
+
+        fillRect( r, c, r + 1 + rand() % 6, c + 1 + rand() % 6, HOLE );
+    }
+}
+
+
+// like in solve.cpp, the pads of the connection being routed are not obstacles
+static inline bool isBlocked( int aRow, int aCol, int aSide )
+{
+    MATRIX_CELL cell = RoutingMatrix.GetCell( aRow, aCol, aSide );
+
+    return ( cell & HOLE ) && !( cell & CURRENT_PAD );
+}
+
+
+static bool routeOne( int r1, int c1, int r2, int c2 )
+{
+    int r, c, side, d, apx;
+
+    RoutingMatrix.ClearRouteCells();
+    InitQueue();
+
+    apx = RoutingMatrix.GetApxDist( r1, c1, r2, c2 );
+    SetQueue( r1, c1, TOP, 0, apx, r2, c2 );
+    SetQueue( r1, c1, BOTTOM, 0, apx, r2, c2 );
+
+    for( GetQueue( &r, &c, &side, &d, &apx ); r != ILLEGAL;
+         GetQueue( &r, &c, &side, &d, &apx ) )
+    {
+        if( r == r2 && c == c2 )
+        {
+            // mark the path as an obstacle for the next connections
+            for( int steps = 0; steps < RoutingMatrix.m_Nrows * RoutingMatrix.m_Ncols; steps++ )
+            {
+                RoutingMatrix.OrCell( r, c, side, HOLE );
+
+                if( r == r1 && c == c1 )
+                    break;
+
+                int dir = RoutingMatrix.GetDir( r, c, side );
+
+                if( dir == FROM_NOWHERE )
+                    break;
+
+                if( dir == FROM_OTHERSIDE )
+                {
+                    side = 1 - side;
+                    continue;
+                }
+
+                r += back[dir][0];
+                c += back[dir][1];
+            }
+
+            return true;
+        }
+
+        int olddir = RoutingMatrix.GetDir( r, c, side );
+
+        for( int i = 0; i < 8; i++ )
+        {
+            int nr = r + delta[i][0];
+            int nc = c + delta[i][1];
+
+            if( nr < 0 || nr >= RoutingMatrix.m_Nrows || nc < 0 || nc >= RoutingMatrix.m_Ncols )
+                continue;
+
+            if( isBlocked( nr, nc, side ) && ( nr != r2 || nc != c2 ) )
+                continue;
+
+            if( delta[i][0] && delta[i][1] )
+            {
+                if( isBlocked( r, nc, side ) || isBlocked( nr, c, side ) )
+                    continue;
+            }
+
+            int newdist = d + RoutingMatrix.CalcDist( ndir[i], olddir,
+                                ( olddir == FROM_OTHERSIDE ) ?
+                                RoutingMatrix.GetDir( r, c, 1 - side ) : 0, side );
+
+            if( !RoutingMatrix.GetDir( nr, nc, side ) )
+            {
+                RoutingMatrix.SetDirDist( nr, nc, side, ndir[i], newdist );
+                SetQueue( nr, nc, side, newdist,
+                          RoutingMatrix.GetApxDist( nr, nc, r2, c2 ), r2, c2 );
+            }
+            else if( newdist < RoutingMatrix.GetDist( nr, nc, side ) )
+            {
+                RoutingMatrix.SetDirDist( nr, nc, side, ndir[i], newdist );
+                ReSetQueue( nr, nc, side, newdist,
+                            RoutingMatrix.GetApxDist( nr, nc, r2, c2 ), r2, c2 );
+            }
+        }
+
+        // try a via
+        if( olddir == FROM_OTHERSIDE || RoutingMatrix.GetCell( r, c, side )
+            || RoutingMatrix.GetCell( r, c, 1 - side ) )
+            continue;
+
+        int newdist = d + RoutingMatrix.CalcDist( FROM_OTHERSIDE, olddir, 0, side );
+
+        if( !RoutingMatrix.GetDir( r, c, 1 - side ) )
+        {
+            RoutingMatrix.SetDirDist( r, c, 1 - side, FROM_OTHERSIDE, newdist );
+            SetQueue( r, c, 1 - side, newdist, apx, r2, c2 );
+        }
+        else if( newdist < RoutingMatrix.GetDist( r, c, 1 - side ) )
+        {
+            RoutingMatrix.SetDirDist( r, c, 1 - side, FROM_OTHERSIDE, newdist );
+            ReSetQueue( r, c, 1 - side, newdist, apx, r2, c2 );
+        }
+    }
+
+    return false;
+}
+
+
+int main( int argc, char** argv )
+{
+    int size  = argc > 1 ? atoi( argv[1] ) : 1000;
+    int count = argc > 2 ? atoi( argv[2] ) : 100;
+    int seed  = argc > 3 ? atoi( argv[3] ) : 1;
+
+    srand( seed );
+
+    RoutingMatrix.m_Nrows = size;
+    RoutingMatrix.m_Ncols = size;
+    RoutingMatrix.m_RoutingLayersCount = 2;
+    RoutingMatrix.m_RouteCount = 2;
+
+    unsigned start = GetRunningMicroSecs();
+
+    if( RoutingMatrix.InitRoutingMatrix() < 0 )
+    {
+        printf( "unable to allocate the routing matrix\n" );
+        return 1;
+    }
+
+    std::vector<wxPoint> pads;
+    generateBoard( pads );
+
+    unsigned built = GetRunningMicroSecs();
+
+    int  routed = 0;
+    long opened = 0, closed = 0, maxOpen = 0;
+
+    for( int ii = 0; ii < count && pads.size() > 1; ii++ )
+    {
+        const wxPoint& from = pads[rand() % pads.size()];
+        const wxPoint& to   = pads[rand() % pads.size()];
+
+        if( from == to )
+            continue;
+
+        fillRect( from.y - 1, from.x - 1, from.y + 1, from.x + 1, CURRENT_PAD );
+        fillRect( to.y - 1, to.x - 1, to.y + 1, to.x + 1, CURRENT_PAD );
+
+        if( routeOne( from.y, from.x, to.y, to.x ) )
+            routed++;
+
+        clearRect( from.y - 1, from.x - 1, from.y + 1, from.x + 1, CURRENT_PAD );
+        clearRect( to.y - 1, to.x - 1, to.y + 1, to.x + 1, CURRENT_PAD );
+
+        opened += OpenNodes;
+        closed += ClosNodes;
+        maxOpen = std::max( maxOpen, (long) MaxNodes );
+    }
+
+    unsigned done = GetRunningMicroSecs();
+
+    FreeQueue();
+    RoutingMatrix.UnInitRoutingMatrix();
+
+    printf( "grid %dx%d, %d pads: generated in %u usecs\n",
+            size, size, (int) pads.size(), built - start );
+    printf( "%d/%d connections routed in %u usecs (%.1f usecs per connection)\n",
+            routed, count, done - built, (double) ( done - built ) / std::max( count, 1 ) );
+    printf( "nodes opened %ld, closed %ld, max open %ld\n", opened, closed, maxOpen );
+
+    return 0;
+}
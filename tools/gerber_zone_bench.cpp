@@ -0,0 +1,226 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Size and time of the Gerber output of a copper pour, plotted the three ways the
+// zones can be plotted:
+//  - outline: the filled areas as G36/G37 polygons, and their thick outlines (solid fill)
+//  - segments: the filling segments, and the thick outlines (segment fill)
+//  - regions: the filled areas inflated by half the outline thickness, as G36/G37 regions
+// The pour is a 200x200 mm square, with a grid of round clearance holes (vias)
+// and 0.25 mm min thickness, filled as the zone filler does.
+//
+// usage: gerber_zone_bench [holes per row (default 100)]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include <wx/app.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <common.h>
+#include <plot_common.h>
+#include <convert_basic_shapes_to_polygon.h>
+#include <geometry/shape_poly_set.h>
+
+
+static const int    pourSize     = 200000000;  // nm
+static const int    minThickness = 250000;
+static const int    holeRadius   = 400000;
+static const int    circleSegs   = 32;
+
+
+// The filling segments of aAreas, as ZONE_CONTAINER::FillZoneAreasWithSegments makes them
+static void buildFillSegments( const SHAPE_POLY_SET& aAreas,
+                               std::vector< std::pair<wxPoint, wxPoint> >& aSegments )
+{
+    BOX2I bbox = aAreas.BBox();
+    std::vector<int> crossings;
+
+    for( int y = bbox.GetY() + minThickness / 2; y < bbox.GetBottom(); y += minThickness / 2 )
+    {
+        crossings.clear();
+
+        for( int ii = 0; ii < aAreas.OutlineCount(); ii++ )
+        {
+            const SHAPE_LINE_CHAIN& outline = aAreas.COutline( ii );
+
+            for( int jj = 0; jj < outline.PointCount(); jj++ )
+            {
+                const VECTOR2I& a = outline.CPoint( jj );
+                const VECTOR2I& b = outline.CPoint( jj + 1 );
+
+                if( ( a.y <= y ) == ( b.y <= y ) )
+                    continue;
+
+                crossings.push_back( a.x + (int64_t) ( y - a.y ) * ( b.x - a.x ) / ( b.y - a.y ) );
+            }
+        }
+
+        std::sort( crossings.begin(), crossings.end() );
+
+        for( unsigned ii = 0; ii + 1 < crossings.size(); ii += 2 )
+            aSegments.push_back( std::make_pair( wxPoint( crossings[ii], y ),
+                                                 wxPoint( crossings[ii + 1], y ) ) );
+    }
+}
+
+
+static GERBER_PLOTTER* startPlot( const wxString& aFileName )
+{
+    GERBER_PLOTTER* plotter = new GERBER_PLOTTER();
+
+    plotter->SetViewport( wxPoint( 0, 0 ), 2540.0, 1.0, false );    // nm
+    plotter->SetGerberCoordinatesFormat( 6 );
+    plotter->SetCreator( wxT( "gerber_zone_bench" ) );
+
+    if( !plotter->OpenFile( aFileName ) )
+    {
+        delete plotter;
+        return NULL;
+    }
+
+    plotter->StartPlot();
+
+    return plotter;
+}
+
+
+static void endPlot( GERBER_PLOTTER* aPlotter, const char* aName, const wxString& aFileName,
+                     unsigned aStart )
+{
+    aPlotter->EndPlot();
+    delete aPlotter;
+
+    unsigned usecs = GetRunningMicroSecs() - aStart;
+
+    printf( "%-10s: %10lu bytes in %8u usecs\n", aName,
+            (unsigned long) wxFileName::GetSize( aFileName ).ToULong(), usecs );
+
+    wxRemoveFile( aFileName );
+}
+
+
+int main( int argc, char** argv )
+{
+    int holesPerRow = argc > 1 ? atoi( argv[1] ) : 100;
+
+    wxInitializer initializer;
+
+    // Build the pour: outline, minus the holes, shrunk by half the min thickness
+    SHAPE_POLY_SET areas;
+    SHAPE_POLY_SET holes;
+
+    areas.NewOutline();
+    areas.Append( 0, 0 );
+    areas.Append( pourSize, 0 );
+    areas.Append( pourSize, pourSize );
+    areas.Append( 0, pourSize );
+
+    int pitch = pourSize / ( holesPerRow + 1 );
+
+    for( int ix = 1; ix <= holesPerRow; ix++ )
+    {
+        for( int iy = 1; iy <= holesPerRow; iy++ )
+            TransformCircleToPolygon( holes, wxPoint( ix * pitch, iy * pitch ),
+                                      holeRadius, circleSegs );
+    }
+
+    areas.Inflate( -minThickness / 2, circleSegs );
+    areas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+    areas.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    std::vector< std::pair<wxPoint, wxPoint> > segments;
+    buildFillSegments( areas, segments );
+
+    printf( "pour: %d holes, %d corners, %lu filling segments\n",
+            holesPerRow * holesPerRow, areas.TotalVertices(), (unsigned long) segments.size() );
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "zonebench" ) );
+    std::vector<wxPoint> cornerList;
+
+    // outline: filled polygons, and their outline drawn with a thick pen
+    unsigned start = GetRunningMicroSecs();
+    GERBER_PLOTTER* plotter = startPlot( fileName );
+
+    if( !plotter )
+    {
+        printf( "cannot create %s\n", (const char*) fileName.mb_str() );
+        return 1;
+    }
+
+    for( int ii = 0; ii < areas.OutlineCount(); ii++ )
+    {
+        const SHAPE_LINE_CHAIN& outline = areas.COutline( ii );
+
+        cornerList.clear();
+
+        for( int jj = 0; jj < outline.PointCount(); jj++ )
+            cornerList.push_back( wxPoint( outline.CPoint( jj ).x, outline.CPoint( jj ).y ) );
+
+        cornerList.push_back( cornerList[0] );
+        plotter->PlotPoly( cornerList, FILLED_SHAPE, minThickness );
+    }
+
+    endPlot( plotter, "outline", fileName, start );
+
+    // segments: the filling segments, and the outline drawn with a thick pen
+    start = GetRunningMicroSecs();
+    plotter = startPlot( fileName );
+
+    for( unsigned ii = 0; ii < segments.size(); ii++ )
+        plotter->ThickSegment( segments[ii].first, segments[ii].second, minThickness, FILLED );
+
+    for( int ii = 0; ii < areas.OutlineCount(); ii++ )
+    {
+        const SHAPE_LINE_CHAIN& outline = areas.COutline( ii );
+
+        cornerList.clear();
+
+        for( int jj = 0; jj < outline.PointCount(); jj++ )
+            cornerList.push_back( wxPoint( outline.CPoint( jj ).x, outline.CPoint( jj ).y ) );
+
+        cornerList.push_back( cornerList[0] );
+        plotter->PlotPoly( cornerList, NO_FILL, minThickness );
+    }
+
+    endPlot( plotter, "segments", fileName, start );
+
+    // regions: the copper itself, as regions
+    start = GetRunningMicroSecs();
+    plotter = startPlot( fileName );
+
+    SHAPE_POLY_SET copper = areas;
+
+    copper.Inflate( minThickness / 2, circleSegs );
+    copper.Fracture( SHAPE_POLY_SET::PM_FAST );
+    plotter->PlotRegions( copper );
+
+    endPlot( plotter, "regions", fileName, start );
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Size and time of the SVG and DXF export of a synthetic copper layer, plotted as
+// pcbnew plots a layer: tracks (thick segments), round and rectangular pads, arcs,
+// and stroked texts, on a 200x200 mm board.
+// For the SVG file, the number of <path> elements is also given: the consecutive
+// strokes drawn with the same pen are grouped in one path.
+//
+// usage: plot_export_bench [tracks per row (default 500)]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wx/app.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <common.h>
+#include <plot_common.h>
+
+
+static const int    boardSize   = 200000000;   // nm
+static const int    trackWidth  = 250000;
+static const int    padSize     = 1500000;
+
+
+static void plotLayer( PLOTTER* aPlotter, int aTracksPerRow )
+{
+    int pitch = boardSize / ( aTracksPerRow + 1 );
+
+    aPlotter->SetColor( RED );
+
+    for( int iy = 1; iy <= aTracksPerRow; iy++ )
+    {
+        int y = iy * pitch;
+
+        // A track made of short segments along the row, with a pad at each end
+        for( int ix = 1; ix < aTracksPerRow; ix++ )
+        {
+            wxPoint start( ix * pitch, y );
+            wxPoint end( ( ix + 1 ) * pitch, y + ( ix % 2 ? pitch / 2 : 0 ) );
+
+            aPlotter->ThickSegment( start, end, trackWidth, FILLED );
+        }
+
+        aPlotter->FlashPadCircle( wxPoint( pitch, y ), padSize, FILLED );
+        aPlotter->FlashPadRect( wxPoint( aTracksPerRow * pitch, y ),
+                                wxSize( padSize, padSize ), 0.0, FILLED );
+        aPlotter->Arc( wxPoint( pitch, y ), 0.0, 900.0, padSize, NO_FILL, trackWidth );
+    }
+
+    // Some silkscreen-like texts
+    aPlotter->SetColor( BLUE );
+
+    for( int iy = 1; iy <= aTracksPerRow; iy += 10 )
+    {
+        wxString text = wxString::Format( wxT( "NET%d" ), iy );
+
+        aPlotter->Text( wxPoint( pitch / 2, iy * pitch ), BLUE, text, 0.0,
+                        wxSize( 1000000, 1000000 ), GR_TEXT_HJUSTIFY_LEFT,
+                        GR_TEXT_VJUSTIFY_CENTER, 150000, false, false );
+    }
+}
+
+
+// Count the occurrences of aPattern in the file aFileName
+static unsigned countInFile( const wxString& aFileName, const char* aPattern )
+{
+    FILE*    file = wxFopen( aFileName, wxT( "rb" ) );
+    char     line[1024];
+    unsigned count = 0;
+
+    if( !file )
+        return 0;
+
+    while( fgets( line, sizeof( line ), file ) )
+    {
+        for( const char* p = strstr( line, aPattern ); p; p = strstr( p + 1, aPattern ) )
+            count++;
+    }
+
+    fclose( file );
+    return count;
+}
+
+
+static bool runExport( PLOTTER* aPlotter, const char* aName, const wxString& aFileName,
+                       int aTracksPerRow )
+{
+    unsigned start = GetRunningMicroSecs();
+
+    aPlotter->SetViewport( wxPoint( 0, 0 ), 2540.0, 1.0, false );    // nm
+    aPlotter->SetCreator( wxT( "plot_export_bench" ) );
+
+    if( !aPlotter->OpenFile( aFileName ) )
+    {
+        printf( "cannot create %s\n", (const char*) aFileName.mb_str() );
+        delete aPlotter;
+        return false;
+    }
+
+    aPlotter->StartPlot();
+    plotLayer( aPlotter, aTracksPerRow );
+    aPlotter->EndPlot();
+    delete aPlotter;
+
+    unsigned usecs = GetRunningMicroSecs() - start;
+
+    printf( "%-4s: %10lu bytes in %8u usecs", aName,
+            (unsigned long) wxFileName::GetSize( aFileName ).ToULong(), usecs );
+
+    if( !strcmp( aName, "SVG" ) )
+        printf( ", %u <path> elements", countInFile( aFileName, "<path" ) );
+
+    printf( "\n" );
+
+    wxRemoveFile( aFileName );
+    return true;
+}
+
+
+int main( int argc, char** argv )
+{
+    int tracksPerRow = argc > 1 ? atoi( argv[1] ) : 500;
+
+    wxInitializer initializer;
+    LOCALE_IO     toggle;
+
+    printf( "layer: %d track segments, %d pads\n",
+            tracksPerRow * ( tracksPerRow - 1 ), tracksPerRow * 2 );
+
+    wxString fileName = wxFileName::CreateTempFileName( wxT( "plotbench" ) );
+
+    if( !runExport( new SVG_PLOTTER(), "SVG", fileName, tracksPerRow ) )
+        return 1;
+
+    if( !runExport( new DXF_PLOTTER(), "DXF", fileName, tracksPerRow ) )
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Micro-benchmark of the geometry code run by the interactive router on each mouse
+// move when placing a differential pair or tuning the length of a trace/pair:
+// gateway generation and fitting (DP_GATEWAYS) and meander generation (MEANDERED_LINE).
+// No board and no collision checks are involved.
+//
+// usage: pns_dp_meander_bench [iterations (default 2000)]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <common.h>
+
+#include <pns_diff_pair.h>
+#include <pns_itemset.h>
+#include <pns_meander.h>
+#include <pns_meander_placer_base.h>
+
+
+using namespace PNS;
+
+
+// A tuning placer without router: every meander fits in a fixed corridor around
+// the tuned segment.
+class BENCH_PLACER : public MEANDER_PLACER_BASE
+{
+public:
+    BENCH_PLACER( int aCorridor ) :
+        MEANDER_PLACER_BASE( NULL ),
+        m_corridor( aCorridor )
+    {
+        m_currentWidth = 200000;
+    }
+
+    bool Start( const VECTOR2I& aP, ITEM* aStartItem ) { return false; }
+    bool Move( const VECTOR2I& aP, ITEM* aEndItem ) { return false; }
+    bool FixRoute( const VECTOR2I& aP, ITEM* aEndItem ) { return false; }
+    const ITEM_SET Traces() { return ITEM_SET(); }
+    const VECTOR2I& CurrentEnd() const { return m_end; }
+    const std::vector<int> CurrentNets() const { return std::vector<int>(); }
+    int CurrentLayer() const { return 0; }
+    NODE* CurrentNode( bool aLoopsRemoved = false ) const { return NULL; }
+    const wxString TuningInfo() const { return wxEmptyString; }
+    TUNING_STATUS TuningStatus() const { return TUNED; }
+
+    bool CheckFit( MEANDER_SHAPE* aShape )
+    {
+        for( int i = 0; i < ( aShape->IsDual() ? 2 : 1 ); i++ )
+        {
+            const BOX2I bbox = aShape->CLine( i ).BBox();
+
+            if( bbox.GetTop() < -m_corridor || bbox.GetBottom() > m_corridor )
+                return false;
+        }
+
+        return true;
+    }
+
+    // meanders a straight horizontal segment, as MEANDER_PLACER::doMove() does
+    int Tune( MEANDERED_LINE& aLine, const SEG& aSeg, bool aDual, int aElongation )
+    {
+        aLine.Reset( this, aDual );
+        aLine.SetWidth( m_currentWidth );
+        aLine.SetBaselineOffset( aDual ? 2 * m_currentWidth : 0 );
+        aLine.AddCorner( aSeg.A );
+        aLine.MeanderSegment( aSeg );
+        aLine.AddCorner( aSeg.B );
+
+        tuneLineLength( aLine, aElongation );
+
+        int points = 0;
+
+        for( MEANDER_SHAPE* m : aLine.Meanders() )
+            points += m->CLine( 0 ).PointCount();
+
+        return points;
+    }
+
+private:
+    int      m_corridor;
+    VECTOR2I m_end;
+};
+
+
+int main( int argc, char** argv )
+{
+    int iterations = argc > 1 ? atoi( argv[1] ) : 2000;
+
+    BENCH_PLACER placer( 3000000 );
+    MEANDERED_LINE line;
+
+    long points = 0;
+    unsigned start = GetRunningMicroSecs();
+
+    for( int ii = 0; ii < iterations; ii++ )
+    {
+        SEG seg( VECTOR2I( 0, 0 ), VECTOR2I( 20000000 + ( ii % 50 ) * 100000, 0 ) );
+        points += placer.Tune( line, seg, false, 5000000 + ( ii % 20 ) * 500000 );
+    }
+
+    unsigned single = GetRunningMicroSecs();
+
+    for( int ii = 0; ii < iterations; ii++ )
+    {
+        SEG seg( VECTOR2I( 0, 0 ), VECTOR2I( 20000000 + ( ii % 50 ) * 100000, 0 ) );
+        points += placer.Tune( line, seg, true, 5000000 + ( ii % 20 ) * 500000 );
+    }
+
+    unsigned dual = GetRunningMicroSecs();
+
+    // the differential pair placer builds the entry gateways at a fixed pad pair
+    // and the target gateways at the cursor, then fits a pair between them
+    const int gap = 200000;
+    DP_GATEWAYS gwsEntry( gap );
+    DP_GATEWAYS gwsTarget( gap );
+    DIFF_PAIR dp;
+    int fitted = 0;
+
+    for( int ii = 0; ii < iterations; ii++ )
+    {
+        VECTOR2I cursor( 5000000 + ( ii % 97 ) * 73000, 3000000 + ( ii % 89 ) * 51000 );
+
+        gwsEntry.Clear();
+        gwsEntry.SetGap( gap );
+        gwsEntry.SetFitVias( true );
+        gwsEntry.BuildGeneric( VECTOR2I( 0, 0 ), VECTOR2I( 0, 400000 ), true );
+
+        gwsTarget.Clear();
+        gwsTarget.SetGap( gap );
+        gwsTarget.SetFitVias( true );
+        gwsTarget.BuildForCursor( cursor );
+
+        DP_GATEWAYS fit( gap );
+
+        if( fit.FitGateways( gwsEntry, gwsTarget, ii % 2, dp ) )
+            fitted++;
+    }
+
+    unsigned done = GetRunningMicroSecs();
+
+    printf( "single meanders: %d tunings in %u usecs (%.1f usecs each)\n",
+            iterations, single - start, (double) ( single - start ) / iterations );
+    printf( "dual meanders: %d tunings in %u usecs (%.1f usecs each)\n",
+            iterations, dual - single, (double) ( dual - single ) / iterations );
+    printf( "meander points generated: %ld\n", points );
+    printf( "diff pair gateways: %d fits (%d found) in %u usecs (%.1f usecs each)\n",
+            iterations, fitted, done - dual, (double) ( done - dual ) / iterations );
+
+    return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Throughput benchmark of the 3D viewer ray tracer packet traversal.
+// A reference board is generated in 3D units, as the ray tracer builds it: copper
+// tracks, pads and vias as layer items on both sides, the board body and component
+// bodies as triangles. Primary ray packets covering an image are traced from an
+// isometric camera with each instruction set of the packet kernels (scalar, SSE2,
+// AVX when supported), and the hits are checked to be the same.
+//
+// usage: raytrace_packet_bench [image size (default 1024)] [tracks (default 4000)] [seed]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <fctsys.h>
+#include <common.h>
+#include <class_drawsegment.h>
+
+#include <3d_rendering/3d_render_raytracing/accelerators/ccontainer.h>
+#include <3d_rendering/3d_render_raytracing/accelerators/cbvh_pbrt.h>
+#include <3d_rendering/3d_render_raytracing/shapes2D/cfilledcircle2d.h>
+#include <3d_rendering/3d_render_raytracing/shapes2D/cring2d.h>
+#include <3d_rendering/3d_render_raytracing/shapes2D/croundsegment2d.h>
+#include <3d_rendering/3d_render_raytracing/shapes3D/clayeritem.h>
+#include <3d_rendering/3d_render_raytracing/shapes3D/ctriangle.h>
+#include <3d_rendering/3d_render_raytracing/raypacket_simd.h>
+#include <3d_rendering/ctrack_ball.h>
+
+
+// board size and layer heights, in 3D units
+static const float boardX = 6.0f;
+static const float boardY = 4.0f;
+static const float boardZ = 0.16f;
+static const float copperZ = 0.0035f;
+
+
+static float frand( float aMin, float aMax )
+{
+    return aMin + ( aMax - aMin ) * rand() / (float) RAND_MAX;
+}
+
+
+static void addQuad( CCONTAINER& aScene, const SFVEC3F& a, const SFVEC3F& b,
+                     const SFVEC3F& c, const SFVEC3F& d )
+{
+    aScene.Add( new CTRIANGLE( a, b, c ) );
+    aScene.Add( new CTRIANGLE( c, d, a ) );
+}
+
+
+// an axis aligned box made of 12 triangles, like a component model
+static void addBox( CCONTAINER& aScene, const SFVEC3F& aMin, const SFVEC3F& aMax )
+{
+    const SFVEC3F p[8] =
+    {
+        SFVEC3F( aMin.x, aMin.y, aMin.z ), SFVEC3F( aMax.x, aMin.y, aMin.z ),
+        SFVEC3F( aMax.x, aMax.y, aMin.z ), SFVEC3F( aMin.x, aMax.y, aMin.z ),
+        SFVEC3F( aMin.x, aMin.y, aMax.z ), SFVEC3F( aMax.x, aMin.y, aMax.z ),
+        SFVEC3F( aMax.x, aMax.y, aMax.z ), SFVEC3F( aMin.x, aMax.y, aMax.z )
+    };
+
+    addQuad( aScene, p[0], p[3], p[2], p[1] );
+    addQuad( aScene, p[4], p[5], p[6], p[7] );
+    addQuad( aScene, p[0], p[1], p[5], p[4] );
+    addQuad( aScene, p[1], p[2], p[6], p[5] );
+    addQuad( aScene, p[2], p[3], p[7], p[6] );
+    addQuad( aScene, p[3], p[0], p[4], p[7] );
+}
+
+
+static void generateBoard( CCONTAINER& aScene, std::vector<COBJECT2D*>& aObjects2D,
+                           const BOARD_ITEM& aItem, int aTracks )
+{
+    const float x0 = -boardX / 2, x1 = boardX / 2;
+    const float y0 = -boardY / 2, y1 = boardY / 2;
+
+    // board body, finely tessellated as the outline often is
+    for( int ix = 0; ix < 32; ix++ )
+    {
+        for( int iy = 0; iy < 32; iy++ )
+        {
+            const float xa = x0 + boardX * ix / 32, xb = x0 + boardX * ( ix + 1 ) / 32;
+            const float ya = y0 + boardY * iy / 32, yb = y0 + boardY * ( iy + 1 ) / 32;
+
+            addQuad( aScene, SFVEC3F( xa, ya, boardZ ), SFVEC3F( xb, ya, boardZ ),
+                     SFVEC3F( xb, yb, boardZ ), SFVEC3F( xa, yb, boardZ ) );
+            addQuad( aScene, SFVEC3F( xa, ya, 0.0f ), SFVEC3F( xa, yb, 0.0f ),
+                     SFVEC3F( xb, yb, 0.0f ), SFVEC3F( xb, ya, 0.0f ) );
+        }
+    }
+
+    for( int ii = 0; ii < aTracks; ii++ )
+    {
+        const bool  top = rand() & 1;
+        const float zMin = top ? boardZ : -copperZ;
+        const float zMax = top ? boardZ + copperZ : 0.0f;
+
+        SFVEC2F start( frand( x0, x1 ), frand( y0, y1 ) );
+        SFVEC2F end = start + SFVEC2F( frand( -0.4f, 0.4f ), frand( -0.4f, 0.4f ) );
+
+        COBJECT2D* track = new CROUNDSEGMENT2D( start, end, frand( 0.005f, 0.02f ), aItem );
+        aObjects2D.push_back( track );
+        aScene.Add( new CLAYERITEM( track, zMin, zMax ) );
+
+        // a pad at one end of one track out of 2, a via out of 4
+        if( ii % 2 == 0 )
+        {
+            COBJECT2D* pad = new CFILLEDCIRCLE2D( end, frand( 0.02f, 0.05f ), aItem );
+            aObjects2D.push_back( pad );
+            aScene.Add( new CLAYERITEM( pad, zMin, zMax ) );
+        }
+        else if( ii % 4 == 1 )
+        {
+            COBJECT2D* via = new CRING2D( end, 0.01f, 0.025f, aItem );
+            aObjects2D.push_back( via );
+            aScene.Add( new CLAYERITEM( via, -copperZ, boardZ + copperZ ) );
+        }
+    }
+
+    // components
+    for( int ii = 0; ii < aTracks / 20; ii++ )
+    {
+        const SFVEC3F pos( frand( x0, x1 ), frand( y0, y1 ), boardZ + copperZ );
+        const SFVEC3F size( frand( 0.05f, 0.4f ), frand( 0.05f, 0.4f ), frand( 0.02f, 0.3f ) );
+
+        addBox( aScene, pos, pos + size );
+    }
+}
+
+
+struct TRACE_RESULT
+{
+    unsigned    usecs;
+    long        rays;
+    long        hits;
+    double      tSum;
+};
+
+
+static TRACE_RESULT trace( const CBVH_PBRT& aAccelerator, const CCAMERA& aCamera,
+                           int aSize, int aPasses )
+{
+    TRACE_RESULT result = { 0, 0, 0, 0.0 };
+    HITINFO_PACKET hits[RAYPACKET_RAYS_PER_PACKET];
+
+    unsigned start = GetRunningMicroSecs();
+
+    for( int pass = 0; pass < aPasses; pass++ )
+    {
+        for( int y = 0; y + RAYPACKET_DIM <= aSize; y += RAYPACKET_DIM )
+        {
+            for( int x = 0; x + RAYPACKET_DIM <= aSize; x += RAYPACKET_DIM )
+            {
+                RAYPACKET packet( aCamera, SFVEC2I( x, y ) );
+
+                for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+                {
+                    hits[i].m_HitInfo.m_tHit = std::numeric_limits<float>::infinity();
+                    hits[i].m_HitInfo.m_acc_node_info = 0;
+                    hits[i].m_hitresult = false;
+                }
+
+                aAccelerator.Intersect( packet, hits );
+
+                for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+                {
+                    if( hits[i].m_hitresult )
+                    {
+                        result.hits++;
+                        result.tSum += hits[i].m_HitInfo.m_tHit;
+                    }
+                }
+
+                result.rays += RAYPACKET_RAYS_PER_PACKET;
+            }
+        }
+    }
+
+    result.usecs = GetRunningMicroSecs() - start;
+
+    return result;
+}
+
+
+int main( int argc, char** argv )
+{
+    int size   = argc > 1 ? atoi( argv[1] ) : 1024;
+    int tracks = argc > 2 ? atoi( argv[2] ) : 4000;
+    int seed   = argc > 3 ? atoi( argv[3] ) : 1;
+
+    srand( seed );
+
+    DRAWSEGMENT boardItem;
+    CCONTAINER scene;
+    std::vector<COBJECT2D*> objects2D;
+
+    unsigned start = GetRunningMicroSecs();
+
+    generateBoard( scene, objects2D, boardItem, tracks );
+
+    unsigned built = GetRunningMicroSecs();
+
+    CBVH_PBRT accelerator( scene );
+
+    unsigned bvhBuilt = GetRunningMicroSecs();
+
+    printf( "%d objects: generated in %u usecs, BVH built in %u usecs\n",
+            (int) scene.GetList().size(), built - start, bvhBuilt - built );
+
+    CTRACK_BALL camera( 8.0f );
+
+    camera.SetCurWindowSize( wxSize( size, size ) );
+    camera.RotateX( glm::radians( -55.0f ) );
+    camera.RotateZ( glm::radians( -45.0f ) );
+
+    // the kernels are compared with the scalar one
+    TRACE_RESULT reference = { 0, 0, 0, 0.0 };
+
+    for( int level = RAYPACKET_SIMD_SCALAR; level <= RAYPACKET_SIMD_AVX; level++ )
+    {
+        if( RAYPACKET_SetSimdLevel( (RAYPACKET_SIMD) level ) != level )
+            break;
+
+        trace( accelerator, camera, size, 1 );     // warm up
+
+        TRACE_RESULT result = trace( accelerator, camera, size, 3 );
+
+        if( level == RAYPACKET_SIMD_SCALAR )
+            reference = result;
+
+        printf( "%-6s: %ld rays in %u usecs, %.2f Mrays/s, %ld hits%s\n",
+                RAYPACKET_SimdName( (RAYPACKET_SIMD) level ), result.rays, result.usecs,
+                (double) result.rays / std::max( result.usecs, 1u ), result.hits,
+                ( result.hits == reference.hits && result.tSum == reference.tSum ) ?
+                "" : " (MISMATCH)" );
+    }
+
+    for( COBJECT2D* object : objects2D )
+        delete object;
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Query throughput of the packed R-tree used by SHAPE_INDEX and the VIEW, compared
+// to the generic RTree it replaces. Boxes shaped like tracks and pads are scattered over
+// a 300x300 mm board; the trees are built by inserting them one by one, then searched
+// with small (clearance check) and large (screen redraw) windows, then edited with
+// interleaved removals, insertions and searches (interactive routing).
+//
+// usage: shape_index_bench [items (default 100000)] [queries (default 200000)]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+#include <common.h>
+
+#include <geometry/rtree.h>
+#include <geometry/packed_rtree.h>
+
+
+// RTree stores the data in the child pointers of the leaves: ids must be pointer-sized
+typedef intptr_t ITEM_ID;
+
+typedef RTree<ITEM_ID, int, 2, float> GENERIC_TREE;
+typedef PACKED_RTREE<ITEM_ID>         PACKED_TREE;
+
+static const int boardSize = 300000000;     // nm
+
+
+struct BOX
+{
+    int m_min[2];
+    int m_max[2];
+};
+
+
+struct COUNTER
+{
+    long m_sum;
+
+    COUNTER() : m_sum( 0 ) {}
+
+    bool operator()( ITEM_ID aItem )
+    {
+        m_sum += aItem;
+        return true;
+    }
+};
+
+
+static BOX randomBox( int aMaxSize )
+{
+    BOX b;
+
+    b.m_min[0] = rand() % boardSize;
+    b.m_min[1] = rand() % boardSize;
+
+    // mostly narrow horizontal or vertical boxes, like track segments
+    int len = 1 + rand() % aMaxSize;
+    int width = 1 + rand() % ( aMaxSize / 20 );
+
+    if( rand() % 2 )
+        std::swap( len, width );
+
+    b.m_max[0] = b.m_min[0] + len;
+    b.m_max[1] = b.m_min[1] + width;
+
+    return b;
+}
+
+
+template <class TREE>
+static void runBench( const char* aName, const std::vector<BOX>& aItems,
+                      const std::vector<BOX>& aSmall, const std::vector<BOX>& aLarge,
+                      const std::vector<BOX>& aEdits )
+{
+    TREE tree;
+    COUNTER small, large, edits;
+    unsigned t0 = GetRunningMicroSecs();
+
+    for( unsigned i = 0; i < aItems.size(); i++ )
+        tree.Insert( aItems[i].m_min, aItems[i].m_max, (ITEM_ID) i );
+
+    // the first search packs the tree
+    int dummy[2] = { 0, 0 };
+    tree.Search( dummy, dummy, small );
+    small.m_sum = 0;
+
+    unsigned t1 = GetRunningMicroSecs();
+
+    for( const BOX& q : aSmall )
+        tree.Search( q.m_min, q.m_max, small );
+
+    unsigned t2 = GetRunningMicroSecs();
+
+    for( const BOX& q : aLarge )
+        tree.Search( q.m_min, q.m_max, large );
+
+    unsigned t3 = GetRunningMicroSecs();
+
+    // move items around, searching their neighbourhood after each move
+    for( unsigned i = 0; i < aEdits.size(); i++ )
+    {
+        ITEM_ID item = i % aItems.size();
+        const BOX& b = aItems[item];
+
+        tree.Remove( b.m_min, b.m_max, item );
+        tree.Insert( aEdits[i].m_min, aEdits[i].m_max, item );
+        tree.Search( aEdits[i].m_min, aEdits[i].m_max, edits );
+    }
+
+    unsigned t4 = GetRunningMicroSecs();
+
+    printf( "%s:\n", aName );
+    printf( "  build %u usecs\n", t1 - t0 );
+    printf( "  %d small queries %u usecs (%.2f usecs each, checksum %ld)\n",
+            (int) aSmall.size(), t2 - t1, (double) ( t2 - t1 ) / aSmall.size(), small.m_sum );
+    printf( "  %d large queries %u usecs (%.2f usecs each, checksum %ld)\n",
+            (int) aLarge.size(), t3 - t2, (double) ( t3 - t2 ) / aLarge.size(), large.m_sum );
+    printf( "  %d edits %u usecs (%.2f usecs each, checksum %ld)\n",
+            (int) aEdits.size(), t4 - t3, (double) ( t4 - t3 ) / aEdits.size(), edits.m_sum );
+}
+
+
+int main( int argc, char** argv )
+{
+    int itemCount  = argc > 1 ? atoi( argv[1] ) : 100000;
+    int queryCount = argc > 2 ? atoi( argv[2] ) : 200000;
+
+    srand( 1 );
+
+    std::vector<BOX> items, small, large, edits;
+
+    for( int i = 0; i < itemCount; i++ )
+        items.push_back( randomBox( 5000000 ) );
+
+    for( int i = 0; i < queryCount; i++ )
+        small.push_back( randomBox( 2000000 ) );
+
+    for( int i = 0; i < queryCount / 1000 + 1; i++ )
+    {
+        BOX b = randomBox( 1000 );
+
+        b.m_max[0] = b.m_min[0] + 40000000;
+        b.m_max[1] = b.m_min[1] + 25000000;
+        large.push_back( b );
+    }
+
+    for( int i = 0; i < queryCount / 10; i++ )
+        edits.push_back( randomBox( 5000000 ) );
+
+    runBench<GENERIC_TREE>( "RTree", items, small, large, edits );
+    runBench<PACKED_TREE>( "PACKED_RTREE", items, small, large, edits );
+
+    return 0;
+}
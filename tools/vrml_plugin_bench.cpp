@@ -0,0 +1,113 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Load time benchmark of a 3D model plugin, usually the VRML one.
+// The plugin is opened as the 3D viewer does and each model of the corpus is loaded
+// (parsed and translated to a scene graph) several times; the best time is kept.
+// The 3D cache is not involved.
+//
+// usage: vrml_plugin_bench <plugin file> <model file> [<model file> ...]
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include <wx/app.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <common.h>
+
+#include <plugins/ldr/3d/pluginldr3D.h>
+#include <plugins/3dapi/ifsg_api.h>
+
+
+static const int runs = 3;
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 3 )
+    {
+        printf( "usage: %s <plugin file> <model file> [<model file> ...]\n", argv[0] );
+        return 1;
+    }
+
+    wxInitializer initializer;
+
+    KICAD_PLUGIN_LDR_3D plugin;
+
+    if( !plugin.Open( wxString::FromUTF8( argv[1] ) ) )
+    {
+        printf( "cannot open the plugin %s\n", argv[1] );
+        return 1;
+    }
+
+    double   totalBytes = 0.0;
+    unsigned totalUsecs = 0;
+
+    for( int i = 2; i < argc; ++i )
+    {
+        wxULongLong size = wxFileName::GetSize( wxString::FromUTF8( argv[i] ) );
+        unsigned best = 0;
+        bool loaded = true;
+
+        for( int run = 0; run < runs && loaded; ++run )
+        {
+            unsigned start = GetRunningMicroSecs();
+            SCENEGRAPH* scene = plugin.Load( argv[i] );
+            unsigned usecs = GetRunningMicroSecs() - start;
+
+            loaded = ( NULL != scene );
+
+            if( scene )
+                S3D::DestroyNode( (SGNODE*) scene );
+
+            if( run == 0 || usecs < best )
+                best = usecs;
+        }
+
+        if( !loaded || size == wxInvalidSize )
+        {
+            printf( "%s: load failed\n", argv[i] );
+            continue;
+        }
+
+        double bytes = size.ToDouble();
+
+        printf( "%s: %.0f bytes in %u usecs, %.2f MB/s\n", argv[i], bytes, best,
+                bytes / std::max( best, 1u ) );
+
+        totalBytes += bytes;
+        totalUsecs += best;
+    }
+
+    printf( "total: %.0f bytes in %u usecs, %.2f MB/s\n", totalBytes, totalUsecs,
+            totalBytes / std::max( totalUsecs, 1u ) );
+
+    plugin.Close();
+
+    return 0;
+}